@@ -0,0 +1,84 @@
+#include <getopt.h>
+#include <spdlog/spdlog.h>
+
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "internal/result_sink.h"
+
+using namespace sudoku;
+
+static const char help_msg[] =
+    R"([?] Usage:
+    $ ./convert_results -i [FILE] [OPTIONS]
+
+    Convert a binary result file (--binary) to the CSV of its log.
+
+    Options:
+      --input,     -i [FILE]    Binary result file (.bin)
+      --output,    -o [FILE]    Output CSV file (default: stdout)
+
+      --help,      -h           Show this help message
+)";
+
+void PrintHelp(std::string msg) {
+  if (!msg.empty()) {
+    spdlog::error("{}", msg);
+    spdlog::info("Use --help or -h to see usage.");
+  } else {
+    spdlog::info("{}", help_msg);
+  }
+}
+
+int main(int argc, char* argv[]) {
+  std::string input_fname = "", output_fname = "";
+
+  // parse argument
+  static struct option long_options[] = {
+      {"input", required_argument, 0, 'i'},
+      {"output", required_argument, 0, 'o'},
+      {"help", optional_argument, 0, 'h'},
+      {0, 0, 0, 0}};
+  if (argc < 2) {
+    PrintHelp("");
+  } else {
+    int opt, idx;
+    while ((opt = getopt_long(argc, argv, "i:o:h", long_options, &idx)) !=
+           -1) {
+      switch (opt) {
+        case 'i':
+          input_fname = std::string(optarg);
+          break;
+        case 'o':
+          output_fname = std::string(optarg);
+          break;
+        case 'h':
+          PrintHelp("");
+          exit(EXIT_SUCCESS);
+        default:
+          PrintHelp("");
+          exit(EXIT_FAILURE);
+      }
+    }
+  }
+  if (input_fname.empty()) {
+    PrintHelp("No input file (--input, -i)");
+    exit(EXIT_FAILURE);
+  }
+
+  bool converted;
+  if (output_fname.empty()) {
+    converted = ConvertResultFileToCSV(input_fname, std::cout);
+  } else {
+    std::ofstream ofs(output_fname);
+    if (!ofs.is_open()) {
+      spdlog::error("Cannot open output file: {}", output_fname);
+      exit(EXIT_FAILURE);
+    }
+    converted = ConvertResultFileToCSV(input_fname, ofs);
+  }
+
+  return converted ? 0 : 1;
+}
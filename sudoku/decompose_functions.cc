@@ -1,11 +1,11 @@
 #include <getopt.h>
 #include <spdlog/spdlog.h>
-#include <unistd.h>
 
 #include <cstdint>
 #include <iostream>
 #include <string>
 
+#include "internal/backend.h"
 #include "internal/constants.h"
 #include "sudoku.h"
 #include "sudoku_addressing.h"
@@ -24,9 +24,25 @@ static const char help_msg[] =
       --size,      -s [INT]     Size of DRAM module in GB
       --rank,      -r [INT]     Number of ranks per DRAM module
       --width,     -w [INT]     DQ width of DRAM (8, 16, or 32)
+      --mapping,   -M [FILE]    DRAM address mapping from an earlier step ({prefix}.mapping.json)
       --functions, -f [HEXes]   DRAM functions in hex, separated by commas
       --row,       -R [HEX]     DRAM row bits
       --column,    -C [HEX]     DRAM column bits
+      --platform,  -P [STR]     Platform profile name (default: auto-detect)
+      --profiles,  -F [FILE]    Custom platform profiles file
+      --spectral,  -E           Estimate refresh intervals spectrally (fewer trials per function)
+      --concurrent, -K          Probe all functions in one refresh capture per window (spectral)
+      --turnarounds, -W         Also time write turnarounds (RDWR, WRRD, WRWR) per pair
+      --budget,    -B [INT]     Total pairs for adaptive trial allocation (default: 0, fixed trials)
+      --pipeline,  -j           Prepare address pairs on a helper thread
+      --helper,    -H [INT]     Helper thread core (with --pipeline, default: another allowed core)
+      --report,    -J           Write a JSON run report ({prefix}.report.json)
+      --checkpoint, -k          Checkpoint long-running phases ({prefix}.checkpoint)
+      --resume,    -u           Resume from {prefix}.checkpoint (implies --checkpoint)
+      --simulate,  -x           Run on the simulated DRAM backend (no sudo)
+      --sim-file,  -X [FILE]    Simulated DRAM file (implies --simulate)
+      --record,    -c [FILE]    Record all oracle calls into a trace file
+      --replay,    -i [FILE]    Replay oracle calls from a trace file (no sudo)
 
       --debug,     -d
       --verbose,   -v
@@ -50,15 +66,25 @@ int main(int argc, char* argv[]) {
            module_size = 32ULL * 1024ULL * 1024ULL * 1024ULL, num_ranks = 2,
            dq_width = 8, row_bits = 0, column_bits = 0;
   DDRType ddr_type = DDRType::DDR4;
+  MappingArtifact mapping;
+  bool mapped = false;
   std::vector<uint64_t> functions = {};
+  std::string platform = "", profiles_fname = "";
+  bool spectral = false;
+  bool concurrent = false;
+  bool turnarounds = false;
+  uint64_t budget = 0;
+  bool pipelined = false;
+  int helper_core = -1;
+  bool report = false;
+  bool checkpoint = false;
+  bool resume = false;
+  bool simulate = false;
+  std::string sim_fname = "";
+  std::string record_fname = "";
+  std::string replay_fname = "";
   bool debug = false, verbose = false, logging = false;
 
-  // check sudo privilege
-  if (getuid() != 0) {
-    spdlog::error("decompose_functions requires sudo privilege.");
-    exit(EXIT_FAILURE);
-  }
-
   // parse argument
   static struct option long_options[] = {
       {"output", optional_argument, 0, 'o'},
@@ -68,9 +94,25 @@ int main(int argc, char* argv[]) {
       {"size", required_argument, 0, 's'},
       {"rank", required_argument, 0, 'r'},
       {"width", required_argument, 0, 'w'},
+      {"mapping", required_argument, 0, 'M'},
       {"functions", required_argument, 0, 'f'},
       {"row", required_argument, 0, 'R'},
       {"column", required_argument, 0, 'C'},
+      {"platform", required_argument, 0, 'P'},
+      {"profiles", required_argument, 0, 'F'},
+      {"spectral", no_argument, 0, 'E'},
+      {"concurrent", no_argument, 0, 'K'},
+      {"turnarounds", no_argument, 0, 'W'},
+      {"budget", required_argument, 0, 'B'},
+      {"pipeline", no_argument, 0, 'j'},
+      {"helper", required_argument, 0, 'H'},
+      {"report", no_argument, 0, 'J'},
+      {"checkpoint", no_argument, 0, 'k'},
+      {"resume", no_argument, 0, 'u'},
+      {"simulate", no_argument, 0, 'x'},
+      {"sim-file", required_argument, 0, 'X'},
+      {"record", required_argument, 0, 'c'},
+      {"replay", required_argument, 0, 'i'},
       {"debug", optional_argument, 0, 'd'},
       {"verbose", optional_argument, 0, 'v'},
       {"log", optional_argument, 0, 'l'},
@@ -80,7 +122,9 @@ int main(int argc, char* argv[]) {
     PrintHelp("");
   } else {
     int opt, idx;
-    while ((opt = getopt_long(argc, argv, "o:p:t:n:s:r:w:f:R:C:dvlh",
+    while ((opt = getopt_long(argc, argv,
+                              "o:p:t:n:s:r:w:M:f:R:C:P:F:EKWB:jH:"
+                              "JkuxX:c:i:dvlh",
                               long_options, &idx)) != -1) {
       switch (opt) {
         case 'o':
@@ -116,6 +160,21 @@ int main(int argc, char* argv[]) {
         case 'w':
           dq_width = strtoull(optarg, NULL, 10);
           break;
+        case 'M':
+          if (!ReadMappingArtifact(std::string(optarg), &mapping)) {
+            exit(EXIT_FAILURE);
+          }
+          mapped = true;
+          ddr_type = mapping.ddr_type;
+          type = (ddr_type == DDRType::DDR5) ? "ddr5" : "ddr4";
+          module_size = mapping.module_size;
+          num_ranks = mapping.num_ranks;
+          dq_width = mapping.dq_width;
+          num_dimms = mapping.num_dimms;
+          functions = mapping.Functions();
+          row_bits = mapping.row_bits;
+          column_bits = mapping.column_bits;
+          break;
         case 'f': {
           std::stringstream ss(optarg);
           std::string token;
@@ -130,6 +189,52 @@ int main(int argc, char* argv[]) {
         case 'C':
           column_bits = strtoull(optarg, NULL, 16);
           break;
+        case 'P':
+          platform = std::string(optarg);
+          break;
+        case 'F':
+          profiles_fname = std::string(optarg);
+          break;
+        case 'E':
+          spectral = true;
+          break;
+        case 'K':
+          concurrent = true;
+          break;
+        case 'W':
+          turnarounds = true;
+          break;
+        case 'B':
+          budget = strtoull(optarg, NULL, 10);
+          break;
+        case 'j':
+          pipelined = true;
+          break;
+        case 'H':
+          helper_core = static_cast<int>(strtol(optarg, NULL, 10));
+          break;
+        case 'J':
+          report = true;
+          break;
+        case 'k':
+          checkpoint = true;
+          break;
+        case 'u':
+          resume = true;
+          break;
+        case 'x':
+          simulate = true;
+          break;
+        case 'X':
+          simulate = true;
+          sim_fname = std::string(optarg);
+          break;
+        case 'c':
+          record_fname = std::string(optarg);
+          break;
+        case 'i':
+          replay_fname = std::string(optarg);
+          break;
         case 'd':
           debug = true;
           break;
@@ -149,8 +254,18 @@ int main(int argc, char* argv[]) {
     }
   }
 
+  InitBackends("decompose_functions", simulate, sim_fname, record_fname,
+               replay_fname, profiles_fname, ddr_type, &platform);
+
   AddressingConfig* addressing_config =
       new AddressingConfig(type, fname_prefix, verbose, debug, logging);
+  addressing_config->checkpoint = checkpoint || resume;
+  addressing_config->pipelined = pipelined;
+  addressing_config->helper_core = helper_core;
+  addressing_config->spectral = spectral;
+  addressing_config->concurrent = concurrent;
+  addressing_config->turnarounds = turnarounds;
+  addressing_config->trial_budget = budget;
   MemoryPoolConfig* memory_pool_config = new MemoryPoolConfig(
       page_size, num_pages, granularity, true /* hugepage */);
   DRAMConfig* dram_config =
@@ -161,11 +276,31 @@ int main(int argc, char* argv[]) {
   Addressing* sudoku = new Addressing(dram_config, memory_config,
                                       memory_pool_config, addressing_config);
   sudoku->Initialize();
+  if (resume && !sudoku->ResumeCheckpoint()) {
+    exit(EXIT_FAILURE);
+  }
+  if (mapped) {
+    if (!sudoku->SetMapping(mapping)) {
+      exit(EXIT_FAILURE);
+    }
+  }
   sudoku->SetAddressingFunctions(functions);
   sudoku->SetRowBits(row_bits);
   sudoku->SetColumnBits(column_bits);
-  sudoku->DecomposeUsingRefreshes();
-  sudoku->DecomposeUsingConsecutiveAccesses();
+  if (!sudoku->Decomposable()) {
+    exit(EXIT_FAILURE);
+  }
+  if (concurrent) {
+    // the concurrent refresh capture does not time single pairs
+    sudoku->DecomposeUsingRefreshes();
+    sudoku->DecomposeUsingConsecutiveAccesses();
+  } else {
+    sudoku->DecomposeFunctions();
+  }
+  sudoku->WriteMapping("decompose_functions");
+  if (report) {
+    sudoku->ReportRun("decompose_functions");
+  }
   sudoku->Finalize();
 
   delete sudoku;
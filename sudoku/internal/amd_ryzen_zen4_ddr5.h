@@ -1,16 +0,0 @@
-#ifndef SUDOKU_INTERNAL_AMD_RYZEN_ZEN4_DDR5_H
-#define SUDOKU_INTERNAL_AMD_RYZEN_ZEN4_DDR5_H
-
-// AMD Ryzen 9 7950X (Zen 4, Raphael)
-#define SBDR_LOWER_BOUND_ 540
-#define SBDR_UPPER_BOUND_ 1000
-#define BANK_GROUP_THRESHOLD_ 590
-#define REFRESH_CYCLE_LOWER_BOUND_ 850
-#define REFRESH_CYCLE_UPPER_BOUND_ 1100
-#define REGULAR_REFRESH_INTERVAL_THRESHOLD_ 12750
-#define PCI_OFFSET_UPPER_BOUND_ 0x100000000
-#define PCI_OFFSET_LOWER_BOUND_ 0xA0000000
-
-// #define IS_RDPRU
-
-#endif  // SUDOKU_INTERNAL_AMD_RYZEN_ZEN4_DDR5_H
\ No newline at end of file
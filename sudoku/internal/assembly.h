@@ -8,6 +8,12 @@ static inline __attribute__((always_inline)) void clflushopt(volatile void* p) {
   asm volatile("clflushopt (%0)\n" : : "r"(p) : "memory");
 }
 
+// Non-temporal store (bypasses the caches through write-combining buffers)
+static inline __attribute__((always_inline)) void movnti(volatile void* p,
+                                                         uint64_t v) {
+  asm volatile("movnti %1, (%0)\n" : : "r"(p), "r"(v) : "memory");
+}
+
 // Load fence
 static inline __attribute__((always_inline)) void lfence() {
   asm volatile("lfence\n" : : : "memory");
@@ -23,6 +29,11 @@ static inline __attribute__((always_inline)) void mfence() {
   asm volatile("mfence\n" : : : "memory");
 }
 
+// Spin-wait hint
+static inline __attribute__((always_inline)) void cpu_pause() {
+  asm volatile("pause\n" : : : "memory");
+}
+
 // Read time-stamp counter and processor id
 // https://github.com/amdprefetch/amd-prefetch-attacks/blob/master/case-studies/kaslr-break/cacheutils.h
 static inline __attribute__((always_inline)) uint64_t rdtscp() {
@@ -0,0 +1,63 @@
+#include "backend.h"
+
+#include <unistd.h>
+
+#include <memory>
+#include <random>
+
+#include "platform.h"
+#include "simulator.h"
+#include "trace.h"
+
+namespace sudoku {
+
+namespace {
+
+std::unique_ptr<Backend> active_backend;
+
+}  // namespace
+
+uint64_t HardwareBackend::RandomSeed() { return std::random_device{}(); }
+
+void SetBackend(Backend* backend) { active_backend.reset(backend); }
+
+Backend& GetBackend() {
+  if (!active_backend) {
+    active_backend.reset(new HardwareBackend());
+  }
+  return *active_backend;
+}
+
+Backend* ReleaseBackend() {
+  GetBackend();
+  return active_backend.release();
+}
+
+void InitBackends(const std::string& binary, bool simulate,
+                  const std::string& sim_fname,
+                  const std::string& record_fname,
+                  const std::string& replay_fname,
+                  const std::string& profiles_fname, DDRType ddr_type,
+                  std::string* platform, bool no_hardware) {
+  if (!no_hardware && !simulate && replay_fname.empty() && getuid() != 0) {
+    spdlog::error("{} requires sudo privilege.", binary);
+    exit(EXIT_FAILURE);
+  }
+  if (!replay_fname.empty()) {
+    std::string recorded = InitReplayBackend(replay_fname);
+    if (platform->empty()) {
+      *platform = recorded;
+    }
+  } else if (simulate) {
+    InitSimulatedBackend(sim_fname);
+    if (platform->empty()) {
+      *platform = "simulated";
+    }
+  }
+  InitPlatformProfile(*platform, profiles_fname, ddr_type);
+  if (!record_fname.empty()) {
+    InitRecordingBackend(record_fname);
+  }
+}
+
+}  // namespace sudoku
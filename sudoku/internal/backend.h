@@ -0,0 +1,131 @@
+#ifndef SUDOKU_INTERNAL_BACKEND_H
+#define SUDOKU_INTERNAL_BACKEND_H
+
+#include <stddef.h>
+
+#include <cstdint>
+#include <string>
+
+#include "config.h"
+#include "consecutive_accesses.h"
+
+namespace sudoku {
+
+class RefreshScheduler;
+
+/// @brief Memory and timing source beneath the memory pool and the conflict,
+/// refresh, and consecutive access oracles. The kernels fill histograms in
+/// the layouts of the oracle functions of the same names (see conflicts.h,
+/// refreshes.h, and consecutive_accesses.h); the oracles count and
+/// post-process the measurements on top of the active backend.
+class Backend {
+ public:
+  virtual ~Backend() = default;
+
+  virtual std::string Name() const = 0;
+
+  // Memory pool pages and their physical addresses
+  virtual char* MapPage(uint64_t page_size, bool huge) = 0;
+  virtual void UnmapPage(char* page, uint64_t page_size) = 0;
+  virtual uint64_t VirtToPhys(uint64_t vaddr) = 0;
+
+  // Timestamp counter of the kernels (cycles)
+  virtual uint64_t Timestamp() = 0;
+  // Seed of the memory pool's address generator
+  virtual uint64_t RandomSeed() = 0;
+
+  // Conflicts
+  virtual void AccessTimingSingleMemoryAccess(uint64_t addr,
+                                              uint64_t** histogram) = 0;
+  virtual void AccessTimingPairedMemoryAccess(uint64_t faddr, uint64_t saddr,
+                                              uint64_t** histogram) = 0;
+  virtual void AccessTimingPairedMemoryAccessScheduled(
+      uint64_t faddr, uint64_t saddr, RefreshScheduler& scheduler,
+      uint64_t** histogram) = 0;
+  virtual void AccessTimingBatchedPairedMemoryAccess(const uint64_t* faddrs,
+                                                     const uint64_t* saddrs,
+                                                     size_t num_pairs,
+                                                     uint64_t** histogram) = 0;
+
+  // Refreshes
+  virtual void MeasureRefreshSingleAccess(uint64_t addr,
+                                          uint64_t** histogram) = 0;
+  virtual void MeasureRefreshPairedAccessCoarse(uint64_t faddr, uint64_t saddr,
+                                                uint64_t** histogram) = 0;
+  virtual void MeasureRefreshPairedAccessFine(uint64_t faddr, uint64_t saddr,
+                                              uint64_t** histogram) = 0;
+  virtual void MeasureRefreshMultiAccess(const uint64_t* addrs,
+                                         size_t num_addrs,
+                                         uint64_t num_iterations,
+                                         uint64_t** histogram) = 0;
+
+  // Consecutive accesses
+  virtual void ConsecutiveAccessLatency(ConsecutiveAccess pattern,
+                                        const uint64_t* faddrs,
+                                        const uint64_t* saddrs, size_t length,
+                                        uint64_t** histogram) = 0;
+};
+
+/// @brief Backend timing the DRAM of this machine. Pages are (huge) anonymous
+/// mappings translated through /proc/self/pagemap, so it requires sudo
+/// privilege. The kernels live next to their oracles.
+class HardwareBackend : public Backend {
+ public:
+  std::string Name() const override { return "hardware"; }
+
+  char* MapPage(uint64_t page_size, bool huge) override;
+  void UnmapPage(char* page, uint64_t page_size) override;
+  uint64_t VirtToPhys(uint64_t vaddr) override;
+
+  uint64_t Timestamp() override;
+  uint64_t RandomSeed() override;
+
+  void AccessTimingSingleMemoryAccess(uint64_t addr,
+                                      uint64_t** histogram) override;
+  void AccessTimingPairedMemoryAccess(uint64_t faddr, uint64_t saddr,
+                                      uint64_t** histogram) override;
+  void AccessTimingPairedMemoryAccessScheduled(uint64_t faddr, uint64_t saddr,
+                                               RefreshScheduler& scheduler,
+                                               uint64_t** histogram) override;
+  void AccessTimingBatchedPairedMemoryAccess(const uint64_t* faddrs,
+                                             const uint64_t* saddrs,
+                                             size_t num_pairs,
+                                             uint64_t** histogram) override;
+
+  void MeasureRefreshSingleAccess(uint64_t addr,
+                                  uint64_t** histogram) override;
+  void MeasureRefreshPairedAccessCoarse(uint64_t faddr, uint64_t saddr,
+                                        uint64_t** histogram) override;
+  void MeasureRefreshPairedAccessFine(uint64_t faddr, uint64_t saddr,
+                                      uint64_t** histogram) override;
+  void MeasureRefreshMultiAccess(const uint64_t* addrs, size_t num_addrs,
+                                 uint64_t num_iterations,
+                                 uint64_t** histogram) override;
+
+  void ConsecutiveAccessLatency(ConsecutiveAccess pattern,
+                                const uint64_t* faddrs, const uint64_t* saddrs,
+                                size_t length, uint64_t** histogram) override;
+};
+
+// Active backend (the hardware backend when not set). SetBackend takes
+// ownership and must be called before the memory pool is initialized;
+// ReleaseBackend hands the active backend over (e.g., to a wrapper).
+void SetBackend(Backend* backend);
+Backend& GetBackend();
+Backend* ReleaseBackend();
+
+// Backends and platform profile of a binary's main(). Exits unless it runs
+// with sudo privilege or without hardware access (simulated, replayed, or
+// no_hardware). Replays replay_fname (platform defaults to the recorded one)
+// or simulates sim_fname (platform defaults to "simulated"), selects the
+// platform profile, and records oracle calls into record_fname if set.
+void InitBackends(const std::string& binary, bool simulate,
+                  const std::string& sim_fname,
+                  const std::string& record_fname,
+                  const std::string& replay_fname,
+                  const std::string& profiles_fname, DDRType ddr_type,
+                  std::string* platform, bool no_hardware = false);
+
+}  // namespace sudoku
+
+#endif  // SUDOKU_INTERNAL_BACKEND_H
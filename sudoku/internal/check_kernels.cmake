@@ -0,0 +1,113 @@
+# Check the disassembly of the timing kernels (kernels.cc) against their
+# source: the flushes, fences, timestamps, loads, non-temporal stores, and
+# calls of each kernel must appear in the order the source spells out, so
+# nothing is reordered into, or hoisted out of, a timed window.
+#
+# Usage: cmake -DOBJDUMP=objdump -DLIBRARY=libsudoku_kernel_lib.a \
+#            -P check_kernels.cmake
+
+execute_process(
+    COMMAND ${OBJDUMP} -d -C --no-show-raw-insn ${LIBRARY}
+    OUTPUT_VARIABLE disassembly
+    RESULT_VARIABLE result
+)
+if(NOT result EQUAL 0)
+    message(FATAL_ERROR "Cannot disassemble ${LIBRARY}")
+endif()
+
+# Keep the function labels and the instructions of interest
+string(REPLACE ";" "," disassembly "${disassembly}")
+string(REGEX MATCHALL
+    "[^\n]*(>:|\tclflushopt|\t[lms]fence|\trdtscp|\trdpru|\tmovnti|\tcall|\tmovzbl +\\()[^\n]*"
+    lines "${disassembly}")
+
+# Sequence of each function: load (single byte read), movnti, call, and the
+# flushes, fences, and timestamps (rdpru counts as rdtscp)
+set(functions "")
+set(index -1)
+foreach(line IN LISTS lines)
+    if(line MATCHES "^[0-9a-f]+ <(.*)>:$")
+        math(EXPR index "${index} + 1")
+        list(APPEND functions "${CMAKE_MATCH_1}")
+        set(sequence_${index} "")
+    elseif(line MATCHES "\t(clflushopt|[lms]fence|rdtscp|rdpru|movnti|call|movzbl)")
+        set(op ${CMAKE_MATCH_1})
+        if(op STREQUAL "rdpru")
+            set(op rdtscp)
+        elseif(op STREQUAL "movzbl")
+            set(op load)
+        endif()
+        set(sequence_${index} "${sequence_${index}} ${op}")
+    endif()
+endforeach()
+
+set(failures 0)
+set(checked 0)
+
+# Check every function whose demangled name contains name_part
+function(check_kernel name_part expected)
+    set(found FALSE)
+    set(index 0)
+    foreach(function IN LISTS functions)
+        string(FIND "${function}" "${name_part}" position)
+        if(NOT position EQUAL -1)
+            set(found TRUE)
+            string(STRIP "${sequence_${index}}" sequence)
+            if(NOT sequence MATCHES "^${expected}$")
+                message(SEND_ERROR "${function}\n"
+                                   "  expected: ${expected}\n"
+                                   "  found:    ${sequence}")
+                math(EXPR failures "${failures} + 1")
+            endif()
+            math(EXPR checked "${checked} + 1")
+        endif()
+        math(EXPR index "${index} + 1")
+    endforeach()
+    if(NOT found)
+        message(SEND_ERROR "Missing kernel: ${name_part}")
+        math(EXPR failures "${failures} + 1")
+    endif()
+    set(failures ${failures} PARENT_SCOPE)
+    set(checked ${checked} PARENT_SCOPE)
+endfunction()
+
+set(single "clflushopt mfence rdtscp load lfence rdtscp")
+set(paired "clflushopt clflushopt mfence rdtscp load load lfence rdtscp")
+
+check_kernel("HardwareBackend::Timestamp()" "rdtscp")
+check_kernel("HardwareBackend::AccessTimingSingleMemoryAccess(" "${single}")
+check_kernel("HardwareBackend::AccessTimingPairedMemoryAccess(" "${paired}")
+# the scheduler re-locks (calls) before the flushes and waits (calls) between
+# the fence and the first timestamp
+check_kernel("HardwareBackend::AccessTimingPairedMemoryAccessScheduled("
+    "((load|call) )*clflushopt clflushopt mfence( call| load)* rdtscp load load lfence rdtscp")
+# flushes of a pair overlap with the timing of the next pair
+check_kernel("HardwareBackend::AccessTimingBatchedPairedMemoryAccess("
+    "${paired} clflushopt clflushopt")
+check_kernel("HardwareBackend::MeasureRefreshSingleAccess(" "${single}")
+check_kernel("HardwareBackend::MeasureRefreshPairedAccessCoarse(" "${paired}")
+check_kernel("HardwareBackend::MeasureRefreshPairedAccessFine("
+    "clflushopt clflushopt mfence rdtscp load lfence rdtscp load lfence rdtscp")
+check_kernel("HardwareBackend::MeasureRefreshMultiAccess(" "${single}")
+
+# Consecutive access streams (RDRD, RDWR, WRRD, and WRWR): straight-line
+# streams of one and two pairs, and the fallback loop
+set(patterns 0 1 2 3)
+set(first_ops load load movnti movnti)
+set(second_ops load movnti load movnti)
+foreach(pattern IN LISTS patterns)
+    list(GET first_ops ${pattern} first)
+    list(GET second_ops ${pattern} second)
+    set(kernel "<(sudoku::ConsecutiveAccess)${pattern}")
+    check_kernel("ConsecutiveAccessLatencyUnrolled${kernel}, 0ul>("
+        "clflushopt clflushopt mfence rdtscp ${first} ${second} mfence rdtscp")
+    check_kernel("ConsecutiveAccessLatencyUnrolled${kernel}, 0ul, 1ul>("
+        "clflushopt clflushopt clflushopt clflushopt mfence rdtscp ${first} ${second} ${first} ${second} mfence rdtscp")
+    check_kernel("ConsecutiveAccessLatencyLoop${kernel}>("
+        "clflushopt clflushopt mfence rdtscp ${first} ${second} mfence rdtscp")
+endforeach()
+
+if(failures GREATER 0)
+    message(FATAL_ERROR "${failures} timing kernel(s) do not match their source")
+endif()
+message(STATUS "Timing kernels match their source (${checked} checked)")
@@ -0,0 +1,279 @@
+#include "checkpoint.h"
+
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iterator>
+
+#include "constants.h"
+
+namespace sudoku {
+
+static volatile sig_atomic_t interrupted = 0;
+static time_t last_checkpoint = 0;
+
+// A second SIGINT terminates the run right away
+static void HandleInterrupt(int) {
+  interrupted = 1;
+  std::signal(SIGINT, SIG_DFL);
+}
+
+static void PutDouble(double value, std::vector<uint8_t>* out) {
+  uint8_t bytes[sizeof(value)];
+  memcpy(bytes, &value, sizeof(value));
+  out->insert(out->end(), bytes, bytes + sizeof(bytes));
+}
+
+static bool GetDouble(const uint8_t** p, const uint8_t* end, double* value) {
+  if (static_cast<size_t>(end - *p) < sizeof(*value)) {
+    return false;
+  }
+  memcpy(value, *p, sizeof(*value));
+  *p += sizeof(*value);
+  return true;
+}
+
+static void PutStatistics(const RunningStatistics& stats,
+                          std::vector<uint8_t>* out) {
+  PutVarint(stats.count, out);
+  PutVarint(stats.minimum, out);
+  PutVarint(stats.maximum, out);
+  PutDouble(stats.mean, out);
+  PutDouble(stats.m2, out);
+  for (size_t i = 0; i < 5; ++i) {
+    PutDouble(stats.heights[i], out);
+    PutDouble(stats.positions[i], out);
+    PutDouble(stats.desired[i], out);
+  }
+}
+
+static bool GetStatistics(const uint8_t** p, const uint8_t* end,
+                          RunningStatistics* stats) {
+  bool ok = GetVarint(p, end, &stats->count) &&
+            GetVarint(p, end, &stats->minimum) &&
+            GetVarint(p, end, &stats->maximum) &&
+            GetDouble(p, end, &stats->mean) && GetDouble(p, end, &stats->m2);
+  for (size_t i = 0; i < 5 && ok; ++i) {
+    ok = GetDouble(p, end, &stats->heights[i]) &&
+         GetDouble(p, end, &stats->positions[i]) &&
+         GetDouble(p, end, &stats->desired[i]);
+  }
+  return ok;
+}
+
+// Zigzag deltas of sorted or similar values (addresses and latencies)
+static void PutDeltas(const std::vector<uint64_t>& values,
+                      std::vector<uint8_t>* out) {
+  PutVarint(values.size(), out);
+  uint64_t previous = 0;
+  for (const auto& value : values) {
+    PutVarint(ZigZag(value, previous), out);
+    previous = value;
+  }
+}
+
+static bool GetDeltas(const uint8_t** p, const uint8_t* end,
+                      std::vector<uint64_t>* values) {
+  uint64_t count, value, previous = 0;
+  if (!GetVarint(p, end, &count)) {
+    return false;
+  }
+  values->clear();
+  for (uint64_t i = 0; i < count; ++i) {
+    if (!GetVarint(p, end, &value)) {
+      return false;
+    }
+    previous = UnZigZag(value, previous);
+    values->push_back(previous);
+  }
+  return true;
+}
+
+bool WriteCheckpoint(std::string fname, const Checkpoint& checkpoint) {
+  std::vector<uint8_t> buffer;
+  CheckpointFileHeader header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, SUDOKU_CHECKPOINT_MAGIC, sizeof(header.magic));
+  header.version = SUDOKU_CHECKPOINT_VERSION;
+  const uint8_t* raw = reinterpret_cast<const uint8_t*>(&header);
+  buffer.insert(buffer.end(), raw, raw + sizeof(header));
+
+  buffer.push_back(static_cast<uint8_t>(CheckpointRecord::RNG));
+  PutVarint(checkpoint.rng.size(), &buffer);
+  buffer.insert(buffer.end(), checkpoint.rng.begin(), checkpoint.rng.end());
+
+  buffer.push_back(static_cast<uint8_t>(CheckpointRecord::FUNCTIONS));
+  PutVarint(checkpoint.functions.size(), &buffer);
+  for (const auto& function : checkpoint.functions) {
+    PutVarint(function, &buffer);
+  }
+
+  buffer.push_back(static_cast<uint8_t>(CheckpointRecord::SETS));
+  PutVarint(checkpoint.sets.size(), &buffer);
+  for (const auto& set : checkpoint.sets) {
+    PutDeltas(set, &buffer);
+  }
+
+  for (const auto& entry : checkpoint.masks) {
+    buffer.push_back(static_cast<uint8_t>(CheckpointRecord::MASK));
+    PutVarint(entry.first, &buffer);
+    PutVarint(entry.second.row_bit_score, &buffer);
+    PutVarint(entry.second.column_bit_score, &buffer);
+    PutVarint(entry.second.effective_trials, &buffer);
+    PutVarint(entry.second.trials, &buffer);
+  }
+
+  // function, refresh tallies, latencies per pattern, and RDRD samples
+  for (const auto& evidence : checkpoint.evidences) {
+    buffer.push_back(static_cast<uint8_t>(CheckpointRecord::EVIDENCE));
+    PutVarint(evidence.function, &buffer);
+    PutVarint(evidence.refresh_trials, &buffer);
+    PutVarint(evidence.refresh_attempts, &buffer);
+    PutVarint(evidence.normal_interval_score, &buffer);
+    PutVarint(evidence.reduced_interval_score, &buffer);
+    PutVarint(evidence.latencies.size(), &buffer);
+    for (const auto& stats : evidence.latencies) {
+      PutStatistics(stats, &buffer);
+    }
+    PutDeltas(evidence.rdrd_samples, &buffer);
+  }
+
+  buffer.push_back(static_cast<uint8_t>(CheckpointRecord::PAIRS));
+  PutVarint(checkpoint.num_pairs, &buffer);
+
+  std::string tmp_fname = fname + ".tmp";
+  std::ofstream ofs(tmp_fname, std::ios::binary | std::ios::trunc);
+  if (!ofs.is_open()) {
+    PRINT_ERROR("Cannot create checkpoint file: {}", tmp_fname);
+    return false;
+  }
+  ofs.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+  ofs.close();
+  if (!ofs.good() || std::rename(tmp_fname.c_str(), fname.c_str()) != 0) {
+    PRINT_ERROR("Cannot write checkpoint file: {}", fname);
+    return false;
+  }
+  return true;
+}
+
+bool ReadCheckpoint(std::string fname, Checkpoint* checkpoint) {
+  std::ifstream ifs(fname, std::ios::binary);
+  if (!ifs.is_open()) {
+    PRINT_ERROR("Cannot open checkpoint file: {}", fname);
+    return false;
+  }
+  std::vector<uint8_t> data((std::istreambuf_iterator<char>(ifs)),
+                            std::istreambuf_iterator<char>());
+
+  CheckpointFileHeader header;
+  if (data.size() < sizeof(header)) {
+    PRINT_ERROR("Not a checkpoint file: {}", fname);
+    return false;
+  }
+  memcpy(&header, data.data(), sizeof(header));
+  if (memcmp(header.magic, SUDOKU_CHECKPOINT_MAGIC, sizeof(header.magic)) !=
+          0 ||
+      header.version != SUDOKU_CHECKPOINT_VERSION) {
+    PRINT_ERROR("Not a checkpoint file (or unsupported version): {}", fname);
+    return false;
+  }
+
+  // Checkpoints are renamed into place, so any malformed record is an error
+  const uint8_t* p = data.data() + sizeof(header);
+  const uint8_t* end = data.data() + data.size();
+  bool ok = true;
+  while (p < end && ok) {
+    CheckpointRecord record = static_cast<CheckpointRecord>(*p++);
+    uint64_t count = 0, value = 0;
+    if (record == CheckpointRecord::RNG) {
+      ok = GetVarint(&p, end, &count) &&
+           static_cast<uint64_t>(end - p) >= count;
+      if (ok) {
+        checkpoint->rng.assign(reinterpret_cast<const char*>(p), count);
+        p += count;
+      }
+    } else if (record == CheckpointRecord::FUNCTIONS) {
+      ok = GetVarint(&p, end, &count);
+      checkpoint->functions.clear();
+      for (uint64_t i = 0; i < count && ok; ++i) {
+        ok = GetVarint(&p, end, &value);
+        checkpoint->functions.push_back(value);
+      }
+    } else if (record == CheckpointRecord::SETS) {
+      ok = GetVarint(&p, end, &count);
+      checkpoint->sets.clear();
+      for (uint64_t i = 0; i < count && ok; ++i) {
+        checkpoint->sets.emplace_back();
+        ok = GetDeltas(&p, end, &checkpoint->sets.back());
+      }
+    } else if (record == CheckpointRecord::MASK) {
+      MaskScore score;
+      ok = GetVarint(&p, end, &value) &&
+           GetVarint(&p, end, &score.row_bit_score) &&
+           GetVarint(&p, end, &score.column_bit_score) &&
+           GetVarint(&p, end, &score.effective_trials) &&
+           GetVarint(&p, end, &score.trials);
+      if (ok) {
+        checkpoint->masks[value] = score;
+      }
+    } else if (record == CheckpointRecord::EVIDENCE) {
+      ok = GetVarint(&p, end, &value);
+      FunctionEvidence evidence(value);
+      ok = ok && GetVarint(&p, end, &evidence.refresh_trials) &&
+           GetVarint(&p, end, &evidence.refresh_attempts) &&
+           GetVarint(&p, end, &evidence.normal_interval_score) &&
+           GetVarint(&p, end, &evidence.reduced_interval_score) &&
+           GetVarint(&p, end, &count) && count == evidence.latencies.size();
+      for (uint64_t i = 0; i < count && ok; ++i) {
+        ok = GetStatistics(&p, end, &evidence.latencies[i]);
+      }
+      ok = ok && GetDeltas(&p, end, &evidence.rdrd_samples);
+      if (ok) {
+        checkpoint->evidences.push_back(evidence);
+      }
+    } else if (record == CheckpointRecord::PAIRS) {
+      ok = GetVarint(&p, end, &checkpoint->num_pairs);
+    } else {
+      ok = false;
+    }
+  }
+  if (!ok) {
+    PRINT_ERROR("Corrupted checkpoint file: {}", fname);
+    return false;
+  }
+  return true;
+}
+
+void StartCheckpointTimer() { last_checkpoint = time(nullptr); }
+
+bool CheckpointDue() {
+  return interrupted || (time(nullptr) - last_checkpoint >=
+                         SUDOKU_CHECKPOINT_INTERVAL_SECONDS);
+}
+
+bool CheckpointInterrupted() { return interrupted; }
+
+CheckpointedPhase::CheckpointedPhase(bool enabled)
+    : enabled_(enabled), previous_(SIG_DFL) {
+  if (enabled_) {
+    previous_ = std::signal(SIGINT, HandleInterrupt);
+  }
+}
+
+CheckpointedPhase::~CheckpointedPhase() {
+  if (!enabled_) {
+    return;
+  }
+  // Nested phases keep catching; the outermost one delivers a pending SIGINT
+  if (previous_ == HandleInterrupt && !interrupted) {
+    return;
+  }
+  std::signal(SIGINT, previous_ == HandleInterrupt ? SIG_DFL : previous_);
+  if (interrupted) {
+    std::raise(SIGINT);
+  }
+}
+
+}  // namespace sudoku
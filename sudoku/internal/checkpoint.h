@@ -0,0 +1,108 @@
+#ifndef SUDOKU_INTERNAL_CHECKPOINT_H
+#define SUDOKU_INTERNAL_CHECKPOINT_H
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "consecutive_accesses.h"
+#include "utils.h"
+
+namespace sudoku {
+
+#define SUDOKU_CHECKPOINT_MAGIC "SDKCKPT"
+#define SUDOKU_CHECKPOINT_VERSION 1
+
+/// @brief Per-function evidence from the refresh and consecutive access
+/// oracles, measured on the same constrained address pairs
+struct FunctionEvidence {
+  uint64_t function;
+  uint64_t refresh_trials;
+  uint64_t refresh_attempts;
+  uint64_t normal_interval_score;
+  uint64_t reduced_interval_score;
+  // average latency per pair, indexed like ConsecutiveAccesses
+  std::vector<RunningStatistics> latencies;
+  std::vector<uint64_t> rdrd_samples;  // average RDRD latency per pair
+
+  explicit FunctionEvidence(uint64_t f)
+      : function(f),
+        refresh_trials(0),
+        refresh_attempts(0),
+        normal_interval_score(0),
+        reduced_interval_score(0),
+        latencies(sizeof(ConsecutiveAccesses) /
+                  sizeof(ConsecutiveAccesses[0])) {}
+};
+
+/// @brief Scores of a bitmask checked when identifying row and column bits
+struct MaskScore {
+  uint64_t row_bit_score;
+  uint64_t column_bit_score;
+  uint64_t effective_trials;
+  uint64_t trials;
+};
+
+// Records of a checkpoint file
+enum class CheckpointRecord : uint8_t {
+  RNG = 0,    // length-prefixed state of the pool's generator
+  FUNCTIONS,  // count, functions: varints
+  SETS,       // count, then per set a count and zigzag-delta addresses
+  MASK,       // mask, scores, effective trials, trials: varints
+  EVIDENCE,   // see WriteCheckpoint
+  PAIRS,      // pairs measured when decomposing: varint
+};
+
+/// @brief Header of a checkpoint file, followed by the records
+struct CheckpointFileHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t reserved;
+};
+
+/// @brief In-progress state of the long-running phases: same-bank sets
+/// (CollectSameBankPairs), scored bitmasks (CheckUnusedBits and
+/// CheckUsedBits), and per-function evidence (DecomposeFunctions). Addresses
+/// are physical, so a resumed run maps them into its own pool.
+struct Checkpoint {
+  std::string rng;  // std::mt19937 state of the memory pool
+  // functions the masks and evidences were measured with
+  std::vector<uint64_t> functions;
+  std::vector<std::vector<uint64_t>> sets;
+  std::map<uint64_t, MaskScore> masks;
+  std::vector<FunctionEvidence> evidences;
+  uint64_t num_pairs = 0;
+};
+
+// Write the checkpoint to fname.tmp and rename it over fname, so a run killed
+// while writing keeps its previous checkpoint
+bool WriteCheckpoint(std::string fname, const Checkpoint& checkpoint);
+bool ReadCheckpoint(std::string fname, Checkpoint* checkpoint);
+
+// Start the checkpoint timer
+void StartCheckpointTimer();
+// True once SUDOKU_CHECKPOINT_INTERVAL_SECONDS passed since the timer was
+// (re)started or SIGINT was caught
+bool CheckpointDue();
+bool CheckpointInterrupted();
+
+/// @brief Catches SIGINT (Ctrl-C) while a checkpointed phase runs, where it
+/// only requests a final checkpoint; a second SIGINT terminates the run.
+/// Outside of these phases SIGINT terminates the run right away, also if it
+/// was caught but the phase ended before checkpointing.
+class CheckpointedPhase {
+ public:
+  explicit CheckpointedPhase(bool enabled);
+  CheckpointedPhase(const CheckpointedPhase&) = delete;
+  CheckpointedPhase& operator=(const CheckpointedPhase&) = delete;
+  ~CheckpointedPhase();
+
+ private:
+  bool enabled_;
+  void (*previous_)(int);
+};
+
+}  // namespace sudoku
+
+#endif  // SUDOKU_INTERNAL_CHECKPOINT_H
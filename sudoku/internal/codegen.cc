@@ -0,0 +1,247 @@
+#include "codegen.h"
+
+#include <spdlog/fmt/fmt.h>
+
+#include <cctype>
+#include <fstream>
+#include <random>
+#include <vector>
+
+#include "constants.h"
+#include "translator.h"
+#include "utils.h"
+
+namespace sudoku {
+
+namespace {
+
+/// @brief Component of the generated Coordinate: its functions (XOR-reduced,
+/// function i is bit i) or its bits (packed in address order)
+struct Component {
+  std::string field;     // member of Coordinate
+  std::string function;  // decoding function
+  std::string constant;  // prefix of the function constants
+  std::vector<uint64_t> functions;
+  uint64_t bits;
+
+  uint64_t Width() const {
+    return bits ? static_cast<uint64_t>(__builtin_popcountll(bits))
+                : functions.size();
+  }
+};
+
+// Decoding expression of a component
+std::string DecodeExpression(const Component& component) {
+  std::vector<std::string> terms;
+  for (size_t i = 0; i < component.functions.size(); ++i) {
+    std::string term =
+        fmt::format("Parity(paddr & {}{})", component.constant, i);
+    terms.push_back(i ? fmt::format("({} << {})", term, i) : term);
+  }
+  // Runs of consecutive bits are shifted and masked at once
+  uint64_t bits = component.bits, position = 0;
+  while (bits) {
+    uint64_t start = __builtin_ctzll(bits);
+    uint64_t length = __builtin_ctzll(~(bits >> start));
+    uint64_t mask = (length == 64) ? ~0ULL : ((1ULL << length) - 1);
+    std::string term = fmt::format("((paddr >> {}) & {:#x})", start, mask);
+    if (position) {
+      term = fmt::format("({} << {})", term, position);
+    }
+    terms.push_back(term);
+    bits &= ~(mask << start);
+    position += length;
+  }
+  std::string expression;
+  for (size_t i = 0; i < terms.size(); ++i) {
+    expression += (i ? " |\n         " : "") + terms[i];
+  }
+  if (component.bits) {
+    expression = "static_cast<uint32_t>(" + expression + ")";
+  }
+  return expression;
+}
+
+std::string CoordinateLiteral(const DRAMCoordinate& coordinate) {
+  return fmt::format("Coordinate{{{:#x}, {:#x}, {:#x}, {:#x}, {:#x}, {:#x}}}",
+                     coordinate.channel, coordinate.rank,
+                     coordinate.bank_group, coordinate.bank, coordinate.row,
+                     coordinate.column);
+}
+
+}  // namespace
+
+std::string MappingHeaderName(const MappingArtifact& mapping) {
+  std::string name = "sudoku_";
+  for (char c : mapping.platform.empty() ? std::string("mapping")
+                                         : mapping.platform) {
+    name += std::isalnum(static_cast<unsigned char>(c))
+                ? static_cast<char>(std::tolower(c))
+                : '_';
+  }
+  return name;
+}
+
+bool WriteMappingHeader(std::string fname, const MappingArtifact& mapping,
+                        std::string name, std::string source) {
+  DRAMTranslator translator;
+  if (!translator.Build(mapping)) {
+    return false;
+  }
+  if (!translator.Invertible()) {
+    PRINT_ERROR("DRAM address mapping is not invertible: {}", source);
+    return false;
+  }
+
+  // Roles as in DRAMTranslator::Build (unknown roles are bank addresses)
+  std::vector<uint64_t> bank_address_functions =
+      mapping.Functions(FunctionRole::BANK_ADDRESS);
+  for (const auto& function : mapping.Functions(FunctionRole::UNKNOWN)) {
+    bank_address_functions.push_back(function);
+  }
+  std::vector<Component> components = {
+      {"channel", "Channel", "kChannelFunction",
+       mapping.Functions(FunctionRole::CHANNEL), 0},
+      {"rank", "Rank", "kRankFunction", mapping.Functions(FunctionRole::RANK),
+       0},
+      {"bank_group", "BankGroup", "kBankGroupFunction",
+       mapping.Functions(FunctionRole::BANK_GROUP), 0},
+      {"bank", "Bank", "kBankAddressFunction", bank_address_functions, 0},
+      {"row", "Row", "", {}, mapping.row_bits},
+      {"column", "Column", "", {}, mapping.column_bits},
+  };
+  uint64_t num_code_bits = 0;
+  for (const auto& component : components) {
+    num_code_bits += component.Width();
+  }
+  if (num_code_bits == 0) {
+    PRINT_ERROR("DRAM address mapping is empty: {}", source);
+    return false;
+  }
+
+  std::ofstream ofs(fname);
+  if (!ofs.is_open()) {
+    PRINT_ERROR("Cannot open header file: {}", fname);
+    return false;
+  }
+  std::string guard = name + "_H";
+  for (auto& c : guard) {
+    c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+  }
+
+  ofs << fmt::format(
+      "// DRAM address mapping of {} ({}, {} x {} GB, {} rank(s), x{})\n"
+      "// Generated by sudoku_codegen from {} (format version {}, written by\n"
+      "// {}); do not edit.\n"
+      "#ifndef {}\n#define {}\n\n#include <cstdint>\n\nnamespace {} {{\n\n",
+      mapping.platform, DDRTypeStr[static_cast<int>(mapping.ddr_type)],
+      mapping.num_dimms, mapping.module_size / GB, mapping.num_ranks,
+      mapping.dq_width, source, mapping.version, mapping.binary, guard, guard,
+      name);
+
+  ofs << "// Physical addresses are DRAM addresses (PCI offset removed)\n"
+      << fmt::format("constexpr uint64_t kPCIOffset = {:#x};\n\n",
+                     mapping.pci_offset);
+  ofs << "// Functions by role (function i is bit i of its component)\n";
+  for (const auto& component : components) {
+    for (size_t i = 0; i < component.functions.size(); ++i) {
+      ofs << fmt::format("constexpr uint64_t {}{} = {:#x};\n",
+                         component.constant, i, component.functions[i]);
+    }
+  }
+  ofs << fmt::format("constexpr uint64_t kRowBits = {:#x};\n",
+                     mapping.row_bits)
+      << fmt::format("constexpr uint64_t kColumnBits = {:#x};\n",
+                     mapping.column_bits)
+      << "// Address bits set by the coordinates; EncodeAddress takes the\n"
+      << "// others (e.g., the cacheline offset) from its base\n"
+      << fmt::format("constexpr uint64_t kPivotBits = {:#x};\n\n",
+                     translator.PivotBits());
+
+  ofs << "struct Coordinate {\n";
+  for (const auto& component : components) {
+    ofs << "  uint32_t " << component.field << ";\n";
+  }
+  ofs << "};\n\n"
+      << "constexpr uint32_t Parity(uint64_t value) {\n"
+      << "  return static_cast<uint32_t>(__builtin_parityll(value));\n"
+      << "}\n\n";
+
+  for (const auto& component : components) {
+    if (component.Width() == 0) {
+      ofs << fmt::format("constexpr uint32_t {}(uint64_t) {{ return 0; }}\n\n",
+                         component.function);
+    } else {
+      ofs << fmt::format(
+          "constexpr uint32_t {}(uint64_t paddr) {{\n  return {};\n}}\n\n",
+          component.function, DecodeExpression(component));
+    }
+  }
+  ofs << "constexpr Coordinate DecodeAddress(uint64_t paddr) {\n"
+      << "  return Coordinate{Channel(paddr), Rank(paddr), BankGroup(paddr),\n"
+      << "                    Bank(paddr), Row(paddr), Column(paddr)};\n"
+      << "}\n\n";
+
+  // Inverse: XOR of the address of each set coordinate bit alone
+  ofs << "constexpr uint64_t Select(uint32_t value, uint32_t bit, "
+         "uint64_t address) {\n"
+      << "  return (0 - static_cast<uint64_t>((value >> bit) & 1)) & "
+         "address;\n"
+      << "}\n\n"
+      << "constexpr uint64_t PivotAddress(const Coordinate& coordinate) {\n"
+      << "  return ";
+  uint64_t code_bit = 0;
+  for (const auto& component : components) {
+    for (uint64_t bit = 0; bit < component.Width(); ++bit, ++code_bit) {
+      ofs << fmt::format("{}Select(coordinate.{}, {}, {:#x})",
+                         code_bit ? " ^\n         " : "", component.field,
+                         bit, translator.Decode(1ULL << code_bit));
+    }
+  }
+  ofs << ";\n}\n\n"
+      << "constexpr uint64_t EncodeAddress(const Coordinate& coordinate,\n"
+      << "                                 uint64_t base = 0) {\n"
+      << "  return (base & ~kPivotBits) ^ PivotAddress(coordinate) ^\n"
+      << "         PivotAddress(DecodeAddress(base & ~kPivotBits));\n"
+      << "}\n\n";
+
+  ofs << "constexpr bool SameCoordinate(const Coordinate& a, "
+         "const Coordinate& b) {\n"
+      << "  return a.channel == b.channel && a.rank == b.rank &&\n"
+      << "         a.bank_group == b.bank_group && a.bank == b.bank &&\n"
+      << "         a.row == b.row && a.column == b.column;\n"
+      << "}\n\n";
+
+  // Self-test: sample addresses below the highest mapped bit, decoded by
+  // DRAMTranslator when the header was generated
+  uint64_t mapped = mapping.row_bits | mapping.column_bits;
+  for (const auto& function : mapping.Functions()) {
+    mapped |= function;
+  }
+  uint64_t highest = 63 - __builtin_clzll(mapped);
+  uint64_t range = (highest == 63) ? ~0ULL : ((1ULL << (highest + 1)) - 1);
+  std::mt19937_64 gen(0);
+  ofs << "// Self-test against the mapping as measured\n";
+  for (uint64_t i = 0; i < SUDOKU_CODEGEN_NUM_SAMPLES; ++i) {
+    uint64_t paddr = gen() & range;
+    ofs << fmt::format(
+        "static_assert(SameCoordinate(DecodeAddress({:#x}),\n"
+        "                             {}),\n"
+        "              \"{} decodes {:#x}\");\n"
+        "static_assert(EncodeAddress(DecodeAddress({:#x}), {:#x}) ==\n"
+        "                  {:#x},\n"
+        "              \"{} encodes {:#x}\");\n",
+        paddr, CoordinateLiteral(translator.Translate(paddr)), name, paddr,
+        paddr, paddr, paddr, name, paddr);
+  }
+  ofs << fmt::format("\n}}  // namespace {}\n\n#endif  // {}\n", name, guard);
+
+  ofs.close();
+  if (!ofs.good()) {
+    PRINT_ERROR("Cannot write header file: {}", fname);
+    return false;
+  }
+  return true;
+}
+
+}  // namespace sudoku
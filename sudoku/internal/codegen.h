@@ -0,0 +1,24 @@
+#ifndef SUDOKU_INTERNAL_CODEGEN_H
+#define SUDOKU_INTERNAL_CODEGEN_H
+
+#include <string>
+
+#include "mapping.h"
+
+namespace sudoku {
+
+// C++ identifier from a platform name (e.g., "sudoku_" + "intel_core_12th")
+std::string MappingHeaderName(const MappingArtifact& mapping);
+
+// Write a self-contained C++14 header for a mapping into namespace name:
+// constexpr functions and bits, constexpr decoding of each coordinate with
+// a fixed XOR network, the inverse (coordinates to address), and
+// static_asserts checking both against DRAMTranslator on sample addresses.
+// source names the mapping file in the header comment. Fails if the mapping
+// is empty or not invertible.
+bool WriteMappingHeader(std::string fname, const MappingArtifact& mapping,
+                        std::string name, std::string source);
+
+}  // namespace sudoku
+
+#endif  // SUDOKU_INTERNAL_CODEGEN_H
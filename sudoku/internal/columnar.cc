@@ -0,0 +1,462 @@
+#include "columnar.h"
+
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+
+#include "constants.h"
+#include "utils.h"
+
+namespace sudoku {
+
+/// @brief Trailer of a columnar file, locating the chunk index
+struct ColumnarFooter {
+  uint64_t index_offset;
+  uint64_t num_chunks;
+  uint64_t num_records;
+  char magic[8];
+};
+
+static_assert(sizeof(ColumnarChunk) == 64, "ColumnarChunk must be 64 bytes");
+
+// Delta column: first value, then zigzag deltas
+static void EncodeDeltas(const std::vector<uint64_t>& values,
+                         std::vector<uint8_t>* out) {
+  uint64_t previous = 0;
+  for (const auto& value : values) {
+    PutVarint(ZigZag(value, previous), out);
+    previous = value;
+  }
+}
+
+static bool DecodeDeltas(const uint8_t* p, const uint8_t* end, size_t num,
+                         std::vector<uint64_t>* values) {
+  values->resize(num);
+  uint64_t previous = 0, value;
+  for (size_t i = 0; i < num; ++i) {
+    if (!GetVarint(&p, end, &value)) {
+      return false;
+    }
+    previous = UnZigZag(value, previous);
+    (*values)[i] = previous;
+  }
+  return true;
+}
+
+// Bit-packed column: minimum (frame of reference), bit width, and the
+// offsets from the minimum packed little-endian
+static void EncodePacked(const std::vector<uint64_t>& values,
+                         std::vector<uint8_t>* out) {
+  uint64_t base = *std::min_element(values.begin(), values.end());
+  uint64_t range = *std::max_element(values.begin(), values.end()) - base;
+  uint32_t width = range ? 64 - __builtin_clzll(range) : 0;
+  PutVarint(base, out);
+  out->push_back(static_cast<uint8_t>(width));
+  unsigned __int128 acc = 0;
+  uint32_t bits = 0;
+  for (const auto& value : values) {
+    acc |= static_cast<unsigned __int128>(value - base) << bits;
+    bits += width;
+    while (bits >= 8) {
+      out->push_back(static_cast<uint8_t>(acc));
+      acc >>= 8;
+      bits -= 8;
+    }
+  }
+  if (bits) {
+    out->push_back(static_cast<uint8_t>(acc));
+  }
+}
+
+static bool DecodePacked(const uint8_t* p, const uint8_t* end, size_t num,
+                         std::vector<uint64_t>* values) {
+  uint64_t base;
+  if (!GetVarint(&p, end, &base) || p >= end) {
+    return false;
+  }
+  uint32_t width = *p++;
+  if (width > 64 || static_cast<uint64_t>(end - p) < (num * width + 7) / 8) {
+    return false;
+  }
+  uint64_t mask = (width == 64) ? ~0ULL : ((1ULL << width) - 1);
+  values->resize(num);
+  unsigned __int128 acc = 0;
+  uint32_t bits = 0;
+  for (size_t i = 0; i < num; ++i) {
+    while (bits < width) {
+      acc |= static_cast<unsigned __int128>(*p++) << bits;
+      bits += 8;
+    }
+    (*values)[i] = base + (static_cast<uint64_t>(acc) & mask);
+    acc >>= width;
+    bits -= width;
+  }
+  return true;
+}
+
+bool ColumnarFilter::Match(uint64_t fpaddr, uint64_t spaddr) const {
+  if ((fpaddr < min_addr || fpaddr > max_addr) &&
+      (spaddr < min_addr || spaddr > max_addr)) {
+    return false;
+  }
+  for (const auto& function : same_functions) {
+    if (XORReductionWithMask(function, fpaddr ^ spaddr)) {
+      return false;
+    }
+  }
+  for (const auto& function : diff_functions) {
+    if (!XORReductionWithMask(function, fpaddr ^ spaddr)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool ColumnarFilter::MayMatch(const ColumnarChunk& chunk,
+                              const std::vector<uint64_t>& functions) const {
+  if (chunk.max_addr < min_addr || chunk.min_addr > max_addr) {
+    return false;
+  }
+  for (size_t i = 0; i < functions.size(); ++i) {
+    bool same = std::find(same_functions.begin(), same_functions.end(),
+                          functions[i]) != same_functions.end();
+    bool diff = std::find(diff_functions.begin(), diff_functions.end(),
+                          functions[i]) != diff_functions.end();
+    if ((same && !((chunk.same_mask >> i) & 1)) ||
+        (diff && !((chunk.diff_mask >> i) & 1))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+ColumnarWriter::ColumnarWriter() : offset_(0), num_records_(0) {}
+
+bool ColumnarWriter::Open(std::string fname, const ColumnarMetadata& metadata,
+                          const std::vector<uint64_t>& functions) {
+  ofs_.open(fname, std::ios::binary | std::ios::trunc);
+  if (!ofs_.is_open()) {
+    PRINT_ERROR("Cannot open columnar file: {}", fname);
+    return false;
+  }
+  functions_ = functions;
+  if (functions_.size() > 64) {
+    functions_.resize(64);
+  }
+  std::ostringstream oss;
+  for (const auto& entry : metadata) {
+    oss << entry.first << "=" << entry.second << "\n";
+  }
+  oss << "functions=";
+  for (size_t i = 0; i < functions_.size(); ++i) {
+    oss << (i ? "," : "") << reinterpret_cast<void*>(functions_[i]);
+  }
+  oss << "\n";
+  std::string text = oss.str();
+
+  char magic[8] = {0};
+  std::memcpy(magic, SUDOKU_COLUMNAR_MAGIC, sizeof(magic));
+  uint32_t version = SUDOKU_COLUMNAR_VERSION;
+  uint32_t metadata_size = static_cast<uint32_t>(text.size());
+  ofs_.write(magic, sizeof(magic));
+  ofs_.write(reinterpret_cast<const char*>(&version), sizeof(version));
+  ofs_.write(reinterpret_cast<const char*>(&metadata_size),
+             sizeof(metadata_size));
+  ofs_.write(text.data(), text.size());
+  offset_ = sizeof(magic) + sizeof(version) + sizeof(metadata_size) +
+            text.size();
+  chunk_.reserve(SUDOKU_COLUMNAR_CHUNK_RECORDS);
+  index_.clear();
+  num_records_ = 0;
+  return true;
+}
+
+void ColumnarWriter::Append(const ResultRecord& record) {
+  chunk_.push_back(record);
+  if (chunk_.size() == SUDOKU_COLUMNAR_CHUNK_RECORDS) {
+    WriteChunk();
+  }
+}
+
+void ColumnarWriter::WriteChunk() {
+  if (chunk_.empty()) {
+    return;
+  }
+  size_t num = chunk_.size();
+  ColumnarChunk entry;
+  entry.offset = offset_;
+  entry.size = 0;
+  entry.num_records = num;
+  entry.first_idx = chunk_[0].idx;
+  entry.min_addr = UINT64_MAX;
+  entry.max_addr = 0;
+  entry.same_mask = 0;
+  entry.diff_mask = 0;
+  std::vector<std::vector<uint64_t>> columns(
+      SUDOKU_COLUMNAR_NUM_COLUMNS, std::vector<uint64_t>(num));
+  for (size_t i = 0; i < num; ++i) {
+    const ResultRecord& record = chunk_[i];
+    columns[0][i] = record.idx;
+    columns[1][i] = record.fpaddr;
+    columns[2][i] = record.spaddr;
+    for (size_t k = 0; k < 4; ++k) {
+      columns[3 + k][i] = record.statistics[k];
+    }
+    columns[7][i] = record.num;
+
+    entry.min_addr =
+        std::min(entry.min_addr, std::min(record.fpaddr, record.spaddr));
+    entry.max_addr =
+        std::max(entry.max_addr, std::max(record.fpaddr, record.spaddr));
+    for (size_t f = 0; f < functions_.size(); ++f) {
+      if (XORReductionWithMask(functions_[f], record.fpaddr ^ record.spaddr)) {
+        entry.diff_mask |= (1ULL << f);
+      } else {
+        entry.same_mask |= (1ULL << f);
+      }
+    }
+  }
+
+  // Column sizes up front, so readers can decode the addresses alone
+  std::vector<std::vector<uint8_t>> encoded(SUDOKU_COLUMNAR_NUM_COLUMNS);
+  for (size_t c = 0; c < SUDOKU_COLUMNAR_NUM_COLUMNS; ++c) {
+    if (c < 3) {
+      EncodeDeltas(columns[c], &encoded[c]);
+    } else {
+      EncodePacked(columns[c], &encoded[c]);
+    }
+  }
+  uint32_t sizes[SUDOKU_COLUMNAR_NUM_COLUMNS];
+  for (size_t c = 0; c < SUDOKU_COLUMNAR_NUM_COLUMNS; ++c) {
+    sizes[c] = static_cast<uint32_t>(encoded[c].size());
+    entry.size += encoded[c].size();
+  }
+  ofs_.write(reinterpret_cast<const char*>(sizes), sizeof(sizes));
+  entry.size += sizeof(sizes);
+  for (const auto& column : encoded) {
+    ofs_.write(reinterpret_cast<const char*>(column.data()), column.size());
+  }
+
+  offset_ += entry.size;
+  num_records_ += num;
+  index_.push_back(entry);
+  chunk_.clear();
+}
+
+bool ColumnarWriter::Close() {
+  if (!ofs_.is_open()) {
+    return false;
+  }
+  WriteChunk();
+  ColumnarFooter footer = {offset_, index_.size(), num_records_, {0}};
+  std::memcpy(footer.magic, SUDOKU_COLUMNAR_MAGIC, sizeof(footer.magic));
+  ofs_.write(reinterpret_cast<const char*>(index_.data()),
+             index_.size() * sizeof(ColumnarChunk));
+  ofs_.write(reinterpret_cast<const char*>(&footer), sizeof(footer));
+  ofs_.close();
+  return !ofs_.fail();
+}
+
+ColumnarReader::ColumnarReader() : num_records_(0) {}
+
+bool ColumnarReader::Open(std::string fname) {
+  ifs_.open(fname, std::ios::binary);
+  if (!ifs_.is_open()) {
+    PRINT_ERROR("Cannot open columnar file: {}", fname);
+    return false;
+  }
+  char magic[8];
+  uint32_t version, metadata_size;
+  ifs_.read(magic, sizeof(magic));
+  ifs_.read(reinterpret_cast<char*>(&version), sizeof(version));
+  ifs_.read(reinterpret_cast<char*>(&metadata_size), sizeof(metadata_size));
+  if (!ifs_ || std::strncmp(magic, SUDOKU_COLUMNAR_MAGIC, sizeof(magic))) {
+    PRINT_ERROR("Not a columnar file: {}", fname);
+    return false;
+  }
+  if (version != SUDOKU_COLUMNAR_VERSION) {
+    PRINT_ERROR("Unsupported columnar file version {}", version);
+    return false;
+  }
+
+  // Metadata
+  std::string text(metadata_size, '\0');
+  ifs_.read(&text[0], metadata_size);
+  std::istringstream iss(text);
+  std::string line;
+  metadata_.clear();
+  functions_.clear();
+  while (std::getline(iss, line)) {
+    size_t pos = line.find('=');
+    if (pos == std::string::npos) {
+      continue;
+    }
+    metadata_.emplace_back(line.substr(0, pos), line.substr(pos + 1));
+  }
+  std::istringstream functions(Get("functions"));
+  while (std::getline(functions, line, ',')) {
+    functions_.push_back(strtoull(line.c_str(), nullptr, 16));
+  }
+
+  // Footer and chunk index
+  ColumnarFooter footer;
+  ifs_.seekg(-static_cast<std::streamoff>(sizeof(footer)), std::ios::end);
+  ifs_.read(reinterpret_cast<char*>(&footer), sizeof(footer));
+  if (!ifs_ ||
+      std::strncmp(footer.magic, SUDOKU_COLUMNAR_MAGIC, sizeof(magic))) {
+    PRINT_ERROR("Truncated columnar file: {}", fname);
+    return false;
+  }
+  index_.resize(footer.num_chunks);
+  ifs_.seekg(footer.index_offset);
+  ifs_.read(reinterpret_cast<char*>(index_.data()),
+            footer.num_chunks * sizeof(ColumnarChunk));
+  num_records_ = footer.num_records;
+  return static_cast<bool>(ifs_);
+}
+
+std::string ColumnarReader::Get(const std::string& key) const {
+  for (const auto& entry : metadata_) {
+    if (entry.first == key) {
+      return entry.second;
+    }
+  }
+  return "";
+}
+
+bool ColumnarReader::ReadChunkData(size_t chunk, std::vector<uint8_t>* data) {
+  const ColumnarChunk& entry = index_[chunk];
+  data->resize(entry.size);
+  ifs_.clear();
+  ifs_.seekg(entry.offset);
+  ifs_.read(reinterpret_cast<char*>(data->data()), entry.size);
+  if (!ifs_ || entry.size < SUDOKU_COLUMNAR_NUM_COLUMNS * sizeof(uint32_t)) {
+    PRINT_ERROR("Cannot read chunk {}", chunk);
+    return false;
+  }
+  return true;
+}
+
+// Decode the columns [first, last) of a chunk read by ReadChunkData
+static bool DecodeColumns(const std::vector<uint8_t>& data, size_t num,
+                          size_t first, size_t last,
+                          std::vector<std::vector<uint64_t>>* columns) {
+  uint32_t sizes[SUDOKU_COLUMNAR_NUM_COLUMNS];
+  std::memcpy(sizes, data.data(), sizeof(sizes));
+  const uint8_t* p = data.data() + sizeof(sizes);
+  const uint8_t* end = data.data() + data.size();
+  for (size_t c = 0; c < last; ++c) {
+    if (static_cast<uint64_t>(end - p) < sizes[c]) {
+      return false;
+    }
+    if (c >= first) {
+      std::vector<uint64_t>* column = &(*columns)[c];
+      bool decoded = (c < 3) ? DecodeDeltas(p, p + sizes[c], num, column)
+                             : DecodePacked(p, p + sizes[c], num, column);
+      if (!decoded) {
+        return false;
+      }
+    }
+    p += sizes[c];
+  }
+  return true;
+}
+
+bool ColumnarReader::ReadChunk(size_t chunk,
+                               std::vector<ResultRecord>* records) {
+  std::vector<uint8_t> data;
+  if (chunk >= index_.size() || !ReadChunkData(chunk, &data)) {
+    return false;
+  }
+  size_t num = index_[chunk].num_records;
+  std::vector<std::vector<uint64_t>> columns(SUDOKU_COLUMNAR_NUM_COLUMNS);
+  if (!DecodeColumns(data, num, 0, SUDOKU_COLUMNAR_NUM_COLUMNS, &columns)) {
+    PRINT_ERROR("Corrupted chunk {}", chunk);
+    return false;
+  }
+  records->resize(num);
+  for (size_t i = 0; i < num; ++i) {
+    ResultRecord& record = (*records)[i];
+    record.idx = columns[0][i];
+    record.fpaddr = columns[1][i];
+    record.spaddr = columns[2][i];
+    for (size_t k = 0; k < 4; ++k) {
+      record.statistics[k] = columns[3 + k][i];
+    }
+    record.num = columns[7][i];
+  }
+  return true;
+}
+
+uint64_t ColumnarReader::Scan(const ColumnarFilter& filter,
+                              std::function<void(const ResultRecord&)> visit,
+                              uint64_t* chunks_read) {
+  uint64_t num_matches = 0;
+  *chunks_read = 0;
+  std::vector<uint8_t> data;
+  std::vector<std::vector<uint64_t>> columns(SUDOKU_COLUMNAR_NUM_COLUMNS);
+  std::vector<size_t> matches;
+  for (size_t chunk = 0; chunk < index_.size(); ++chunk) {
+    if (!filter.MayMatch(index_[chunk], functions_)) {
+      continue;
+    }
+    if (!ReadChunkData(chunk, &data)) {
+      break;
+    }
+    (*chunks_read)++;
+    size_t num = index_[chunk].num_records;
+    // Addresses first
+    if (!DecodeColumns(data, num, 0, 3, &columns)) {
+      PRINT_ERROR("Corrupted chunk {}", chunk);
+      break;
+    }
+    matches.clear();
+    for (size_t i = 0; i < num; ++i) {
+      if (filter.Match(columns[1][i], columns[2][i])) {
+        matches.push_back(i);
+      }
+    }
+    if (matches.empty()) {
+      continue;
+    }
+    if (!DecodeColumns(data, num, 3, SUDOKU_COLUMNAR_NUM_COLUMNS, &columns)) {
+      PRINT_ERROR("Corrupted chunk {}", chunk);
+      break;
+    }
+    for (const auto& i : matches) {
+      ResultRecord record = {columns[0][i],
+                             columns[1][i],
+                             columns[2][i],
+                             {columns[3][i], columns[4][i], columns[5][i],
+                              columns[6][i]},
+                             columns[7][i]};
+      visit(record);
+    }
+    num_matches += matches.size();
+  }
+  return num_matches;
+}
+
+bool ConvertResultFileToColumnar(std::string bin_fname, std::string fname,
+                                 const ColumnarMetadata& metadata,
+                                 const std::vector<uint64_t>& functions) {
+  ResultFileHeader header;
+  std::vector<ResultRecord> records;
+  if (!ReadResultFile(bin_fname, &header, &records)) {
+    return false;
+  }
+  ColumnarMetadata with_layout = metadata;
+  with_layout.emplace_back("with_num", header.with_num ? "1" : "0");
+  ColumnarWriter writer;
+  if (!writer.Open(fname, with_layout, functions)) {
+    return false;
+  }
+  for (auto record : records) {
+    record.fpaddr -= header.pci_offset;
+    record.spaddr -= header.pci_offset;
+    writer.Append(record);
+  }
+  return writer.Close();
+}
+
+}  // namespace sudoku
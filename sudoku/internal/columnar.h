@@ -0,0 +1,124 @@
+#ifndef SUDOKU_INTERNAL_COLUMNAR_H
+#define SUDOKU_INTERNAL_COLUMNAR_H
+
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "result_sink.h"
+
+namespace sudoku {
+
+#define SUDOKU_COLUMNAR_MAGIC "SDKCOL1"
+#define SUDOKU_COLUMNAR_VERSION 1
+
+// Columns of a chunk, in order
+#define SUDOKU_COLUMNAR_NUM_COLUMNS 8
+
+// Ordered key-value pairs (platform, thresholds, DRAM config, ...)
+using ColumnarMetadata = std::vector<std::pair<std::string, std::string>>;
+
+/// @brief Chunk index entry. The address range and the function masks let
+/// readers skip chunks without reading them.
+struct ColumnarChunk {
+  uint64_t offset;
+  uint64_t size;
+  uint64_t num_records;
+  uint64_t first_idx;
+  uint64_t min_addr;  // over both addresses of all pairs
+  uint64_t max_addr;
+  uint64_t same_mask;  // bit i: some pair agrees on metadata function i
+  uint64_t diff_mask;  // bit i: some pair differs on metadata function i
+};
+
+/// @brief Record filter: either address in [min_addr, max_addr], and the
+/// pair agrees on all same_functions and differs on all diff_functions
+struct ColumnarFilter {
+  uint64_t min_addr;
+  uint64_t max_addr;
+  std::vector<uint64_t> same_functions;
+  std::vector<uint64_t> diff_functions;
+
+  ColumnarFilter() : min_addr(0), max_addr(UINT64_MAX) {}
+
+  bool Match(uint64_t fpaddr, uint64_t spaddr) const;
+  // False only if no pair of the chunk can match (functions are the
+  // metadata functions behind the chunk masks)
+  bool MayMatch(const ColumnarChunk& chunk,
+                const std::vector<uint64_t>& functions) const;
+};
+
+/// @brief Columnar result file writer. Records are buffered into chunks of
+/// SUDOKU_COLUMNAR_CHUNK_RECORDS; each chunk stores delta-encoded indices and
+/// addresses (zigzag varints) and bit-packed statistics (frame of reference).
+/// The chunk index and a footer follow the last chunk.
+class ColumnarWriter {
+ public:
+  ColumnarWriter();
+  ColumnarWriter(const ColumnarWriter&) = delete;
+  ColumnarWriter& operator=(const ColumnarWriter&) = delete;
+
+  // functions (at most 64) are summarized per chunk for filtering
+  bool Open(std::string fname, const ColumnarMetadata& metadata,
+            const std::vector<uint64_t>& functions);
+  // Addresses are DRAM addresses (PCI offset removed)
+  void Append(const ResultRecord& record);
+  bool Close();
+
+ private:
+  void WriteChunk();
+
+  std::ofstream ofs_;
+  std::vector<uint64_t> functions_;
+  std::vector<ResultRecord> chunk_;
+  std::vector<ColumnarChunk> index_;
+  uint64_t offset_;
+  uint64_t num_records_;
+};
+
+/// @brief Columnar result file reader. Open() reads the metadata and the
+/// chunk index only; chunks are read on demand.
+class ColumnarReader {
+ public:
+  ColumnarReader();
+  ColumnarReader(const ColumnarReader&) = delete;
+  ColumnarReader& operator=(const ColumnarReader&) = delete;
+
+  bool Open(std::string fname);
+
+  const ColumnarMetadata& Metadata() const { return metadata_; }
+  std::string Get(const std::string& key) const;
+  const std::vector<ColumnarChunk>& Chunks() const { return index_; }
+  const std::vector<uint64_t>& Functions() const { return functions_; }
+  uint64_t NumRecords() const { return num_records_; }
+
+  // Decode all columns of a chunk
+  bool ReadChunk(size_t chunk, std::vector<ResultRecord>* records);
+  // Visit the matching records in order; chunks ruled out by the index are
+  // not read, and statistics are only decoded for chunks with a match.
+  // Returns the number of matches (chunks_read counts the chunks read).
+  uint64_t Scan(const ColumnarFilter& filter,
+                std::function<void(const ResultRecord&)> visit,
+                uint64_t* chunks_read);
+
+ private:
+  bool ReadChunkData(size_t chunk, std::vector<uint8_t>* data);
+
+  std::ifstream ifs_;
+  ColumnarMetadata metadata_;
+  std::vector<uint64_t> functions_;
+  std::vector<ColumnarChunk> index_;
+  uint64_t num_records_;
+};
+
+// Encode a binary result file (see ResultSink) into a columnar file
+bool ConvertResultFileToColumnar(std::string bin_fname, std::string fname,
+                                 const ColumnarMetadata& metadata,
+                                 const std::vector<uint64_t>& functions);
+
+}  // namespace sudoku
+
+#endif  // SUDOKU_INTERNAL_COLUMNAR_H
@@ -1,32 +1,24 @@
 #include "conflicts.h"
 
 #include <cstdint>
+#include <vector>
 
-#include "assembly.h"
+#include "backend.h"
 #include "constants.h"
+#include "counters.h"
 #include "utils.h"
 
 namespace sudoku {
 
 void AccessTimingSingleMemoryAccess(uint64_t addr, uint64_t** histogram) {
-  // measure
-  for (size_t i = 0; i < SUDOKU_CONFLICT_NUM_ITERATION; ++i) {
-    clflushopt(reinterpret_cast<void*>(addr));
-    mfence();
-    histogram[i][0] = rdtscp();
-    *(volatile char*)addr;
-    lfence();
-    histogram[i][1] = rdtscp();
-  }
-  for (size_t i = 0; i < SUDOKU_CONFLICT_NUM_ITERATION; ++i) {
-    histogram[i][1] -= histogram[i][0];
-  }
+  Count(Counter::SINGLE_MEASUREMENTS);
+  GetBackend().AccessTimingSingleMemoryAccess(addr, histogram);
 }
 
 uint64_t MedianAccessTimingSingleMemoryAccess(uint64_t addr) {
   uint64_t** histogram = AllocateHistogram(SUDOKU_CONFLICT_NUM_ITERATION, 2);
   AccessTimingSingleMemoryAccess(addr, histogram);
-  uint64_t med = GetMedian(histogram, SUDOKU_CONFLICT_NUM_ITERATION, 2);
+  uint64_t med = GetMedian(histogram, SUDOKU_CONFLICT_NUM_ITERATION, 1);
   FreeHistogram(histogram, SUDOKU_CONFLICT_NUM_ITERATION);
   return med;
 }
@@ -34,7 +26,7 @@ uint64_t MedianAccessTimingSingleMemoryAccess(uint64_t addr) {
 uint64_t AverageAccessTimingSingleMemoryAccess(uint64_t addr) {
   uint64_t** histogram = AllocateHistogram(SUDOKU_CONFLICT_NUM_ITERATION, 2);
   AccessTimingSingleMemoryAccess(addr, histogram);
-  uint64_t avg = GetAverage(histogram, SUDOKU_CONFLICT_NUM_ITERATION, 2);
+  uint64_t avg = GetAverage(histogram, SUDOKU_CONFLICT_NUM_ITERATION, 1);
   FreeHistogram(histogram, SUDOKU_CONFLICT_NUM_ITERATION);
   return avg;
 }
@@ -48,19 +40,8 @@ void StatAccessTimingSingleMemoryAccess(uint64_t addr, uint64_t* results) {
 
 void AccessTimingPairedMemoryAccess(uint64_t faddr, uint64_t saddr,
                                     uint64_t** histogram) {
-  for (size_t i = 0; i < SUDOKU_CONFLICT_NUM_ITERATION; ++i) {
-    clflushopt(reinterpret_cast<void*>(faddr));
-    clflushopt(reinterpret_cast<void*>(saddr));
-    mfence();
-    histogram[i][0] = rdtscp();
-    *(volatile char*)faddr;
-    *(volatile char*)saddr;
-    lfence();
-    histogram[i][1] = rdtscp();
-  }
-  for (size_t i = 0; i < SUDOKU_CONFLICT_NUM_ITERATION; ++i) {
-    histogram[i][1] -= histogram[i][0];
-  }
+  Count(Counter::PAIR_MEASUREMENTS);
+  GetBackend().AccessTimingPairedMemoryAccess(faddr, saddr, histogram);
 }
 
 uint64_t MedianAccessTimingPairedMemoryAccess(uint64_t faddr, uint64_t saddr) {
@@ -87,4 +68,100 @@ void StatAccessTimingPairedMemoryAccess(uint64_t faddr, uint64_t saddr,
   FreeHistogram(histogram, SUDOKU_CONFLICT_NUM_ITERATION);
 }
 
-}  // namespace sudoku
\ No newline at end of file
+void AccessTimingPairedMemoryAccessScheduled(uint64_t faddr, uint64_t saddr,
+                                             RefreshScheduler& scheduler,
+                                             uint64_t** histogram) {
+  Count(Counter::SCHEDULED_MEASUREMENTS);
+  GetBackend().AccessTimingPairedMemoryAccessScheduled(
+      faddr, saddr, scheduler, histogram);
+}
+
+uint64_t MedianAccessTimingPairedMemoryAccessScheduled(
+    uint64_t faddr, uint64_t saddr, RefreshScheduler& scheduler) {
+  uint64_t** histogram =
+      AllocateHistogram(SUDOKU_SCHEDULED_CONFLICT_NUM_ITERATION, 2);
+  AccessTimingPairedMemoryAccessScheduled(faddr, saddr, scheduler, histogram);
+  uint64_t med =
+      GetMedian(histogram, SUDOKU_SCHEDULED_CONFLICT_NUM_ITERATION, 1);
+  FreeHistogram(histogram, SUDOKU_SCHEDULED_CONFLICT_NUM_ITERATION);
+  return med;
+}
+
+uint64_t AverageAccessTimingPairedMemoryAccessScheduled(
+    uint64_t faddr, uint64_t saddr, RefreshScheduler& scheduler) {
+  uint64_t** histogram =
+      AllocateHistogram(SUDOKU_SCHEDULED_CONFLICT_NUM_ITERATION, 2);
+  AccessTimingPairedMemoryAccessScheduled(faddr, saddr, scheduler, histogram);
+  uint64_t avg =
+      GetAverage(histogram, SUDOKU_SCHEDULED_CONFLICT_NUM_ITERATION, 1);
+  FreeHistogram(histogram, SUDOKU_SCHEDULED_CONFLICT_NUM_ITERATION);
+  return avg;
+}
+
+void StatAccessTimingPairedMemoryAccessScheduled(uint64_t faddr,
+                                                 uint64_t saddr,
+                                                 RefreshScheduler& scheduler,
+                                                 uint64_t* results) {
+  uint64_t** histogram =
+      AllocateHistogram(SUDOKU_SCHEDULED_CONFLICT_NUM_ITERATION, 2);
+  AccessTimingPairedMemoryAccessScheduled(faddr, saddr, scheduler, histogram);
+  GetStatistics(histogram, SUDOKU_SCHEDULED_CONFLICT_NUM_ITERATION, 1,
+                results);
+  FreeHistogram(histogram, SUDOKU_SCHEDULED_CONFLICT_NUM_ITERATION);
+}
+
+void AccessTimingBatchedPairedMemoryAccess(const uint64_t* faddrs,
+                                           const uint64_t* saddrs,
+                                           size_t num_pairs,
+                                           uint64_t** histogram) {
+  Count(Counter::PAIR_MEASUREMENTS, num_pairs);
+  GetBackend().AccessTimingBatchedPairedMemoryAccess(
+      faddrs, saddrs, num_pairs, histogram);
+}
+
+void MedianAccessTimingBatchedPairedMemoryAccess(const uint64_t* faddrs,
+                                                 const uint64_t* saddrs,
+                                                 size_t num_pairs,
+                                                 uint64_t* results) {
+  uint64_t** histogram =
+      AllocateHistogram(num_pairs, SUDOKU_CONFLICT_NUM_ITERATION);
+  AccessTimingBatchedPairedMemoryAccess(faddrs, saddrs, num_pairs, histogram);
+  for (size_t k = 0; k < num_pairs; ++k) {
+    std::vector<uint64_t> values(histogram[k],
+                                 histogram[k] + SUDOKU_CONFLICT_NUM_ITERATION);
+    results[k] = GetMedian(values);
+  }
+  FreeHistogram(histogram, num_pairs);
+}
+
+void AverageAccessTimingBatchedPairedMemoryAccess(const uint64_t* faddrs,
+                                                  const uint64_t* saddrs,
+                                                  size_t num_pairs,
+                                                  uint64_t* results) {
+  uint64_t** histogram =
+      AllocateHistogram(num_pairs, SUDOKU_CONFLICT_NUM_ITERATION);
+  AccessTimingBatchedPairedMemoryAccess(faddrs, saddrs, num_pairs, histogram);
+  for (size_t k = 0; k < num_pairs; ++k) {
+    std::vector<uint64_t> values(histogram[k],
+                                 histogram[k] + SUDOKU_CONFLICT_NUM_ITERATION);
+    results[k] = GetAverage(values);
+  }
+  FreeHistogram(histogram, num_pairs);
+}
+
+void StatAccessTimingBatchedPairedMemoryAccess(const uint64_t* faddrs,
+                                               const uint64_t* saddrs,
+                                               size_t num_pairs,
+                                               uint64_t** results) {
+  uint64_t** histogram =
+      AllocateHistogram(num_pairs, SUDOKU_CONFLICT_NUM_ITERATION);
+  AccessTimingBatchedPairedMemoryAccess(faddrs, saddrs, num_pairs, histogram);
+  for (size_t k = 0; k < num_pairs; ++k) {
+    std::vector<uint64_t> values(histogram[k],
+                                 histogram[k] + SUDOKU_CONFLICT_NUM_ITERATION);
+    GetStatistics(values, results[k]);
+  }
+  FreeHistogram(histogram, num_pairs);
+}
+
+}  // namespace sudoku
@@ -1,8 +1,12 @@
 #ifndef SUDOKU_INTERNAL_CONFLICTS_H
 #define SUDOKU_INTERNAL_CONFLICTS_H
 
+#include <stddef.h>
+
 #include <cstdint>
 
+#include "refresh_scheduler.h"
+
 namespace sudoku {
 
 // Single address access timing
@@ -19,6 +23,42 @@ uint64_t AverageAccessTimingPairedMemoryAccess(uint64_t faddr, uint64_t saddr);
 void StatAccessTimingPairedMemoryAccess(uint64_t faddr, uint64_t saddr,
                                         uint64_t* results);
 
+// Paired address access timing scheduled in the quiet windows between the
+// refreshes of the scheduler's rank (SUDOKU_SCHEDULED_CONFLICT_NUM_ITERATION
+// iterations); the phase is re-locked between iterations when due
+void AccessTimingPairedMemoryAccessScheduled(uint64_t faddr, uint64_t saddr,
+                                             RefreshScheduler& scheduler,
+                                             uint64_t** histogram);
+uint64_t MedianAccessTimingPairedMemoryAccessScheduled(
+    uint64_t faddr, uint64_t saddr, RefreshScheduler& scheduler);
+uint64_t AverageAccessTimingPairedMemoryAccessScheduled(
+    uint64_t faddr, uint64_t saddr, RefreshScheduler& scheduler);
+void StatAccessTimingPairedMemoryAccessScheduled(uint64_t faddr,
+                                                 uint64_t saddr,
+                                                 RefreshScheduler& scheduler,
+                                                 uint64_t* results);
+
+// Batched paired address access timing. Each of the num_pairs pairs is timed
+// round-robin in one flush epoch per iteration (histogram: num_pairs rows x
+// SUDOKU_CONFLICT_NUM_ITERATION columns). Pairs should map to distinct banks
+// and must not share addresses.
+void AccessTimingBatchedPairedMemoryAccess(const uint64_t* faddrs,
+                                           const uint64_t* saddrs,
+                                           size_t num_pairs,
+                                           uint64_t** histogram);
+void MedianAccessTimingBatchedPairedMemoryAccess(const uint64_t* faddrs,
+                                                 const uint64_t* saddrs,
+                                                 size_t num_pairs,
+                                                 uint64_t* results);
+void AverageAccessTimingBatchedPairedMemoryAccess(const uint64_t* faddrs,
+                                                  const uint64_t* saddrs,
+                                                  size_t num_pairs,
+                                                  uint64_t* results);
+void StatAccessTimingBatchedPairedMemoryAccess(const uint64_t* faddrs,
+                                               const uint64_t* saddrs,
+                                               size_t num_pairs,
+                                               uint64_t** results);
+
 }  // namespace sudoku
 
 #endif  // SUDOKU_INTERNAL_CONFLICTS_H
\ No newline at end of file
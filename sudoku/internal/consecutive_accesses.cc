@@ -6,59 +6,130 @@
 #include <cstdint>
 #include <string>
 
-#include "assembly.h"
+#include "backend.h"
 #include "constants.h"
+#include "counters.h"
 #include "utils.h"
 
 namespace sudoku {
 
-void ReadReadLatency(uint64_t* faddrs, uint64_t* saddrs, size_t length,
-                     uint64_t** histogram) {
-  for (size_t i = 0; i < SUDOKU_CONSECUTIVE_NUM_ITERATION; ++i) {
-    // clflushopt
-    for (size_t j = 0; j < length; ++j) {
-      clflushopt(reinterpret_cast<void*>(faddrs[j]));
-      clflushopt(reinterpret_cast<void*>(saddrs[j]));
-    }
-    mfence();
-    histogram[i][0] = rdtscp();
-    // let MCs schedule the requests in this loop
-    for (size_t j = 0; j < length; ++j) {
-      *(volatile char*)faddrs[j];
-      *(volatile char*)saddrs[j];
-    }
-    mfence();
-    histogram[i][1] = rdtscp();
-  }
-  for (size_t i = 0; i < SUDOKU_CONSECUTIVE_NUM_ITERATION; ++i) {
-    histogram[i][1] -= histogram[i][0];
-  }
+void ConsecutiveAccessLatency(ConsecutiveAccess pattern, uint64_t* faddrs,
+                              uint64_t* saddrs, size_t length,
+                              uint64_t** histogram) {
+  Count(Counter::CONSECUTIVE_MEASUREMENTS);
+  GetBackend().ConsecutiveAccessLatency(pattern, faddrs, saddrs, length,
+                                        histogram);
 }
 
-uint64_t MedianReadReadLatency(uint64_t* faddrs, uint64_t* saddrs,
-                               size_t length) {
+uint64_t MedianConsecutiveAccessLatency(ConsecutiveAccess pattern,
+                                        uint64_t* faddrs, uint64_t* saddrs,
+                                        size_t length) {
   uint64_t** histogram = AllocateHistogram(SUDOKU_CONSECUTIVE_NUM_ITERATION, 2);
-  ReadReadLatency(faddrs, saddrs, length, histogram);
+  ConsecutiveAccessLatency(pattern, faddrs, saddrs, length, histogram);
   uint64_t med = GetMedian(histogram, SUDOKU_CONSECUTIVE_NUM_ITERATION, 1);
   FreeHistogram(histogram, SUDOKU_CONSECUTIVE_NUM_ITERATION);
   return med;
 }
 
-uint64_t AverageReadReadLatency(uint64_t* faddrs, uint64_t* saddrs,
-                                size_t length) {
+uint64_t AverageConsecutiveAccessLatency(ConsecutiveAccess pattern,
+                                         uint64_t* faddrs, uint64_t* saddrs,
+                                         size_t length) {
   uint64_t** histogram = AllocateHistogram(SUDOKU_CONSECUTIVE_NUM_ITERATION, 2);
-  ReadReadLatency(faddrs, saddrs, length, histogram);
+  ConsecutiveAccessLatency(pattern, faddrs, saddrs, length, histogram);
   uint64_t avg = GetAverage(histogram, SUDOKU_CONSECUTIVE_NUM_ITERATION, 1);
   FreeHistogram(histogram, SUDOKU_CONSECUTIVE_NUM_ITERATION);
   return avg;
 }
 
-void StatReadReadLatency(uint64_t* faddrs, uint64_t* saddrs, size_t length,
-                         uint64_t* results) {
+void StatConsecutiveAccessLatency(ConsecutiveAccess pattern, uint64_t* faddrs,
+                                  uint64_t* saddrs, size_t length,
+                                  uint64_t* results) {
   uint64_t** histogram = AllocateHistogram(SUDOKU_CONSECUTIVE_NUM_ITERATION, 2);
-  ReadReadLatency(faddrs, saddrs, length, histogram);
+  ConsecutiveAccessLatency(pattern, faddrs, saddrs, length, histogram);
   GetStatistics(histogram, SUDOKU_CONSECUTIVE_NUM_ITERATION, 1, results);
   FreeHistogram(histogram, SUDOKU_CONSECUTIVE_NUM_ITERATION);
 }
 
-}  // namespace sudoku
\ No newline at end of file
+// Read-read
+void ReadReadLatency(uint64_t* faddrs, uint64_t* saddrs, size_t length,
+                     uint64_t** histogram) {
+  ConsecutiveAccessLatency(ConsecutiveAccess::RDRD, faddrs, saddrs, length,
+                           histogram);
+}
+
+uint64_t MedianReadReadLatency(uint64_t* faddrs, uint64_t* saddrs,
+                               size_t length) {
+  return MedianConsecutiveAccessLatency(ConsecutiveAccess::RDRD, faddrs,
+                                        saddrs, length);
+}
+
+uint64_t AverageReadReadLatency(uint64_t* faddrs, uint64_t* saddrs,
+                                size_t length) {
+  return AverageConsecutiveAccessLatency(ConsecutiveAccess::RDRD, faddrs,
+                                         saddrs, length);
+}
+
+void StatReadReadLatency(uint64_t* faddrs, uint64_t* saddrs, size_t length,
+                         uint64_t* results) {
+  StatConsecutiveAccessLatency(ConsecutiveAccess::RDRD, faddrs, saddrs, length,
+                               results);
+}
+
+// Read-write
+uint64_t MedianReadWriteLatency(uint64_t* faddrs, uint64_t* saddrs,
+                                size_t length) {
+  return MedianConsecutiveAccessLatency(ConsecutiveAccess::RDWR, faddrs,
+                                        saddrs, length);
+}
+
+uint64_t AverageReadWriteLatency(uint64_t* faddrs, uint64_t* saddrs,
+                                 size_t length) {
+  return AverageConsecutiveAccessLatency(ConsecutiveAccess::RDWR, faddrs,
+                                         saddrs, length);
+}
+
+void StatReadWriteLatency(uint64_t* faddrs, uint64_t* saddrs, size_t length,
+                          uint64_t* results) {
+  StatConsecutiveAccessLatency(ConsecutiveAccess::RDWR, faddrs, saddrs, length,
+                               results);
+}
+
+// Write-read
+uint64_t MedianWriteReadLatency(uint64_t* faddrs, uint64_t* saddrs,
+                                size_t length) {
+  return MedianConsecutiveAccessLatency(ConsecutiveAccess::WRRD, faddrs,
+                                        saddrs, length);
+}
+
+uint64_t AverageWriteReadLatency(uint64_t* faddrs, uint64_t* saddrs,
+                                 size_t length) {
+  return AverageConsecutiveAccessLatency(ConsecutiveAccess::WRRD, faddrs,
+                                         saddrs, length);
+}
+
+void StatWriteReadLatency(uint64_t* faddrs, uint64_t* saddrs, size_t length,
+                          uint64_t* results) {
+  StatConsecutiveAccessLatency(ConsecutiveAccess::WRRD, faddrs, saddrs, length,
+                               results);
+}
+
+// Write-write
+uint64_t MedianWriteWriteLatency(uint64_t* faddrs, uint64_t* saddrs,
+                                 size_t length) {
+  return MedianConsecutiveAccessLatency(ConsecutiveAccess::WRWR, faddrs,
+                                        saddrs, length);
+}
+
+uint64_t AverageWriteWriteLatency(uint64_t* faddrs, uint64_t* saddrs,
+                                  size_t length) {
+  return AverageConsecutiveAccessLatency(ConsecutiveAccess::WRWR, faddrs,
+                                         saddrs, length);
+}
+
+void StatWriteWriteLatency(uint64_t* faddrs, uint64_t* saddrs, size_t length,
+                           uint64_t* results) {
+  StatConsecutiveAccessLatency(ConsecutiveAccess::WRWR, faddrs, saddrs, length,
+                               results);
+}
+
+}  // namespace sudoku
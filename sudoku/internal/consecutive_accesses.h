@@ -8,6 +8,46 @@
 
 namespace sudoku {
 
+// Consecutive access patterns (first stream, second stream). Writes are
+// non-temporal stores, so they bypass the caches and reach the memory
+// controller without a write-back.
+enum class ConsecutiveAccess {
+  RDRD = 0,  // read-read (tCCD)
+  RDWR,      // read-write (tRTW)
+  WRRD,      // write-read (tWTR_S/L)
+  WRWR,      // write-write (tCCD_WR)
+};
+
+static const std::string ConsecutiveAccessStr[] = {
+    "rdrd",
+    "rdwr",
+    "wrrd",
+    "wrwr",
+};
+
+static const ConsecutiveAccess ConsecutiveAccesses[] = {
+    ConsecutiveAccess::RDRD,
+    ConsecutiveAccess::RDWR,
+    ConsecutiveAccess::WRRD,
+    ConsecutiveAccess::WRWR,
+};
+
+// Lengths from 1 to SUDOKU_CONSECUTIVE_MAX_LENGTH dispatch to unrolled
+// kernels; longer streams fall back to a loop.
+void ConsecutiveAccessLatency(ConsecutiveAccess pattern, uint64_t* faddrs,
+                              uint64_t* saddrs, size_t length,
+                              uint64_t** histogram);
+uint64_t MedianConsecutiveAccessLatency(ConsecutiveAccess pattern,
+                                        uint64_t* faddrs, uint64_t* saddrs,
+                                        size_t length);
+uint64_t AverageConsecutiveAccessLatency(ConsecutiveAccess pattern,
+                                         uint64_t* faddrs, uint64_t* saddrs,
+                                         size_t length);
+void StatConsecutiveAccessLatency(ConsecutiveAccess pattern, uint64_t* faddrs,
+                                  uint64_t* saddrs, size_t length,
+                                  uint64_t* results);
+
+// Read-read
 void ReadReadLatency(uint64_t* faddrs, uint64_t* saddrs, size_t length,
                      uint64_t** histogram);
 uint64_t MedianReadReadLatency(uint64_t* faddrs, uint64_t* saddrs,
@@ -17,6 +57,30 @@ uint64_t AverageReadReadLatency(uint64_t* faddrs, uint64_t* saddrs,
 void StatReadReadLatency(uint64_t* faddrs, uint64_t* saddrs, size_t length,
                          uint64_t* results);
 
+// Read-write
+uint64_t MedianReadWriteLatency(uint64_t* faddrs, uint64_t* saddrs,
+                                size_t length);
+uint64_t AverageReadWriteLatency(uint64_t* faddrs, uint64_t* saddrs,
+                                 size_t length);
+void StatReadWriteLatency(uint64_t* faddrs, uint64_t* saddrs, size_t length,
+                          uint64_t* results);
+
+// Write-read
+uint64_t MedianWriteReadLatency(uint64_t* faddrs, uint64_t* saddrs,
+                                size_t length);
+uint64_t AverageWriteReadLatency(uint64_t* faddrs, uint64_t* saddrs,
+                                 size_t length);
+void StatWriteReadLatency(uint64_t* faddrs, uint64_t* saddrs, size_t length,
+                          uint64_t* results);
+
+// Write-write
+uint64_t MedianWriteWriteLatency(uint64_t* faddrs, uint64_t* saddrs,
+                                 size_t length);
+uint64_t AverageWriteWriteLatency(uint64_t* faddrs, uint64_t* saddrs,
+                                  size_t length);
+void StatWriteWriteLatency(uint64_t* faddrs, uint64_t* saddrs, size_t length,
+                           uint64_t* results);
+
 }  // namespace sudoku
 
-#endif  // SUDOKU_INTERNAL_CONSECUTIVE_ACCESSES_H
\ No newline at end of file
+#endif  // SUDOKU_INTERNAL_CONSECUTIVE_ACCESSES_H
@@ -1,17 +1,7 @@
 #ifndef SUDOKU_INTERNAL_CONSTANTS_H
 #define SUDOKU_INTERNAL_CONSTANTS_H
 
-#if defined(COMPILE_ALDER_LAKE_DDR4)
-#include "intel_core_12th_ddr4.h"
-#elif defined(COMPILE_ALDER_LAKE_DDR5)
-#include "intel_core_12th_ddr5.h"
-#elif defined(COMPILE_RAPTOR_LAKE)
-#include "intel_core_14th_ddr5.h"
-#elif defined(COMPILE_ZEN_4)
-#include "amd_ryzen_zen4_ddr5.h"
-#else
-#error "Please add the appropriate header files in compile options."
-#endif
+#include "platform.h"
 
 #define SUDOKU_TEST_NUM_ITERATION 16384
 
@@ -25,18 +15,74 @@
 #define SUDOKU_FILTER_SCORE 4
 
 #define SUDOKU_CONFLICT_NUM_ITERATION 300
+// number of pairs timed per flush epoch in batched conflict measurements
+#define SUDOKU_CONFLICT_BATCH_SIZE 16
 #define SUDOKU_REFRESH_NUM_ITERATION 1024
+// streaming refresh detection: rings of SUDOKU_REFRESH_NUM_ITERATION samples
+// until the 95% confidence interval of the mean interval is within 2%
+#define SUDOKU_REFRESH_STREAM_MAX_RINGS 64
+#define SUDOKU_REFRESH_STREAM_MIN_INTERVALS 32
+#define SUDOKU_REFRESH_STREAM_RELATIVE_ERROR 0.02
+// spectral refresh interval estimation
+#define SUDOKU_REFRESH_SPECTRAL_MIN_EVENTS 4
+#define SUDOKU_REFRESH_MIN_COHERENCE 0.5
+#define SUDOKU_REFRESH_SPECTRAL_NUM_TRIAL 64
+#define SUDOKU_REFRESH_SPECTRAL_SUCCESS_SCORE (64 - 4)
+// iterations per shared capture when probing all functions concurrently;
+// longer than a paired window since each address is sampled less often
+#define SUDOKU_REFRESH_CONCURRENT_NUM_ITERATION 512
+// refresh-phase-aware scheduling of conflict measurements
+#define SUDOKU_REFRESH_LOCK_RINGS 4
+#define SUDOKU_REFRESH_RELOCK_PERIODS 256
+#define SUDOKU_REFRESH_GUARD_CYCLES 2000
+// half of SUDOKU_CONFLICT_NUM_ITERATION: scheduled samples avoid the refreshes
+// of both ranks of a pair and leave almost no outliers
+#define SUDOKU_SCHEDULED_CONFLICT_NUM_ITERATION 150
 #define SUDOKU_CONSECUTIVE_NUM_ITERATION 512
+// per-function RDRD trials (and write turnarounds on request) when decomposing
+#define SUDOKU_CONSECUTIVE_NUM_EFFECTIVE_TRIAL 1024
+// Gaussian mixture of per-pair RDRD latencies (tCCD_S, tCCD_L, and rank
+// switches) replacing BANK_GROUP_THRESHOLD when decomposing
+#define SUDOKU_MIXTURE_MIN_COMPONENTS 2
+#define SUDOKU_MIXTURE_MAX_COMPONENTS 3
+#define SUDOKU_MIXTURE_MAX_ITERATION 200
+#define SUDOKU_MIXTURE_TOLERANCE 1e-9
+#define SUDOKU_MIXTURE_MIN_VARIANCE 1.0
+#define SUDOKU_MIXTURE_MIN_CONFIDENCE 0.95
+// warm-up trials per function before allocating a decomposition budget
+#define SUDOKU_ADAPTIVE_MIN_TRIAL 16
+#define SUDOKU_ADAPTIVE_REFIT_ROUNDS 16
+// Wilson interval half width settling a function near its decision threshold
+#define SUDOKU_ADAPTIVE_MIN_HALF_WIDTH 0.05
 
-// DRAM timings
-#define SBDR_LOWER_BOUND SBDR_LOWER_BOUND_
-#define SBDR_UPPER_BOUND SBDR_UPPER_BOUND_
-#define REFRESH_CYCLE_LOWER_BOUND REFRESH_CYCLE_LOWER_BOUND_
-#define REFRESH_CYCLE_UPPER_BOUND REFRESH_CYCLE_UPPER_BOUND_
-#define REGULAR_REFRESH_INTERVAL_THRESHOLD REGULAR_REFRESH_INTERVAL_THRESHOLD_
+// DRAM timings (resolved from the active platform profile at runtime)
+#define SBDR_LOWER_BOUND (sudoku::GetPlatformProfile().sbdr_lower_bound)
+#define SBDR_UPPER_BOUND (sudoku::GetPlatformProfile().sbdr_upper_bound)
+#define REFRESH_CYCLE_LOWER_BOUND \
+  (sudoku::GetPlatformProfile().refresh_cycle_lower_bound)
+#define REFRESH_CYCLE_UPPER_BOUND \
+  (sudoku::GetPlatformProfile().refresh_cycle_upper_bound)
+#define REGULAR_REFRESH_INTERVAL_THRESHOLD \
+  (sudoku::GetPlatformProfile().regular_refresh_interval_threshold)
+#define REDUCED_REFRESH_INTERVAL_LOWER_BOUND \
+  (sudoku::GetPlatformProfile().reduced_refresh_interval_lower_bound)
 
 #define CONSECUTIVE_LENGTH 4
-#define BANK_GROUP_THRESHOLD BANK_GROUP_THRESHOLD_
+// longest stream length with an unrolled consecutive access kernel
+#define SUDOKU_CONSECUTIVE_MAX_LENGTH 32
+#define BANK_GROUP_THRESHOLD (sudoku::GetPlatformProfile().bank_group_threshold)
+
+// slots per SPSC ring of the preparation/measurement pipeline
+#define SUDOKU_PIPELINE_RING_SIZE 1024
+// binary result files: records added per growth and flush period
+#define SUDOKU_RESULT_SINK_GROW_RECORDS (64ULL * 1024ULL)
+#define SUDOKU_RESULT_SINK_FLUSH_MS 100
+// records per chunk of columnar result files
+#define SUDOKU_COLUMNAR_CHUNK_RECORDS 4096
+// seconds between checkpoints of the reverse-engineering phases
+#define SUDOKU_CHECKPOINT_INTERVAL_SECONDS 60
+// Sample addresses of the self-test of generated mapping headers
+#define SUDOKU_CODEGEN_NUM_SAMPLES 16
 
 // Testing
 #define TESTING_STATISTICS_NUM_PAIRS (1024ULL * 1024ULL)
@@ -51,8 +97,10 @@
 
 // AMD-specific (refer to "ZenHammer: Rowhammer Attacks on AMD Zen-based
 // Platforms," USENIX Security, 2024)
-#define PCI_OFFSET_UPPER_BOUND PCI_OFFSET_UPPER_BOUND_
-#define PCI_OFFSET_LOWER_BOUND PCI_OFFSET_LOWER_BOUND_
+#define PCI_OFFSET_UPPER_BOUND \
+  (sudoku::GetPlatformProfile().pci_offset_upper_bound)
+#define PCI_OFFSET_LOWER_BOUND \
+  (sudoku::GetPlatformProfile().pci_offset_lower_bound)
 #define PCI_OFFSET (PCI_OFFSET_UPPER_BOUND - PCI_OFFSET_LOWER_BOUND)
 
 #endif  // SUDOKU_INTERNAL_CONSTANTS_H
@@ -0,0 +1,131 @@
+#include "counters.h"
+
+#include <fstream>
+#include <mutex>
+
+#include "utils.h"
+
+namespace sudoku {
+
+thread_local uint64_t thread_counters[SUDOKU_NUM_COUNTERS] = {0};
+
+/// @brief Closed or open phase of the run report
+struct PhaseRecord {
+  std::string name;
+  size_t depth;
+  double start_ms;
+  double duration_ms;
+  bool open;
+  uint64_t counters[SUDOKU_NUM_COUNTERS];
+};
+
+/// @brief Run totals and phases, shared by all threads
+struct RunRecord {
+  std::mutex mutex;
+  std::chrono::steady_clock::time_point start;
+  uint64_t totals[SUDOKU_NUM_COUNTERS];
+  std::vector<PhaseRecord> phases;
+
+  RunRecord() : start(std::chrono::steady_clock::now()), totals{0} {}
+};
+
+static RunRecord& GetRunRecord() {
+  static RunRecord record;
+  return record;
+}
+
+static thread_local size_t phase_depth = 0;
+
+static double MillisecondsSince(std::chrono::steady_clock::time_point start,
+                                std::chrono::steady_clock::time_point end) {
+  return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+void FlushCounters() {
+  RunRecord& run = GetRunRecord();
+  std::lock_guard<std::mutex> lock(run.mutex);
+  for (int i = 0; i < SUDOKU_NUM_COUNTERS; ++i) {
+    run.totals[i] += thread_counters[i];
+    thread_counters[i] = 0;
+  }
+}
+
+ScopedPhase::ScopedPhase(std::string name) {
+  FlushCounters();
+  RunRecord& run = GetRunRecord();
+  start_ = std::chrono::steady_clock::now();
+  std::lock_guard<std::mutex> lock(run.mutex);
+  PhaseRecord phase;
+  phase.name = name;
+  phase.depth = phase_depth++;
+  phase.start_ms = MillisecondsSince(run.start, start_);
+  phase.duration_ms = 0.0;
+  phase.open = true;
+  for (int i = 0; i < SUDOKU_NUM_COUNTERS; ++i) {
+    phase.counters[i] = 0;
+    snapshot_[i] = run.totals[i];
+  }
+  record_ = run.phases.size();
+  run.phases.push_back(phase);
+}
+
+ScopedPhase::~ScopedPhase() {
+  FlushCounters();
+  RunRecord& run = GetRunRecord();
+  auto end = std::chrono::steady_clock::now();
+  std::lock_guard<std::mutex> lock(run.mutex);
+  PhaseRecord& phase = run.phases[record_];
+  phase.duration_ms = MillisecondsSince(start_, end);
+  phase.open = false;
+  for (int i = 0; i < SUDOKU_NUM_COUNTERS; ++i) {
+    phase.counters[i] = run.totals[i] - snapshot_[i];
+  }
+  phase_depth--;
+}
+
+static void WriteCounters(std::ofstream& ofs, const uint64_t* counters) {
+  ofs << "{";
+  for (int i = 0; i < SUDOKU_NUM_COUNTERS; ++i) {
+    ofs << (i ? ", " : "") << JSONString(CounterStr[i]) << ": "
+        << counters[i];
+  }
+  ofs << "}";
+}
+
+bool WriteRunReport(std::string fname,
+                    const std::vector<std::pair<std::string, std::string>>&
+                        info) {
+  FlushCounters();
+  std::ofstream ofs(fname);
+  if (!ofs.is_open()) {
+    PRINT_ERROR("Cannot open run report: {}", fname);
+    return false;
+  }
+  RunRecord& run = GetRunRecord();
+  std::lock_guard<std::mutex> lock(run.mutex);
+  ofs << "{\n";
+  for (const auto& entry : info) {
+    ofs << "  " << JSONString(entry.first) << ": " << JSONString(entry.second)
+        << ",\n";
+  }
+  ofs << "  \"wall_ms\": "
+      << MillisecondsSince(run.start, std::chrono::steady_clock::now())
+      << ",\n";
+  ofs << "  \"totals\": ";
+  WriteCounters(ofs, run.totals);
+  ofs << ",\n  \"phases\": [";
+  for (size_t i = 0; i < run.phases.size(); ++i) {
+    const PhaseRecord& phase = run.phases[i];
+    ofs << (i ? ",\n" : "\n") << "    {\"name\": " << JSONString(phase.name)
+        << ", \"depth\": " << phase.depth << ", \"start_ms\": "
+        << phase.start_ms << ", \"duration_ms\": " << phase.duration_ms
+        << ", \"complete\": " << (phase.open ? "false" : "true")
+        << ", \"counters\": ";
+    WriteCounters(ofs, phase.counters);
+    ofs << "}";
+  }
+  ofs << "\n  ]\n}\n";
+  return !ofs.fail();
+}
+
+}  // namespace sudoku
@@ -0,0 +1,79 @@
+#ifndef SUDOKU_INTERNAL_COUNTERS_H
+#define SUDOKU_INTERNAL_COUNTERS_H
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace sudoku {
+
+// Instrumentation counters (see WriteRunReport)
+enum class Counter {
+  SINGLE_MEASUREMENTS = 0,   // single-address timing loops
+  PAIR_MEASUREMENTS,         // paired timing loops (batched pairs count each)
+  SCHEDULED_MEASUREMENTS,    // refresh-phase-scheduled paired timing loops
+  REFRESH_CAPTURES,          // refresh sampling loops
+  CONSECUTIVE_MEASUREMENTS,  // consecutive access stream timing loops
+  VIRT_TO_PHYS,              // physical address lookups
+  PHYS_TO_VIRT,              // pool lookups
+  PHYS_TO_VIRT_MISSES,       // pool lookups outside the pool
+  RANDOM_TUPLES,             // random address tuples
+  CONSTRAINT_SOLVES,         // constrained address generation
+  CONSTRAINT_FAILURES,       // ... without a solution in the pool
+  DECOMPOSITION_PAIRS,       // function pairs timed when decomposing
+  NUM_COUNTERS,
+};
+
+#define SUDOKU_NUM_COUNTERS static_cast<int>(Counter::NUM_COUNTERS)
+
+static const std::string CounterStr[] = {
+    "single_measurements",
+    "pair_measurements",
+    "scheduled_measurements",
+    "refresh_captures",
+    "consecutive_measurements",
+    "virt_to_phys",
+    "phys_to_virt",
+    "phys_to_virt_misses",
+    "random_tuples",
+    "constraint_solves",
+    "constraint_failures",
+    "decomposition_pairs",
+};
+
+// Counts of the calling thread since its last flush
+extern thread_local uint64_t thread_counters[];
+
+inline void Count(Counter counter, uint64_t n = 1) {
+  thread_counters[static_cast<int>(counter)] += n;
+}
+
+// Add the calling thread's counts to the run totals (helper threads flush
+// before they exit; phases flush the thread that ends them)
+void FlushCounters();
+
+/// @brief Timed phase of a run. A phase records its duration and the counts
+/// flushed while it was open, including those of nested phases.
+class ScopedPhase {
+ public:
+  explicit ScopedPhase(std::string name);
+  ScopedPhase(const ScopedPhase&) = delete;
+  ScopedPhase& operator=(const ScopedPhase&) = delete;
+  ~ScopedPhase();
+
+ private:
+  size_t record_;
+  std::chrono::steady_clock::time_point start_;
+  uint64_t snapshot_[SUDOKU_NUM_COUNTERS];
+};
+
+// Write phases and totals as JSON; info adds top-level string fields
+bool WriteRunReport(std::string fname,
+                    const std::vector<std::pair<std::string, std::string>>&
+                        info);
+
+}  // namespace sudoku
+
+#endif  // SUDOKU_INTERNAL_COUNTERS_H
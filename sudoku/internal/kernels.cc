@@ -0,0 +1,340 @@
+#include <stddef.h>
+
+#include <cstdint>
+#include <utility>
+
+#include "assembly.h"
+#include "backend.h"
+#include "consecutive_accesses.h"
+#include "constants.h"
+#include "refresh_scheduler.h"
+#include "utils.h"
+
+// Timing kernels of the hardware backend. This translation unit is built
+// into its own library at -O0 without LTO (see CMakeLists.txt), so the
+// flush, fence, access, and timestamp sequences are emitted as written while
+// the rest of the code is optimized; check_kernels verifies the disassembly.
+
+namespace sudoku {
+
+uint64_t HardwareBackend::Timestamp() { return rdtscp(); }
+
+// Conflicts
+void HardwareBackend::AccessTimingSingleMemoryAccess(uint64_t addr,
+                                                     uint64_t** histogram) {
+  // measure
+  for (size_t i = 0; i < SUDOKU_CONFLICT_NUM_ITERATION; ++i) {
+    clflushopt(reinterpret_cast<void*>(addr));
+    mfence();
+    histogram[i][0] = rdtscp();
+    *(volatile char*)addr;
+    lfence();
+    histogram[i][1] = rdtscp();
+  }
+  for (size_t i = 0; i < SUDOKU_CONFLICT_NUM_ITERATION; ++i) {
+    histogram[i][1] -= histogram[i][0];
+  }
+}
+
+void HardwareBackend::AccessTimingPairedMemoryAccess(uint64_t faddr,
+                                                     uint64_t saddr,
+                                                     uint64_t** histogram) {
+  for (size_t i = 0; i < SUDOKU_CONFLICT_NUM_ITERATION; ++i) {
+    clflushopt(reinterpret_cast<void*>(faddr));
+    clflushopt(reinterpret_cast<void*>(saddr));
+    mfence();
+    histogram[i][0] = rdtscp();
+    *(volatile char*)faddr;
+    *(volatile char*)saddr;
+    lfence();
+    histogram[i][1] = rdtscp();
+  }
+  for (size_t i = 0; i < SUDOKU_CONFLICT_NUM_ITERATION; ++i) {
+    histogram[i][1] -= histogram[i][0];
+  }
+}
+
+void HardwareBackend::AccessTimingPairedMemoryAccessScheduled(
+    uint64_t faddr, uint64_t saddr, RefreshScheduler& scheduler,
+    uint64_t** histogram) {
+  for (size_t i = 0; i < SUDOKU_SCHEDULED_CONFLICT_NUM_ITERATION; ++i) {
+    // re-lock between samples, the flushes then evict the locked address
+    scheduler.Maintain();
+    clflushopt(reinterpret_cast<void*>(faddr));
+    clflushopt(reinterpret_cast<void*>(saddr));
+    mfence();
+    // start only if the accesses end before the next refresh
+    scheduler.Wait(2 * SBDR_UPPER_BOUND);
+    histogram[i][0] = rdtscp();
+    *(volatile char*)faddr;
+    *(volatile char*)saddr;
+    lfence();
+    histogram[i][1] = rdtscp();
+  }
+  for (size_t i = 0; i < SUDOKU_SCHEDULED_CONFLICT_NUM_ITERATION; ++i) {
+    histogram[i][1] -= histogram[i][0];
+  }
+}
+
+void HardwareBackend::AccessTimingBatchedPairedMemoryAccess(
+    const uint64_t* faddrs, const uint64_t* saddrs, size_t num_pairs,
+    uint64_t** histogram) {
+  uint64_t start, end;
+  for (size_t k = 0; k < num_pairs; ++k) {
+    clflushopt(reinterpret_cast<void*>(faddrs[k]));
+    clflushopt(reinterpret_cast<void*>(saddrs[k]));
+  }
+  for (size_t i = 0; i < SUDOKU_CONFLICT_NUM_ITERATION; ++i) {
+    // a single fence per flush epoch instead of one per pair
+    mfence();
+    for (size_t k = 0; k < num_pairs; ++k) {
+      start = rdtscp();
+      *(volatile char*)faddrs[k];
+      *(volatile char*)saddrs[k];
+      lfence();
+      end = rdtscp();
+      // flushes of this pair overlap with the timing of the next pair
+      clflushopt(reinterpret_cast<void*>(faddrs[k]));
+      clflushopt(reinterpret_cast<void*>(saddrs[k]));
+      histogram[k][i] = end - start;
+    }
+  }
+}
+
+// Refreshes
+void HardwareBackend::MeasureRefreshSingleAccess(uint64_t addr,
+                                                 uint64_t** histogram) {
+  for (size_t i = 0; i < SUDOKU_REFRESH_NUM_ITERATION; ++i) {
+    clflushopt(reinterpret_cast<void*>(addr));
+    mfence();
+    histogram[i][0] = rdtscp();
+    *(volatile char*)addr;
+    lfence();
+    histogram[i][1] = rdtscp();
+  }
+  for (size_t i = 0; i < SUDOKU_REFRESH_NUM_ITERATION; ++i) {
+    histogram[i][1] -= histogram[i][0];
+  }
+}
+
+void HardwareBackend::MeasureRefreshPairedAccessCoarse(uint64_t faddr,
+                                                       uint64_t saddr,
+                                                       uint64_t** histogram) {
+  for (size_t i = 0; i < SUDOKU_REFRESH_NUM_ITERATION; ++i) {
+    clflushopt(reinterpret_cast<void*>(faddr));
+    clflushopt(reinterpret_cast<void*>(saddr));
+    mfence();
+    histogram[i][0] = rdtscp();
+    *(volatile char*)faddr;
+    *(volatile char*)saddr;
+    lfence();
+    histogram[i][1] = rdtscp();
+  }
+  for (size_t i = 0; i < SUDOKU_REFRESH_NUM_ITERATION; ++i) {
+    histogram[i][1] -= histogram[i][0];
+  }
+}
+
+void HardwareBackend::MeasureRefreshPairedAccessFine(uint64_t faddr,
+                                                     uint64_t saddr,
+                                                     uint64_t** histogram) {
+  for (size_t i = 0; i < SUDOKU_REFRESH_NUM_ITERATION; ++i) {
+    clflushopt(reinterpret_cast<void*>(faddr));
+    clflushopt(reinterpret_cast<void*>(saddr));
+    mfence();
+    histogram[i][0] = rdtscp();
+    *(volatile char*)faddr;
+    lfence();
+    histogram[i][1] = rdtscp();
+    *(volatile char*)saddr;
+    lfence();
+    histogram[i][2] = rdtscp();
+  }
+  for (size_t i = 0; i < SUDOKU_REFRESH_NUM_ITERATION; ++i) {
+    histogram[i][2] -= histogram[i][1];
+    histogram[i][1] -= histogram[i][0];
+  }
+}
+
+void HardwareBackend::MeasureRefreshMultiAccess(const uint64_t* addrs,
+                                                size_t num_addrs,
+                                                uint64_t num_iterations,
+                                                uint64_t** histogram) {
+  for (size_t i = 0; i < num_iterations; ++i) {
+    for (size_t k = 0; k < num_addrs; ++k) {
+      clflushopt(reinterpret_cast<void*>(addrs[k]));
+    }
+    mfence();
+    histogram[i][0] = rdtscp();
+    for (size_t k = 0; k < num_addrs; ++k) {
+      *(volatile char*)addrs[k];
+      lfence();
+      histogram[i][k + 1] = rdtscp();
+    }
+  }
+  for (size_t i = 0; i < num_iterations; ++i) {
+    for (size_t k = num_addrs; k > 0; --k) {
+      histogram[i][k] -= histogram[i][k - 1];
+    }
+  }
+}
+
+// Consecutive accesses
+namespace {
+
+constexpr bool FirstStreamWrites(ConsecutiveAccess pattern) {
+  return pattern == ConsecutiveAccess::WRRD ||
+         pattern == ConsecutiveAccess::WRWR;
+}
+
+constexpr bool SecondStreamWrites(ConsecutiveAccess pattern) {
+  return pattern == ConsecutiveAccess::RDWR ||
+         pattern == ConsecutiveAccess::WRWR;
+}
+
+// A single read, or a non-temporal write that skips the read-for-ownership
+template <bool Write>
+inline __attribute__((always_inline)) void Access(uint64_t addr);
+
+template <>
+inline __attribute__((always_inline)) void Access<false>(uint64_t addr) {
+  *(volatile char*)addr;
+}
+
+template <>
+inline __attribute__((always_inline)) void Access<true>(uint64_t addr) {
+  movnti(reinterpret_cast<void*>(addr), addr);
+}
+
+// Straight-line access streams: the expansions over the compile-time stream
+// indices leave no loop control or index update in the timed window, and the
+// addresses are copied into locals before it, so the window reads no
+// caller's array. mfence also drains the write-combining buffers of the
+// non-temporal stores.
+template <ConsecutiveAccess P, size_t... I>
+void ConsecutiveAccessLatencyUnrolled(const uint64_t* faddrs,
+                                      const uint64_t* saddrs,
+                                      uint64_t** histogram) {
+  using Expand = int[];
+  const uint64_t first[] = {faddrs[I]...};
+  const uint64_t second[] = {saddrs[I]...};
+  for (size_t i = 0; i < SUDOKU_CONSECUTIVE_NUM_ITERATION; ++i) {
+    (void)Expand{(clflushopt(reinterpret_cast<void*>(first[I])),
+                  clflushopt(reinterpret_cast<void*>(second[I])), 0)...};
+    mfence();
+    histogram[i][0] = rdtscp();
+    // let MCs schedule the requests in this sequence
+    (void)Expand{(Access<FirstStreamWrites(P)>(first[I]),
+                  Access<SecondStreamWrites(P)>(second[I]), 0)...};
+    mfence();
+    histogram[i][1] = rdtscp();
+  }
+  for (size_t i = 0; i < SUDOKU_CONSECUTIVE_NUM_ITERATION; ++i) {
+    histogram[i][1] -= histogram[i][0];
+  }
+}
+
+// Fallback for lengths beyond the dispatch table
+template <ConsecutiveAccess P>
+void ConsecutiveAccessLatencyLoop(const uint64_t* faddrs,
+                                  const uint64_t* saddrs, size_t length,
+                                  uint64_t** histogram) {
+  for (size_t i = 0; i < SUDOKU_CONSECUTIVE_NUM_ITERATION; ++i) {
+    // clflushopt
+    for (size_t j = 0; j < length; ++j) {
+      clflushopt(reinterpret_cast<void*>(faddrs[j]));
+      clflushopt(reinterpret_cast<void*>(saddrs[j]));
+    }
+    mfence();
+    histogram[i][0] = rdtscp();
+    // let MCs schedule the requests in this loop
+    for (size_t j = 0; j < length; ++j) {
+      Access<FirstStreamWrites(P)>(faddrs[j]);
+      Access<SecondStreamWrites(P)>(saddrs[j]);
+    }
+    mfence();
+    histogram[i][1] = rdtscp();
+  }
+  for (size_t i = 0; i < SUDOKU_CONSECUTIVE_NUM_ITERATION; ++i) {
+    histogram[i][1] -= histogram[i][0];
+  }
+}
+
+using ConsecutiveAccessKernel = void (*)(const uint64_t*, const uint64_t*,
+                                         uint64_t**);
+
+// Dispatch table indexed by (length - 1)
+template <ConsecutiveAccess P, typename Sequence>
+struct ConsecutiveAccessKernelTable;
+
+// Straight-line kernel of the streams of length sizeof...(I)
+template <ConsecutiveAccess P, typename Sequence>
+struct UnrolledConsecutiveAccessKernel;
+
+template <ConsecutiveAccess P, size_t... I>
+struct UnrolledConsecutiveAccessKernel<P, std::index_sequence<I...>> {
+  static constexpr ConsecutiveAccessKernel kernel =
+      &ConsecutiveAccessLatencyUnrolled<P, I...>;
+};
+
+template <ConsecutiveAccess P, size_t... I>
+struct ConsecutiveAccessKernelTable<P, std::index_sequence<I...>> {
+  static constexpr ConsecutiveAccessKernel kernels[] = {
+      UnrolledConsecutiveAccessKernel<
+          P, std::make_index_sequence<I + 1>>::kernel...};
+};
+
+template <ConsecutiveAccess P, size_t... I>
+constexpr ConsecutiveAccessKernel
+    ConsecutiveAccessKernelTable<P, std::index_sequence<I...>>::kernels[];
+
+template <ConsecutiveAccess P>
+void ConsecutiveAccessLatency(const uint64_t* faddrs, const uint64_t* saddrs,
+                              size_t length, uint64_t** histogram) {
+  using Kernels = ConsecutiveAccessKernelTable<
+      P, std::make_index_sequence<SUDOKU_CONSECUTIVE_MAX_LENGTH>>;
+  if (length >= 1 && length <= SUDOKU_CONSECUTIVE_MAX_LENGTH) {
+    Kernels::kernels[length - 1](faddrs, saddrs, histogram);
+  } else {
+    ConsecutiveAccessLatencyLoop<P>(faddrs, saddrs, length, histogram);
+  }
+}
+
+void DispatchConsecutiveAccessLatency(ConsecutiveAccess pattern,
+                                      const uint64_t* faddrs,
+                                      const uint64_t* saddrs, size_t length,
+                                      uint64_t** histogram) {
+  switch (pattern) {
+    case ConsecutiveAccess::RDRD:
+      ConsecutiveAccessLatency<ConsecutiveAccess::RDRD>(faddrs, saddrs, length,
+                                                        histogram);
+      break;
+    case ConsecutiveAccess::RDWR:
+      ConsecutiveAccessLatency<ConsecutiveAccess::RDWR>(faddrs, saddrs, length,
+                                                        histogram);
+      break;
+    case ConsecutiveAccess::WRRD:
+      ConsecutiveAccessLatency<ConsecutiveAccess::WRRD>(faddrs, saddrs, length,
+                                                        histogram);
+      break;
+    case ConsecutiveAccess::WRWR:
+      ConsecutiveAccessLatency<ConsecutiveAccess::WRWR>(faddrs, saddrs, length,
+                                                        histogram);
+      break;
+    default:
+      PRINT_ERROR("Unsupported consecutive access pattern");
+      exit(EXIT_FAILURE);
+  }
+}
+
+}  // namespace
+
+void HardwareBackend::ConsecutiveAccessLatency(ConsecutiveAccess pattern,
+                                               const uint64_t* faddrs,
+                                               const uint64_t* saddrs,
+                                               size_t length,
+                                               uint64_t** histogram) {
+  DispatchConsecutiveAccessLatency(pattern, faddrs, saddrs, length, histogram);
+}
+
+}  // namespace sudoku
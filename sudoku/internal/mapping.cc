@@ -0,0 +1,381 @@
+#include "mapping.h"
+
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iterator>
+#include <sstream>
+
+#include "utils.h"
+
+namespace sudoku {
+
+namespace {
+
+/// @brief Parsed JSON value; numbers keep their text so 64-bit integers
+/// survive
+struct JSONValue {
+  enum class Type { NONE, BOOL, NUMBER, STRING, ARRAY, OBJECT };
+  Type type = Type::NONE;
+  std::string text;  // number or string
+  bool boolean = false;
+  std::vector<JSONValue> array;
+  std::map<std::string, JSONValue> object;
+
+  const JSONValue* Get(const std::string& key) const {
+    auto it = object.find(key);
+    return (it == object.end()) ? nullptr : &it->second;
+  }
+};
+
+// Recursive descent parser of the subset written by WriteMappingArtifact
+// (no \u escapes)
+class JSONParser {
+ public:
+  explicit JSONParser(const std::string& str)
+      : p_(str.data()), end_(str.data() + str.size()) {}
+
+  bool Parse(JSONValue* value) {
+    if (!ParseValue(value, 0)) {
+      return false;
+    }
+    SkipSpaces();
+    return p_ == end_;
+  }
+
+ private:
+  void SkipSpaces() {
+    while (p_ < end_ && isspace(static_cast<unsigned char>(*p_))) {
+      p_++;
+    }
+  }
+
+  bool Consume(const char* literal) {
+    size_t length = strlen(literal);
+    if (static_cast<size_t>(end_ - p_) < length ||
+        strncmp(p_, literal, length) != 0) {
+      return false;
+    }
+    p_ += length;
+    return true;
+  }
+
+  bool ParseString(std::string* str) {
+    if (p_ == end_ || *p_ != '"') {
+      return false;
+    }
+    p_++;
+    str->clear();
+    while (p_ < end_ && *p_ != '"') {
+      if (*p_ == '\\') {
+        if (++p_ == end_) {
+          return false;
+        }
+        char c = *p_;
+        str->push_back(c == 'n' ? '\n' : c == 't' ? '\t' : c);
+      } else {
+        str->push_back(*p_);
+      }
+      p_++;
+    }
+    if (p_ == end_) {
+      return false;
+    }
+    p_++;
+    return true;
+  }
+
+  bool ParseValue(JSONValue* value, int depth) {
+    SkipSpaces();
+    if (p_ == end_ || depth > 16) {
+      return false;
+    }
+    if (*p_ == '{') {
+      p_++;
+      value->type = JSONValue::Type::OBJECT;
+      SkipSpaces();
+      if (p_ < end_ && *p_ == '}') {
+        p_++;
+        return true;
+      }
+      for (;;) {
+        std::string key;
+        SkipSpaces();
+        if (!ParseString(&key)) {
+          return false;
+        }
+        SkipSpaces();
+        if (!Consume(":") || !ParseValue(&value->object[key], depth + 1)) {
+          return false;
+        }
+        SkipSpaces();
+        if (Consume("}")) {
+          return true;
+        }
+        if (!Consume(",")) {
+          return false;
+        }
+      }
+    }
+    if (*p_ == '[') {
+      p_++;
+      value->type = JSONValue::Type::ARRAY;
+      SkipSpaces();
+      if (p_ < end_ && *p_ == ']') {
+        p_++;
+        return true;
+      }
+      for (;;) {
+        value->array.emplace_back();
+        if (!ParseValue(&value->array.back(), depth + 1)) {
+          return false;
+        }
+        SkipSpaces();
+        if (Consume("]")) {
+          return true;
+        }
+        if (!Consume(",")) {
+          return false;
+        }
+      }
+    }
+    if (*p_ == '"') {
+      value->type = JSONValue::Type::STRING;
+      return ParseString(&value->text);
+    }
+    if (Consume("true")) {
+      value->type = JSONValue::Type::BOOL;
+      value->boolean = true;
+      return true;
+    }
+    if (Consume("false")) {
+      value->type = JSONValue::Type::BOOL;
+      return true;
+    }
+    if (Consume("null")) {
+      value->type = JSONValue::Type::NONE;
+      return true;
+    }
+    const char* start = p_;
+    while (p_ < end_ && (isdigit(static_cast<unsigned char>(*p_)) ||
+                         strchr("+-.eE", *p_) != nullptr)) {
+      p_++;
+    }
+    value->type = JSONValue::Type::NUMBER;
+    value->text.assign(start, p_);
+    return p_ != start;
+  }
+
+  const char* p_;
+  const char* end_;
+};
+
+std::string Hex(uint64_t value) {
+  std::ostringstream oss;
+  oss << "\"0x" << std::hex << value << "\"";
+  return oss.str();
+}
+
+// Numbers, and hex strings for functions and bits
+uint64_t GetUnsigned(const JSONValue* value, uint64_t fallback = 0) {
+  if (value == nullptr || (value->type != JSONValue::Type::NUMBER &&
+                           value->type != JSONValue::Type::STRING)) {
+    return fallback;
+  }
+  return strtoull(value->text.c_str(), nullptr, 0);
+}
+
+double GetDouble(const JSONValue* value, double fallback) {
+  if (value == nullptr || value->type != JSONValue::Type::NUMBER) {
+    return fallback;
+  }
+  return strtod(value->text.c_str(), nullptr);
+}
+
+std::string GetString(const JSONValue* value) {
+  if (value == nullptr || value->type != JSONValue::Type::STRING) {
+    return "";
+  }
+  return value->text;
+}
+
+}  // namespace
+
+std::vector<uint64_t> MappingArtifact::Functions() const {
+  std::vector<uint64_t> result;
+  for (const auto& entry : functions) {
+    result.push_back(entry.function);
+  }
+  return result;
+}
+
+std::vector<uint64_t> MappingArtifact::Functions(FunctionRole role) const {
+  std::vector<uint64_t> result;
+  for (const auto& entry : functions) {
+    if (entry.role == role) {
+      result.push_back(entry.function);
+    }
+  }
+  return result;
+}
+
+bool WriteMappingArtifact(std::string fname, const MappingArtifact& mapping) {
+  std::ofstream ofs(fname);
+  if (!ofs.is_open()) {
+    PRINT_ERROR("Cannot open mapping file: {}", fname);
+    return false;
+  }
+  ofs << std::fixed << std::setprecision(4);
+  ofs << "{\n";
+  ofs << "  \"format\": \"" << SUDOKU_MAPPING_FORMAT << "\",\n";
+  ofs << "  \"version\": " << mapping.version << ",\n";
+  ofs << "  \"binary\": " << JSONString(mapping.binary) << ",\n";
+  ofs << "  \"platform\": {\"name\": " << JSONString(mapping.platform)
+      << ", \"sbdr_lower_bound\": " << mapping.sbdr_lower_bound
+      << ", \"sbdr_upper_bound\": " << mapping.sbdr_upper_bound
+      << ", \"bank_group_threshold\": " << mapping.bank_group_threshold
+      << ", \"refresh_cycle_lower_bound\": "
+      << mapping.refresh_cycle_lower_bound
+      << ", \"regular_refresh_interval_threshold\": "
+      << mapping.regular_refresh_interval_threshold
+      << ", \"reduced_refresh_interval_lower_bound\": "
+      << mapping.reduced_refresh_interval_lower_bound
+      << ", \"pci_offset\": " << Hex(mapping.pci_offset) << "},\n";
+  ofs << "  \"dram\": {\"type\": \""
+      << DDRTypeStr[static_cast<int>(mapping.ddr_type)]
+      << "\", \"module_size\": " << mapping.module_size
+      << ", \"num_ranks\": " << mapping.num_ranks
+      << ", \"dq_width\": " << mapping.dq_width
+      << ", \"num_dimms\": " << mapping.num_dimms << "},\n";
+  ofs << "  \"functions\": [";
+  for (size_t i = 0; i < mapping.functions.size(); ++i) {
+    const MappedFunction& entry = mapping.functions[i];
+    ofs << (i ? ",\n" : "\n") << "    {\"function\": "
+        << Hex(entry.function) << ", \"role\": \""
+        << FunctionRoleStr[static_cast<int>(entry.role)] << "\"";
+    if (entry.confidence >= 0.0) {
+      ofs << ", \"confidence\": " << entry.confidence;
+    }
+    ofs << "}";
+  }
+  ofs << (mapping.functions.empty() ? "],\n" : "\n  ],\n");
+  ofs << "  \"row_bits\": " << Hex(mapping.row_bits) << ",\n";
+  ofs << "  \"column_bits\": " << Hex(mapping.column_bits) << ",\n";
+  ofs << "  \"bits\": [";
+  bool first = true;
+  for (uint64_t bit = 0; bit < 64; ++bit) {
+    bool row = mapping.row_bits & (1ULL << bit);
+    bool column = mapping.column_bits & (1ULL << bit);
+    if (!row && !column) {
+      continue;
+    }
+    ofs << (first ? "\n" : ",\n") << "    {\"bit\": " << bit
+        << ", \"role\": \"" << (row ? "row" : "column") << "\"";
+    auto it = mapping.bit_confidences.find(1ULL << bit);
+    if (it != mapping.bit_confidences.end()) {
+      ofs << ", \"confidence\": " << it->second;
+    }
+    ofs << "}";
+    first = false;
+  }
+  ofs << (first ? "],\n" : "\n  ],\n");
+  ofs << "  \"validated\": " << (mapping.validated ? "true" : "false")
+      << "\n}\n";
+  return !ofs.fail();
+}
+
+bool ReadMappingArtifact(std::string fname, MappingArtifact* mapping) {
+  std::ifstream ifs(fname);
+  if (!ifs.is_open()) {
+    PRINT_ERROR("Cannot open mapping file: {}", fname);
+    return false;
+  }
+  std::string str((std::istreambuf_iterator<char>(ifs)),
+                  std::istreambuf_iterator<char>());
+  JSONValue root;
+  if (!JSONParser(str).Parse(&root) ||
+      root.type != JSONValue::Type::OBJECT ||
+      GetString(root.Get("format")) != SUDOKU_MAPPING_FORMAT) {
+    PRINT_ERROR("Not a mapping file: {}", fname);
+    return false;
+  }
+  *mapping = MappingArtifact();
+  mapping->version = GetUnsigned(root.Get("version"));
+  if (mapping->version == 0 || mapping->version > SUDOKU_MAPPING_VERSION) {
+    PRINT_ERROR("Unsupported mapping version {}: {}", mapping->version,
+                fname);
+    return false;
+  }
+  mapping->binary = GetString(root.Get("binary"));
+
+  static const JSONValue none;
+  const JSONValue* platform = root.Get("platform");
+  platform = platform ? platform : &none;
+  mapping->platform = GetString(platform->Get("name"));
+  mapping->sbdr_lower_bound = GetUnsigned(platform->Get("sbdr_lower_bound"));
+  mapping->sbdr_upper_bound = GetUnsigned(platform->Get("sbdr_upper_bound"));
+  mapping->bank_group_threshold =
+      GetUnsigned(platform->Get("bank_group_threshold"));
+  mapping->refresh_cycle_lower_bound =
+      GetUnsigned(platform->Get("refresh_cycle_lower_bound"));
+  mapping->regular_refresh_interval_threshold =
+      GetUnsigned(platform->Get("regular_refresh_interval_threshold"));
+  mapping->reduced_refresh_interval_lower_bound =
+      GetUnsigned(platform->Get("reduced_refresh_interval_lower_bound"));
+  mapping->pci_offset = GetUnsigned(platform->Get("pci_offset"));
+
+  const JSONValue* dram = root.Get("dram");
+  dram = dram ? dram : &none;
+  std::string type = GetString(dram->Get("type"));
+  if (type == "DDR5" || type == "ddr5") {
+    mapping->ddr_type = DDRType::DDR5;
+  } else if (type == "DDR4" || type == "ddr4") {
+    mapping->ddr_type = DDRType::DDR4;
+  } else {
+    PRINT_ERROR("Unsupported DDR type in mapping {}: {}", fname, type);
+    return false;
+  }
+  mapping->module_size = GetUnsigned(dram->Get("module_size"));
+  mapping->num_ranks = GetUnsigned(dram->Get("num_ranks"));
+  mapping->dq_width = GetUnsigned(dram->Get("dq_width"));
+  mapping->num_dimms = GetUnsigned(dram->Get("num_dimms"));
+
+  const JSONValue* functions = root.Get("functions");
+  if (functions != nullptr) {
+    for (const auto& entry : functions->array) {
+      MappedFunction function = {GetUnsigned(entry.Get("function")),
+                                 FunctionRole::UNKNOWN,
+                                 GetDouble(entry.Get("confidence"), -1.0)};
+      std::string role = GetString(entry.Get("role"));
+      for (int r = 0; r < static_cast<int>(FunctionRole::NUM_ROLES); ++r) {
+        if (role == FunctionRoleStr[r]) {
+          function.role = static_cast<FunctionRole>(r);
+        }
+      }
+      if (function.function == 0) {
+        PRINT_ERROR("Malformed function in mapping: {}", fname);
+        return false;
+      }
+      mapping->functions.push_back(function);
+    }
+  }
+  mapping->row_bits = GetUnsigned(root.Get("row_bits"));
+  mapping->column_bits = GetUnsigned(root.Get("column_bits"));
+  const JSONValue* bits = root.Get("bits");
+  if (bits != nullptr) {
+    for (const auto& entry : bits->array) {
+      const JSONValue* confidence = entry.Get("confidence");
+      uint64_t bit = GetUnsigned(entry.Get("bit"), 64);
+      if (confidence != nullptr && bit < 64) {
+        mapping->bit_confidences[1ULL << bit] = GetDouble(confidence, -1.0);
+      }
+    }
+  }
+  const JSONValue* validated = root.Get("validated");
+  mapping->validated = validated != nullptr && validated->boolean;
+  return true;
+}
+
+}  // namespace sudoku
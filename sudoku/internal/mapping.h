@@ -0,0 +1,98 @@
+#ifndef SUDOKU_INTERNAL_MAPPING_H
+#define SUDOKU_INTERNAL_MAPPING_H
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "config.h"
+
+namespace sudoku {
+
+#define SUDOKU_MAPPING_FORMAT "sudoku-mapping"
+#define SUDOKU_MAPPING_VERSION 1
+
+// Component of a function, as decomposed (UNKNOWN before decomposition)
+enum class FunctionRole : uint8_t {
+  UNKNOWN = 0,
+  CHANNEL,
+  RANK,  // functions with reduced refresh intervals (see the profile)
+  BANK_GROUP,
+  BANK_ADDRESS,
+  NUM_ROLES,
+};
+
+static const std::string FunctionRoleStr[] = {
+    "unknown", "channel", "rank", "bank_group", "bank_address",
+};
+
+/// @brief A DRAM addressing function of a mapping and its role. Confidences
+/// are in [0, 1] and negative if not measured.
+struct MappedFunction {
+  uint64_t function;
+  FunctionRole role;
+  double confidence;
+};
+
+/// @brief DRAM address mapping artifact ({prefix}.mapping.json) written by
+/// every step and accepted by --mapping, so a later step starts from the
+/// mapping of an earlier one instead of its log lines
+struct MappingArtifact {
+  uint64_t version;
+  std::string binary;  // producer
+  // Platform profile and the thresholds the mapping was measured with
+  std::string platform;
+  uint64_t sbdr_lower_bound;
+  uint64_t sbdr_upper_bound;
+  uint64_t bank_group_threshold;
+  uint64_t refresh_cycle_lower_bound;
+  uint64_t regular_refresh_interval_threshold;
+  uint64_t reduced_refresh_interval_lower_bound;
+  uint64_t pci_offset;
+  // DRAM configuration
+  DDRType ddr_type;
+  uint64_t module_size;  // bytes
+  uint64_t num_ranks;
+  uint64_t dq_width;
+  uint64_t num_dimms;
+  // Mapping
+  std::vector<MappedFunction> functions;
+  uint64_t row_bits;
+  uint64_t column_bits;
+  std::map<uint64_t, double> bit_confidences;  // single bit -> confidence
+  bool validated;
+
+  MappingArtifact()
+      : version(SUDOKU_MAPPING_VERSION),
+        binary(""),
+        platform(""),
+        sbdr_lower_bound(0),
+        sbdr_upper_bound(0),
+        bank_group_threshold(0),
+        refresh_cycle_lower_bound(0),
+        regular_refresh_interval_threshold(0),
+        reduced_refresh_interval_lower_bound(0),
+        pci_offset(0),
+        ddr_type(DDRType::DDR4),
+        module_size(0),
+        num_ranks(0),
+        dq_width(0),
+        num_dimms(0),
+        functions(),
+        row_bits(0),
+        column_bits(0),
+        bit_confidences(),
+        validated(false) {}
+
+  std::vector<uint64_t> Functions() const;
+  std::vector<uint64_t> Functions(FunctionRole role) const;
+};
+
+bool WriteMappingArtifact(std::string fname, const MappingArtifact& mapping);
+// Fails on malformed files and newer versions; unknown keys are ignored
+bool ReadMappingArtifact(std::string fname, MappingArtifact* mapping);
+
+}  // namespace sudoku
+
+#endif  // SUDOKU_INTERNAL_MAPPING_H
@@ -0,0 +1,211 @@
+#include "mixture.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <numeric>
+#include <vector>
+
+#include "constants.h"
+
+namespace sudoku {
+
+double GaussianMixture::LogDensity(size_t c, double value) const {
+  double delta = value - means[c];
+  return std::log(weights[c]) - 0.5 * std::log(2.0 * M_PI * variances[c]) -
+         delta * delta / (2.0 * variances[c]);
+}
+
+std::vector<double> GaussianMixture::MeanPosterior(
+    const std::vector<uint64_t>& values) const {
+  std::vector<double> posterior;
+  if (values.empty() || means.empty()) {
+    return posterior;
+  }
+  posterior.assign(NumComponents(), 0.0);
+  std::vector<double> r(NumComponents(), 0.0);
+  for (const auto& value : values) {
+    double max_log = -INFINITY;
+    for (size_t c = 0; c < NumComponents(); ++c) {
+      r[c] = LogDensity(c, static_cast<double>(value));
+      max_log = std::max(max_log, r[c]);
+    }
+    double sum = 0.0;
+    for (size_t c = 0; c < NumComponents(); ++c) {
+      r[c] = std::exp(r[c] - max_log);
+      sum += r[c];
+    }
+    for (size_t c = 0; c < NumComponents(); ++c) {
+      posterior[c] += r[c] / sum;
+    }
+  }
+  for (auto& p : posterior) {
+    p /= values.size();
+  }
+  return posterior;
+}
+
+GaussianMixture FitGaussianMixture(const std::vector<double>& values,
+                                   size_t num_components) {
+  GaussianMixture mixture;
+  const size_t n = values.size();
+  if (num_components == 0 || n < num_components) {
+    return mixture;
+  }
+  std::vector<double> sorted(values);
+  std::sort(sorted.begin(), sorted.end());
+
+  // k-means seeded with the means of equal-count chunks of the sorted values
+  std::vector<double> means(num_components, 0.0);
+  for (size_t c = 0; c < num_components; ++c) {
+    size_t begin = c * n / num_components, end = (c + 1) * n / num_components;
+    means[c] = std::accumulate(sorted.begin() + begin, sorted.begin() + end,
+                               0.0) /
+               (end - begin);
+  }
+  std::vector<size_t> labels(n, 0);
+  for (size_t iteration = 0; iteration < SUDOKU_MIXTURE_MAX_ITERATION;
+       ++iteration) {
+    bool changed = false;
+    for (size_t i = 0; i < n; ++i) {
+      size_t best = 0;
+      for (size_t c = 1; c < num_components; ++c) {
+        if (std::fabs(sorted[i] - means[c]) <
+            std::fabs(sorted[i] - means[best])) {
+          best = c;
+        }
+      }
+      changed |= (labels[i] != best);
+      labels[i] = best;
+    }
+    std::vector<double> sums(num_components, 0.0);
+    std::vector<size_t> counts(num_components, 0);
+    for (size_t i = 0; i < n; ++i) {
+      sums[labels[i]] += sorted[i];
+      counts[labels[i]]++;
+    }
+    for (size_t c = 0; c < num_components; ++c) {
+      if (counts[c] > 0) {
+        means[c] = sums[c] / counts[c];
+      }
+    }
+    if (!changed && iteration > 0) {
+      break;
+    }
+  }
+
+  // Initial parameters from the k-means clusters
+  double total_mean = std::accumulate(sorted.begin(), sorted.end(), 0.0) / n;
+  double total_variance = 0.0;
+  for (const auto& value : sorted) {
+    total_variance += (value - total_mean) * (value - total_mean);
+  }
+  total_variance = std::max(total_variance / n, SUDOKU_MIXTURE_MIN_VARIANCE);
+  mixture.weights.assign(num_components, 0.0);
+  mixture.means = means;
+  mixture.variances.assign(num_components, 0.0);
+  for (size_t i = 0; i < n; ++i) {
+    double delta = sorted[i] - means[labels[i]];
+    mixture.weights[labels[i]] += 1.0;
+    mixture.variances[labels[i]] += delta * delta;
+  }
+  for (size_t c = 0; c < num_components; ++c) {
+    if (mixture.weights[c] > 0.0) {
+      mixture.variances[c] /= mixture.weights[c];
+    } else {
+      mixture.variances[c] = total_variance;
+    }
+    mixture.variances[c] =
+        std::max(mixture.variances[c], SUDOKU_MIXTURE_MIN_VARIANCE);
+    mixture.weights[c] = std::max(mixture.weights[c], 1.0) / n;
+  }
+
+  // Expectation-maximization
+  std::vector<double> responsibilities(n * num_components, 0.0);
+  double previous = -INFINITY;
+  for (size_t iteration = 0; iteration < SUDOKU_MIXTURE_MAX_ITERATION;
+       ++iteration) {
+    double log_likelihood = 0.0;
+    for (size_t i = 0; i < n; ++i) {
+      double* r = &responsibilities[i * num_components];
+      double max_log = -INFINITY;
+      for (size_t c = 0; c < num_components; ++c) {
+        r[c] = mixture.LogDensity(c, sorted[i]);
+        max_log = std::max(max_log, r[c]);
+      }
+      double sum = 0.0;
+      for (size_t c = 0; c < num_components; ++c) {
+        r[c] = std::exp(r[c] - max_log);
+        sum += r[c];
+      }
+      for (size_t c = 0; c < num_components; ++c) {
+        r[c] /= sum;
+      }
+      log_likelihood += max_log + std::log(sum);
+    }
+    mixture.log_likelihood = log_likelihood;
+    if (log_likelihood - previous <
+        SUDOKU_MIXTURE_TOLERANCE * std::fabs(log_likelihood)) {
+      break;
+    }
+    previous = log_likelihood;
+
+    for (size_t c = 0; c < num_components; ++c) {
+      double weight = 0.0, mean = 0.0;
+      for (size_t i = 0; i < n; ++i) {
+        weight += responsibilities[i * num_components + c];
+        mean += responsibilities[i * num_components + c] * sorted[i];
+      }
+      if (weight < 1e-9) {
+        continue;  // keep an empty component where it is
+      }
+      mean /= weight;
+      double variance = 0.0;
+      for (size_t i = 0; i < n; ++i) {
+        double delta = sorted[i] - mean;
+        variance += responsibilities[i * num_components + c] * delta * delta;
+      }
+      mixture.weights[c] = weight / n;
+      mixture.means[c] = mean;
+      mixture.variances[c] =
+          std::max(variance / weight, SUDOKU_MIXTURE_MIN_VARIANCE);
+    }
+  }
+
+  // Sort components by mean
+  std::vector<size_t> order(num_components);
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+    return mixture.means[a] < mixture.means[b];
+  });
+  GaussianMixture sorted_mixture;
+  for (const auto& c : order) {
+    sorted_mixture.weights.push_back(mixture.weights[c]);
+    sorted_mixture.means.push_back(mixture.means[c]);
+    sorted_mixture.variances.push_back(mixture.variances[c]);
+  }
+  sorted_mixture.log_likelihood = mixture.log_likelihood;
+  // weights (k - 1), means (k), and variances (k)
+  double num_parameters = 3.0 * num_components - 1.0;
+  sorted_mixture.bic =
+      -2.0 * mixture.log_likelihood + num_parameters * std::log(n);
+  return sorted_mixture;
+}
+
+GaussianMixture FitGaussianMixtureBIC(const std::vector<double>& values,
+                                      size_t min_components,
+                                      size_t max_components) {
+  GaussianMixture best;
+  for (size_t k = min_components; k <= max_components; ++k) {
+    GaussianMixture mixture = FitGaussianMixture(values, k);
+    if (mixture.NumComponents() == 0) {
+      continue;
+    }
+    if (best.NumComponents() == 0 || mixture.bic < best.bic) {
+      best = mixture;
+    }
+  }
+  return best;
+}
+
+}  // namespace sudoku
@@ -0,0 +1,43 @@
+#ifndef SUDOKU_INTERNAL_MIXTURE_H
+#define SUDOKU_INTERNAL_MIXTURE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace sudoku {
+
+/// @brief One-dimensional Gaussian mixture (components sorted by mean), e.g.,
+/// of per-pair consecutive access latencies with tCCD_S, tCCD_L, and rank
+/// switch populations
+struct GaussianMixture {
+  std::vector<double> weights;
+  std::vector<double> means;
+  std::vector<double> variances;
+  double log_likelihood;
+  double bic;  // Bayesian information criterion (lower is better)
+
+  GaussianMixture() : log_likelihood(0.0), bic(0.0) {}
+
+  size_t NumComponents() const { return means.size(); }
+  // log(weight * density) of component c at value
+  double LogDensity(size_t c, double value) const;
+  // Mean posterior (responsibility) of each component over values, i.e., the
+  // share of values it explains (e.g., of all pairs split by one function).
+  // The joint posterior of a group saturates at 1 within a few values, so it
+  // cannot tell certain from uncertain groups. Empty without values.
+  std::vector<double> MeanPosterior(const std::vector<uint64_t>& values) const;
+};
+
+// EM fit with num_components components, seeded by k-means from quantiles
+// (deterministic); the fit has no components if there are fewer values
+GaussianMixture FitGaussianMixture(const std::vector<double>& values,
+                                   size_t num_components);
+// Fit with the lowest BIC among min_components to max_components components
+GaussianMixture FitGaussianMixtureBIC(const std::vector<double>& values,
+                                      size_t min_components,
+                                      size_t max_components);
+
+}  // namespace sudoku
+
+#endif  // SUDOKU_INTERNAL_MIXTURE_H
@@ -0,0 +1,42 @@
+#include "pipeline.h"
+
+#include <pthread.h>
+#include <sched.h>
+
+#include <thread>
+
+namespace sudoku {
+
+bool PinThread(std::thread::native_handle_type thread, int core) {
+  if (core < 0) {
+    return false;
+  }
+  cpu_set_t cpuset;
+  CPU_ZERO(&cpuset);
+  CPU_SET(core, &cpuset);
+  return pthread_setaffinity_np(thread, sizeof(cpu_set_t), &cpuset) == 0;
+}
+
+int PickHelperCore(int core, int measuring_core) {
+  if (core >= 0 && core != measuring_core) {
+    return core;
+  }
+  if (core >= 0) {
+    PRINT_WARNING("Helper core {} is the measuring core, picking another",
+                  core);
+  }
+  // Allowed cores of the process (e.g., numactl -C {core},{helper})
+  cpu_set_t cpuset;
+  CPU_ZERO(&cpuset);
+  if (sched_getaffinity(0, sizeof(cpu_set_t), &cpuset) != 0) {
+    return -1;
+  }
+  for (int c = 0; c < CPU_SETSIZE; ++c) {
+    if (c != measuring_core && CPU_ISSET(c, &cpuset)) {
+      return c;
+    }
+  }
+  return -1;
+}
+
+}  // namespace sudoku
@@ -0,0 +1,127 @@
+#ifndef SUDOKU_INTERNAL_PIPELINE_H
+#define SUDOKU_INTERNAL_PIPELINE_H
+
+#include <pthread.h>
+#include <sched.h>
+
+#include <cstdint>
+#include <functional>
+#include <thread>
+
+#include "assembly.h"
+#include "constants.h"
+#include "counters.h"
+#include "result_sink.h"
+#include "spsc_ring.h"
+#include "utils.h"
+
+namespace sudoku {
+
+/// @brief Ready-to-measure address pair (translated on the helper thread)
+struct PairJob {
+  uint64_t idx;
+  addr_tuple first;
+  addr_tuple second;
+};
+
+// Results are stored as they are written to binary result files
+using PairResult = ResultRecord;
+
+// Pin a thread to a core; false if the core is not in the allowed set
+bool PinThread(std::thread::native_handle_type thread, int core);
+// Core for the helper thread: the given core or, if negative or the
+// measuring core, the first allowed core other than measuring_core; -1 if
+// there is none
+int PickHelperCore(int core, int measuring_core);
+
+/// @brief Two-stage pipeline overlapping preparation with measurement. A
+/// helper thread on another core produces jobs into one SPSC ring and
+/// consumes results (e.g., logging) from a second ring, while the calling
+/// thread, pinned to its current core, only measures. The calling thread's
+/// affinity is restored afterwards.
+template <typename Job, typename Result>
+class Pipeline {
+ public:
+  using Producer = std::function<void(uint64_t, Job*)>;
+  using Measurement = std::function<void(const Job&, Result*)>;
+  using Consumer = std::function<void(const Result&)>;
+
+  explicit Pipeline(int helper_core) : helper_core_(helper_core) {}
+
+  // Jobs and results keep their order
+  void Run(uint64_t num_jobs, Producer produce, Measurement measure,
+           Consumer consume) {
+    // On the stack: operator new does not honor the cache line alignment
+    // before C++17
+    SpscRing<Job, SUDOKU_PIPELINE_RING_SIZE> jobs;
+    SpscRing<Result, SUDOKU_PIPELINE_RING_SIZE> results;
+
+    cpu_set_t affinity;
+    bool restore = pthread_getaffinity_np(pthread_self(), sizeof(cpu_set_t),
+                                          &affinity) == 0;
+    int measuring_core = sched_getcpu();
+    int helper_core = PickHelperCore(helper_core_, measuring_core);
+    if (!PinThread(pthread_self(), measuring_core)) {
+      PRINT_WARNING("Cannot pin the measuring thread to core {}",
+                    measuring_core);
+    }
+
+    std::thread helper([&]() {
+      Job job;
+      Result result;
+      uint64_t produced = 0, consumed = 0;
+      bool pending = false;
+      while (consumed < num_jobs) {
+        bool idle = true;
+        if (!pending && produced < num_jobs) {
+          produce(produced, &job);
+          pending = true;
+        }
+        if (pending && jobs.TryPush(job)) {
+          produced++;
+          pending = false;
+          idle = false;
+        }
+        while (results.TryPop(&result)) {
+          consume(result);
+          consumed++;
+          idle = false;
+        }
+        if (idle) {
+          cpu_pause();
+        }
+      }
+      FlushCounters();
+    });
+    if (helper_core < 0) {
+      PRINT_WARNING("No core for the helper thread, sharing core {}",
+                    measuring_core);
+    } else if (!PinThread(helper.native_handle(), helper_core)) {
+      PRINT_WARNING("Cannot pin the helper thread to core {}", helper_core);
+    }
+
+    Job job;
+    Result result;
+    for (uint64_t i = 0; i < num_jobs; ++i) {
+      while (!jobs.TryPop(&job)) {
+        cpu_pause();
+      }
+      measure(job, &result);
+      while (!results.TryPush(result)) {
+        cpu_pause();
+      }
+    }
+    helper.join();
+    if (restore && pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t),
+                                          &affinity) != 0) {
+      PRINT_WARNING("Cannot restore the affinity of the measuring thread");
+    }
+  }
+
+ private:
+  int helper_core_;
+};
+
+}  // namespace sudoku
+
+#endif  // SUDOKU_INTERNAL_PIPELINE_H
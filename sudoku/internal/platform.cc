@@ -0,0 +1,315 @@
+#include "platform.h"
+
+#include <cpuid.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#include "utils.h"
+
+namespace sudoku {
+
+namespace {
+
+PlatformProfile MakeProfile(std::string name, std::string vendor,
+                            uint32_t family, std::vector<uint32_t> models,
+                            DDRType type, uint64_t sbdr_lower_bound,
+                            uint64_t sbdr_upper_bound,
+                            uint64_t bank_group_threshold,
+                            uint64_t refresh_cycle_lower_bound,
+                            uint64_t refresh_cycle_upper_bound,
+                            uint64_t regular_refresh_interval_threshold,
+                            uint64_t reduced_refresh_interval_lower_bound,
+                            uint64_t pci_offset_upper_bound,
+                            uint64_t pci_offset_lower_bound,
+                            RefreshOracle refresh_oracle,
+                            std::string reduced_refresh_functions) {
+  PlatformProfile profile;
+  profile.name = name;
+  profile.vendor = vendor;
+  profile.family = family;
+  profile.models = models;
+  profile.type = type;
+  profile.sbdr_lower_bound = sbdr_lower_bound;
+  profile.sbdr_upper_bound = sbdr_upper_bound;
+  profile.bank_group_threshold = bank_group_threshold;
+  profile.refresh_cycle_lower_bound = refresh_cycle_lower_bound;
+  profile.refresh_cycle_upper_bound = refresh_cycle_upper_bound;
+  profile.regular_refresh_interval_threshold =
+      regular_refresh_interval_threshold;
+  profile.reduced_refresh_interval_lower_bound =
+      reduced_refresh_interval_lower_bound;
+  profile.pci_offset_upper_bound = pci_offset_upper_bound;
+  profile.pci_offset_lower_bound = pci_offset_lower_bound;
+  profile.refresh_oracle = refresh_oracle;
+  profile.reduced_refresh_functions = reduced_refresh_functions;
+  return profile;
+}
+
+std::string Trim(const std::string& str) {
+  size_t first = str.find_first_not_of(" \t\r\n");
+  if (first == std::string::npos) {
+    return "";
+  }
+  size_t last = str.find_last_not_of(" \t\r\n");
+  return str.substr(first, last - first + 1);
+}
+
+bool ParseProfileEntry(PlatformProfile& profile, const std::string& key,
+                       const std::string& value) {
+  uint64_t number = strtoull(value.c_str(), nullptr, 0);
+  if (key == "vendor") {
+    profile.vendor = value;
+  } else if (key == "family") {
+    profile.family = static_cast<uint32_t>(number);
+  } else if (key == "models") {
+    std::stringstream ss(value);
+    std::string token;
+    profile.models.clear();
+    while (std::getline(ss, token, ',')) {
+      profile.models.push_back(
+          static_cast<uint32_t>(strtoull(Trim(token).c_str(), nullptr, 0)));
+    }
+  } else if (key == "type") {
+    if (value == "DDR4" || value == "ddr4") {
+      profile.type = DDRType::DDR4;
+    } else if (value == "DDR5" || value == "ddr5") {
+      profile.type = DDRType::DDR5;
+    } else {
+      profile.type = DDRType::UNKNOWN;
+    }
+  } else if (key == "sbdr_lower_bound") {
+    profile.sbdr_lower_bound = number;
+  } else if (key == "sbdr_upper_bound") {
+    profile.sbdr_upper_bound = number;
+  } else if (key == "bank_group_threshold") {
+    profile.bank_group_threshold = number;
+  } else if (key == "refresh_cycle_lower_bound") {
+    profile.refresh_cycle_lower_bound = number;
+  } else if (key == "refresh_cycle_upper_bound") {
+    profile.refresh_cycle_upper_bound = number;
+  } else if (key == "regular_refresh_interval_threshold") {
+    profile.regular_refresh_interval_threshold = number;
+  } else if (key == "reduced_refresh_interval_lower_bound") {
+    profile.reduced_refresh_interval_lower_bound = number;
+  } else if (key == "pci_offset_upper_bound") {
+    profile.pci_offset_upper_bound = number;
+  } else if (key == "pci_offset_lower_bound") {
+    profile.pci_offset_lower_bound = number;
+  } else if (key == "refresh_oracle") {
+    if (value == "fine") {
+      profile.refresh_oracle = RefreshOracle::FINE;
+    } else if (value == "coarse") {
+      profile.refresh_oracle = RefreshOracle::COARSE;
+    } else {
+      return false;
+    }
+  } else if (key == "reduced_refresh_functions") {
+    profile.reduced_refresh_functions = value;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+bool active_profile_set = false;
+PlatformProfile active_profile;
+
+}  // namespace
+
+std::string PlatformProfile::ToString() const {
+  std::ostringstream oss;
+  oss << name << "," << vendor << ",family=0x" << std::hex << family
+      << ",models=";
+  for (const auto& model : models) {
+    oss << "0x" << model << ";";
+  }
+  oss << std::dec << "," << DDRTypeStr[static_cast<int>(type)]
+      << ",sbdr=" << sbdr_lower_bound << "-" << sbdr_upper_bound
+      << ",refresh_cycle=" << refresh_cycle_lower_bound << "-"
+      << refresh_cycle_upper_bound
+      << ",regular_interval=" << regular_refresh_interval_threshold
+      << ",bank_group=" << bank_group_threshold << ",pci=0x" << std::hex
+      << pci_offset_lower_bound << "-0x" << pci_offset_upper_bound << std::dec
+      << ",oracle=" << RefreshOracleStr[static_cast<int>(refresh_oracle)];
+  return oss.str();
+}
+
+const std::vector<PlatformProfile>& GetBuiltinPlatformProfiles() {
+  static const std::vector<PlatformProfile> profiles = {
+      // Intel Core 12th Alder Lake (i9-12900K) with DDR4
+      MakeProfile("alder_lake_ddr4", "GenuineIntel", 0x6, {0x97, 0x9A},
+                  DDRType::DDR4, 450, 600, 400, 500, 1000, 20000, 1000, 0x0,
+                  0x0, RefreshOracle::FINE, "channel, DIMM, and rank"),
+      // Intel Core 12th Alder Lake (i9-12900K) with DDR5
+      MakeProfile("alder_lake_ddr5", "GenuineIntel", 0x6, {0x97, 0x9A},
+                  DDRType::DDR5, 450, 800, 500, 500, 1100, 5000, 1000, 0x0,
+                  0x0, RefreshOracle::COARSE,
+                  "channel, sub-channel, and bank address"),
+      // Intel Core 14th Raptor Lake (i9-14900K) with DDR5
+      MakeProfile("raptor_lake_ddr5", "GenuineIntel", 0x6, {0xB7, 0xBA, 0xBF},
+                  DDRType::DDR5, 450, 800, 500, 500, 1100, 5500, 1000, 0x0,
+                  0x0, RefreshOracle::COARSE,
+                  "channel, sub-channel, and bank address"),
+      // AMD Ryzen 9 7950X (Zen 4, Raphael) with DDR5; no reduced refresh
+      // interval lower bound (only Intel processors miss refreshes)
+      MakeProfile("zen4_ddr5", "AuthenticAMD", 0x19, {0x61}, DDRType::DDR5,
+                  540, 1000, 590, 850, 1100, 12750, 0, 0x100000000,
+                  0xA0000000, RefreshOracle::COARSE,
+                  "sub-channel, DIMM, and rank"),
+      // Simulated DRAM backend (--simulate) with its default timings; never
+      // detected, selected by the binaries in simulation
+      MakeProfile("simulated", "", 0x0, {}, DDRType::UNKNOWN, 450, 600, 450,
+                  500, 2000, 20000, 1000, 0x0, 0x0, RefreshOracle::COARSE,
+                  "channel, DIMM, and rank"),
+  };
+  return profiles;
+}
+
+// Profiles file format (one section per profile, '#' for comments):
+//   [name]
+//   vendor = AuthenticAMD
+//   family = 0x19
+//   models = 0x61,0x74
+//   type = ddr5
+//   sbdr_lower_bound = 540
+//   ...
+//   refresh_oracle = coarse
+// Unspecified keys default to zero; numbers may be decimal or hex.
+bool LoadPlatformProfiles(const std::string& fname,
+                          std::vector<PlatformProfile>& profiles) {
+  std::ifstream ifs(fname);
+  if (!ifs.is_open()) {
+    PRINT_ERROR("Cannot open platform profiles: {}", fname);
+    return false;
+  }
+
+  std::vector<PlatformProfile> loaded;
+  std::string line;
+  uint64_t line_number = 0;
+  while (std::getline(ifs, line)) {
+    line_number++;
+    line = Trim(line.substr(0, line.find('#')));
+    if (line.empty()) {
+      continue;
+    }
+    if (line.front() == '[' && line.back() == ']') {
+      loaded.push_back(PlatformProfile());
+      loaded.back().name = Trim(line.substr(1, line.size() - 2));
+      continue;
+    }
+    size_t pos = line.find('=');
+    if (loaded.empty() || pos == std::string::npos) {
+      PRINT_ERROR("Malformed platform profile at {}:{}", fname, line_number);
+      return false;
+    }
+    std::string key = Trim(line.substr(0, pos));
+    std::string value = Trim(line.substr(pos + 1));
+    if (!ParseProfileEntry(loaded.back(), key, value)) {
+      PRINT_ERROR("Unknown platform profile entry at {}:{}: {}", fname,
+                  line_number, key);
+      return false;
+    }
+  }
+  // Custom profiles take precedence over the built-in profiles
+  profiles.insert(profiles.begin(), loaded.begin(), loaded.end());
+  return true;
+}
+
+bool FindPlatformProfile(const std::vector<PlatformProfile>& profiles,
+                         const std::string& name, PlatformProfile& profile) {
+  for (const auto& candidate : profiles) {
+    if (candidate.name == name) {
+      profile = candidate;
+      return true;
+    }
+  }
+  return false;
+}
+
+void GetProcessorSignature(std::string& vendor, uint32_t& family,
+                           uint32_t& model) {
+  uint32_t eax = 0, ebx = 0, ecx = 0, edx = 0;
+  char name[13] = {0};
+  __get_cpuid(0, &eax, &ebx, &ecx, &edx);
+  std::memcpy(name, &ebx, 4);
+  std::memcpy(name + 4, &edx, 4);
+  std::memcpy(name + 8, &ecx, 4);
+  vendor = std::string(name);
+
+  __get_cpuid(1, &eax, &ebx, &ecx, &edx);
+  uint32_t base_family = (eax >> 8) & 0xF;
+  uint32_t base_model = (eax >> 4) & 0xF;
+  family = base_family;
+  model = base_model;
+  if (base_family == 0xF) {
+    family += (eax >> 20) & 0xFF;
+  }
+  if (base_family == 0x6 || base_family == 0xF) {
+    model |= ((eax >> 16) & 0xF) << 4;
+  }
+}
+
+bool DetectPlatformProfile(const std::vector<PlatformProfile>& profiles,
+                           DDRType type, PlatformProfile& profile) {
+  std::string vendor;
+  uint32_t family = 0, model = 0;
+  GetProcessorSignature(vendor, family, model);
+
+  for (const auto& candidate : profiles) {
+    if (candidate.vendor != vendor || candidate.family != family) {
+      continue;
+    }
+    if (std::find(candidate.models.begin(), candidate.models.end(), model) ==
+        candidate.models.end()) {
+      continue;
+    }
+    if (type != DDRType::UNKNOWN && candidate.type != DDRType::UNKNOWN &&
+        candidate.type != type) {
+      continue;
+    }
+    profile = candidate;
+    return true;
+  }
+  PRINT_WARNING("No platform profile for {} family 0x{:x} model 0x{:x}",
+                vendor, family, model);
+  return false;
+}
+
+void SetPlatformProfile(const PlatformProfile& profile) {
+  active_profile = profile;
+  active_profile_set = true;
+}
+
+const PlatformProfile& GetPlatformProfile() {
+  assert(active_profile_set);
+  return active_profile;
+}
+
+void InitPlatformProfile(const std::string& name, const std::string& fname,
+                         DDRType type) {
+  std::vector<PlatformProfile> profiles = GetBuiltinPlatformProfiles();
+  if (!fname.empty() && !LoadPlatformProfiles(fname, profiles)) {
+    exit(EXIT_FAILURE);
+  }
+
+  PlatformProfile profile;
+  if (!name.empty()) {
+    if (!FindPlatformProfile(profiles, name, profile)) {
+      PRINT_ERROR("Unknown platform profile: {}", name);
+      exit(EXIT_FAILURE);
+    }
+  } else if (!DetectPlatformProfile(profiles, type, profile)) {
+    PRINT_ERROR("Please select a platform profile (--platform) or add one "
+                "for this processor (--profiles).");
+    exit(EXIT_FAILURE);
+  }
+
+  SetPlatformProfile(profile);
+  PRINT_INFO("Platform profile: {}", profile.ToString());
+}
+
+}  // namespace sudoku
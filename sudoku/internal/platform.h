@@ -0,0 +1,100 @@
+#ifndef SUDOKU_INTERNAL_PLATFORM_H
+#define SUDOKU_INTERNAL_PLATFORM_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "config.h"
+
+namespace sudoku {
+
+// Refresh oracles for decomposing functions
+enum class RefreshOracle {
+  COARSE = 0,  // paired accesses, one timing per pair
+  FINE,        // paired accesses, one timing per access
+};
+
+static const std::string RefreshOracleStr[] = {
+    "coarse",
+    "fine",
+};
+
+/// @brief Processor-specific timing thresholds and decomposition rules.
+/// Built-in profiles cover the tested platforms (see README.md), and custom
+/// profiles can be loaded from a file at runtime.
+struct PlatformProfile {
+  std::string name;
+  // CPUID identification (display family/model)
+  std::string vendor;
+  uint32_t family;
+  std::vector<uint32_t> models;
+  DDRType type;  // UNKNOWN matches any DDR type
+
+  // Row buffer conflicts
+  uint64_t sbdr_lower_bound;
+  uint64_t sbdr_upper_bound;
+  // Consecutive accesses
+  uint64_t bank_group_threshold;
+  // Auto-refreshes
+  uint64_t refresh_cycle_lower_bound;
+  uint64_t refresh_cycle_upper_bound;
+  uint64_t regular_refresh_interval_threshold;
+  // Intervals in (lower bound, regular threshold) count as reduced intervals
+  uint64_t reduced_refresh_interval_lower_bound;
+  // PCI address region (refer to ZenHammer, USENIX Security, 2024)
+  uint64_t pci_offset_upper_bound;
+  uint64_t pci_offset_lower_bound;
+
+  // Decomposition rules
+  RefreshOracle refresh_oracle;
+  std::string reduced_refresh_functions;  // roles showing reduced intervals
+
+  PlatformProfile()
+      : name("unknown"),
+        vendor(""),
+        family(0),
+        models(),
+        type(DDRType::UNKNOWN),
+        sbdr_lower_bound(0),
+        sbdr_upper_bound(0),
+        bank_group_threshold(0),
+        refresh_cycle_lower_bound(0),
+        refresh_cycle_upper_bound(0),
+        regular_refresh_interval_threshold(0),
+        reduced_refresh_interval_lower_bound(0),
+        pci_offset_upper_bound(0),
+        pci_offset_lower_bound(0),
+        refresh_oracle(RefreshOracle::COARSE),
+        reduced_refresh_functions("rank") {}
+
+  std::string ToString() const;
+};
+
+// Profile registry
+const std::vector<PlatformProfile>& GetBuiltinPlatformProfiles();
+bool LoadPlatformProfiles(const std::string& fname,
+                          std::vector<PlatformProfile>& profiles);
+bool FindPlatformProfile(const std::vector<PlatformProfile>& profiles,
+                         const std::string& name, PlatformProfile& profile);
+
+// CPUID-based auto selection
+void GetProcessorSignature(std::string& vendor, uint32_t& family,
+                           uint32_t& model);
+bool DetectPlatformProfile(const std::vector<PlatformProfile>& profiles,
+                           DDRType type, PlatformProfile& profile);
+
+// Active profile, selected once in main() (InitPlatformProfile, or
+// InitBackends) before anything is measured; the threshold macros of
+// constants.h read it on the hot paths
+void SetPlatformProfile(const PlatformProfile& profile);
+const PlatformProfile& GetPlatformProfile();
+
+// Select the active profile from a name (built-in or custom), custom profiles
+// file, and DDR type. Empty name means auto-detection. Exits on failure.
+void InitPlatformProfile(const std::string& name, const std::string& fname,
+                         DDRType type);
+
+}  // namespace sudoku
+
+#endif  // SUDOKU_INTERNAL_PLATFORM_H
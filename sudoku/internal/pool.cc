@@ -8,16 +8,57 @@
 #include <iostream>
 #include <random>
 
+#include "backend.h"
+#include "counters.h"
 #include "utils.h"
 
-bool InitMemoryPool(MemoryPool* pool) {
+namespace sudoku {
+
+char* HardwareBackend::MapPage(uint64_t page_size, bool huge) {
   uint32_t map_flag = MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE;
-  if (pool->config->huge) {
+  if (huge) {
     map_flag |= (MAP_HUGETLB | MAP_HUGE_1GB);
   }
+  void* page =
+      mmap(nullptr, page_size, PROT_READ | PROT_WRITE, map_flag, -1, 0);
+  return (page == MAP_FAILED) ? nullptr : static_cast<char*>(page);
+}
+
+void HardwareBackend::UnmapPage(char* page, uint64_t page_size) {
+  munmap(page, page_size);
+}
+
+uint64_t HardwareBackend::VirtToPhys(uint64_t vaddr) {
+  const uint64_t page_size = sysconf(_SC_PAGESIZE);
+  uint64_t paddr = 0;
+  uint64_t offset = (vaddr / page_size) * sizeof(uint64_t);
+
+  int fd = open("/proc/self/pagemap", O_RDONLY);
+  if (fd < 0) {
+    PRINT_ERROR("[-] Cannot open pagemap\n");
+    exit(EXIT_FAILURE);
+  }
+
+  ssize_t read_size = pread(fd, &paddr, sizeof(paddr), offset);
+  close(fd);
+
+  if (read_size != sizeof(uint64_t)) {
+    PRINT_ERROR("[-] Failed to read from pagemap\n");
+    exit(EXIT_FAILURE);
+  }
+
+  assert(paddr & (1ULL << 63));  // page
+  paddr &= 0x7fffffffffffffULL;
+
+  return (paddr * page_size) | (vaddr % page_size);
+}
+
+}  // namespace sudoku
 
+bool InitMemoryPool(MemoryPool* pool) {
   pool->config->pool_size = pool->config->num_pages * pool->config->page_size;
-  pool->gen = std::mt19937(std::random_device{}());
+  pool->gen = std::mt19937(
+      static_cast<uint32_t>(sudoku::GetBackend().RandomSeed()));
   pool->page_dist =
       std::uniform_int_distribution<uint64_t>(0, pool->config->num_pages - 1);
   pool->page_offset =
@@ -26,16 +67,27 @@ bool InitMemoryPool(MemoryPool* pool) {
   pool->pages = new char*[pool->config->num_pages];
 
   for (uint64_t i = 0; i < pool->config->num_pages; ++i) {
-    pool->pages[i] =
-        static_cast<char*>(mmap(nullptr, pool->config->page_size,
-                                PROT_READ | PROT_WRITE, map_flag, -1, 0));
+    pool->pages[i] = sudoku::GetBackend().MapPage(pool->config->page_size,
+                                                  pool->config->huge);
 
-    if (pool->pages[i] == MAP_FAILED) {
+    if (pool->pages[i] == nullptr) {
       PRINT_ERROR("[-] mmap failed\n");
       exit(EXIT_FAILURE);
     }
   }
 
+  // Translate each page once; later lookups of the pool (PhysToVirt, random
+  // tuples) are served from the cache
+  pool->first_paddrs.resize(pool->config->num_pages);
+  pool->last_paddrs.resize(pool->config->num_pages);
+  for (uint64_t i = 0; i < pool->config->num_pages; ++i) {
+    uint64_t mem_start = reinterpret_cast<uint64_t>(pool->pages[i]);
+    uint64_t mem_end =
+        mem_start + pool->config->page_size - pool->config->granularity;
+    pool->first_paddrs[i] = VirtToPhys(mem_start);
+    pool->last_paddrs[i] = VirtToPhys(mem_end);
+  }
+
   return true;
 }
 
@@ -45,10 +97,12 @@ bool FreeMemoryPool(MemoryPool* pool) {
   }
 
   for (uint64_t i = 0; i < pool->config->num_pages; ++i) {
-    munmap(pool->pages[i], pool->config->page_size);
+    sudoku::GetBackend().UnmapPage(pool->pages[i], pool->config->page_size);
   }
   delete[] pool->pages;
   pool->pages = nullptr;
+  pool->first_paddrs.clear();
+  pool->last_paddrs.clear();
 
   return true;
 }
@@ -62,31 +116,12 @@ bool UpdateMemoryPool(MemoryPool* pool, MemoryPoolConfig* cfg) {
 }
 
 uint64_t VirtToPhys(uint64_t vaddr) {
-  const uint64_t page_size = sysconf(_SC_PAGESIZE);
-  uint64_t paddr = 0;
-  uint64_t offset = (vaddr / page_size) * sizeof(uint64_t);
-
-  int fd = open("/proc/self/pagemap", O_RDONLY);
-  if (fd < 0) {
-    PRINT_ERROR("[-] Cannot open pagemap\n");
-    exit(EXIT_FAILURE);
-  }
-
-  ssize_t read_size = pread(fd, &paddr, sizeof(paddr), offset);
-  close(fd);
-
-  if (read_size != sizeof(uint64_t)) {
-    PRINT_ERROR("[-] Failed to read from pagemap\n");
-    exit(EXIT_FAILURE);
-  }
-
-  assert(paddr & (1ULL << 63));  // page
-  paddr &= 0x7fffffffffffffULL;
-
-  return (paddr * page_size) | (vaddr % page_size);
+  sudoku::Count(sudoku::Counter::VIRT_TO_PHYS);
+  return sudoku::GetBackend().VirtToPhys(vaddr);
 }
 
 uint64_t PhysToVirt(MemoryPool* pool, uint64_t paddr) {
+  sudoku::Count(sudoku::Counter::PHYS_TO_VIRT);
   if (!pool || !pool->pages) {
     return 0;
   }
@@ -96,8 +131,8 @@ uint64_t PhysToVirt(MemoryPool* pool, uint64_t paddr) {
     uint64_t mem_end =
         mem_start + pool->config->page_size - pool->config->granularity;
 
-    uint64_t mem_start_p = VirtToPhys(mem_start);
-    uint64_t mem_end_p = VirtToPhys(mem_end);
+    uint64_t mem_start_p = pool->first_paddrs[i];
+    uint64_t mem_end_p = pool->last_paddrs[i];
 
     if (mem_start_p <= paddr && paddr <= mem_end_p) {
       return mem_start + (paddr - mem_start_p);
@@ -108,5 +143,14 @@ uint64_t PhysToVirt(MemoryPool* pool, uint64_t paddr) {
     }
   }
 
+  sudoku::Count(sudoku::Counter::PHYS_TO_VIRT_MISSES);
   return 0;  // not found
-}
\ No newline at end of file
+}
+
+uint64_t PoolVirtToPhys(MemoryPool* pool, uint64_t page_num, uint64_t vaddr) {
+  if (!pool->config->huge) {
+    return VirtToPhys(vaddr);
+  }
+  return pool->first_paddrs[page_num] +
+         (vaddr - reinterpret_cast<uint64_t>(pool->pages[page_num]));
+}
@@ -6,6 +6,7 @@
 #include <cstdint>
 #include <iostream>
 #include <random>
+#include <vector>
 
 constexpr uint64_t MAP_HUGE_1GB =
     (30ULL << MAP_HUGE_SHIFT);  // we only use this
@@ -43,6 +44,11 @@ struct MemoryPool {
   std::uniform_int_distribution<uint64_t> page_dist;
   std::uniform_int_distribution<uint64_t> page_offset;
 
+  // Translation cache: physical addresses of the first and last granule of
+  // each page, looked up once when the pool is initialized
+  std::vector<uint64_t> first_paddrs;
+  std::vector<uint64_t> last_paddrs;
+
   MemoryPool() : config(new MemoryPoolConfig()) {}
 
   MemoryPool(uint64_t p, uint64_t n, uint64_t g, bool h)
@@ -57,5 +63,8 @@ bool UpdateMemoryPool(MemoryPool* pool, MemoryPoolConfig* cfg);
 
 uint64_t VirtToPhys(uint64_t vaddr);
 uint64_t PhysToVirt(MemoryPool* pool, uint64_t paddr);
+// Physical address of vaddr in page page_num of the pool, from the
+// translation cache for (physically contiguous) huge pages
+uint64_t PoolVirtToPhys(MemoryPool* pool, uint64_t page_num, uint64_t vaddr);
 
 #endif  // SUDOKU_INTERNAL_POOL_H
\ No newline at end of file
@@ -0,0 +1,155 @@
+#include "refresh_detector.h"
+
+#include <cstdint>
+
+#include "constants.h"
+#include "refreshes.h"
+#include "utils.h"
+
+namespace sudoku {
+
+RefreshDetector::RefreshDetector(uint64_t threshold)
+    : threshold_(threshold),
+      ring_(AllocateHistogram(SUDOKU_REFRESH_NUM_ITERATION, 3)) {
+  Reset();
+}
+
+RefreshDetector::~RefreshDetector() {
+  FreeHistogram(ring_, SUDOKU_REFRESH_NUM_ITERATION);
+}
+
+void RefreshDetector::Consume(uint64_t num_cols, EventCallback callback) {
+  if (num_cols != 2 && num_cols != 3) {
+    PRINT_ERROR("Unsupported num_cols: {}", num_cols);
+    return;
+  }
+  Break();
+  for (size_t i = 0; i < SUDOKU_REFRESH_NUM_ITERATION; ++i) {
+    // Same timestamps as FilterRefreshTiming
+    uint64_t timestamp = ring_[i][0];
+    uint64_t latency = ring_[i][1];
+    if (num_cols == 3) {
+      timestamp += ring_[i][1];
+      latency = ring_[i][2];
+    }
+    uint64_t previous = last_event_;
+    bool had_last_event = has_last_event_;
+    if (Push(timestamp, latency) && callback) {
+      callback(timestamp - origin_,
+               had_last_event ? timestamp - previous : 0);
+    }
+  }
+}
+
+bool RefreshDetector::Push(uint64_t timestamp, uint64_t latency) {
+  if (num_samples_ == 0) {
+    origin_ = timestamp;
+  }
+  num_samples_++;
+
+  if (latency <= threshold_) {
+    in_spike_ = false;
+    return false;
+  }
+  // Back-to-back slow samples belong to the same refresh
+  if (in_spike_) {
+    return false;
+  }
+  in_spike_ = true;
+  num_events_++;
+  if (has_last_event_) {
+    intervals_.Add(timestamp - last_event_);
+  }
+  last_event_ = timestamp;
+  has_last_event_ = true;
+  return true;
+}
+
+void RefreshDetector::Break() {
+  has_last_event_ = false;
+  in_spike_ = false;
+}
+
+void RefreshDetector::Reset() {
+  num_samples_ = 0;
+  num_events_ = 0;
+  origin_ = 0;
+  last_event_ = 0;
+  has_last_event_ = false;
+  in_spike_ = false;
+  intervals_.Reset();
+}
+
+bool RefreshDetector::Converged(uint64_t min_intervals,
+                                double relative_error) const {
+  if (intervals_.count < min_intervals) {
+    return false;
+  }
+  return intervals_.ConfidenceHalfWidth() <= relative_error * intervals_.mean;
+}
+
+void StreamRefreshSingleAccess(uint64_t addr, RefreshDetector& detector) {
+  MeasureRefreshSingleAccess(addr, detector.Ring());
+  detector.Consume(2);
+}
+
+void StreamRefreshPairedAccessCoarse(uint64_t faddr, uint64_t saddr,
+                                     RefreshDetector& detector) {
+  MeasureRefreshPairedAccessCoarse(faddr, saddr, detector.Ring());
+  detector.Consume(2);
+}
+
+void StreamRefreshPairedAccessFine(uint64_t faddr, uint64_t saddr,
+                                   RefreshDetector& detector) {
+  MeasureRefreshPairedAccessFine(faddr, saddr, detector.Ring());
+  detector.Consume(3);
+}
+
+uint64_t StatStableRefreshIntervalSingleAccess(uint64_t addr,
+                                               uint64_t threshold,
+                                               uint64_t* results) {
+  RefreshDetector detector(threshold);
+  for (size_t i = 0; i < SUDOKU_REFRESH_STREAM_MAX_RINGS; ++i) {
+    StreamRefreshSingleAccess(addr, detector);
+    if (detector.Converged(SUDOKU_REFRESH_STREAM_MIN_INTERVALS,
+                           SUDOKU_REFRESH_STREAM_RELATIVE_ERROR)) {
+      break;
+    }
+  }
+  detector.Intervals().GetStatistics(results);
+  return detector.Intervals().count;
+}
+
+uint64_t StatStableRefreshIntervalPairedAccessCoarse(uint64_t faddr,
+                                                     uint64_t saddr,
+                                                     uint64_t threshold,
+                                                     uint64_t* results) {
+  RefreshDetector detector(threshold);
+  for (size_t i = 0; i < SUDOKU_REFRESH_STREAM_MAX_RINGS; ++i) {
+    StreamRefreshPairedAccessCoarse(faddr, saddr, detector);
+    if (detector.Converged(SUDOKU_REFRESH_STREAM_MIN_INTERVALS,
+                           SUDOKU_REFRESH_STREAM_RELATIVE_ERROR)) {
+      break;
+    }
+  }
+  detector.Intervals().GetStatistics(results);
+  return detector.Intervals().count;
+}
+
+uint64_t StatStableRefreshIntervalPairedAccessFine(uint64_t faddr,
+                                                   uint64_t saddr,
+                                                   uint64_t threshold,
+                                                   uint64_t* results) {
+  RefreshDetector detector(threshold);
+  for (size_t i = 0; i < SUDOKU_REFRESH_STREAM_MAX_RINGS; ++i) {
+    StreamRefreshPairedAccessFine(faddr, saddr, detector);
+    if (detector.Converged(SUDOKU_REFRESH_STREAM_MIN_INTERVALS,
+                           SUDOKU_REFRESH_STREAM_RELATIVE_ERROR)) {
+      break;
+    }
+  }
+  detector.Intervals().GetStatistics(results);
+  return detector.Intervals().count;
+}
+
+}  // namespace sudoku
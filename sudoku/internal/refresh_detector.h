@@ -0,0 +1,80 @@
+#ifndef SUDOKU_INTERNAL_REFRESH_DETECTOR_H
+#define SUDOKU_INTERNAL_REFRESH_DETECTOR_H
+
+#include <cstdint>
+#include <functional>
+
+#include "utils.h"
+
+namespace sudoku {
+
+/// @brief Online refresh detector for long watches. Measurement kernels fill
+/// a fixed ring of SUDOKU_REFRESH_NUM_ITERATION samples, and the detector
+/// consumes it into refresh events and running interval statistics, so memory
+/// does not grow with the length of a watch.
+class RefreshDetector {
+ public:
+  // (timestamp relative to the first sample, interval or 0 for the first)
+  using EventCallback = std::function<void(uint64_t, uint64_t)>;
+
+  explicit RefreshDetector(uint64_t threshold);
+  ~RefreshDetector();
+
+  // Ring for MeasureRefresh* kernels (2 or 3 columns)
+  uint64_t** Ring() { return ring_; }
+  // Consume a filled ring; intervals never span two rings since refreshes
+  // may be missed while the previous ring is processed
+  void Consume(uint64_t num_cols, EventCallback callback = nullptr);
+  // Single sample; true if it starts a new refresh event
+  bool Push(uint64_t timestamp, uint64_t latency);
+  // Drop the last event so that the next interval starts fresh
+  void Break();
+  void Reset();
+
+  // Stable once enough intervals are observed and the 95% confidence
+  // interval of the mean is within relative_error of the mean
+  bool Converged(uint64_t min_intervals, double relative_error) const;
+
+  // TSC of the first sample; event timestamps are relative to it
+  uint64_t Origin() const { return origin_; }
+  uint64_t NumSamples() const { return num_samples_; }
+  uint64_t NumEvents() const { return num_events_; }
+  const RunningStatistics& Intervals() const { return intervals_; }
+
+ private:
+  uint64_t threshold_;
+  uint64_t** ring_;
+
+  uint64_t num_samples_;
+  uint64_t num_events_;
+  uint64_t origin_;
+  uint64_t last_event_;
+  bool has_last_event_;
+  bool in_spike_;
+  RunningStatistics intervals_;
+};
+
+// Measure a ring of samples and feed them into the detector
+void StreamRefreshSingleAccess(uint64_t addr, RefreshDetector& detector);
+void StreamRefreshPairedAccessCoarse(uint64_t faddr, uint64_t saddr,
+                                     RefreshDetector& detector);
+void StreamRefreshPairedAccessFine(uint64_t faddr, uint64_t saddr,
+                                   RefreshDetector& detector);
+
+// Interval statistics (avg,med,min,max) measured until they stabilize or
+// SUDOKU_REFRESH_STREAM_MAX_RINGS rings; returns the number of intervals
+uint64_t StatStableRefreshIntervalSingleAccess(uint64_t addr,
+                                               uint64_t threshold,
+                                               uint64_t* results);
+uint64_t StatStableRefreshIntervalPairedAccessCoarse(uint64_t faddr,
+                                                     uint64_t saddr,
+                                                     uint64_t threshold,
+                                                     uint64_t* results);
+uint64_t StatStableRefreshIntervalPairedAccessFine(uint64_t faddr,
+                                                   uint64_t saddr,
+                                                   uint64_t threshold,
+                                                   uint64_t* results);
+
+}  // namespace sudoku
+
+#endif  // SUDOKU_INTERNAL_REFRESH_DETECTOR_H
@@ -0,0 +1,141 @@
+#include "refresh_scheduler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "constants.h"
+#include "refresh_detector.h"
+#include "refreshes.h"
+#include "utils.h"
+
+namespace sudoku {
+
+RefreshScheduler::RefreshScheduler()
+    : locked_(false),
+      period_(0.0),
+      locked_at_(0),
+      relock_cycles_(0),
+      guard_(SUDOKU_REFRESH_GUARD_CYCLES),
+      quiet_start_(0.0) {}
+
+bool RefreshScheduler::Lock(uint64_t addr) { return LockPhases({addr}); }
+
+bool RefreshScheduler::Lock(uint64_t faddr, uint64_t saddr) {
+  return LockPhases({faddr, saddr});
+}
+
+bool RefreshScheduler::LockPhases(const std::vector<uint64_t>& addrs) {
+  addrs_ = addrs;
+  anchors_.clear();
+  locked_ = false;
+  quiet_start_ = REFRESH_CYCLE_UPPER_BOUND + guard_;
+
+  for (const auto& addr : addrs) {
+    // Event timestamps relative to the first sample across all rings; the
+    // gaps between rings only drop events
+    RefreshDetector detector(REFRESH_CYCLE_LOWER_BOUND);
+    std::vector<uint64_t> refreshes;
+    for (size_t i = 0; i < SUDOKU_REFRESH_LOCK_RINGS; ++i) {
+      MeasureRefreshSingleAccess(addr, detector.Ring());
+      detector.Consume(2, [&](uint64_t timestamp, uint64_t) {
+        refreshes.push_back(timestamp);
+      });
+    }
+
+    double coherence = 0.0;
+    double period = EstimateRefreshInterval(refreshes, &coherence);
+    if (period == 0.0 || coherence < SUDOKU_REFRESH_MIN_COHERENCE) {
+      return false;
+    }
+    double anchor = 0.0;
+    if (!FitRefreshPhase(refreshes, &period, &anchor)) {
+      return false;
+    }
+    uint64_t refresh = detector.Origin() + static_cast<uint64_t>(anchor);
+
+    // All ranks share the refresh period; an address of an already locked
+    // rank adds no phase
+    if (anchors_.empty()) {
+      period_ = period;
+    }
+    bool locked_rank = false;
+    for (const auto& other : anchors_) {
+      double offset = std::fmod(
+          std::fabs(static_cast<double>(refresh) - static_cast<double>(other)),
+          period_);
+      if (std::min(offset, period_ - offset) < quiet_start_) {
+        locked_rank = true;
+        break;
+      }
+    }
+    if (!locked_rank) {
+      anchors_.push_back(refresh);
+    }
+  }
+
+  locked_at_ = GetBackend().Timestamp();
+  relock_cycles_ =
+      static_cast<uint64_t>(period_ * SUDOKU_REFRESH_RELOCK_PERIODS);
+  locked_ = true;
+  return true;
+}
+
+void RefreshScheduler::Relock() {
+  if (!LockPhases(addrs_)) {
+    PRINT_WARNING("Lost the refresh phase lock on {}, measuring unscheduled",
+                  reinterpret_cast<void*>(addrs_[0]));
+  }
+}
+
+bool FitRefreshPhase(const std::vector<uint64_t>& refreshes, double* period,
+                     double* anchor) {
+  if (refreshes.size() < SUDOKU_REFRESH_SPECTRAL_MIN_EVENTS || *period <= 0.0) {
+    return false;
+  }
+
+  // Initial phase from the circular mean at the estimated period
+  double real = 0.0, imag = 0.0;
+  for (const auto& refresh : refreshes) {
+    double phase = 2.0 * M_PI * std::fmod(static_cast<double>(refresh),
+                                          *period) /
+                   *period;
+    real += std::cos(phase);
+    imag += std::sin(phase);
+  }
+  double phase = std::atan2(imag, real);
+  if (phase < 0.0) {
+    phase += 2.0 * M_PI;
+  }
+  double origin = phase / (2.0 * M_PI) * *period;
+
+  // Least-squares fit of timestamp = anchor + k * period over the events
+  // within 1/8 period of the grid
+  double sum_k = 0.0, sum_t = 0.0, sum_kk = 0.0, sum_kt = 0.0, n = 0.0;
+  for (const auto& refresh : refreshes) {
+    double t = static_cast<double>(refresh) - origin;
+    double k = std::round(t / *period);
+    if (std::fabs(t - k * *period) > *period / 8.0) {
+      continue;
+    }
+    sum_k += k;
+    sum_t += t;
+    sum_kk += k * k;
+    sum_kt += k * t;
+    n += 1.0;
+  }
+  double denominator = n * sum_kk - sum_k * sum_k;
+  if (n < SUDOKU_REFRESH_SPECTRAL_MIN_EVENTS || denominator <= 0.0) {
+    return false;
+  }
+  *period = (n * sum_kt - sum_k * sum_t) / denominator;
+  *anchor = origin + (sum_t - *period * sum_k) / n;
+  // Keep the anchor non-negative (relative to the first sample)
+  while (*anchor < 0.0) {
+    *anchor += *period;
+  }
+  return true;
+}
+
+}  // namespace sudoku
@@ -0,0 +1,91 @@
+#ifndef SUDOKU_INTERNAL_REFRESH_SCHEDULER_H
+#define SUDOKU_INTERNAL_REFRESH_SCHEDULER_H
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "backend.h"
+
+namespace sudoku {
+
+/// @brief Refresh-phase-aware scheduler for timing measurements. Lock() finds
+/// the refresh period and phases of the ranks of the measured addresses, and
+/// Wait() delays each timed access until it fits in the quiet window between
+/// two refreshes of every locked rank.
+class RefreshScheduler {
+ public:
+  RefreshScheduler();
+
+  // Lock onto the refreshes observed on addr (SUDOKU_REFRESH_LOCK_RINGS rings
+  // of single accesses); false if no coherent refresh period is found
+  bool Lock(uint64_t addr);
+  // Lock onto the refreshes of both addresses of a pair, which may lie in
+  // different ranks refreshing at different phases; false if either has no
+  // coherent refresh period
+  bool Lock(uint64_t faddr, uint64_t saddr);
+  bool Locked() const { return locked_; }
+  double Period() const { return period_; }
+  // Number of distinct refresh phases (ranks) avoided
+  size_t NumPhases() const { return anchors_.size(); }
+
+  // Re-lock the phases after SUDOKU_REFRESH_RELOCK_PERIODS periods since the
+  // period error accumulates. Call between samples, before the measured
+  // addresses are flushed: the re-lock accesses the locked addresses.
+  inline __attribute__((always_inline)) void Maintain() {
+    if (locked_ && GetBackend().Timestamp() - locked_at_ > relock_cycles_) {
+      Relock();
+    }
+  }
+
+  // Spin until a measurement of up to burst_cycles ends before the next
+  // refresh of every locked rank
+  inline __attribute__((always_inline)) void Wait(uint64_t burst_cycles) {
+    if (!locked_) {
+      return;
+    }
+    double quiet_end = period_ - guard_ - burst_cycles;
+    if (quiet_end <= quiet_start_) {
+      return;
+    }
+    for (;;) {
+      uint64_t now = GetBackend().Timestamp();
+      bool quiet = true;
+      for (const auto& anchor : anchors_) {
+        double phase = std::fmod(static_cast<double>(now - anchor), period_);
+        if (phase <= quiet_start_ || phase >= quiet_end) {
+          quiet = false;
+          break;
+        }
+      }
+      if (quiet) {
+        return;
+      }
+    }
+  }
+
+ private:
+  // Lock onto the refresh phases of addrs (one per rank)
+  bool LockPhases(const std::vector<uint64_t>& addrs);
+  // Lock again; warns if the lock is lost
+  void Relock();
+
+  bool locked_;
+  std::vector<uint64_t> addrs_;
+  double period_;
+  std::vector<uint64_t> anchors_;  // a refresh timestamp per locked rank
+  uint64_t locked_at_;
+  uint64_t relock_cycles_;
+  double guard_;
+  double quiet_start_;  // refresh duration plus guard
+};
+
+// Fit refresh timestamps to anchor + k * period around an initial period
+// estimate; spikes off the period grid (interrupts) are excluded. Returns
+// false if fewer than SUDOKU_REFRESH_SPECTRAL_MIN_EVENTS events fit.
+bool FitRefreshPhase(const std::vector<uint64_t>& refreshes, double* period,
+                     double* anchor);
+
+}  // namespace sudoku
+
+#endif  // SUDOKU_INTERNAL_REFRESH_SCHEDULER_H
@@ -1,10 +1,12 @@
 #include "refreshes.h"
 
 #include <algorithm>
+#include <cmath>
 #include <cstdint>
 
-#include "assembly.h"
+#include "backend.h"
 #include "constants.h"
+#include "counters.h"
 #include "utils.h"
 
 namespace sudoku {
@@ -25,7 +27,7 @@ void FilterRefreshTiming(uint64_t** histogram, uint64_t num_cols,
       }
     }
   } else {
-    PRINT_ERROR("Unsupported num_cols: ", num_cols);
+    PRINT_ERROR("Unsupported num_cols: {}", num_cols);
   }
 }
 
@@ -45,18 +47,124 @@ std::vector<uint64_t> ComputeRefreshIntervals(
   return intervals;
 }
 
-void MeasureRefreshSingleAccess(uint64_t addr, uint64_t** histogram) {
-  for (size_t i = 0; i < SUDOKU_REFRESH_NUM_ITERATION; ++i) {
-    clflushopt(reinterpret_cast<void*>(addr));
-    mfence();
-    histogram[i][0] = rdtscp();
-    *(volatile char*)addr;
-    lfence();
-    histogram[i][1] = rdtscp();
+double RefreshPhaseCoherence(const std::vector<uint64_t>& refreshes,
+                             double period) {
+  if (refreshes.empty() || period <= 0.0) {
+    return 0.0;
+  }
+  double real = 0.0, imag = 0.0;
+  for (const auto& refresh : refreshes) {
+    double phase = 2.0 * M_PI *
+                   std::fmod(static_cast<double>(refresh - refreshes[0]),
+                             period) /
+                   period;
+    real += std::cos(phase);
+    imag += std::sin(phase);
+  }
+  return std::sqrt(real * real + imag * imag) / refreshes.size();
+}
+
+double RefreshPhase(const std::vector<uint64_t>& refreshes, double period) {
+  if (refreshes.empty() || period <= 0.0) {
+    return 0.0;
+  }
+  double real = 0.0, imag = 0.0;
+  for (const auto& refresh : refreshes) {
+    double phase = 2.0 * M_PI *
+                   std::fmod(static_cast<double>(refresh), period) / period;
+    real += std::cos(phase);
+    imag += std::sin(phase);
   }
-  for (size_t i = 0; i < SUDOKU_REFRESH_NUM_ITERATION; ++i) {
-    histogram[i][1] -= histogram[i][0];
+  double phase = std::atan2(imag, real);
+  if (phase < 0.0) {
+    phase += 2.0 * M_PI;
   }
+  return phase / (2.0 * M_PI) * period;
+}
+
+uint64_t EstimateRefreshPeriod(const std::vector<uint64_t>& refreshes,
+                               uint64_t min_period, uint64_t max_period,
+                               double* coherence) {
+  *coherence = 0.0;
+  if (refreshes.size() < SUDOKU_REFRESH_SPECTRAL_MIN_EVENTS ||
+      min_period == 0 || min_period >= max_period) {
+    return 0;
+  }
+  double window = static_cast<double>(refreshes.back() - refreshes.front());
+  if (window <= 0.0) {
+    return 0;
+  }
+
+  // A period step of P^2 / (16 * window) keeps the phase drift across the
+  // window under 1/16 of a cycle, so no peak falls between grid points.
+  uint64_t period = 0;
+  for (double p = min_period; p < max_period;
+       p += std::max(1.0, p * p / (16.0 * window))) {
+    double r = RefreshPhaseCoherence(refreshes, p);
+    if (r > *coherence) {
+      *coherence = r;
+      period = static_cast<uint64_t>(p);
+    }
+  }
+  return period;
+}
+
+uint64_t EstimateRefreshInterval(const std::vector<uint64_t>& refreshes,
+                                 double* coherence) {
+  // tREFI lies in (threshold, 2 * threshold) and tREFI/2 in
+  // (threshold / 2, threshold). A train is also coherent at every integer
+  // fraction of its period, so tREFI/2 is taken only when tREFI is not.
+  uint64_t threshold = REGULAR_REFRESH_INTERVAL_THRESHOLD;
+  uint64_t interval =
+      EstimateRefreshPeriod(refreshes, threshold, threshold * 2, coherence);
+  if (*coherence >= SUDOKU_REFRESH_MIN_COHERENCE) {
+    return interval;
+  }
+  double regular_coherence = *coherence;
+  uint64_t reduced_interval = EstimateRefreshPeriod(
+      refreshes,
+      std::max(REDUCED_REFRESH_INTERVAL_LOWER_BOUND + 1, threshold / 2),
+      threshold, coherence);
+  if (*coherence < regular_coherence) {
+    *coherence = regular_coherence;
+    return interval;
+  }
+  return reduced_interval;
+}
+
+std::vector<uint64_t> GenerateSyntheticRefreshes(
+    uint64_t period, uint64_t sample_cycles, uint64_t num_samples,
+    double jitter, double miss_rate, double spurious_rate, std::mt19937& gen) {
+  std::uniform_real_distribution<double> uniform(0.0, 1.0);
+  std::normal_distribution<double> noise(0.0, jitter);
+  uint64_t window = sample_cycles * num_samples;
+  std::vector<uint64_t> refreshes;
+
+  // Refreshes are seen by the first sample after they start
+  double start = uniform(gen) * period;
+  for (double t = start; t < window; t += period) {
+    if (uniform(gen) < miss_rate) {
+      continue;
+    }
+    double observed = std::max(0.0, t + noise(gen));
+    refreshes.push_back(static_cast<uint64_t>(observed / sample_cycles) *
+                        sample_cycles);
+  }
+  // Spurious spikes (e.g., interrupts) on random samples
+  for (uint64_t i = 0; i < num_samples; ++i) {
+    if (uniform(gen) < spurious_rate) {
+      refreshes.push_back(i * sample_cycles);
+    }
+  }
+  std::sort(refreshes.begin(), refreshes.end());
+  refreshes.erase(std::unique(refreshes.begin(), refreshes.end()),
+                  refreshes.end());
+  return refreshes;
+}
+
+void MeasureRefreshSingleAccess(uint64_t addr, uint64_t** histogram) {
+  Count(Counter::REFRESH_CAPTURES);
+  GetBackend().MeasureRefreshSingleAccess(addr, histogram);
 }
 
 uint64_t MedianRefreshIntervalSingleAccess(uint64_t addr, uint64_t threshold) {
@@ -95,19 +203,8 @@ void StatRefreshIntervalSingleAccess(uint64_t addr, uint64_t threshold,
 
 void MeasureRefreshPairedAccessCoarse(uint64_t faddr, uint64_t saddr,
                                       uint64_t** histogram) {
-  for (size_t i = 0; i < SUDOKU_REFRESH_NUM_ITERATION; ++i) {
-    clflushopt(reinterpret_cast<void*>(faddr));
-    clflushopt(reinterpret_cast<void*>(saddr));
-    mfence();
-    histogram[i][0] = rdtscp();
-    *(volatile char*)faddr;
-    *(volatile char*)saddr;
-    lfence();
-    histogram[i][1] = rdtscp();
-  }
-  for (size_t i = 0; i < SUDOKU_REFRESH_NUM_ITERATION; ++i) {
-    histogram[i][1] -= histogram[i][0];
-  }
+  Count(Counter::REFRESH_CAPTURES);
+  GetBackend().MeasureRefreshPairedAccessCoarse(faddr, saddr, histogram);
 }
 
 uint64_t MedianRefreshIntervalPairedAccessCoarse(uint64_t faddr, uint64_t saddr,
@@ -148,29 +245,27 @@ void StatRefreshIntervalPairedAccessCoarse(uint64_t faddr, uint64_t saddr,
   FreeHistogram(histogram, SUDOKU_REFRESH_NUM_ITERATION);
 }
 
+uint64_t SpectralRefreshIntervalPairedAccessCoarse(uint64_t faddr,
+                                                   uint64_t saddr,
+                                                   uint64_t threshold,
+                                                   double* coherence) {
+  uint64_t** histogram = AllocateHistogram(SUDOKU_REFRESH_NUM_ITERATION, 2);
+  MeasureRefreshPairedAccessCoarse(faddr, saddr, histogram);
+  // Filter refresh timings and estimate the dominant period
+  std::vector<uint64_t> refreshes;
+  FilterRefreshTiming(histogram, 2, threshold, refreshes);
+  FreeHistogram(histogram, SUDOKU_REFRESH_NUM_ITERATION);
+  return EstimateRefreshInterval(refreshes, coherence);
+}
+
 void MeasureRefreshPairedAccessFine(uint64_t faddr, uint64_t saddr,
                                     uint64_t** histogram) {
-  for (size_t i = 0; i < SUDOKU_REFRESH_NUM_ITERATION; ++i) {
-    clflushopt(reinterpret_cast<void*>(faddr));
-    clflushopt(reinterpret_cast<void*>(saddr));
-    mfence();
-    histogram[i][0] = rdtscp();
-    *(volatile char*)faddr;
-    lfence();
-    histogram[i][1] = rdtscp();
-    *(volatile char*)saddr;
-    lfence();
-    histogram[i][2] = rdtscp();
-  }
-  for (size_t i = 0; i < SUDOKU_REFRESH_NUM_ITERATION; ++i) {
-    histogram[i][2] -= histogram[i][1];
-    histogram[i][1] -= histogram[i][0];
-  }
-}
-
-uint64_t MedianFineRefreshIntervalPairedMemoryAccess(uint64_t faddr,
-                                                     uint64_t saddr,
-                                                     uint64_t threshold) {
+  Count(Counter::REFRESH_CAPTURES);
+  GetBackend().MeasureRefreshPairedAccessFine(faddr, saddr, histogram);
+}
+
+uint64_t MedianRefreshIntervalPairedAccessFine(uint64_t faddr, uint64_t saddr,
+                                               uint64_t threshold) {
   uint64_t** histogram = AllocateHistogram(SUDOKU_REFRESH_NUM_ITERATION, 3);
   MeasureRefreshPairedAccessFine(faddr, saddr, histogram);
   // Filter refresh timings and compute intervals
@@ -183,8 +278,8 @@ uint64_t MedianFineRefreshIntervalPairedMemoryAccess(uint64_t faddr,
 
 uint64_t AverageRefreshIntervalPairedAccessFine(uint64_t faddr, uint64_t saddr,
                                                 uint64_t threshold) {
-  uint64_t** histogram = AllocateHistogram(SUDOKU_REFRESH_NUM_ITERATION, 2);
-  MeasureRefreshPairedAccessCoarse(faddr, saddr, histogram);
+  uint64_t** histogram = AllocateHistogram(SUDOKU_REFRESH_NUM_ITERATION, 3);
+  MeasureRefreshPairedAccessFine(faddr, saddr, histogram);
   // Filter refresh timings and compute intervals
   std::vector<uint64_t> refreshes;
   FilterRefreshTiming(histogram, 3, threshold, refreshes);
@@ -206,4 +301,40 @@ void StatRefreshIntervalPairedAccessFine(uint64_t faddr, uint64_t saddr,
   FreeHistogram(histogram, SUDOKU_REFRESH_NUM_ITERATION);
 }
 
+uint64_t SpectralRefreshIntervalPairedAccessFine(uint64_t faddr,
+                                                 uint64_t saddr,
+                                                 uint64_t threshold,
+                                                 double* coherence) {
+  uint64_t** histogram = AllocateHistogram(SUDOKU_REFRESH_NUM_ITERATION, 3);
+  MeasureRefreshPairedAccessFine(faddr, saddr, histogram);
+  // Filter refresh timings and estimate the dominant period
+  std::vector<uint64_t> refreshes;
+  FilterRefreshTiming(histogram, 3, threshold, refreshes);
+  FreeHistogram(histogram, SUDOKU_REFRESH_NUM_ITERATION);
+  return EstimateRefreshInterval(refreshes, coherence);
+}
+
+void MeasureRefreshMultiAccess(const uint64_t* addrs, size_t num_addrs,
+                               uint64_t num_iterations, uint64_t** histogram) {
+  Count(Counter::REFRESH_CAPTURES);
+  GetBackend().MeasureRefreshMultiAccess(
+      addrs, num_addrs, num_iterations, histogram);
+}
+
+void FilterRefreshTimingMultiAccess(
+    uint64_t** histogram, uint64_t num_iterations, size_t num_addrs,
+    uint64_t threshold, std::vector<std::vector<uint64_t>>& refreshes) {
+  refreshes.assign(num_addrs, std::vector<uint64_t>());
+  for (size_t i = 0; i < num_iterations; ++i) {
+    // the access to addrs[k] starts after the accesses to addrs[0..k)
+    uint64_t start = histogram[i][0] - histogram[0][0];
+    for (size_t k = 0; k < num_addrs; ++k) {
+      if (histogram[i][k + 1] > threshold) {
+        refreshes[k].push_back(start);
+      }
+      start += histogram[i][k + 1];
+    }
+  }
+}
+
 }  // namespace sudoku
@@ -2,6 +2,7 @@
 #define SUDOKU_INTERNAL_REFRESHES_H
 
 #include <cstdint>
+#include <random>
 #include <vector>
 
 namespace sudoku {
@@ -12,6 +13,30 @@ void FilterRefreshTiming(uint64_t** histogram, uint64_t num_cols,
 std::vector<uint64_t> ComputeRefreshIntervals(
     const std::vector<uint64_t>& refreshes);
 
+// Spectral interval estimation. The phase coherence (Rayleigh statistic) of
+// the refresh timestamps at a trial period equals the normalized periodogram
+// of the spike train at that frequency: close to 1 when the period (or one of
+// its integer fractions) matches, close to 0 otherwise. Missed refreshes only
+// reduce the number of terms, and spurious spikes add incoherent terms.
+double RefreshPhaseCoherence(const std::vector<uint64_t>& refreshes,
+                             double period);
+// Phase in [0, period) of the refresh timestamps (their circular mean modulo
+// the period), e.g., to tell the staggered refreshes of two ranks apart
+double RefreshPhase(const std::vector<uint64_t>& refreshes, double period);
+// Most coherent period in [min_period, max_period); returns 0 if fewer than
+// SUDOKU_REFRESH_SPECTRAL_MIN_EVENTS refreshes are given
+uint64_t EstimateRefreshPeriod(const std::vector<uint64_t>& refreshes,
+                               uint64_t min_period, uint64_t max_period,
+                               double* coherence);
+// tREFI or tREFI/2 around the active profile's regular interval threshold
+uint64_t EstimateRefreshInterval(const std::vector<uint64_t>& refreshes,
+                                 double* coherence);
+
+// Synthetic spike trains (timestamps of detected refreshes) for validation
+std::vector<uint64_t> GenerateSyntheticRefreshes(
+    uint64_t period, uint64_t sample_cycles, uint64_t num_samples,
+    double jitter, double miss_rate, double spurious_rate, std::mt19937& gen);
+
 // Auto-refresh on single memory accesses
 void MeasureRefreshSingleAccess(uint64_t addr, uint64_t** histogram);
 uint64_t MedianRefreshIntervalSingleAccess(uint64_t addr, uint64_t threshold);
@@ -30,6 +55,10 @@ uint64_t AverageRefreshIntervalPairedAccessCoarse(uint64_t faddr,
 void StatRefreshIntervalPairedAccessCoarse(uint64_t faddr, uint64_t saddr,
                                            uint64_t threshold,
                                            uint64_t* results);
+uint64_t SpectralRefreshIntervalPairedAccessCoarse(uint64_t faddr,
+                                                   uint64_t saddr,
+                                                   uint64_t threshold,
+                                                   double* coherence);
 
 // Auto-refresh on paired memory accesses (fine-grained measurements)
 void MeasureRefreshPairedAccessFine(uint64_t faddr, uint64_t saddr,
@@ -40,6 +69,20 @@ uint64_t AverageRefreshIntervalPairedAccessFine(uint64_t faddr, uint64_t saddr,
                                                 uint64_t threshold);
 void StatRefreshIntervalPairedAccessFine(uint64_t faddr, uint64_t saddr,
                                          uint64_t threshold, uint64_t* results);
+uint64_t SpectralRefreshIntervalPairedAccessFine(uint64_t faddr,
+                                                 uint64_t saddr,
+                                                 uint64_t threshold,
+                                                 double* coherence);
+
+// Auto-refresh on multiple memory accesses. Each iteration times one access
+// per address in turn (column k + 1 holds the latency of addrs[k]), so every
+// address gets its own spike train from a single shared capture.
+void MeasureRefreshMultiAccess(const uint64_t* addrs, size_t num_addrs,
+                               uint64_t num_iterations, uint64_t** histogram);
+// Per-address refresh timestamps (relative to the first sample)
+void FilterRefreshTimingMultiAccess(
+    uint64_t** histogram, uint64_t num_iterations, size_t num_addrs,
+    uint64_t threshold, std::vector<std::vector<uint64_t>>& refreshes);
 
 }  // namespace sudoku
 
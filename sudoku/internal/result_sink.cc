@@ -0,0 +1,189 @@
+#include "result_sink.h"
+
+#include <fcntl.h>
+#include <spdlog/fmt/fmt.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstring>
+#include <fstream>
+
+#include "constants.h"
+#include "utils.h"
+
+namespace sudoku {
+
+static uint64_t MappingSize(uint64_t capacity) {
+  return sizeof(ResultFileHeader) + capacity * sizeof(ResultRecord);
+}
+
+ResultSink::ResultSink()
+    : fd_(-1),
+      base_(nullptr),
+      header_(nullptr),
+      records_(nullptr),
+      capacity_(0),
+      count_(0),
+      published_(0),
+      stop_(false) {}
+
+ResultSink::~ResultSink() { Close(); }
+
+bool ResultSink::Open(std::string fname, uint64_t capacity, bool with_num,
+                      uint64_t pci_offset) {
+  if (capacity == 0) {
+    capacity = SUDOKU_RESULT_SINK_GROW_RECORDS;
+  }
+  fd_ = open(fname.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (fd_ < 0) {
+    PRINT_ERROR("Cannot open result file: {}", fname);
+    return false;
+  }
+  // Allocate the blocks up front so that stores do not fault into the
+  // filesystem on the measuring thread
+  if (posix_fallocate(fd_, 0, MappingSize(capacity)) != 0) {
+    PRINT_ERROR("Cannot allocate result file: {}", fname);
+    close(fd_);
+    fd_ = -1;
+    return false;
+  }
+  void* base = mmap(nullptr, MappingSize(capacity), PROT_READ | PROT_WRITE,
+                    MAP_SHARED | MAP_POPULATE, fd_, 0);
+  if (base == MAP_FAILED) {
+    PRINT_ERROR("Cannot map result file: {}", fname);
+    close(fd_);
+    fd_ = -1;
+    return false;
+  }
+  base_ = static_cast<char*>(base);
+  header_ = reinterpret_cast<ResultFileHeader*>(base_);
+  records_ = reinterpret_cast<ResultRecord*>(base_ + sizeof(ResultFileHeader));
+  capacity_ = capacity;
+  count_ = 0;
+  published_.store(0, std::memory_order_relaxed);
+
+  std::memset(header_, 0, sizeof(ResultFileHeader));
+  std::memcpy(header_->magic, SUDOKU_RESULT_MAGIC, sizeof(header_->magic));
+  header_->version = SUDOKU_RESULT_VERSION;
+  header_->record_size = sizeof(ResultRecord);
+  header_->with_num = with_num ? 1 : 0;
+  header_->pci_offset = pci_offset;
+
+  stop_ = false;
+  flusher_ = std::thread(&ResultSink::Flush, this);
+  return true;
+}
+
+void ResultSink::Close() {
+  if (base_ == nullptr) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  stop_cv_.notify_one();
+  flusher_.join();
+
+  header_->num_records = count_;
+  msync(base_, MappingSize(count_), MS_SYNC);
+  munmap(base_, MappingSize(capacity_));
+  if (ftruncate(fd_, MappingSize(count_)) != 0) {
+    PRINT_WARNING("Cannot truncate the result file");
+  }
+  close(fd_);
+  fd_ = -1;
+  base_ = nullptr;
+  header_ = nullptr;
+  records_ = nullptr;
+}
+
+void ResultSink::Grow() {
+  // Slow path: only taken if the capacity hint was too small
+  std::lock_guard<std::mutex> lock(mutex_);
+  uint64_t capacity = capacity_ + SUDOKU_RESULT_SINK_GROW_RECORDS;
+  if (posix_fallocate(fd_, 0, MappingSize(capacity)) != 0) {
+    PRINT_ERROR("Cannot grow the result file");
+    exit(EXIT_FAILURE);
+  }
+  void* base = mremap(base_, MappingSize(capacity_), MappingSize(capacity),
+                      MREMAP_MAYMOVE);
+  if (base == MAP_FAILED) {
+    PRINT_ERROR("Cannot remap the result file");
+    exit(EXIT_FAILURE);
+  }
+  base_ = static_cast<char*>(base);
+  header_ = reinterpret_cast<ResultFileHeader*>(base_);
+  records_ = reinterpret_cast<ResultRecord*>(base_ + sizeof(ResultFileHeader));
+  capacity_ = capacity;
+}
+
+void ResultSink::Flush() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  uint64_t flushed = 0;
+  while (!stop_) {
+    stop_cv_.wait_for(
+        lock, std::chrono::milliseconds(SUDOKU_RESULT_SINK_FLUSH_MS));
+    uint64_t published = published_.load(std::memory_order_acquire);
+    if (published == flushed) {
+      continue;
+    }
+    // Records first, then the count that makes them visible to readers
+    msync(base_, MappingSize(published), MS_ASYNC);
+    header_->num_records = published;
+    flushed = published;
+  }
+}
+
+bool ReadResultFile(std::string fname, ResultFileHeader* header,
+                    std::vector<ResultRecord>* records) {
+  std::ifstream ifs(fname, std::ios::binary);
+  if (!ifs.is_open()) {
+    PRINT_ERROR("Cannot open result file: {}", fname);
+    return false;
+  }
+  if (!ifs.read(reinterpret_cast<char*>(header), sizeof(ResultFileHeader)) ||
+      std::strncmp(header->magic, SUDOKU_RESULT_MAGIC,
+                   sizeof(header->magic)) != 0) {
+    PRINT_ERROR("Not a result file: {}", fname);
+    return false;
+  }
+  if (header->version != SUDOKU_RESULT_VERSION ||
+      header->record_size != sizeof(ResultRecord)) {
+    PRINT_ERROR("Unsupported result file version {} (record size {})",
+                header->version, header->record_size);
+    return false;
+  }
+  records->resize(header->num_records);
+  ifs.read(reinterpret_cast<char*>(records->data()),
+           header->num_records * sizeof(ResultRecord));
+  // A killed run may have published more records than it synced
+  records->resize(static_cast<uint64_t>(ifs.gcount()) / sizeof(ResultRecord));
+  return true;
+}
+
+bool ConvertResultFileToCSV(std::string fname, std::ostream& out) {
+  ResultFileHeader header;
+  std::vector<ResultRecord> records;
+  if (!ReadResultFile(fname, &header, &records)) {
+    return false;
+  }
+  out << (header.with_num ? "idx,fpaddr,spaddr,avg,med,min,max,num\n"
+                          : "idx,fpaddr,spaddr,avg,med,min,max\n");
+  for (const auto& record : records) {
+    out << fmt::format(
+        "{},{},{},{},{},{},{}", record.idx,
+        reinterpret_cast<void*>(record.fpaddr - header.pci_offset),
+        reinterpret_cast<void*>(record.spaddr - header.pci_offset),
+        record.statistics[0], record.statistics[1], record.statistics[2],
+        record.statistics[3]);
+    if (header.with_num) {
+      out << "," << record.num;
+    }
+    out << "\n";
+  }
+  return true;
+}
+
+}  // namespace sudoku
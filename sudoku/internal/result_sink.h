@@ -0,0 +1,97 @@
+#ifndef SUDOKU_INTERNAL_RESULT_SINK_H
+#define SUDOKU_INTERNAL_RESULT_SINK_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace sudoku {
+
+#define SUDOKU_RESULT_MAGIC "SDKRSLT"
+#define SUDOKU_RESULT_VERSION 1
+
+/// @brief Measured statistics of an address pair (avg,med,min,max and the
+/// number of samples behind them, if any). One cache line per record.
+struct ResultRecord {
+  uint64_t idx;
+  uint64_t fpaddr;  // physical addresses (PCI offset not removed)
+  uint64_t spaddr;
+  uint64_t statistics[4];
+  uint64_t num;
+};
+
+/// @brief Header of a binary result file, followed by the records
+struct ResultFileHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t record_size;
+  uint32_t with_num;  // emit the num column when converting
+  uint32_t reserved;
+  uint64_t num_records;  // updated by the flusher and on close
+  uint64_t pci_offset;   // subtracted from addresses when converting
+  uint8_t padding[24];
+};
+
+static_assert(sizeof(ResultRecord) == 64, "ResultRecord must be 64 bytes");
+static_assert(sizeof(ResultFileHeader) == 64,
+              "ResultFileHeader must be 64 bytes");
+
+/// @brief Append-only binary result file. Records are stored into a shared
+/// memory mapping of the file, so Append() is a 64-byte copy; a background
+/// flusher writes dirty pages back and publishes the record count in the
+/// header, so a killed run leaves a readable prefix.
+class ResultSink {
+ public:
+  ResultSink();
+  ResultSink(const ResultSink&) = delete;
+  ResultSink& operator=(const ResultSink&) = delete;
+  ~ResultSink();
+
+  // Create fname with room for capacity records (grown on demand)
+  bool Open(std::string fname, uint64_t capacity, bool with_num,
+            uint64_t pci_offset);
+  // Stop the flusher, sync, and truncate the file to its records
+  void Close();
+
+  inline void Append(const ResultRecord& record) {
+    if (count_ == capacity_) {
+      Grow();
+    }
+    records_[count_++] = record;
+    published_.store(count_, std::memory_order_release);
+  }
+
+  uint64_t Size() const { return count_; }
+
+ private:
+  void Grow();
+  void Flush();
+
+  int fd_;
+  char* base_;
+  ResultFileHeader* header_;
+  ResultRecord* records_;
+  uint64_t capacity_;
+  uint64_t count_;
+  std::atomic<uint64_t> published_;
+
+  std::mutex mutex_;  // guards the mapping against the flusher
+  std::condition_variable stop_cv_;
+  bool stop_;
+  std::thread flusher_;
+};
+
+// Read a binary result file (up to its published record count)
+bool ReadResultFile(std::string fname, ResultFileHeader* header,
+                    std::vector<ResultRecord>* records);
+// Write the records as idx,fpaddr,spaddr,avg,med,min,max[,num]
+bool ConvertResultFileToCSV(std::string fname, std::ostream& out);
+
+}  // namespace sudoku
+
+#endif  // SUDOKU_INTERNAL_RESULT_SINK_H
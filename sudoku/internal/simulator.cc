@@ -0,0 +1,594 @@
+#include "simulator.h"
+
+#include <sys/mman.h>
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <random>
+#include <sstream>
+
+#include "constants.h"
+#include "refresh_scheduler.h"
+#include "utils.h"
+
+namespace sudoku {
+
+namespace {
+
+constexpr uint64_t kClosedRow = ~0ULL;
+
+std::string Trim(const std::string& str) {
+  size_t first = str.find_first_not_of(" \t\r\n");
+  if (first == std::string::npos) {
+    return "";
+  }
+  size_t last = str.find_last_not_of(" \t\r\n");
+  return str.substr(first, last - first + 1);
+}
+
+std::vector<uint64_t> ParseFunctions(const std::string& value) {
+  std::vector<uint64_t> functions;
+  std::stringstream ss(value);
+  std::string token;
+  while (std::getline(ss, token, ',')) {
+    token = Trim(token);
+    if (!token.empty()) {
+      functions.push_back(strtoull(token.c_str(), nullptr, 16));
+    }
+  }
+  return functions;
+}
+
+std::string FunctionsToString(const std::vector<uint64_t>& functions) {
+  std::ostringstream oss;
+  for (size_t i = 0; i < functions.size(); ++i) {
+    oss << (i ? ";" : "") << "0x" << std::hex << functions[i];
+  }
+  return oss.str();
+}
+
+bool ParseSimulatorEntry(SimulatorConfig& config, const std::string& key,
+                         const std::string& value) {
+  uint64_t number = strtoull(value.c_str(), nullptr, 0);
+  if (key == "channel_functions") {
+    config.channel_functions = ParseFunctions(value);
+  } else if (key == "rank_functions") {
+    config.rank_functions = ParseFunctions(value);
+  } else if (key == "bank_group_functions") {
+    config.bank_group_functions = ParseFunctions(value);
+  } else if (key == "bank_address_functions") {
+    config.bank_address_functions = ParseFunctions(value);
+  } else if (key == "row_bits") {
+    config.row_bits = strtoull(value.c_str(), nullptr, 16);
+  } else if (key == "column_bits") {
+    config.column_bits = strtoull(value.c_str(), nullptr, 16);
+  } else if (key == "dram_size") {
+    config.dram_size = number * GB;
+  } else if (key == "seed") {
+    config.seed = number;
+  } else if (key == "access_latency") {
+    config.access_latency = number;
+  } else if (key == "loop_overhead") {
+    config.loop_overhead = number;
+  } else if (key == "rdtscp_latency") {
+    config.rdtscp_latency = number;
+  } else if (key == "tcl") {
+    config.tcl = number;
+  } else if (key == "trcd") {
+    config.trcd = number;
+  } else if (key == "trp") {
+    config.trp = number;
+  } else if (key == "tccd_s") {
+    config.tccd_s = number;
+  } else if (key == "tccd_l") {
+    config.tccd_l = number;
+  } else if (key == "trtrs") {
+    config.trtrs = number;
+  } else if (key == "trtw") {
+    config.trtw = number;
+  } else if (key == "twtr_s") {
+    config.twtr_s = number;
+  } else if (key == "twtr_l") {
+    config.twtr_l = number;
+  } else if (key == "trefi") {
+    config.trefi = number;
+  } else if (key == "trfc") {
+    config.trfc = number;
+  } else if (key == "noise_stddev") {
+    config.noise_stddev = strtod(value.c_str(), nullptr);
+  } else if (key == "outlier_rate") {
+    config.outlier_rate = strtod(value.c_str(), nullptr);
+  } else if (key == "outlier_latency") {
+    config.outlier_latency = number;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+}  // namespace
+
+std::vector<uint64_t> SimulatorConfig::Functions() const {
+  std::vector<uint64_t> functions(channel_functions);
+  functions.insert(functions.end(), rank_functions.begin(),
+                   rank_functions.end());
+  functions.insert(functions.end(), bank_group_functions.begin(),
+                   bank_group_functions.end());
+  functions.insert(functions.end(), bank_address_functions.begin(),
+                   bank_address_functions.end());
+  return functions;
+}
+
+bool SimulatorConfig::SameBankDifferentRow(uint64_t fpaddr,
+                                           uint64_t spaddr) const {
+  for (const auto& function : Functions()) {
+    if (__builtin_parityll(fpaddr & function) !=
+        __builtin_parityll(spaddr & function)) {
+      return false;
+    }
+  }
+  return (fpaddr & row_bits) != (spaddr & row_bits);
+}
+
+std::string SimulatorConfig::ToString() const {
+  std::ostringstream oss;
+  oss << "channel=" << FunctionsToString(channel_functions)
+      << ",rank=" << FunctionsToString(rank_functions)
+      << ",bank_group=" << FunctionsToString(bank_group_functions)
+      << ",bank_address=" << FunctionsToString(bank_address_functions)
+      << ",row_bits=0x" << std::hex << row_bits << ",column_bits=0x"
+      << column_bits << std::dec << ",dram=" << (dram_size / GB) << "GB"
+      << ",tREFI=" << trefi << ",tRFC=" << trfc << ",tCCD_S/L=" << tccd_s
+      << "/" << tccd_l << ",noise=" << noise_stddev;
+  return oss.str();
+}
+
+bool LoadSimulatorConfig(const std::string& fname, SimulatorConfig& config) {
+  std::ifstream ifs(fname);
+  if (!ifs.is_open()) {
+    PRINT_ERROR("Cannot open simulator file: {}", fname);
+    return false;
+  }
+
+  std::string line;
+  uint64_t line_number = 0;
+  while (std::getline(ifs, line)) {
+    line_number++;
+    line = Trim(line.substr(0, line.find('#')));
+    if (line.empty()) {
+      continue;
+    }
+    size_t pos = line.find('=');
+    if (pos == std::string::npos) {
+      PRINT_ERROR("Malformed simulator entry at {}:{}", fname, line_number);
+      return false;
+    }
+    std::string key = Trim(line.substr(0, pos));
+    if (!ParseSimulatorEntry(config, key, Trim(line.substr(pos + 1)))) {
+      PRINT_ERROR("Unknown simulator entry at {}:{}: {}", fname, line_number,
+                  key);
+      return false;
+    }
+  }
+  if (config.trefi == 0 || config.trfc >= config.trefi) {
+    PRINT_ERROR("Simulated tRFC must be shorter than tREFI");
+    return false;
+  }
+  return true;
+}
+
+SimulatedBackend::SimulatedBackend(const SimulatorConfig& config)
+    : config_(config),
+      num_rank_bits_(config.rank_functions.size()),
+      num_bank_group_bits_(config.bank_group_functions.size()),
+      num_bank_address_bits_(config.bank_address_functions.size()),
+      num_ranks_(1U << (config.channel_functions.size() +
+                        config.rank_functions.size())),
+      clock_(0) {
+  uint64_t num_banks =
+      static_cast<uint64_t>(num_ranks_)
+      << (num_bank_group_bits_ + num_bank_address_bits_);
+  open_rows_.assign(num_banks, kClosedRow);
+  opened_at_.assign(num_banks, 0);
+
+  // splitmix64 seeding of the xorshift128+ state
+  uint64_t seed = config_.seed ? config_.seed : std::random_device{}();
+  for (auto& state : state_) {
+    uint64_t z = (seed += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    state = z ^ (z >> 31);
+  }
+  refresh_phase_ = NextRandom() % config_.trefi;
+}
+
+char* SimulatedBackend::MapPage(uint64_t page_size, bool /* huge */) {
+  // Pages are never accessed, so an inaccessible reservation suffices
+  uint64_t num_frames = config_.dram_size / page_size;
+  if (used_frames_.size() >= num_frames) {
+    PRINT_ERROR("Simulated DRAM ({} GB) is smaller than the memory pool",
+                config_.dram_size / GB);
+    return nullptr;
+  }
+  void* page = mmap(nullptr, page_size, PROT_NONE,
+                    MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  if (page == MAP_FAILED) {
+    return nullptr;
+  }
+
+  uint64_t frame = 0;
+  do {
+    frame = NextRandom() % num_frames;
+  } while (std::find(used_frames_.begin(), used_frames_.end(), frame) !=
+           used_frames_.end());
+  used_frames_.push_back(frame);
+
+  Page entry = {reinterpret_cast<uint64_t>(page), frame * page_size,
+                page_size};
+  auto it = std::upper_bound(
+      pages_.begin(), pages_.end(), entry,
+      [](const Page& a, const Page& b) { return a.vaddr < b.vaddr; });
+  pages_.insert(it, entry);
+  return static_cast<char*>(page);
+}
+
+void SimulatedBackend::UnmapPage(char* page, uint64_t page_size) {
+  uint64_t vaddr = reinterpret_cast<uint64_t>(page);
+  for (auto it = pages_.begin(); it != pages_.end(); ++it) {
+    if (it->vaddr == vaddr) {
+      used_frames_.erase(std::find(used_frames_.begin(), used_frames_.end(),
+                                   it->paddr / it->size));
+      pages_.erase(it);
+      break;
+    }
+  }
+  munmap(page, page_size);
+}
+
+uint64_t SimulatedBackend::VirtToPhys(uint64_t vaddr) {
+  // pages_ only changes while the pool is (re)initialized, so helper threads
+  // may translate concurrently with the kernels
+  auto it = std::upper_bound(
+      pages_.begin(), pages_.end(), vaddr,
+      [](uint64_t addr, const Page& page) { return addr < page.vaddr; });
+  if (it == pages_.begin()) {
+    return 0;
+  }
+  --it;
+  if (vaddr - it->vaddr >= it->size) {
+    return 0;
+  }
+  return it->paddr + (vaddr - it->vaddr);
+}
+
+uint64_t SimulatedBackend::Timestamp() {
+  clock_ += config_.rdtscp_latency;
+  return clock_;
+}
+
+SimulatedBackend::Location SimulatedBackend::Decode(uint64_t vaddr) const {
+  // pages_ is sorted, so the lookup is the same as in VirtToPhys
+  auto it = std::upper_bound(
+      pages_.begin(), pages_.end(), vaddr,
+      [](uint64_t addr, const Page& page) { return addr < page.vaddr; });
+  if (it == pages_.begin() || vaddr - (it - 1)->vaddr >= (it - 1)->size) {
+    PRINT_ERROR("Simulated access outside the memory pool: {}",
+                reinterpret_cast<void*>(vaddr));
+    exit(EXIT_FAILURE);
+  }
+  --it;
+  uint64_t paddr = it->paddr + (vaddr - it->vaddr);
+
+  Location location;
+  location.channel = XORReductionWithMasks(config_.channel_functions, paddr);
+  location.rank =
+      (location.channel << num_rank_bits_) |
+      XORReductionWithMasks(config_.rank_functions, paddr);
+  location.bank_group =
+      (location.rank << num_bank_group_bits_) |
+      XORReductionWithMasks(config_.bank_group_functions, paddr);
+  location.bank =
+      (location.bank_group << num_bank_address_bits_) |
+      XORReductionWithMasks(config_.bank_address_functions, paddr);
+  location.row = paddr & config_.row_bits;
+  return location;
+}
+
+uint64_t SimulatedBackend::RefreshWait(const Location& location, uint64_t t) {
+  // Ranks refresh tREFI apart, staggered evenly across the ranks
+  uint64_t offset =
+      refresh_phase_ + location.rank * config_.trefi / num_ranks_;
+  if (t < offset) {
+    return 0;
+  }
+  uint64_t start = t - (t - offset) % config_.trefi;
+  if (opened_at_[location.bank] < start) {
+    open_rows_[location.bank] = kClosedRow;
+  }
+  return (t < start + config_.trfc) ? start + config_.trfc - t : 0;
+}
+
+uint64_t SimulatedBackend::RowLatency(const Location& location, uint64_t t) {
+  uint64_t& open_row = open_rows_[location.bank];
+  uint64_t latency = config_.tcl;
+  if (open_row == kClosedRow) {
+    latency += config_.trcd;
+  } else if (open_row != location.row) {
+    latency += config_.trp + config_.trcd;
+  }
+  open_row = location.row;
+  opened_at_[location.bank] = t;
+  return latency;
+}
+
+uint64_t SimulatedBackend::ColumnGap(const Location& prev, bool prev_write,
+                                     const Location& next,
+                                     bool next_write) const {
+  if (prev.rank != next.rank) {
+    return config_.trtrs;
+  }
+  bool same_bank_group = prev.bank_group == next.bank_group;
+  if (!prev_write && next_write) {
+    return config_.trtw;
+  }
+  if (prev_write && !next_write) {
+    return same_bank_group ? config_.twtr_l : config_.twtr_s;
+  }
+  return same_bank_group ? config_.tccd_l : config_.tccd_s;
+}
+
+uint64_t SimulatedBackend::SingleAccess(const Location& location) {
+  uint64_t t = clock_;
+  uint64_t wait = RefreshWait(location, t);
+  return Measured(config_.access_latency + wait +
+                  RowLatency(location, t + wait));
+}
+
+uint64_t SimulatedBackend::PairedAccess(const Location& first,
+                                        const Location& second) {
+  uint64_t t = clock_;
+  uint64_t first_wait = RefreshWait(first, t);
+  uint64_t second_wait = RefreshWait(second, t);
+  uint64_t first_done = t + first_wait + RowLatency(first, t + first_wait);
+  uint64_t second_done = 0;
+  if (first.bank == second.bank) {
+    // serialized in the bank: a row buffer hit or conflict after the first
+    second_done = (first.row == second.row)
+                      ? first_done + config_.tccd_l
+                      : first_done + RowLatency(second, first_done);
+  } else {
+    second_done = t + second_wait + RowLatency(second, t + second_wait);
+    if (first.channel == second.channel) {
+      second_done = std::max(second_done,
+                             first_done + ColumnGap(first, false, second,
+                                                    false));
+    }
+  }
+  return Measured(config_.access_latency + std::max(first_done, second_done) -
+                  t);
+}
+
+uint64_t SimulatedBackend::StreamAccess(const std::vector<Location>& locations,
+                                        const std::vector<bool>& writes) {
+  // Column commands in issue order: each waits for its row and for the
+  // previous command on its channel
+  uint64_t t = clock_, end = t;
+  std::vector<uint64_t> columns(locations.size());
+  for (size_t k = 0; k < locations.size(); ++k) {
+    const Location& location = locations[k];
+    size_t same_bank = k, same_channel = k;
+    for (size_t j = k; j-- > 0;) {
+      if (same_bank == k && locations[j].bank == location.bank) {
+        same_bank = j;
+      }
+      if (same_channel == k && locations[j].channel == location.channel) {
+        same_channel = j;
+      }
+    }
+    uint64_t base = (same_bank == k) ? t + RefreshWait(location, t)
+                                     : columns[same_bank];
+    uint64_t column = base + RowLatency(location, base) - config_.tcl;
+    if (same_channel != k) {
+      column = std::max(column, columns[same_channel] +
+                                    ColumnGap(locations[same_channel],
+                                              writes[same_channel], location,
+                                              writes[k]));
+    }
+    columns[k] = column;
+    end = std::max(end, column + config_.tcl);
+  }
+  return Measured(config_.access_latency + end - t);
+}
+
+uint64_t SimulatedBackend::Measured(uint64_t latency) {
+  // Irwin-Hall approximation of a standard normal sample
+  double normal = (NextUniform() + NextUniform() + NextUniform() +
+                   NextUniform() - 2.0) *
+                  std::sqrt(3.0);
+  double measured = latency + config_.noise_stddev * normal;
+  if (NextUniform() < config_.outlier_rate) {
+    measured += config_.outlier_latency * (0.5 + NextUniform());
+  }
+  return (measured < 1.0) ? 1 : static_cast<uint64_t>(measured);
+}
+
+uint64_t SimulatedBackend::NextRandom() {
+  // xorshift128+
+  uint64_t s1 = state_[0];
+  const uint64_t s0 = state_[1];
+  state_[0] = s0;
+  s1 ^= s1 << 23;
+  state_[1] = s1 ^ s0 ^ (s1 >> 18) ^ (s0 >> 5);
+  return state_[1] + s0;
+}
+
+double SimulatedBackend::NextUniform() {
+  return (NextRandom() >> 11) * (1.0 / 9007199254740992.0);
+}
+
+void SimulatedBackend::AccessTimingSingleMemoryAccess(uint64_t addr,
+                                                      uint64_t** histogram) {
+  Location location = Decode(addr);
+  for (size_t i = 0; i < SUDOKU_CONFLICT_NUM_ITERATION; ++i) {
+    clock_ += config_.loop_overhead;
+    histogram[i][0] = clock_;
+    histogram[i][1] = SingleAccess(location);
+    clock_ += histogram[i][1];
+  }
+}
+
+void SimulatedBackend::AccessTimingPairedMemoryAccess(uint64_t faddr,
+                                                      uint64_t saddr,
+                                                      uint64_t** histogram) {
+  Location first = Decode(faddr), second = Decode(saddr);
+  for (size_t i = 0; i < SUDOKU_CONFLICT_NUM_ITERATION; ++i) {
+    clock_ += config_.loop_overhead;
+    histogram[i][0] = clock_;
+    histogram[i][1] = PairedAccess(first, second);
+    clock_ += histogram[i][1];
+  }
+}
+
+void SimulatedBackend::AccessTimingPairedMemoryAccessScheduled(
+    uint64_t faddr, uint64_t saddr, RefreshScheduler& scheduler,
+    uint64_t** histogram) {
+  Location first = Decode(faddr), second = Decode(saddr);
+  for (size_t i = 0; i < SUDOKU_SCHEDULED_CONFLICT_NUM_ITERATION; ++i) {
+    scheduler.Maintain();
+    clock_ += config_.loop_overhead;
+    // the scheduler spins on Timestamp(), which advances the clock
+    scheduler.Wait(2 * SBDR_UPPER_BOUND);
+    histogram[i][0] = clock_;
+    histogram[i][1] = PairedAccess(first, second);
+    clock_ += histogram[i][1];
+  }
+}
+
+void SimulatedBackend::AccessTimingBatchedPairedMemoryAccess(
+    const uint64_t* faddrs, const uint64_t* saddrs, size_t num_pairs,
+    uint64_t** histogram) {
+  std::vector<Location> firsts, seconds;
+  for (size_t k = 0; k < num_pairs; ++k) {
+    firsts.push_back(Decode(faddrs[k]));
+    seconds.push_back(Decode(saddrs[k]));
+  }
+  for (size_t i = 0; i < SUDOKU_CONFLICT_NUM_ITERATION; ++i) {
+    clock_ += config_.loop_overhead;
+    for (size_t k = 0; k < num_pairs; ++k) {
+      clock_ += config_.rdtscp_latency;
+      histogram[k][i] = PairedAccess(firsts[k], seconds[k]);
+      clock_ += histogram[k][i];
+    }
+  }
+}
+
+void SimulatedBackend::MeasureRefreshSingleAccess(uint64_t addr,
+                                                  uint64_t** histogram) {
+  Location location = Decode(addr);
+  for (size_t i = 0; i < SUDOKU_REFRESH_NUM_ITERATION; ++i) {
+    clock_ += config_.loop_overhead;
+    histogram[i][0] = clock_;
+    histogram[i][1] = SingleAccess(location);
+    clock_ += histogram[i][1];
+  }
+}
+
+void SimulatedBackend::MeasureRefreshPairedAccessCoarse(uint64_t faddr,
+                                                        uint64_t saddr,
+                                                        uint64_t** histogram) {
+  Location first = Decode(faddr), second = Decode(saddr);
+  for (size_t i = 0; i < SUDOKU_REFRESH_NUM_ITERATION; ++i) {
+    clock_ += config_.loop_overhead;
+    histogram[i][0] = clock_;
+    histogram[i][1] = PairedAccess(first, second);
+    clock_ += histogram[i][1];
+  }
+}
+
+void SimulatedBackend::MeasureRefreshPairedAccessFine(uint64_t faddr,
+                                                      uint64_t saddr,
+                                                      uint64_t** histogram) {
+  Location first = Decode(faddr), second = Decode(saddr);
+  for (size_t i = 0; i < SUDOKU_REFRESH_NUM_ITERATION; ++i) {
+    clock_ += config_.loop_overhead;
+    histogram[i][0] = clock_;
+    histogram[i][1] = SingleAccess(first);
+    clock_ += histogram[i][1] + config_.rdtscp_latency;
+    histogram[i][2] = SingleAccess(second);
+    clock_ += histogram[i][2];
+  }
+}
+
+void SimulatedBackend::MeasureRefreshMultiAccess(const uint64_t* addrs,
+                                                 size_t num_addrs,
+                                                 uint64_t num_iterations,
+                                                 uint64_t** histogram) {
+  std::vector<Location> locations;
+  for (size_t k = 0; k < num_addrs; ++k) {
+    locations.push_back(Decode(addrs[k]));
+  }
+  for (size_t i = 0; i < num_iterations; ++i) {
+    clock_ += config_.loop_overhead;
+    histogram[i][0] = clock_;
+    for (size_t k = 0; k < num_addrs; ++k) {
+      histogram[i][k + 1] = SingleAccess(locations[k]);
+      clock_ += histogram[i][k + 1];
+    }
+  }
+}
+
+void SimulatedBackend::ConsecutiveAccessLatency(ConsecutiveAccess pattern,
+                                                const uint64_t* faddrs,
+                                                const uint64_t* saddrs,
+                                                size_t length,
+                                                uint64_t** histogram) {
+  bool first_writes = pattern == ConsecutiveAccess::WRRD ||
+                      pattern == ConsecutiveAccess::WRWR;
+  bool second_writes = pattern == ConsecutiveAccess::RDWR ||
+                       pattern == ConsecutiveAccess::WRWR;
+  // issue order of the kernels: faddrs[0], saddrs[0], faddrs[1], ...
+  std::vector<Location> locations;
+  std::vector<bool> writes;
+  for (size_t j = 0; j < length; ++j) {
+    locations.push_back(Decode(faddrs[j]));
+    writes.push_back(first_writes);
+    locations.push_back(Decode(saddrs[j]));
+    writes.push_back(second_writes);
+  }
+  for (size_t i = 0; i < SUDOKU_CONSECUTIVE_NUM_ITERATION; ++i) {
+    clock_ += config_.loop_overhead;
+    histogram[i][0] = clock_;
+    histogram[i][1] = StreamAccess(locations, writes);
+    clock_ += histogram[i][1];
+  }
+}
+
+void InitSimulatedBackend(const std::string& fname) {
+  SimulatorConfig config;
+  if (!fname.empty() && !LoadSimulatorConfig(fname, config)) {
+    exit(EXIT_FAILURE);
+  }
+
+  // Functions, row bits, and column bits of an injective mapping cover every
+  // DRAM address bit above the cache line offset exactly once
+  uint64_t num_bits = config.Functions().size() +
+                      __builtin_popcountll(config.row_bits) +
+                      __builtin_popcountll(config.column_bits);
+  uint64_t dram_bits = static_cast<uint64_t>(std::log2(config.dram_size));
+  if (num_bits + CACHELINE_OFFSET != dram_bits) {
+    PRINT_WARNING("Simulated mapping covers {} bits of a {}-bit DRAM address",
+                  num_bits + CACHELINE_OFFSET, dram_bits);
+  }
+
+  SetBackend(new SimulatedBackend(config));
+  PRINT_INFO("Simulated DRAM: {}", config.ToString());
+}
+
+const SimulatorConfig* SimulatedGroundTruth() {
+  const SimulatedBackend* backend =
+      dynamic_cast<const SimulatedBackend*>(&GetBackend());
+  return backend ? &backend->Config() : nullptr;
+}
+
+}  // namespace sudoku
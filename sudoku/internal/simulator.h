@@ -0,0 +1,204 @@
+#ifndef SUDOKU_INTERNAL_SIMULATOR_H
+#define SUDOKU_INTERNAL_SIMULATOR_H
+
+#include <stddef.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "backend.h"
+#include "config.h"
+
+namespace sudoku {
+
+/// @brief Ground truth and timings of the simulated memory controller. The
+/// defaults model the default DRAM configuration of the binaries (a single
+/// 32 GB DDR4 2Rx8 DIMM) with timings matching the `simulated` platform
+/// profile. Timings are in cycles of the (simulated) timestamp counter.
+struct SimulatorConfig {
+  // Addressing functions by role (XOR masks of physical address bits)
+  std::vector<uint64_t> channel_functions;
+  std::vector<uint64_t> rank_functions;  // DIMM, rank, and sub-channel
+  std::vector<uint64_t> bank_group_functions;
+  std::vector<uint64_t> bank_address_functions;
+  uint64_t row_bits;
+  uint64_t column_bits;
+  uint64_t dram_size;  // physical memory backing the pool pages
+  uint64_t seed;       // 0: random
+
+  // Core to memory controller and back, and the flushes and fences between
+  // two timed windows
+  uint64_t access_latency;
+  uint64_t loop_overhead;
+  uint64_t rdtscp_latency;
+  // Open-page row buffers
+  uint64_t tcl;
+  uint64_t trcd;
+  uint64_t trp;
+  // Column commands on a channel (rank switch, read to write, write to read)
+  uint64_t tccd_s;
+  uint64_t tccd_l;
+  uint64_t trtrs;
+  uint64_t trtw;
+  uint64_t twtr_s;
+  uint64_t twtr_l;
+  // Refreshes of each rank (staggered across the ranks)
+  uint64_t trefi;
+  uint64_t trfc;
+  // Gaussian noise per timed window and rare spikes (e.g., interrupts)
+  double noise_stddev;
+  double outlier_rate;
+  uint64_t outlier_latency;
+
+  SimulatorConfig()
+      : channel_functions(),
+        rank_functions({0x220000}),
+        bank_group_functions({0x2040, 0x44000}),
+        bank_address_functions({0x88000, 0x110000}),
+        row_bits(0x7fffc0000),
+        column_bits(0x1fc0),
+        dram_size(32ULL * GB),
+        seed(0),
+        access_latency(300),
+        loop_overhead(150),
+        rdtscp_latency(32),
+        tcl(40),
+        trcd(40),
+        trp(40),
+        tccd_s(12),
+        tccd_l(20),
+        trtrs(30),
+        trtw(24),
+        twtr_s(16),
+        twtr_l(32),
+        trefi(24960),
+        trfc(1120),
+        noise_stddev(8.0),
+        outlier_rate(0.0001),
+        outlier_latency(5000) {}
+
+  std::vector<uint64_t> Functions() const;
+  std::string ToString() const;
+  // Ground truth of a pair of physical addresses: same bank, different row
+  bool SameBankDifferentRow(uint64_t fpaddr, uint64_t spaddr) const;
+};
+
+// Simulator file format (one entry per line, '#' for comments):
+//   rank_functions = 0x220000
+//   bank_group_functions = 0x2040,0x44000
+//   row_bits = 0x7fffc0000
+//   trefi = 24960
+//   ...
+// Unspecified keys keep their defaults; numbers may be decimal or hex.
+bool LoadSimulatorConfig(const std::string& fname, SimulatorConfig& config);
+
+/// @brief Backend simulating a memory controller and its DRAM, so that all
+/// steps run without sudo privilege, hugepages, or DRAM timing. Pool pages
+/// are inaccessible reservations mapped to random physical frames, and the
+/// kernels advance a simulated clock by the modeled latencies instead of
+/// accessing memory. The model is deterministic for a given seed and call
+/// sequence.
+class SimulatedBackend : public Backend {
+ public:
+  explicit SimulatedBackend(const SimulatorConfig& config);
+
+  std::string Name() const override { return "simulated"; }
+  const SimulatorConfig& Config() const { return config_; }
+
+  char* MapPage(uint64_t page_size, bool huge) override;
+  void UnmapPage(char* page, uint64_t page_size) override;
+  uint64_t VirtToPhys(uint64_t vaddr) override;
+
+  uint64_t Timestamp() override;
+  uint64_t RandomSeed() override { return NextRandom(); }
+
+  void AccessTimingSingleMemoryAccess(uint64_t addr,
+                                      uint64_t** histogram) override;
+  void AccessTimingPairedMemoryAccess(uint64_t faddr, uint64_t saddr,
+                                      uint64_t** histogram) override;
+  void AccessTimingPairedMemoryAccessScheduled(uint64_t faddr, uint64_t saddr,
+                                               RefreshScheduler& scheduler,
+                                               uint64_t** histogram) override;
+  void AccessTimingBatchedPairedMemoryAccess(const uint64_t* faddrs,
+                                             const uint64_t* saddrs,
+                                             size_t num_pairs,
+                                             uint64_t** histogram) override;
+
+  void MeasureRefreshSingleAccess(uint64_t addr,
+                                  uint64_t** histogram) override;
+  void MeasureRefreshPairedAccessCoarse(uint64_t faddr, uint64_t saddr,
+                                        uint64_t** histogram) override;
+  void MeasureRefreshPairedAccessFine(uint64_t faddr, uint64_t saddr,
+                                      uint64_t** histogram) override;
+  void MeasureRefreshMultiAccess(const uint64_t* addrs, size_t num_addrs,
+                                 uint64_t num_iterations,
+                                 uint64_t** histogram) override;
+
+  void ConsecutiveAccessLatency(ConsecutiveAccess pattern,
+                                const uint64_t* faddrs, const uint64_t* saddrs,
+                                size_t length, uint64_t** histogram) override;
+
+ private:
+  /// @brief DRAM location of an address (rank, bank group, and bank are
+  /// unique across the whole memory system)
+  struct Location {
+    uint32_t channel;
+    uint32_t rank;
+    uint32_t bank_group;
+    uint32_t bank;
+    uint64_t row;
+  };
+
+  /// @brief Simulated page (virtual reservation and physical frame)
+  struct Page {
+    uint64_t vaddr;
+    uint64_t paddr;
+    uint64_t size;
+  };
+
+  Location Decode(uint64_t vaddr) const;
+  // Cycles until the refresh of the rank in progress at time t ends; a
+  // refresh closes the rank's row buffers
+  uint64_t RefreshWait(const Location& location, uint64_t t);
+  // Row buffer latency of an access at time t (opens the row)
+  uint64_t RowLatency(const Location& location, uint64_t t);
+  // Minimum distance of two column commands on a channel
+  uint64_t ColumnGap(const Location& prev, bool prev_write,
+                     const Location& next, bool next_write) const;
+
+  uint64_t SingleAccess(const Location& location);
+  uint64_t PairedAccess(const Location& first, const Location& second);
+  uint64_t StreamAccess(const std::vector<Location>& locations,
+                        const std::vector<bool>& writes);
+  // Noise and spikes of one timed window
+  uint64_t Measured(uint64_t latency);
+
+  uint64_t NextRandom();
+  double NextUniform();
+
+  SimulatorConfig config_;
+  uint32_t num_rank_bits_;
+  uint32_t num_bank_group_bits_;
+  uint32_t num_bank_address_bits_;
+  uint32_t num_ranks_;
+  std::vector<Page> pages_;  // sorted by vaddr
+  std::vector<uint64_t> used_frames_;
+  std::vector<uint64_t> open_rows_;
+  std::vector<uint64_t> opened_at_;
+  uint64_t clock_;
+  uint64_t refresh_phase_;
+  uint64_t state_[2];
+};
+
+// Load the simulator file (defaults if fname is empty) and make a simulated
+// backend the active backend. Exits on failure.
+void InitSimulatedBackend(const std::string& fname);
+// Configuration of the active backend if it is simulated (nullptr otherwise,
+// e.g., on hardware or when replaying), so measurements can be scored
+// against the ground truth
+const SimulatorConfig* SimulatedGroundTruth();
+
+}  // namespace sudoku
+
+#endif  // SUDOKU_INTERNAL_SIMULATOR_H
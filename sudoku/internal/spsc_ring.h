@@ -0,0 +1,53 @@
+#ifndef SUDOKU_INTERNAL_SPSC_RING_H
+#define SUDOKU_INTERNAL_SPSC_RING_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace sudoku {
+
+/// @brief Lock-free single-producer, single-consumer ring of Capacity slots
+/// (a power of two). The head and the tail live on separate cache lines so
+/// that the producer and the consumer do not share a written line.
+template <typename T, size_t Capacity>
+class SpscRing {
+  static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0,
+                "SpscRing capacity must be a power of two");
+
+ public:
+  SpscRing() : head_(0), tail_(0) {}
+  SpscRing(const SpscRing&) = delete;
+  SpscRing& operator=(const SpscRing&) = delete;
+
+  // Producer side; false if the ring is full
+  bool TryPush(const T& value) {
+    uint64_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail - head_.load(std::memory_order_acquire) == Capacity) {
+      return false;
+    }
+    slots_[tail & (Capacity - 1)] = value;
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer side; false if the ring is empty
+  bool TryPop(T* value) {
+    uint64_t head = head_.load(std::memory_order_relaxed);
+    if (head == tail_.load(std::memory_order_acquire)) {
+      return false;
+    }
+    *value = slots_[head & (Capacity - 1)];
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+ private:
+  alignas(64) std::atomic<uint64_t> head_;
+  alignas(64) std::atomic<uint64_t> tail_;
+  alignas(64) T slots_[Capacity];
+};
+
+}  // namespace sudoku
+
+#endif  // SUDOKU_INTERNAL_SPSC_RING_H
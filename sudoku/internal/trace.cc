@@ -0,0 +1,548 @@
+#include "trace.h"
+
+#include <sys/mman.h>
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <random>
+
+#include "constants.h"
+#include "platform.h"
+#include "utils.h"
+
+namespace sudoku {
+
+static void PutString(const std::string& str, std::vector<uint8_t>* out) {
+  PutVarint(str.size(), out);
+  out->insert(out->end(), str.begin(), str.end());
+}
+
+static bool GetString(const uint8_t** p, const uint8_t* end,
+                      std::string* str) {
+  uint64_t size;
+  if (!GetVarint(p, end, &size) || static_cast<uint64_t>(end - *p) < size) {
+    return false;
+  }
+  str->assign(reinterpret_cast<const char*>(*p), size);
+  *p += size;
+  return true;
+}
+
+bool TraceWriter::Open(
+    std::string fname,
+    const std::vector<std::pair<std::string, std::string>>& metadata) {
+  ofs_.open(fname, std::ios::binary | std::ios::trunc);
+  if (!ofs_.is_open()) {
+    PRINT_ERROR("Cannot create trace file: {}", fname);
+    return false;
+  }
+  TraceFileHeader header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, SUDOKU_TRACE_MAGIC, sizeof(header.magic));
+  header.version = SUDOKU_TRACE_VERSION;
+  ofs_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+  buffer_.clear();
+  PutVarint(metadata.size(), &buffer_);
+  for (const auto& entry : metadata) {
+    PutString(entry.first, &buffer_);
+    PutString(entry.second, &buffer_);
+  }
+  ofs_.write(reinterpret_cast<const char*>(buffer_.data()), buffer_.size());
+  return ofs_.good();
+}
+
+void TraceWriter::Seed(uint64_t seed) {
+  buffer_.clear();
+  buffer_.push_back(static_cast<uint8_t>(TraceRecord::SEED));
+  PutVarint(seed, &buffer_);
+  ofs_.write(reinterpret_cast<const char*>(buffer_.data()), buffer_.size());
+}
+
+void TraceWriter::Page(uint64_t page_size, uint64_t paddr) {
+  buffer_.clear();
+  buffer_.push_back(static_cast<uint8_t>(TraceRecord::PAGE));
+  PutVarint(page_size, &buffer_);
+  PutVarint(paddr, &buffer_);
+  ofs_.write(reinterpret_cast<const char*>(buffer_.data()), buffer_.size());
+}
+
+void TraceWriter::Call(TraceKernel kernel, uint64_t param,
+                       const std::vector<uint64_t>& paddrs,
+                       uint64_t** histogram, size_t num_rows,
+                       size_t num_cols) {
+  buffer_.clear();
+  buffer_.push_back(static_cast<uint8_t>(TraceRecord::CALL));
+  buffer_.push_back(static_cast<uint8_t>(kernel));
+  PutVarint(param, &buffer_);
+  PutVarint(paddrs.size(), &buffer_);
+  uint64_t previous = 0;
+  for (const auto& paddr : paddrs) {
+    PutVarint(ZigZag(paddr, previous), &buffer_);
+    previous = paddr;
+  }
+  PutVarint(num_rows, &buffer_);
+  PutVarint(num_cols, &buffer_);
+  for (size_t c = 0; c < num_cols; ++c) {
+    previous = 0;
+    for (size_t r = 0; r < num_rows; ++r) {
+      PutVarint(ZigZag(histogram[r][c], previous), &buffer_);
+      previous = histogram[r][c];
+    }
+  }
+  ofs_.write(reinterpret_cast<const char*>(buffer_.data()), buffer_.size());
+}
+
+void TraceWriter::Close() {
+  if (ofs_.is_open()) {
+    ofs_.close();
+  }
+}
+
+RecordingBackend::RecordingBackend(Backend* backend) : backend_(backend) {}
+
+RecordingBackend::~RecordingBackend() { writer_.Close(); }
+
+bool RecordingBackend::Open(std::string fname) {
+  std::vector<std::pair<std::string, std::string>> metadata = {
+      {"backend", backend_->Name()},
+      {"platform", GetPlatformProfile().name},
+      {"profile", GetPlatformProfile().ToString()},
+  };
+  return writer_.Open(fname, metadata);
+}
+
+char* RecordingBackend::MapPage(uint64_t page_size, bool huge) {
+  char* page = backend_->MapPage(page_size, huge);
+  if (page != nullptr) {
+    uint64_t vaddr = reinterpret_cast<uint64_t>(page);
+    uint64_t paddr = backend_->VirtToPhys(vaddr);
+    writer_.Page(page_size, paddr);
+    pages_.push_back({vaddr, paddr, page_size, huge});
+  }
+  return page;
+}
+
+void RecordingBackend::UnmapPage(char* page, uint64_t page_size) {
+  uint64_t vaddr = reinterpret_cast<uint64_t>(page);
+  pages_.erase(std::remove_if(pages_.begin(), pages_.end(),
+                              [vaddr](const Page& entry) {
+                                return entry.vaddr == vaddr;
+                              }),
+               pages_.end());
+  backend_->UnmapPage(page, page_size);
+}
+
+uint64_t RecordingBackend::VirtToPhys(uint64_t vaddr) {
+  return backend_->VirtToPhys(vaddr);
+}
+
+uint64_t RecordingBackend::Timestamp() { return backend_->Timestamp(); }
+
+uint64_t RecordingBackend::RandomSeed() {
+  uint64_t seed = backend_->RandomSeed();
+  writer_.Seed(seed);
+  return seed;
+}
+
+uint64_t RecordingBackend::Translate(uint64_t vaddr) {
+  for (const auto& page : pages_) {
+    if (page.huge && vaddr - page.vaddr < page.size) {
+      return page.paddr + (vaddr - page.vaddr);
+    }
+  }
+  return backend_->VirtToPhys(vaddr);
+}
+
+void RecordingBackend::AccessTimingSingleMemoryAccess(uint64_t addr,
+                                                      uint64_t** histogram) {
+  backend_->AccessTimingSingleMemoryAccess(addr, histogram);
+  writer_.Call(TraceKernel::SINGLE, 0, {Translate(addr)}, histogram,
+               SUDOKU_CONFLICT_NUM_ITERATION, 2);
+}
+
+void RecordingBackend::AccessTimingPairedMemoryAccess(uint64_t faddr,
+                                                      uint64_t saddr,
+                                                      uint64_t** histogram) {
+  backend_->AccessTimingPairedMemoryAccess(faddr, saddr, histogram);
+  writer_.Call(TraceKernel::PAIRED, 0, {Translate(faddr), Translate(saddr)},
+               histogram, SUDOKU_CONFLICT_NUM_ITERATION, 2);
+}
+
+void RecordingBackend::AccessTimingPairedMemoryAccessScheduled(
+    uint64_t faddr, uint64_t saddr, RefreshScheduler& scheduler,
+    uint64_t** histogram) {
+  backend_->AccessTimingPairedMemoryAccessScheduled(faddr, saddr, scheduler,
+                                                    histogram);
+  writer_.Call(TraceKernel::SCHEDULED, 0,
+               {Translate(faddr), Translate(saddr)}, histogram,
+               SUDOKU_SCHEDULED_CONFLICT_NUM_ITERATION, 2);
+}
+
+void RecordingBackend::AccessTimingBatchedPairedMemoryAccess(
+    const uint64_t* faddrs, const uint64_t* saddrs, size_t num_pairs,
+    uint64_t** histogram) {
+  backend_->AccessTimingBatchedPairedMemoryAccess(faddrs, saddrs, num_pairs,
+                                                  histogram);
+  std::vector<uint64_t> paddrs;
+  for (size_t k = 0; k < num_pairs; ++k) {
+    paddrs.push_back(Translate(faddrs[k]));
+    paddrs.push_back(Translate(saddrs[k]));
+  }
+  writer_.Call(TraceKernel::BATCHED, 0, paddrs, histogram, num_pairs,
+               SUDOKU_CONFLICT_NUM_ITERATION);
+}
+
+void RecordingBackend::MeasureRefreshSingleAccess(uint64_t addr,
+                                                  uint64_t** histogram) {
+  backend_->MeasureRefreshSingleAccess(addr, histogram);
+  writer_.Call(TraceKernel::REFRESH_SINGLE, 0, {Translate(addr)}, histogram,
+               SUDOKU_REFRESH_NUM_ITERATION, 2);
+}
+
+void RecordingBackend::MeasureRefreshPairedAccessCoarse(uint64_t faddr,
+                                                        uint64_t saddr,
+                                                        uint64_t** histogram) {
+  backend_->MeasureRefreshPairedAccessCoarse(faddr, saddr, histogram);
+  writer_.Call(TraceKernel::REFRESH_COARSE, 0,
+               {Translate(faddr), Translate(saddr)}, histogram,
+               SUDOKU_REFRESH_NUM_ITERATION, 2);
+}
+
+void RecordingBackend::MeasureRefreshPairedAccessFine(uint64_t faddr,
+                                                      uint64_t saddr,
+                                                      uint64_t** histogram) {
+  backend_->MeasureRefreshPairedAccessFine(faddr, saddr, histogram);
+  writer_.Call(TraceKernel::REFRESH_FINE, 0,
+               {Translate(faddr), Translate(saddr)}, histogram,
+               SUDOKU_REFRESH_NUM_ITERATION, 3);
+}
+
+void RecordingBackend::MeasureRefreshMultiAccess(const uint64_t* addrs,
+                                                 size_t num_addrs,
+                                                 uint64_t num_iterations,
+                                                 uint64_t** histogram) {
+  backend_->MeasureRefreshMultiAccess(addrs, num_addrs, num_iterations,
+                                      histogram);
+  std::vector<uint64_t> paddrs;
+  for (size_t k = 0; k < num_addrs; ++k) {
+    paddrs.push_back(Translate(addrs[k]));
+  }
+  writer_.Call(TraceKernel::REFRESH_MULTI, num_iterations, paddrs, histogram,
+               num_iterations, num_addrs + 1);
+}
+
+void RecordingBackend::ConsecutiveAccessLatency(ConsecutiveAccess pattern,
+                                                const uint64_t* faddrs,
+                                                const uint64_t* saddrs,
+                                                size_t length,
+                                                uint64_t** histogram) {
+  backend_->ConsecutiveAccessLatency(pattern, faddrs, saddrs, length,
+                                     histogram);
+  std::vector<uint64_t> paddrs;
+  for (size_t j = 0; j < length; ++j) {
+    paddrs.push_back(Translate(faddrs[j]));
+    paddrs.push_back(Translate(saddrs[j]));
+  }
+  writer_.Call(TraceKernel::CONSECUTIVE, static_cast<uint64_t>(pattern),
+               paddrs, histogram, SUDOKU_CONSECUTIVE_NUM_ITERATION, 2);
+}
+
+bool ReplayBackend::Open(std::string fname) {
+  std::ifstream ifs(fname, std::ios::binary);
+  if (!ifs.is_open()) {
+    PRINT_ERROR("Cannot open trace file: {}", fname);
+    return false;
+  }
+  data_.assign(std::istreambuf_iterator<char>(ifs),
+               std::istreambuf_iterator<char>());
+
+  TraceFileHeader header;
+  if (data_.size() < sizeof(header)) {
+    PRINT_ERROR("Not a trace file: {}", fname);
+    return false;
+  }
+  memcpy(&header, data_.data(), sizeof(header));
+  if (memcmp(header.magic, SUDOKU_TRACE_MAGIC, sizeof(header.magic)) != 0 ||
+      header.version != SUDOKU_TRACE_VERSION) {
+    PRINT_ERROR("Not a trace file (or unsupported version): {}", fname);
+    return false;
+  }
+
+  const uint8_t* p = data_.data() + sizeof(header);
+  const uint8_t* end = data_.data() + data_.size();
+  uint64_t num_entries;
+  if (!GetVarint(&p, end, &num_entries)) {
+    PRINT_ERROR("Corrupted trace metadata: {}", fname);
+    return false;
+  }
+  for (uint64_t i = 0; i < num_entries; ++i) {
+    std::string key, value;
+    if (!GetString(&p, end, &key) || !GetString(&p, end, &value)) {
+      PRINT_ERROR("Corrupted trace metadata: {}", fname);
+      return false;
+    }
+    metadata_.emplace_back(key, value);
+  }
+
+  // A killed recording may end with a partially written record
+  bool truncated = false;
+  while (p < end && !truncated) {
+    TraceRecord record = static_cast<TraceRecord>(*p++);
+    uint64_t value, paddr;
+    if (record == TraceRecord::SEED) {
+      truncated = !GetVarint(&p, end, &value);
+      if (!truncated) {
+        seeds_.push_back(value);
+      }
+    } else if (record == TraceRecord::PAGE) {
+      truncated = !GetVarint(&p, end, &value) || !GetVarint(&p, end, &paddr);
+      if (!truncated) {
+        frames_.emplace_back(value, paddr);
+      }
+    } else if (record == TraceRecord::CALL && p < end &&
+               *p < static_cast<uint8_t>(TraceKernel::NUM_KERNELS)) {
+      std::vector<uint64_t> key = {*p++};
+      uint64_t num_addrs = 0;
+      truncated = !GetVarint(&p, end, &value) ||
+                  !GetVarint(&p, end, &num_addrs);
+      key.push_back(value);
+      paddr = 0;
+      for (uint64_t k = 0; k < num_addrs && !truncated; ++k) {
+        truncated = !GetVarint(&p, end, &value);
+        paddr = UnZigZag(value, paddr);
+        key.push_back(paddr);
+      }
+      Call call;
+      truncated = truncated || !GetVarint(&p, end, &call.rows) ||
+                  !GetVarint(&p, end, &call.cols);
+      call.offset = p - data_.data();
+      for (uint64_t k = 0; k < call.rows * call.cols && !truncated; ++k) {
+        truncated = !GetVarint(&p, end, &value);
+      }
+      if (!truncated) {
+        Calls& calls = keys_[key];
+        calls.calls.push_back(calls_.size());
+        calls_.push_back(call);
+      }
+    } else {
+      PRINT_ERROR("Corrupted trace record at offset {}: {}",
+                  p - 1 - data_.data(), fname);
+      return false;
+    }
+  }
+  if (truncated) {
+    PRINT_WARNING("Trace {} ends with a truncated record", fname);
+  }
+  PRINT_INFO("Trace {}: {} calls ({} distinct), {} pages, {} seeds", fname,
+             calls_.size(), keys_.size(), frames_.size(), seeds_.size());
+  return true;
+}
+
+std::string ReplayBackend::Get(const std::string& key) const {
+  for (const auto& entry : metadata_) {
+    if (entry.first == key) {
+      return entry.second;
+    }
+  }
+  return "";
+}
+
+char* ReplayBackend::MapPage(uint64_t page_size, bool /* huge */) {
+  if (next_frame_ >= frames_.size() ||
+      frames_[next_frame_].first != page_size) {
+    PRINT_ERROR("The trace has no more recorded pages of {} bytes",
+                page_size);
+    return nullptr;
+  }
+  // Pages are never accessed, so an inaccessible reservation suffices
+  void* page = mmap(nullptr, page_size, PROT_NONE,
+                    MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  if (page == MAP_FAILED) {
+    return nullptr;
+  }
+  Page entry = {reinterpret_cast<uint64_t>(page),
+                frames_[next_frame_++].second, page_size};
+  auto it = std::upper_bound(
+      pages_.begin(), pages_.end(), entry,
+      [](const Page& a, const Page& b) { return a.vaddr < b.vaddr; });
+  pages_.insert(it, entry);
+  return static_cast<char*>(page);
+}
+
+void ReplayBackend::UnmapPage(char* page, uint64_t page_size) {
+  uint64_t vaddr = reinterpret_cast<uint64_t>(page);
+  pages_.erase(std::remove_if(pages_.begin(), pages_.end(),
+                              [vaddr](const Page& entry) {
+                                return entry.vaddr == vaddr;
+                              }),
+               pages_.end());
+  munmap(page, page_size);
+}
+
+uint64_t ReplayBackend::VirtToPhys(uint64_t vaddr) {
+  auto it = std::upper_bound(
+      pages_.begin(), pages_.end(), vaddr,
+      [](uint64_t addr, const Page& page) { return addr < page.vaddr; });
+  if (it == pages_.begin() || vaddr - (it - 1)->vaddr >= (it - 1)->size) {
+    return 0;
+  }
+  --it;
+  return it->paddr + (vaddr - it->vaddr);
+}
+
+uint64_t ReplayBackend::RandomSeed() {
+  if (seeds_.empty()) {
+    return std::random_device{}();
+  }
+  // More pools than recorded reuse the last seed
+  uint64_t seed = seeds_[std::min(next_seed_, seeds_.size() - 1)];
+  next_seed_++;
+  return seed;
+}
+
+void ReplayBackend::Replay(TraceKernel kernel, uint64_t param,
+                           const std::vector<uint64_t>& vaddrs,
+                           uint64_t** histogram, size_t num_rows,
+                           size_t num_cols) {
+  std::vector<uint64_t> key = {static_cast<uint64_t>(kernel), param};
+  for (const auto& vaddr : vaddrs) {
+    key.push_back(VirtToPhys(vaddr));
+  }
+  auto it = keys_.find(key);
+  if (it == keys_.end()) {
+    PRINT_ERROR("The trace has no {} measurement of {} (first of {} "
+                "addresses)",
+                TraceKernelStr[static_cast<int>(kernel)],
+                reinterpret_cast<void*>(key[2]), vaddrs.size());
+    exit(EXIT_FAILURE);
+  }
+
+  Calls& calls = it->second;
+  if (calls.next == calls.calls.size()) {
+    if (repeated_++ == 0) {
+      PRINT_WARNING("Replaying recorded measurements more than once");
+    }
+    calls.next = 0;
+  }
+  const Call& call = calls_[calls.calls[calls.next++]];
+  if (call.rows != num_rows || call.cols != num_cols) {
+    PRINT_ERROR("Recorded {} histogram is {}x{}, expected {}x{}",
+                TraceKernelStr[static_cast<int>(kernel)], call.rows,
+                call.cols, num_rows, num_cols);
+    exit(EXIT_FAILURE);
+  }
+
+  const uint8_t* p = data_.data() + call.offset;
+  const uint8_t* end = data_.data() + data_.size();
+  uint64_t value;
+  for (size_t c = 0; c < num_cols; ++c) {
+    uint64_t previous = 0;
+    for (size_t r = 0; r < num_rows; ++r) {
+      GetVarint(&p, end, &value);
+      previous = UnZigZag(value, previous);
+      histogram[r][c] = previous;
+    }
+  }
+}
+
+void ReplayBackend::AccessTimingSingleMemoryAccess(uint64_t addr,
+                                                   uint64_t** histogram) {
+  Replay(TraceKernel::SINGLE, 0, {addr}, histogram,
+         SUDOKU_CONFLICT_NUM_ITERATION, 2);
+}
+
+void ReplayBackend::AccessTimingPairedMemoryAccess(uint64_t faddr,
+                                                   uint64_t saddr,
+                                                   uint64_t** histogram) {
+  Replay(TraceKernel::PAIRED, 0, {faddr, saddr}, histogram,
+         SUDOKU_CONFLICT_NUM_ITERATION, 2);
+}
+
+void ReplayBackend::AccessTimingPairedMemoryAccessScheduled(
+    uint64_t faddr, uint64_t saddr, RefreshScheduler& /* scheduler */,
+    uint64_t** histogram) {
+  Replay(TraceKernel::SCHEDULED, 0, {faddr, saddr}, histogram,
+         SUDOKU_SCHEDULED_CONFLICT_NUM_ITERATION, 2);
+}
+
+void ReplayBackend::AccessTimingBatchedPairedMemoryAccess(
+    const uint64_t* faddrs, const uint64_t* saddrs, size_t num_pairs,
+    uint64_t** histogram) {
+  std::vector<uint64_t> vaddrs;
+  for (size_t k = 0; k < num_pairs; ++k) {
+    vaddrs.push_back(faddrs[k]);
+    vaddrs.push_back(saddrs[k]);
+  }
+  Replay(TraceKernel::BATCHED, 0, vaddrs, histogram, num_pairs,
+         SUDOKU_CONFLICT_NUM_ITERATION);
+}
+
+void ReplayBackend::MeasureRefreshSingleAccess(uint64_t addr,
+                                               uint64_t** histogram) {
+  Replay(TraceKernel::REFRESH_SINGLE, 0, {addr}, histogram,
+         SUDOKU_REFRESH_NUM_ITERATION, 2);
+}
+
+void ReplayBackend::MeasureRefreshPairedAccessCoarse(uint64_t faddr,
+                                                     uint64_t saddr,
+                                                     uint64_t** histogram) {
+  Replay(TraceKernel::REFRESH_COARSE, 0, {faddr, saddr}, histogram,
+         SUDOKU_REFRESH_NUM_ITERATION, 2);
+}
+
+void ReplayBackend::MeasureRefreshPairedAccessFine(uint64_t faddr,
+                                                   uint64_t saddr,
+                                                   uint64_t** histogram) {
+  Replay(TraceKernel::REFRESH_FINE, 0, {faddr, saddr}, histogram,
+         SUDOKU_REFRESH_NUM_ITERATION, 3);
+}
+
+void ReplayBackend::MeasureRefreshMultiAccess(const uint64_t* addrs,
+                                              size_t num_addrs,
+                                              uint64_t num_iterations,
+                                              uint64_t** histogram) {
+  std::vector<uint64_t> vaddrs(addrs, addrs + num_addrs);
+  Replay(TraceKernel::REFRESH_MULTI, num_iterations, vaddrs, histogram,
+         num_iterations, num_addrs + 1);
+}
+
+void ReplayBackend::ConsecutiveAccessLatency(ConsecutiveAccess pattern,
+                                             const uint64_t* faddrs,
+                                             const uint64_t* saddrs,
+                                             size_t length,
+                                             uint64_t** histogram) {
+  std::vector<uint64_t> vaddrs;
+  for (size_t j = 0; j < length; ++j) {
+    vaddrs.push_back(faddrs[j]);
+    vaddrs.push_back(saddrs[j]);
+  }
+  Replay(TraceKernel::CONSECUTIVE, static_cast<uint64_t>(pattern), vaddrs,
+         histogram, SUDOKU_CONSECUTIVE_NUM_ITERATION, 2);
+}
+
+void InitRecordingBackend(const std::string& fname) {
+  RecordingBackend* backend = new RecordingBackend(ReleaseBackend());
+  if (!backend->Open(fname)) {
+    delete backend;
+    exit(EXIT_FAILURE);
+  }
+  SetBackend(backend);
+  PRINT_INFO("Recording oracle calls to {}", fname);
+}
+
+std::string InitReplayBackend(const std::string& fname) {
+  ReplayBackend* backend = new ReplayBackend();
+  if (!backend->Open(fname)) {
+    delete backend;
+    exit(EXIT_FAILURE);
+  }
+  std::string platform = backend->Get("platform");
+  PRINT_INFO("Replaying {} (recorded on the {} backend, profile {})", fname,
+             backend->Get("backend"), platform);
+  SetBackend(backend);
+  return platform;
+}
+
+}  // namespace sudoku
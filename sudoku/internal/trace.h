@@ -0,0 +1,251 @@
+#ifndef SUDOKU_INTERNAL_TRACE_H
+#define SUDOKU_INTERNAL_TRACE_H
+
+#include <stddef.h>
+
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "backend.h"
+
+namespace sudoku {
+
+#define SUDOKU_TRACE_MAGIC "SDKTRC1"
+#define SUDOKU_TRACE_VERSION 1
+
+// Kernels of the oracles, in the order of the Backend interface
+enum class TraceKernel : uint8_t {
+  SINGLE = 0,
+  PAIRED,
+  SCHEDULED,
+  BATCHED,
+  REFRESH_SINGLE,
+  REFRESH_COARSE,
+  REFRESH_FINE,
+  REFRESH_MULTI,
+  CONSECUTIVE,
+  NUM_KERNELS,
+};
+
+static const std::string TraceKernelStr[] = {
+    "single",
+    "paired",
+    "scheduled",
+    "batched",
+    "refresh_single",
+    "refresh_coarse",
+    "refresh_fine",
+    "refresh_multi",
+    "consecutive",
+};
+
+// Records of a trace file, in call order
+enum class TraceRecord : uint8_t {
+  SEED = 0,  // seed: varint
+  PAGE,      // page size, physical address: varints
+  CALL,      // see TraceWriter::Call
+};
+
+/// @brief Header of a trace file, followed by the metadata (a varint count
+/// of length-prefixed key and value strings) and the records
+struct TraceFileHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t reserved;
+};
+
+/// @brief Trace file writer. A call stores the kernel, its parameter (the
+/// access pattern or iteration count), the physical addresses as zigzag
+/// deltas, and the histogram column by column as zigzag deltas, so
+/// timestamps and similar latencies take one or two bytes per sample.
+class TraceWriter {
+ public:
+  TraceWriter() = default;
+  TraceWriter(const TraceWriter&) = delete;
+  TraceWriter& operator=(const TraceWriter&) = delete;
+
+  bool Open(std::string fname,
+            const std::vector<std::pair<std::string, std::string>>& metadata);
+  void Seed(uint64_t seed);
+  void Page(uint64_t page_size, uint64_t paddr);
+  void Call(TraceKernel kernel, uint64_t param,
+            const std::vector<uint64_t>& paddrs, uint64_t** histogram,
+            size_t num_rows, size_t num_cols);
+  void Close();
+
+ private:
+  std::ofstream ofs_;
+  std::vector<uint8_t> buffer_;
+};
+
+/// @brief Backend recording every page, seed, and kernel call of another
+/// backend into a trace file. Addresses are recorded physical, so a replay
+/// may map its pages anywhere.
+class RecordingBackend : public Backend {
+ public:
+  // Takes ownership of backend
+  explicit RecordingBackend(Backend* backend);
+  ~RecordingBackend() override;
+
+  // Create fname with the wrapped backend and platform profile as metadata
+  bool Open(std::string fname);
+
+  std::string Name() const override { return "recording"; }
+
+  char* MapPage(uint64_t page_size, bool huge) override;
+  void UnmapPage(char* page, uint64_t page_size) override;
+  uint64_t VirtToPhys(uint64_t vaddr) override;
+
+  uint64_t Timestamp() override;
+  uint64_t RandomSeed() override;
+
+  void AccessTimingSingleMemoryAccess(uint64_t addr,
+                                      uint64_t** histogram) override;
+  void AccessTimingPairedMemoryAccess(uint64_t faddr, uint64_t saddr,
+                                      uint64_t** histogram) override;
+  void AccessTimingPairedMemoryAccessScheduled(uint64_t faddr, uint64_t saddr,
+                                               RefreshScheduler& scheduler,
+                                               uint64_t** histogram) override;
+  void AccessTimingBatchedPairedMemoryAccess(const uint64_t* faddrs,
+                                             const uint64_t* saddrs,
+                                             size_t num_pairs,
+                                             uint64_t** histogram) override;
+
+  void MeasureRefreshSingleAccess(uint64_t addr,
+                                  uint64_t** histogram) override;
+  void MeasureRefreshPairedAccessCoarse(uint64_t faddr, uint64_t saddr,
+                                        uint64_t** histogram) override;
+  void MeasureRefreshPairedAccessFine(uint64_t faddr, uint64_t saddr,
+                                      uint64_t** histogram) override;
+  void MeasureRefreshMultiAccess(const uint64_t* addrs, size_t num_addrs,
+                                 uint64_t num_iterations,
+                                 uint64_t** histogram) override;
+
+  void ConsecutiveAccessLatency(ConsecutiveAccess pattern,
+                                const uint64_t* faddrs, const uint64_t* saddrs,
+                                size_t length, uint64_t** histogram) override;
+
+ private:
+  /// @brief Pool page of the wrapped backend
+  struct Page {
+    uint64_t vaddr;
+    uint64_t paddr;
+    uint64_t size;
+    bool huge;
+  };
+
+  // Physical address without a pagemap read for (contiguous) huge pages
+  uint64_t Translate(uint64_t vaddr);
+
+  std::unique_ptr<Backend> backend_;
+  TraceWriter writer_;
+  std::vector<Page> pages_;
+};
+
+/// @brief Backend answering the oracles from a trace file. Pages replay the
+/// recorded physical frames (as inaccessible reservations) and seeds, so an
+/// unchanged run issues the recorded calls in order. Each call is matched by
+/// its kernel, parameter, and physical addresses, and takes the next
+/// recorded histogram of that key (wrapping around when a changed algorithm
+/// repeats a call more often than recorded).
+class ReplayBackend : public Backend {
+ public:
+  ReplayBackend() = default;
+  ReplayBackend(const ReplayBackend&) = delete;
+  ReplayBackend& operator=(const ReplayBackend&) = delete;
+
+  bool Open(std::string fname);
+  std::string Get(const std::string& key) const;
+
+  std::string Name() const override { return "replay"; }
+
+  char* MapPage(uint64_t page_size, bool huge) override;
+  void UnmapPage(char* page, uint64_t page_size) override;
+  uint64_t VirtToPhys(uint64_t vaddr) override;
+
+  // Replayed kernels do not wait for the refresh scheduler, so timestamps
+  // only need to be monotonic
+  uint64_t Timestamp() override { return ++clock_; }
+  uint64_t RandomSeed() override;
+
+  void AccessTimingSingleMemoryAccess(uint64_t addr,
+                                      uint64_t** histogram) override;
+  void AccessTimingPairedMemoryAccess(uint64_t faddr, uint64_t saddr,
+                                      uint64_t** histogram) override;
+  void AccessTimingPairedMemoryAccessScheduled(uint64_t faddr, uint64_t saddr,
+                                               RefreshScheduler& scheduler,
+                                               uint64_t** histogram) override;
+  void AccessTimingBatchedPairedMemoryAccess(const uint64_t* faddrs,
+                                             const uint64_t* saddrs,
+                                             size_t num_pairs,
+                                             uint64_t** histogram) override;
+
+  void MeasureRefreshSingleAccess(uint64_t addr,
+                                  uint64_t** histogram) override;
+  void MeasureRefreshPairedAccessCoarse(uint64_t faddr, uint64_t saddr,
+                                        uint64_t** histogram) override;
+  void MeasureRefreshPairedAccessFine(uint64_t faddr, uint64_t saddr,
+                                      uint64_t** histogram) override;
+  void MeasureRefreshMultiAccess(const uint64_t* addrs, size_t num_addrs,
+                                 uint64_t num_iterations,
+                                 uint64_t** histogram) override;
+
+  void ConsecutiveAccessLatency(ConsecutiveAccess pattern,
+                                const uint64_t* faddrs, const uint64_t* saddrs,
+                                size_t length, uint64_t** histogram) override;
+
+ private:
+  /// @brief Recorded call (samples are decoded on demand)
+  struct Call {
+    uint64_t rows;
+    uint64_t cols;
+    size_t offset;  // of the encoded samples in data_
+  };
+
+  /// @brief Recorded calls of one key and the next one to replay
+  struct Calls {
+    std::vector<size_t> calls;
+    size_t next;
+  };
+
+  /// @brief Replayed page (virtual reservation and recorded frame)
+  struct Page {
+    uint64_t vaddr;
+    uint64_t paddr;
+    uint64_t size;
+  };
+
+  // Fill histogram with the next recorded call of the key; exits if the
+  // trace has none
+  void Replay(TraceKernel kernel, uint64_t param,
+              const std::vector<uint64_t>& vaddrs, uint64_t** histogram,
+              size_t num_rows, size_t num_cols);
+
+  std::vector<uint8_t> data_;
+  std::vector<std::pair<std::string, std::string>> metadata_;
+  std::vector<uint64_t> seeds_;
+  std::vector<std::pair<uint64_t, uint64_t>> frames_;  // size, paddr
+  std::vector<Call> calls_;
+  std::map<std::vector<uint64_t>, Calls> keys_;
+  size_t next_seed_ = 0;
+  size_t next_frame_ = 0;
+  std::vector<Page> pages_;  // sorted by vaddr
+  uint64_t clock_ = 0;
+  uint64_t repeated_ = 0;
+};
+
+// Wrap the active backend into a recording backend writing fname (after the
+// platform profile is initialized, which is recorded). Exits on failure.
+void InitRecordingBackend(const std::string& fname);
+// Make a replay backend of fname the active backend and return the platform
+// profile name of the recorded run. Exits on failure.
+std::string InitReplayBackend(const std::string& fname);
+
+}  // namespace sudoku
+
+#endif  // SUDOKU_INTERNAL_TRACE_H
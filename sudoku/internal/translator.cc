@@ -0,0 +1,377 @@
+#include "translator.h"
+
+#include <immintrin.h>
+
+#include <algorithm>
+
+#include "utils.h"
+
+namespace sudoku {
+
+// Bits of addr under mask, packed in order (software pext)
+static uint64_t ExtractBits(uint64_t mask, uint64_t addr) {
+  uint64_t retval = 0, bitpos = 0;
+  for (; mask; mask &= mask - 1) {
+    uint64_t bit = mask & (~mask + 1);
+    retval |= static_cast<uint64_t>((addr & bit) != 0) << (bitpos++);
+  }
+  return retval;
+}
+
+// XOR of the table entries of the lowest N lanes, unrolled at compile time
+// so every shift is a constant
+template <size_t N>
+struct LaneLookup {
+  static uint64_t Encode(const uint64_t* tables, uint64_t paddr) {
+    return LaneLookup<N - 1>::Encode(tables, paddr) ^
+           tables[(N - 1) * 256 + ((paddr >> (8 * (N - 1))) & 0xff)];
+  }
+};
+
+template <>
+struct LaneLookup<0> {
+  static uint64_t Encode(const uint64_t*, uint64_t) { return 0; }
+};
+
+// Values of a batch are independent, so their lookups overlap
+template <size_t N>
+static void LookupLanes(const uint64_t* values, size_t count,
+                        const uint64_t* tables, uint64_t* results) {
+  for (size_t i = 0; i < count; ++i) {
+    results[i] = LaneLookup<N>::Encode(tables, values[i]);
+  }
+}
+
+static void LookupBatch(uint32_t num_lanes, const uint64_t* tables,
+                        const uint64_t* values, size_t count,
+                        uint64_t* results) {
+  switch (num_lanes) {
+    case 0:
+      std::fill(results, results + count, 0);
+      break;
+    case 1:
+      LookupLanes<1>(values, count, tables, results);
+      break;
+    case 2:
+      LookupLanes<2>(values, count, tables, results);
+      break;
+    case 3:
+      LookupLanes<3>(values, count, tables, results);
+      break;
+    case 4:
+      LookupLanes<4>(values, count, tables, results);
+      break;
+    case 5:
+      LookupLanes<5>(values, count, tables, results);
+      break;
+    case 6:
+      LookupLanes<6>(values, count, tables, results);
+      break;
+    case 7:
+      LookupLanes<7>(values, count, tables, results);
+      break;
+    default:
+      LookupLanes<8>(values, count, tables, results);
+      break;
+  }
+}
+
+static uint64_t Lookup(uint32_t num_lanes, const std::vector<uint64_t>& tables,
+                       uint64_t value) {
+  uint64_t result = 0;
+  for (uint32_t lane = 0; lane < num_lanes; ++lane) {
+    result ^= tables[lane * 256 + ((value >> (8 * lane)) & 0xff)];
+  }
+  return result;
+}
+
+__attribute__((target("bmi2,popcnt"))) static void PextBatch(
+    const uint64_t* paddrs, size_t count,
+    const std::vector<uint64_t>* const* functions, uint64_t row_bits,
+    uint64_t column_bits, DRAMCoordinate* coordinates) {
+  for (size_t i = 0; i < count; ++i) {
+    uint64_t paddr = paddrs[i];
+    uint32_t components[4];
+    for (size_t c = 0; c < 4; ++c) {
+      uint32_t value = 0, bitpos = 0;
+      for (const auto& function : *functions[c]) {
+        value |= (__builtin_popcountll(function & paddr) & 1) << (bitpos++);
+      }
+      components[c] = value;
+    }
+    coordinates[i].channel = components[0];
+    coordinates[i].rank = components[1];
+    coordinates[i].bank_group = components[2];
+    coordinates[i].bank = components[3];
+    coordinates[i].row = static_cast<uint32_t>(_pext_u64(paddr, row_bits));
+    coordinates[i].column =
+        static_cast<uint32_t>(_pext_u64(paddr, column_bits));
+  }
+}
+
+DRAMTranslator::DRAMTranslator()
+    : row_bits_(0),
+      column_bits_(0),
+      shifts_{0, 0, 0, 0, 0, 0},
+      masks_{0, 0, 0, 0, 0, 0},
+      num_lanes_(0),
+      tables_(),
+      invertible_(false),
+      pivot_bits_(0),
+      num_code_lanes_(0),
+      inverse_tables_() {}
+
+bool DRAMTranslator::Build(const std::vector<uint64_t>& channel_functions,
+                           const std::vector<uint64_t>& rank_functions,
+                           const std::vector<uint64_t>& bank_group_functions,
+                           const std::vector<uint64_t>& bank_address_functions,
+                           uint64_t row_bits, uint64_t column_bits) {
+  uint64_t widths[6] = {channel_functions.size(),
+                        rank_functions.size(),
+                        bank_group_functions.size(),
+                        bank_address_functions.size(),
+                        static_cast<uint64_t>(__builtin_popcountll(row_bits)),
+                        static_cast<uint64_t>(
+                            __builtin_popcountll(column_bits))};
+  uint64_t total = 0;
+  for (size_t c = 0; c < 6; ++c) {
+    if (widths[c] > 32) {
+      PRINT_ERROR("DRAM coordinate component wider than 32 bits: {}",
+                  widths[c]);
+      return false;
+    }
+    total += widths[c];
+  }
+  if (total > 64) {
+    PRINT_ERROR("DRAM coordinates wider than 64 bits: {}", total);
+    return false;
+  }
+  total = 0;
+  for (size_t c = 0; c < 6; ++c) {
+    shifts_[c] = (widths[c] > 0) ? total : 0;
+    masks_[c] = (widths[c] > 0) ? ((1ULL << widths[c]) - 1) : 0;
+    total += widths[c];
+  }
+
+  channel_functions_ = channel_functions;
+  rank_functions_ = rank_functions;
+  bank_group_functions_ = bank_group_functions;
+  bank_address_functions_ = bank_address_functions;
+  row_bits_ = row_bits;
+  column_bits_ = column_bits;
+
+  uint64_t mapped = row_bits | column_bits;
+  for (const auto* functions :
+       {&channel_functions, &rank_functions, &bank_group_functions,
+        &bank_address_functions}) {
+    for (const auto& function : *functions) {
+      mapped |= function;
+    }
+  }
+
+  // Coordinates are linear, so the entry of a byte value is the packed
+  // coordinates of that byte alone
+  num_lanes_ = 0;
+  while (num_lanes_ < SUDOKU_TRANSLATOR_NUM_LANES &&
+         (mapped >> (8 * num_lanes_)) != 0) {
+    ++num_lanes_;
+  }
+  tables_.clear();
+  for (uint32_t lane = 0; lane < num_lanes_; ++lane) {
+    for (uint64_t value = 0; value < 256; ++value) {
+      DRAMCoordinate coordinate = TranslateReference(value << (8 * lane));
+      uint64_t components[6] = {coordinate.channel, coordinate.rank,
+                                coordinate.bank_group, coordinate.bank,
+                                coordinate.row, coordinate.column};
+      uint64_t code = 0;
+      for (size_t c = 0; c < 6; ++c) {
+        code |= components[c] << shifts_[c];
+      }
+      tables_.push_back(code);
+    }
+  }
+
+  // Address masks of the coordinate bits, in packed order, reduced over
+  // GF(2) (Gauss-Jordan); combinations[i] tracks the coordinate bits summed
+  // into rows[i]. With one pivot address bit per row and all other address
+  // bits fixed, pivot bit p_i of the inverse is the parity of the
+  // coordinate bits under combinations[i].
+  std::vector<uint64_t> rows;
+  for (const auto* functions :
+       {&channel_functions, &rank_functions, &bank_group_functions,
+        &bank_address_functions}) {
+    rows.insert(rows.end(), functions->begin(), functions->end());
+  }
+  for (uint64_t bits : {row_bits, column_bits}) {
+    for (; bits; bits &= bits - 1) {
+      rows.push_back(bits & (~bits + 1));
+    }
+  }
+  std::vector<uint64_t> combinations(rows.size());
+  for (size_t i = 0; i < rows.size(); ++i) {
+    combinations[i] = 1ULL << i;
+  }
+  std::vector<int> pivots(rows.size(), -1);
+  size_t rank = 0;
+  for (int bit = 63; bit >= 0 && rank < rows.size(); --bit) {
+    size_t pivot = rank;
+    while (pivot < rows.size() && !((rows[pivot] >> bit) & 1)) {
+      ++pivot;
+    }
+    if (pivot == rows.size()) {
+      continue;
+    }
+    std::swap(rows[rank], rows[pivot]);
+    std::swap(combinations[rank], combinations[pivot]);
+    for (size_t i = 0; i < rows.size(); ++i) {
+      if (i != rank && ((rows[i] >> bit) & 1)) {
+        rows[i] ^= rows[rank];
+        combinations[i] ^= combinations[rank];
+      }
+    }
+    pivots[rank++] = bit;
+  }
+  invertible_ = (rank == rows.size());
+  pivot_bits_ = 0;
+  num_code_lanes_ = 0;
+  inverse_tables_.clear();
+  if (!invertible_) {
+    PRINT_WARNING("DRAM address mapping is not invertible: {} of {} "
+                  "coordinate bits are independent",
+                  rank, rows.size());
+    return true;
+  }
+  // Address of each coordinate bit alone, then tables per byte of the
+  // packed coordinates as for the forward direction
+  std::vector<uint64_t> addresses(rows.size(), 0);
+  for (size_t i = 0; i < rows.size(); ++i) {
+    pivot_bits_ |= 1ULL << pivots[i];
+    for (size_t j = 0; j < rows.size(); ++j) {
+      if ((combinations[i] >> j) & 1) {
+        addresses[j] |= 1ULL << pivots[i];
+      }
+    }
+  }
+  num_code_lanes_ = static_cast<uint32_t>((rows.size() + 7) / 8);
+  for (uint32_t lane = 0; lane < num_code_lanes_; ++lane) {
+    for (uint64_t value = 0; value < 256; ++value) {
+      uint64_t paddr = 0;
+      for (size_t b = 0; b < 8 && 8 * lane + b < rows.size(); ++b) {
+        if ((value >> b) & 1) {
+          paddr ^= addresses[8 * lane + b];
+        }
+      }
+      inverse_tables_.push_back(paddr);
+    }
+  }
+  return true;
+}
+
+bool DRAMTranslator::Build(const MappingArtifact& mapping) {
+  std::vector<uint64_t> bank_address_functions =
+      mapping.Functions(FunctionRole::BANK_ADDRESS);
+  std::vector<uint64_t> unknown_functions =
+      mapping.Functions(FunctionRole::UNKNOWN);
+  bank_address_functions.insert(bank_address_functions.end(),
+                                unknown_functions.begin(),
+                                unknown_functions.end());
+  return Build(mapping.Functions(FunctionRole::CHANNEL),
+               mapping.Functions(FunctionRole::RANK),
+               mapping.Functions(FunctionRole::BANK_GROUP),
+               bank_address_functions, mapping.row_bits, mapping.column_bits);
+}
+
+uint64_t DRAMTranslator::Encode(uint64_t paddr) const {
+  return Lookup(num_lanes_, tables_, paddr);
+}
+
+uint64_t DRAMTranslator::Pack(const DRAMCoordinate& coordinate) const {
+  return ((coordinate.channel & masks_[0]) << shifts_[0]) |
+         ((coordinate.rank & masks_[1]) << shifts_[1]) |
+         ((coordinate.bank_group & masks_[2]) << shifts_[2]) |
+         ((coordinate.bank & masks_[3]) << shifts_[3]) |
+         ((coordinate.row & masks_[4]) << shifts_[4]) |
+         ((coordinate.column & masks_[5]) << shifts_[5]);
+}
+
+DRAMCoordinate DRAMTranslator::Unpack(uint64_t code) const {
+  DRAMCoordinate coordinate;
+  coordinate.channel = static_cast<uint32_t>((code >> shifts_[0]) & masks_[0]);
+  coordinate.rank = static_cast<uint32_t>((code >> shifts_[1]) & masks_[1]);
+  coordinate.bank_group =
+      static_cast<uint32_t>((code >> shifts_[2]) & masks_[2]);
+  coordinate.bank = static_cast<uint32_t>((code >> shifts_[3]) & masks_[3]);
+  coordinate.row = static_cast<uint32_t>((code >> shifts_[4]) & masks_[4]);
+  coordinate.column = static_cast<uint32_t>((code >> shifts_[5]) & masks_[5]);
+  return coordinate;
+}
+
+void DRAMTranslator::EncodeBatch(const uint64_t* paddrs, size_t count,
+                                 uint64_t* codes) const {
+  LookupBatch(num_lanes_, tables_.data(), paddrs, count, codes);
+}
+
+uint64_t DRAMTranslator::Decode(uint64_t code, uint64_t base) const {
+  return base ^ Lookup(num_code_lanes_, inverse_tables_, code ^ Encode(base));
+}
+
+void DRAMTranslator::DecodeBatch(const uint64_t* codes, size_t count,
+                                 uint64_t base, uint64_t* paddrs) const {
+  // Decode is linear: base ^ inverse(code) ^ inverse(Encode(base))
+  uint64_t offset = Decode(0, base);
+  LookupBatch(num_code_lanes_, inverse_tables_.data(), codes, count, paddrs);
+  for (size_t i = 0; i < count; ++i) {
+    paddrs[i] ^= offset;
+  }
+}
+
+void DRAMTranslator::TranslateBatch(const uint64_t* paddrs, size_t count,
+                                    DRAMCoordinate* coordinates,
+                                    TranslationMethod method) const {
+  if (method == TranslationMethod::PEXT && PextSupported()) {
+    TranslatePext(paddrs, count, coordinates);
+  } else if (method == TranslationMethod::LOOKUP) {
+    // Encode in blocks that stay in L1 before unpacking
+    uint64_t codes[256];
+    for (size_t i = 0; i < count; i += 256) {
+      size_t block = std::min(count - i, static_cast<size_t>(256));
+      EncodeBatch(paddrs + i, block, codes);
+      for (size_t j = 0; j < block; ++j) {
+        coordinates[i + j] = Unpack(codes[j]);
+      }
+    }
+  } else {
+    for (size_t i = 0; i < count; ++i) {
+      coordinates[i] = TranslateReference(paddrs[i]);
+    }
+  }
+}
+
+bool DRAMTranslator::PextSupported() {
+  return __builtin_cpu_supports("bmi2");
+}
+
+DRAMCoordinate DRAMTranslator::TranslateReference(uint64_t paddr) const {
+  DRAMCoordinate coordinate;
+  coordinate.channel = static_cast<uint32_t>(
+      XORReductionWithMasks(channel_functions_, paddr));
+  coordinate.rank =
+      static_cast<uint32_t>(XORReductionWithMasks(rank_functions_, paddr));
+  coordinate.bank_group = static_cast<uint32_t>(
+      XORReductionWithMasks(bank_group_functions_, paddr));
+  coordinate.bank = static_cast<uint32_t>(
+      XORReductionWithMasks(bank_address_functions_, paddr));
+  coordinate.row = static_cast<uint32_t>(ExtractBits(row_bits_, paddr));
+  coordinate.column = static_cast<uint32_t>(ExtractBits(column_bits_, paddr));
+  return coordinate;
+}
+
+void DRAMTranslator::TranslatePext(const uint64_t* paddrs, size_t count,
+                                   DRAMCoordinate* coordinates) const {
+  const std::vector<uint64_t>* functions[4] = {
+      &channel_functions_, &rank_functions_, &bank_group_functions_,
+      &bank_address_functions_};
+  PextBatch(paddrs, count, functions, row_bits_, column_bits_, coordinates);
+}
+
+}  // namespace sudoku
@@ -0,0 +1,117 @@
+#ifndef SUDOKU_INTERNAL_TRANSLATOR_H
+#define SUDOKU_INTERNAL_TRANSLATOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "mapping.h"
+
+namespace sudoku {
+
+// Byte lanes of a physical address, one lookup table each
+#define SUDOKU_TRANSLATOR_NUM_LANES 8
+
+/// @brief DRAM coordinates of a physical address. Components are the
+/// XOR-reductions of their functions (function i is bit i, as in
+/// XORReductionWithMasks); rows and columns are their bits packed in address
+/// order.
+struct DRAMCoordinate {
+  uint32_t channel;
+  uint32_t rank;  // DIMM, rank, and sub-channel functions
+  uint32_t bank_group;
+  uint32_t bank;  // bank address within the bank group
+  uint32_t row;
+  uint32_t column;
+};
+
+// Decoding methods of DRAMTranslator
+enum class TranslationMethod : uint8_t {
+  REFERENCE = 0,  // XORReductionWithMasks per component
+  LOOKUP,         // byte-sliced lookup tables
+  PEXT,           // BMI2 pext (rows and columns) and parity (functions)
+};
+
+/// @brief Translates physical addresses (PCI offset removed) into DRAM
+/// coordinates under a known mapping. All coordinates are linear over GF(2)
+/// in the address bits, so the packed coordinates of an address are the XOR
+/// of one table entry per byte lane up to the highest mapped bit. The lookup
+/// tables are the default: pext is microcoded and slow on AMD processors
+/// before Zen 3. The inverse (coordinates to address) is precomputed by
+/// Gauss-Jordan elimination into tables over the packed coordinates.
+class DRAMTranslator {
+ public:
+  DRAMTranslator();
+
+  // Fails if the packed coordinates do not fit in 64 bits or a component
+  // does not fit in 32 bits
+  bool Build(const std::vector<uint64_t>& channel_functions,
+             const std::vector<uint64_t>& rank_functions,
+             const std::vector<uint64_t>& bank_group_functions,
+             const std::vector<uint64_t>& bank_address_functions,
+             uint64_t row_bits, uint64_t column_bits);
+  // Functions of unknown role (mapping not decomposed) are bank address
+  // functions, so banks are still told apart
+  bool Build(const MappingArtifact& mapping);
+
+  // Packed coordinates: the components of DRAMCoordinate from the least
+  // significant bit up, each as wide as its functions or bits
+  uint64_t Encode(uint64_t paddr) const;
+  DRAMCoordinate Unpack(uint64_t code) const;
+  DRAMCoordinate Translate(uint64_t paddr) const {
+    return Unpack(Encode(paddr));
+  }
+
+  void EncodeBatch(const uint64_t* paddrs, size_t count, uint64_t* codes) const;
+  void TranslateBatch(
+      const uint64_t* paddrs, size_t count, DRAMCoordinate* coordinates,
+      TranslationMethod method = TranslationMethod::LOOKUP) const;
+
+  // Inverse, if the functions and bits are linearly independent: physical
+  // address (PCI offset removed) of packed coordinates. Address bits the
+  // mapping does not determine (outside PivotBits, e.g., the cacheline
+  // offset) are taken from base.
+  bool Invertible() const { return invertible_; }
+  uint64_t PivotBits() const { return pivot_bits_; }
+  uint64_t Pack(const DRAMCoordinate& coordinate) const;
+  uint64_t Decode(uint64_t code, uint64_t base = 0) const;
+  uint64_t PhysicalAddress(const DRAMCoordinate& coordinate,
+                           uint64_t base = 0) const {
+    return Decode(Pack(coordinate), base);
+  }
+  void DecodeBatch(const uint64_t* codes, size_t count, uint64_t base,
+                   uint64_t* paddrs) const;
+
+  // False if the processor lacks BMI2 (PEXT then falls back to REFERENCE)
+  static bool PextSupported();
+
+ private:
+  DRAMCoordinate TranslateReference(uint64_t paddr) const;
+  void TranslatePext(const uint64_t* paddrs, size_t count,
+                     DRAMCoordinate* coordinates) const;
+
+  std::vector<uint64_t> channel_functions_;
+  std::vector<uint64_t> rank_functions_;
+  std::vector<uint64_t> bank_group_functions_;
+  std::vector<uint64_t> bank_address_functions_;
+  uint64_t row_bits_;
+  uint64_t column_bits_;
+  // Bit offset and mask of each component in the packed coordinates, in the
+  // order of DRAMCoordinate (empty components have offset 0 and mask 0)
+  uint64_t shifts_[6];
+  uint64_t masks_[6];
+  // Lanes up to the highest mapped bit (lane i holds address bits 8i to
+  // 8i+7), and their tables
+  uint32_t num_lanes_;
+  std::vector<uint64_t> tables_;  // num_lanes_ x 256
+  // Inverse: one address bit per coordinate bit (pivots), and the tables of
+  // the bytes of the packed coordinates
+  bool invertible_;
+  uint64_t pivot_bits_;
+  uint32_t num_code_lanes_;
+  std::vector<uint64_t> inverse_tables_;  // num_code_lanes_ x 256
+};
+
+}  // namespace sudoku
+
+#endif  // SUDOKU_INTERNAL_TRANSLATOR_H
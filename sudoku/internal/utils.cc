@@ -4,6 +4,7 @@
 #include <bitset>
 #include <cmath>
 #include <numeric>
+#include <string>
 #include <vector>
 
 #include "constants.h"
@@ -158,6 +159,193 @@ void GetStatistics(std::vector<uint64_t>& values, uint64_t* results) {
   results[3] = values.back();
 }
 
+void RunningStatistics::Reset() {
+  count = 0;
+  mean = 0.0;
+  m2 = 0.0;
+  minimum = UINT64_MAX;
+  maximum = 0;
+  for (size_t i = 0; i < 5; ++i) {
+    heights[i] = 0.0;
+    positions[i] = static_cast<double>(i);
+    desired[i] = static_cast<double>(i);
+  }
+}
+
+void RunningStatistics::Add(uint64_t value) {
+  double x = static_cast<double>(value);
+  count++;
+  double delta = x - mean;
+  mean += delta / count;
+  m2 += delta * (x - mean);
+  minimum = std::min(minimum, value);
+  maximum = std::max(maximum, value);
+
+  // The first five values are kept sorted as the initial markers
+  if (count <= 5) {
+    size_t i = count - 1;
+    while (i > 0 && heights[i - 1] > x) {
+      heights[i] = heights[i - 1];
+      --i;
+    }
+    heights[i] = x;
+    return;
+  }
+
+  // Find the cell of the new value and shift the markers above it
+  size_t k;
+  if (x < heights[0]) {
+    heights[0] = x;
+    k = 0;
+  } else if (x >= heights[4]) {
+    heights[4] = x;
+    k = 3;
+  } else {
+    k = 0;
+    while (k < 3 && x >= heights[k + 1]) {
+      ++k;
+    }
+  }
+  for (size_t i = k + 1; i < 5; ++i) {
+    positions[i] += 1.0;
+  }
+  const double increments[5] = {0.0, 0.25, 0.5, 0.75, 1.0};
+  for (size_t i = 0; i < 5; ++i) {
+    desired[i] += increments[i];
+  }
+
+  // Adjust the middle markers with the piecewise-parabolic formula, falling
+  // back to linear interpolation when the parabola leaves the cell
+  for (size_t i = 1; i < 4; ++i) {
+    double d = desired[i] - positions[i];
+    if ((d >= 1.0 && positions[i + 1] - positions[i] > 1.0) ||
+        (d <= -1.0 && positions[i - 1] - positions[i] < -1.0)) {
+      double s = (d > 0.0) ? 1.0 : -1.0;
+      double parabolic =
+          heights[i] +
+          s / (positions[i + 1] - positions[i - 1]) *
+              ((positions[i] - positions[i - 1] + s) *
+                   (heights[i + 1] - heights[i]) /
+                   (positions[i + 1] - positions[i]) +
+               (positions[i + 1] - positions[i] - s) *
+                   (heights[i] - heights[i - 1]) /
+                   (positions[i] - positions[i - 1]));
+      if (heights[i - 1] < parabolic && parabolic < heights[i + 1]) {
+        heights[i] = parabolic;
+      } else {
+        size_t j = (s > 0.0) ? i + 1 : i - 1;
+        heights[i] += s * (heights[j] - heights[i]) /
+                      (positions[j] - positions[i]);
+      }
+      positions[i] += s;
+    }
+  }
+}
+
+double RunningStatistics::Variance() const {
+  return (count < 2) ? 0.0 : m2 / (count - 1);
+}
+
+double RunningStatistics::StandardDeviation() const {
+  return std::sqrt(Variance());
+}
+
+uint64_t RunningStatistics::Median() const {
+  if (count == 0) {
+    return 0;
+  }
+  if (count <= 5) {
+    size_t n = count;
+    double median = (n % 2 == 0) ? (heights[n / 2 - 1] + heights[n / 2]) / 2
+                                 : heights[n / 2];
+    return static_cast<uint64_t>(median);
+  }
+  return static_cast<uint64_t>(heights[2]);
+}
+
+double RunningStatistics::ConfidenceHalfWidth() const {
+  if (count < 2) {
+    return INFINITY;
+  }
+  return 1.96 * StandardDeviation() / std::sqrt(static_cast<double>(count));
+}
+
+void RunningStatistics::GetStatistics(uint64_t* results) const {
+  if (count == 0) {
+    std::fill(results, results + 4, 0);
+    return;
+  }
+  results[0] = static_cast<uint64_t>(mean);
+  results[1] = Median();
+  results[2] = minimum;
+  results[3] = maximum;
+}
+
+void WilsonInterval(uint64_t successes, uint64_t trials, double* lower,
+                    double* upper) {
+  if (trials == 0) {
+    *lower = 0.0;
+    *upper = 1.0;
+    return;
+  }
+  const double z = 1.96;
+  double n = static_cast<double>(trials);
+  double p = static_cast<double>(successes) / n;
+  double center = (p + z * z / (2.0 * n)) / (1.0 + z * z / n);
+  double width =
+      z * std::sqrt(p * (1.0 - p) / n + z * z / (4.0 * n * n)) /
+      (1.0 + z * z / n);
+  *lower = std::max(0.0, center - width);
+  *upper = std::min(1.0, center + width);
+}
+
+void PutVarint(uint64_t value, std::vector<uint8_t>* out) {
+  while (value >= 0x80) {
+    out->push_back(static_cast<uint8_t>(value | 0x80));
+    value >>= 7;
+  }
+  out->push_back(static_cast<uint8_t>(value));
+}
+
+bool GetVarint(const uint8_t** p, const uint8_t* end, uint64_t* value) {
+  *value = 0;
+  for (uint32_t shift = 0; shift < 64 && *p < end; shift += 7) {
+    uint8_t byte = *(*p)++;
+    *value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+    if (!(byte & 0x80)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+uint64_t ZigZag(uint64_t current, uint64_t previous) {
+  int64_t delta = static_cast<int64_t>(current - previous);
+  return (static_cast<uint64_t>(delta) << 1) ^
+         static_cast<uint64_t>(delta >> 63);
+}
+
+uint64_t UnZigZag(uint64_t value, uint64_t previous) {
+  int64_t delta =
+      static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+  return previous + static_cast<uint64_t>(delta);
+}
+
+std::string JSONString(const std::string& str) {
+  std::string escaped = "\"";
+  for (const auto& c : str) {
+    if (c == '"' || c == '\\') {
+      escaped += '\\';
+      escaped += c;
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      escaped += ' ';
+    } else {
+      escaped += c;
+    }
+  }
+  return escaped + "\"";
+}
+
 // Ref https://graphics.stanford.edu/~seander/bithacks.html#NextBitPermutation
 // Generate next bit permutation pattern (assuming fixed number of 1s)
 uint64_t NextBitPermutation(uint64_t v) {
@@ -4,6 +4,7 @@
 #include <spdlog/spdlog.h>
 
 #include <cstdint>
+#include <string>
 #include <unordered_set>
 #include <utility>
 #include <vector>
@@ -56,6 +57,49 @@ void GetStatistics(uint64_t** histogram, uint64_t num_rows, uint64_t cidx,
                    uint64_t* results);
 void GetStatistics(std::vector<uint64_t>& values, uint64_t* results);
 
+/// @brief Running statistics in constant memory: mean and variance with
+/// Welford's algorithm, and the median with the P-square estimator (Jain and
+/// Chlamtac, CACM, 1985), which is exact up to five values.
+struct RunningStatistics {
+  uint64_t count;
+  double mean;
+  double m2;
+  uint64_t minimum;
+  uint64_t maximum;
+  // P-square markers (heights, positions, and desired positions)
+  double heights[5];
+  double positions[5];
+  double desired[5];
+
+  RunningStatistics() { Reset(); }
+
+  void Reset();
+  void Add(uint64_t value);
+  double Variance() const;
+  double StandardDeviation() const;
+  uint64_t Median() const;
+  // Half width of the 95% confidence interval of the mean
+  double ConfidenceHalfWidth() const;
+  // results: avg,med,min,max (same layout as GetStatistics)
+  void GetStatistics(uint64_t* results) const;
+};
+
+// 95% Wilson score interval of a success ratio (tight near 0 and 1, unlike
+// the normal approximation); [0, 1] without trials
+void WilsonInterval(uint64_t successes, uint64_t trials, double* lower,
+                    double* upper);
+
+// Variable-length integers (LEB128) and zigzag-encoded deltas of the
+// columnar and trace files; GetVarint advances p and fails at end
+void PutVarint(uint64_t value, std::vector<uint8_t>* out);
+bool GetVarint(const uint8_t** p, const uint8_t* end, uint64_t* value);
+uint64_t ZigZag(uint64_t current, uint64_t previous);
+uint64_t UnZigZag(uint64_t value, uint64_t previous);
+
+// Quoted JSON string of the run reports and mapping artifacts: quotes and
+// backslashes are escaped, control characters become spaces
+std::string JSONString(const std::string& str);
+
 // Gaussian elimination to solve the system of the linear equations over GF(2)
 // refer to
 // https://graphics.stanford.edu/~seander/bithacks.html#NextBitPermutation
@@ -1,10 +1,10 @@
 #include <getopt.h>
 #include <spdlog/spdlog.h>
-#include <unistd.h>
 
 #include <iostream>
 #include <string>
 
+#include "internal/backend.h"
 #include "internal/constants.h"
 #include "sudoku.h"
 #include "sudoku_addressing.h"
@@ -16,18 +16,30 @@ static const char help_msg[] =
     $ sudo numactl -C [core] -m [memory] ./reverse_functions [OPTIONS]
 
     Options:
-      --output,  -o [STR]   Output filename prefix
-      --pages,   -p [INT]   Number of OS memory pages to allocate
-      --type,    -t [STR]   DDR type (ddr4 or ddr5)
-      --num,     -n [INT]   Number of DRAM modules
-      --size,    -s [INT]   Size of DRAM module in GB
-      --rank,    -r [INT]   Number of ranks per DRAM module
-      --width,   -w [INT]   DQ width of DRAM (8, 16, or 32)
+      --output,    -o [STR]     Output filename prefix
+      --pages,     -p [INT]     Number of OS memory pages to allocate
+      --type,      -t [STR]     DDR type (ddr4 or ddr5)
+      --num,       -n [INT]     Number of DRAM modules
+      --size,      -s [INT]     Size of DRAM module in GB
+      --rank,      -r [INT]     Number of ranks per DRAM module
+      --width,     -w [INT]     DQ width of DRAM (8, 16, or 32)
+      --mapping,   -M [FILE]    DRAM address mapping from an earlier step ({prefix}.mapping.json)
+      --platform,  -P [STR]     Platform profile name (default: auto-detect)
+      --profiles,  -F [FILE]    Custom platform profiles file
+      --batch,     -b           Use batched conflict measurements
+      --schedule,  -q           Schedule conflict filtering between refreshes
+      --report,    -J           Write a JSON run report ({prefix}.report.json)
+      --checkpoint, -k          Checkpoint long-running phases ({prefix}.checkpoint)
+      --resume,    -u           Resume from {prefix}.checkpoint (implies --checkpoint)
+      --simulate,  -x           Run on the simulated DRAM backend (no sudo)
+      --sim-file,  -X [FILE]    Simulated DRAM file (implies --simulate)
+      --record,    -c [FILE]    Record all oracle calls into a trace file
+      --replay,    -i [FILE]    Replay oracle calls from a trace file (no sudo)
 
-      --debug,   -d         Enable debug output
-      --verbose, -v         Enable verbose mode
-      --log,     -l         Enable logging
-      --help,    -h         Show this help message
+      --debug,     -d           Enable debug output
+      --verbose,   -v           Enable verbose mode
+      --log,       -l           Enable logging
+      --help,      -h           Show this help message
 )";
 
 void PrintHelp(const std::string& msg = "") {
@@ -46,14 +58,20 @@ int main(int argc, char* argv[]) {
            module_size = 32ULL * 1024ULL * 1024ULL * 1024ULL, num_ranks = 2,
            dq_width = 8;
   DDRType ddr_type = DDRType::DDR4;
+  MappingArtifact mapping;
+  bool mapped = false;
+  std::string platform = "", profiles_fname = "";
+  bool batch = false;
+  bool schedule = false;
+  bool report = false;
+  bool checkpoint = false;
+  bool resume = false;
+  bool simulate = false;
+  std::string sim_fname = "";
+  std::string record_fname = "";
+  std::string replay_fname = "";
   bool debug = false, verbose = false, logging = false;
 
-  // check sudo privilege
-  if (getuid() != 0) {
-    spdlog::error("reverse_functions requires sudo privilege.");
-    exit(EXIT_FAILURE);
-  }
-
   // parse argument
   static struct option long_options[] = {
       {"output", optional_argument, 0, 'o'},
@@ -63,6 +81,18 @@ int main(int argc, char* argv[]) {
       {"size", optional_argument, 0, 's'},
       {"rank", optional_argument, 0, 'r'},
       {"width", optional_argument, 0, 'w'},
+      {"mapping", required_argument, 0, 'M'},
+      {"platform", required_argument, 0, 'P'},
+      {"profiles", required_argument, 0, 'F'},
+      {"batch", no_argument, 0, 'b'},
+      {"schedule", no_argument, 0, 'q'},
+      {"report", no_argument, 0, 'J'},
+      {"checkpoint", no_argument, 0, 'k'},
+      {"resume", no_argument, 0, 'u'},
+      {"simulate", no_argument, 0, 'x'},
+      {"sim-file", required_argument, 0, 'X'},
+      {"record", required_argument, 0, 'c'},
+      {"replay", required_argument, 0, 'i'},
       {"debug", optional_argument, 0, 'd'},
       {"verbose", optional_argument, 0, 'v'},
       {"log", optional_argument, 0, 'l'},
@@ -74,8 +104,9 @@ int main(int argc, char* argv[]) {
     exit(EXIT_FAILURE);
   } else {
     int opt, idx;
-    while ((opt = getopt_long(argc, argv, "o:p:t:n:s:r:w:dvlh", long_options,
-                              &idx)) != -1) {
+    while ((opt = getopt_long(argc, argv,
+                              "o:p:t:n:s:r:w:M:P:F:bqJkuxX:c:i:dvlh",
+                              long_options, &idx)) != -1) {
       switch (opt) {
         case 'o':
           if (optarg) {
@@ -109,6 +140,52 @@ int main(int argc, char* argv[]) {
         case 'w':
           dq_width = strtoull(optarg, NULL, 10);
           break;
+        case 'M':
+          if (!ReadMappingArtifact(std::string(optarg), &mapping)) {
+            exit(EXIT_FAILURE);
+          }
+          mapped = true;
+          ddr_type = mapping.ddr_type;
+          type = (ddr_type == DDRType::DDR5) ? "ddr5" : "ddr4";
+          module_size = mapping.module_size;
+          num_ranks = mapping.num_ranks;
+          dq_width = mapping.dq_width;
+          num_dimms = mapping.num_dimms;
+          break;
+        case 'P':
+          platform = std::string(optarg);
+          break;
+        case 'F':
+          profiles_fname = std::string(optarg);
+          break;
+        case 'b':
+          batch = true;
+          break;
+        case 'q':
+          schedule = true;
+          break;
+        case 'J':
+          report = true;
+          break;
+        case 'k':
+          checkpoint = true;
+          break;
+        case 'u':
+          resume = true;
+          break;
+        case 'x':
+          simulate = true;
+          break;
+        case 'X':
+          simulate = true;
+          sim_fname = std::string(optarg);
+          break;
+        case 'c':
+          record_fname = std::string(optarg);
+          break;
+        case 'i':
+          replay_fname = std::string(optarg);
+          break;
         case 'd':
           debug = true;
           break;
@@ -128,8 +205,14 @@ int main(int argc, char* argv[]) {
     }
   }
 
+  InitBackends("reverse_functions", simulate, sim_fname, record_fname,
+               replay_fname, profiles_fname, ddr_type, &platform);
+
   AddressingConfig* addressing_config =
       new AddressingConfig(type, fname_prefix, verbose, debug, logging);
+  addressing_config->checkpoint = checkpoint || resume;
+  addressing_config->batched = batch;
+  addressing_config->scheduled = schedule;
   MemoryPoolConfig* memory_pool_config = new MemoryPoolConfig(
       page_size, num_pages, granularity, true /* hugepage */);
   DRAMConfig* dram_config =
@@ -140,7 +223,19 @@ int main(int argc, char* argv[]) {
   Addressing* sudoku = new Addressing(dram_config, memory_config,
                                       memory_pool_config, addressing_config);
   sudoku->Initialize();
+  if (resume && !sudoku->ResumeCheckpoint()) {
+    exit(EXIT_FAILURE);
+  }
+  if (mapped) {
+    if (!sudoku->SetMapping(mapping)) {
+      exit(EXIT_FAILURE);
+    }
+  }
   sudoku->ReverseAddressingFunctions();
+  sudoku->WriteMapping("reverse_functions");
+  if (report) {
+    sudoku->ReportRun("reverse_functions");
+  }
   sudoku->Finalize();
 
   delete sudoku;
@@ -9,6 +9,7 @@
 
 #include "internal/assembly.h"
 #include "internal/constants.h"
+#include "internal/counters.h"
 
 namespace sudoku {
 
@@ -22,7 +23,9 @@ Sudoku::Sudoku(DRAMConfig* dram_config, MemoryConfig* memory_config,
       fname_prefix_(fname_prefix),
       verbose_(verbose),
       logging_(logging),
-      debug_(debug) {
+      debug_(debug),
+      row_bits_(0),
+      column_bits_(0) {
   if (dram_config_ == nullptr || memory_config_ == nullptr) {
     dram_config_ = new DRAMConfig();
     memory_config_ = new MemoryConfig();
@@ -58,21 +61,21 @@ void Sudoku::Finalize() {
 }
 
 void Sudoku::SetupLogger(std::string fname, std::string log_name) {
-  auto print_sink = std::make_shared<spdlog::sinks::stdout_color_sink_st>();
-  auto file_sink =
-      std::make_shared<spdlog::sinks::basic_file_sink_st>(fname, true);
-  // Check flags
+  // Check flags (the file is only created if logging)
   std::vector<spdlog::sink_ptr> sinks;
   if (verbose_) {
-    sinks.push_back(print_sink);
+    sinks.push_back(std::make_shared<spdlog::sinks::stdout_color_sink_st>());
   }
   if (logging_) {
-    sinks.push_back(file_sink);
+    sinks.push_back(
+        std::make_shared<spdlog::sinks::basic_file_sink_st>(fname, true));
   }
-  // Setup logger
+  // Setup logger; without sinks, records are dropped before formatting
   auto logger =
       std::make_shared<spdlog::logger>(log_name, sinks.begin(), sinks.end());
-  logger->set_level(spdlog::level::info);
+  logger->set_level(sinks.empty() ? spdlog::level::off : spdlog::level::info);
+  // a step run again in the same process replaces its logger
+  spdlog::drop(log_name);
   spdlog::register_logger(logger);
 }
 
@@ -112,6 +115,10 @@ void Sudoku::SetRowBits(uint64_t bits) { row_bits_ = bits; }
 
 void Sudoku::SetColumnBits(uint64_t bits) { column_bits_ = bits; }
 
+std::vector<uint64_t> Sudoku::GetAddressingFunctions() const {
+  return addressing_functions_;
+}
+
 std::vector<uint64_t> Sudoku::GetChannelFunctions() const {
   return channel_functions_;
 }
@@ -161,13 +168,15 @@ uint64_t Sudoku::GetNumBankAddressFunctions() const {
 }
 
 void Sudoku::GenerateRandomAddressTuple(addr_tuple* tuple) {
+  Count(Counter::RANDOM_TUPLES);
   uint64_t page_num = pool_->page_dist(pool_->gen);
   uint64_t offset = pool_->page_offset(pool_->gen);
   uint64_t distance =
       (offset / (pool_->config)->granularity) * (pool_->config)->granularity;
   tuple->vaddr = reinterpret_cast<char*>(
       reinterpret_cast<uint64_t>(pool_->pages[page_num]) + distance);
-  tuple->paddr = VirtToPhys(reinterpret_cast<uint64_t>(tuple->vaddr));
+  tuple->paddr = PoolVirtToPhys(pool_, page_num,
+                                reinterpret_cast<uint64_t>(tuple->vaddr));
 }
 
 void Sudoku::GenerateTwoRandomAddressTuples(addr_tuple* first,
@@ -183,6 +192,7 @@ bool Sudoku::GenerateRandomAddressTupleWithConstraints(
     addr_tuple* first, addr_tuple* second,
     const std::vector<uint64_t>& same_functions,
     const std::vector<uint64_t>& diff_functions) {
+  Count(Counter::CONSTRAINT_SOLVES);
   std::vector<uint64_t> base_functions;
   std::vector<uint8_t> expected;
   // merge functions into matrix and set result vector (expected)
@@ -224,6 +234,7 @@ bool Sudoku::GenerateRandomAddressTupleWithConstraints(
   }
   for (size_t i = row; i < base_functions.size(); ++i) {
     if (base_functions[i] == 0 && expected[i] != 0) {
+      Count(Counter::CONSTRAINT_FAILURES);
       return false;  // No solution
     }
   }
@@ -265,19 +276,43 @@ bool Sudoku::GenerateRandomAddressTupleWithConstraints(
   }
   second->paddr = solution + PCI_OFFSET;
   second->vaddr = reinterpret_cast<char*>(PhysToVirt(pool_, second->paddr));
-  return (second->vaddr != nullptr);
+  if (second->vaddr == nullptr) {
+    Count(Counter::CONSTRAINT_FAILURES);
+    return false;
+  }
+  return true;
 }
 
-std::vector<uint64_t> Sudoku::GenerateRowBufferHitSequences(uint64_t length) {
-  std::vector<uint64_t> sequence(length), generated;
-  uint64_t used_bits_mask = 0, unused_column_bits_mask = 0;
+bool Sudoku::GenerateAddressTupleAtCoordinate(
+    const DRAMTranslator& translator, const DRAMCoordinate& coordinate,
+    addr_tuple* tuple) {
+  if (!translator.Invertible()) {
+    PRINT_ERROR("DRAM address mapping is not invertible");
+    return false;
+  }
+  addr_tuple base;
+  GenerateRandomAddressTuple(&base);
+  uint64_t offset_mask = (1ULL << CACHELINE_OFFSET) - 1;
+  tuple->paddr = translator.PhysicalAddress(
+                     coordinate, (base.paddr - PCI_OFFSET) & ~offset_mask) +
+                 PCI_OFFSET;
+  tuple->vaddr = reinterpret_cast<char*>(PhysToVirt(pool_, tuple->paddr));
+  return tuple->vaddr != nullptr;
+}
+
+uint64_t Sudoku::UnusedColumnBits() const {
+  uint64_t used_bits_mask = 0;
   for (const auto& function : addressing_functions_) {
     used_bits_mask |= function;
   }
+  return column_bits_ & ~used_bits_mask;
+}
+
+std::vector<uint64_t> Sudoku::GenerateRowBufferHitSequences(uint64_t length) {
+  std::vector<uint64_t> sequence(length), generated;
   // only use "unused" column bits for generating sequences
-  unused_column_bits_mask = column_bits_ & ~used_bits_mask;
   // Exhaustive testing to verify all possible bitmasks
-  generated = GenerateAllCombinations(unused_column_bits_mask);
+  generated = GenerateAllCombinations(UnusedColumnBits());
   std::shuffle(generated.begin(), generated.end(), pool_->gen);
   std::copy(generated.begin(), generated.begin() + length, sequence.begin());
   return sequence;
@@ -9,6 +9,7 @@
 #include "config.h"
 #include "memory.h"
 #include "pool.h"
+#include "translator.h"
 #include "utils.h"
 
 namespace sudoku {
@@ -48,6 +49,7 @@ class Sudoku {
   void SetColumnBits(uint64_t bits);
 
   // Getters (functions and bits)
+  std::vector<uint64_t> GetAddressingFunctions() const;
   std::vector<uint64_t> GetChannelFunctions() const;
   std::vector<uint64_t> GetRankFunctions() const;
   std::vector<uint64_t> GetBankFunctions() const;
@@ -70,6 +72,15 @@ class Sudoku {
       addr_tuple* first, addr_tuple* second,
       const std::vector<uint64_t>& same_functions,
       const std::vector<uint64_t>& diff_functions);
+  // Pool address of the given DRAM coordinates (exact inverse of the
+  // translator); address bits the mapping does not determine come from a
+  // random pool address. False if the address is outside the pool.
+  bool GenerateAddressTupleAtCoordinate(const DRAMTranslator& translator,
+                                        const DRAMCoordinate& coordinate,
+                                        addr_tuple* tuple);
+  // Offsets flipping only unused column bits (column bits in no function);
+  // needs 2^k - 1 >= length for k unused column bits
+  uint64_t UnusedColumnBits() const;
   std::vector<uint64_t> GenerateRowBufferHitSequences(uint64_t length);
 
  public:
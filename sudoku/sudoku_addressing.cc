@@ -5,9 +5,13 @@
 #include <spdlog/spdlog.h>
 
 #include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
 #include <fstream>
 #include <functional>
 #include <random>
+#include <sstream>
 #include <thread>
 #include <vector>
 
@@ -15,7 +19,14 @@
 #include "internal/conflicts.h"
 #include "internal/consecutive_accesses.h"
 #include "internal/constants.h"
+#include "internal/counters.h"
+#include "internal/mapping.h"
+#include "internal/mixture.h"
+#include "internal/pipeline.h"
+#include "internal/refresh_detector.h"
+#include "internal/refresh_scheduler.h"
 #include "internal/refreshes.h"
+#include "internal/simulator.h"
 #include "internal/utils.h"
 
 namespace sudoku {
@@ -25,7 +36,12 @@ Addressing::Addressing(MemoryPoolConfig* memory_pool_config,
     : Sudoku(nullptr, nullptr, memory_pool_config, addressing_config->type,
              addressing_config->fname_prefix, addressing_config->verbose,
              addressing_config->logging, addressing_config->debug),
-      addressing_config_(addressing_config) {}
+      addressing_config_(addressing_config),
+      validated_(false) {
+  if (addressing_config_->checkpoint) {
+    StartCheckpointTimer();
+  }
+}
 
 Addressing::Addressing(DRAMConfig* dram_config, MemoryConfig* memory_config,
                        MemoryPoolConfig* memory_pool_config,
@@ -34,10 +50,16 @@ Addressing::Addressing(DRAMConfig* dram_config, MemoryConfig* memory_config,
              addressing_config->type, addressing_config->fname_prefix,
              addressing_config->verbose, addressing_config->logging,
              addressing_config->debug),
-      addressing_config_(addressing_config) {}
+      addressing_config_(addressing_config),
+      validated_(false) {
+  if (addressing_config_->checkpoint) {
+    StartCheckpointTimer();
+  }
+}
 
 void Addressing::StatSingleMemoryAccess() {
   PRINT_DEBUG_FUNCTION_NAME(debug_);
+  ScopedPhase phase(__func__);
 
   std::string fname = fname_prefix_ + ".stat.single.memory.access.log";
   std::string log_name = "single_access_sink";
@@ -64,6 +86,7 @@ void Addressing::StatSingleMemoryAccess() {
 
 void Addressing::StatPairedMemoryAccess() {
   PRINT_DEBUG_FUNCTION_NAME(debug_);
+  ScopedPhase phase(__func__);
 
   std::string fname = fname_prefix_ + ".stat.paired.memory.access.log";
   std::string log_name = "paired_access_sink";
@@ -73,27 +96,21 @@ void Addressing::StatPairedMemoryAccess() {
   logger->set_pattern("%v");
   logger->info("idx,fpaddr,spaddr,avg,med,min,max");
 
-  addr_tuple* ftuple = new addr_tuple;
-  addr_tuple* stuple = new addr_tuple;
-  uint64_t* statistics = new uint64_t[4];
-  for (size_t i = 0; i < SUDOKU_TEST_NUM_ITERATION; ++i) {
-    GenerateTwoRandomAddressTuples(ftuple, stuple);
-    StatAccessTimingPairedMemoryAccess(
-        reinterpret_cast<uint64_t>(ftuple->vaddr),
-        reinterpret_cast<uint64_t>(stuple->vaddr), statistics);
-    logger->info("{},{},{},{},{},{},{}", i,
-                 reinterpret_cast<void*>(ftuple->paddr - PCI_OFFSET),
-                 reinterpret_cast<void*>(stuple->paddr - PCI_OFFSET),
-                 statistics[0], statistics[1], statistics[2], statistics[3]);
-  }
-
-  delete[] statistics;
-  delete ftuple;
-  delete stuple;
+  MeasurePairs(
+      SUDOKU_TEST_NUM_ITERATION,
+      [this](addr_tuple* ftuple, addr_tuple* stuple) {
+        GenerateTwoRandomAddressTuples(ftuple, stuple);
+      },
+      [](uint64_t faddr, uint64_t saddr, uint64_t* statistics) {
+        StatAccessTimingPairedMemoryAccess(faddr, saddr, statistics);
+        return 0ULL;
+      },
+      fname, log_name, false);
 }
 
 void Addressing::CheckPairedMemoryAccess(Constraints& constraints) {
   PRINT_DEBUG_FUNCTION_NAME(debug_);
+  ScopedPhase phase(__func__);
   std::string fname = fname_prefix_ + ".check.paired.memory.access.log";
   std::string log_name = "check_paired_maccess_log";
 
@@ -114,32 +131,235 @@ void Addressing::CheckPairedMemoryAccess(Constraints& constraints) {
 
   logger->info("idx,fpaddr,spaddr,avg,med,min,max");
 
+  MeasurePairs(
+      SUDOKU_TEST_NUM_ITERATION,
+      [this, &constraints](addr_tuple* ftuple, addr_tuple* stuple) {
+        GenerateRandomAddressTuple(ftuple);
+        while (!GenerateRandomAddressTupleWithConstraints(
+            ftuple, stuple, constraints.same_functions,
+            constraints.diff_functions)) {
+          // retry until found
+        }
+      },
+      [](uint64_t faddr, uint64_t saddr, uint64_t* statistics) {
+        StatAccessTimingPairedMemoryAccess(faddr, saddr, statistics);
+        return 0ULL;
+      },
+      fname, log_name, false);
+}
+
+void Addressing::StatBatchedPairedMemoryAccess() {
+  PRINT_DEBUG_FUNCTION_NAME(debug_);
+  ScopedPhase phase(__func__);
+
+  std::string fname = fname_prefix_ + ".stat.batched.paired.memory.access.log";
+  std::string log_name = "batched_paired_access_sink";
+
+  SetupLogger(fname, log_name);
+  auto logger = spdlog::get(log_name);
+  logger->set_pattern("%v");
+  logger->info("idx,fpaddr,spaddr,avg,med,min,max");
+
+  const size_t num_pairs = SUDOKU_CONFLICT_BATCH_SIZE;
+  addr_tuple* ftuples = new addr_tuple[num_pairs];
+  addr_tuple* stuples = new addr_tuple[num_pairs];
+  uint64_t* faddrs = new uint64_t[num_pairs];
+  uint64_t* saddrs = new uint64_t[num_pairs];
+  uint64_t** statistics = AllocateHistogram(num_pairs, 4);
+  ResultSink sink;
+  bool binary =
+      OpenResultSink(fname, SUDOKU_TEST_NUM_ITERATION, false, &sink);
+  for (size_t i = 0; i < SUDOKU_TEST_NUM_ITERATION; i += num_pairs) {
+    GenerateDistinctAddressPairs(ftuples, stuples, num_pairs);
+    for (size_t k = 0; k < num_pairs; ++k) {
+      faddrs[k] = reinterpret_cast<uint64_t>(ftuples[k].vaddr);
+      saddrs[k] = reinterpret_cast<uint64_t>(stuples[k].vaddr);
+    }
+    StatAccessTimingBatchedPairedMemoryAccess(faddrs, saddrs, num_pairs,
+                                              statistics);
+    for (size_t k = 0; k < num_pairs; ++k) {
+      ResultRecord record = {i + k,
+                             ftuples[k].paddr,
+                             stuples[k].paddr,
+                             {statistics[k][0], statistics[k][1],
+                              statistics[k][2], statistics[k][3]},
+                             0};
+      RecordResult(&sink, binary, logger, record, false);
+    }
+  }
+
+  CloseResultSink(&sink, binary, fname);
+  FreeHistogram(statistics, num_pairs);
+  delete[] faddrs;
+  delete[] saddrs;
+  delete[] ftuples;
+  delete[] stuples;
+}
+
+void Addressing::CompareBatchedPairedMemoryAccess() {
+  PRINT_DEBUG_FUNCTION_NAME(debug_);
+  ScopedPhase phase(__func__);
+
+  std::string fname = fname_prefix_ + ".compare.batched.memory.access.log";
+  std::string log_name = "compare_batched_access_sink";
+
+  SetupLogger(fname, log_name);
+  auto logger = spdlog::get(log_name);
+  logger->set_pattern("%v");
+  logger->info(
+      "idx,fpaddr,spaddr,serial_avg,serial_med,batched_avg,batched_med");
+
+  // Both kernels measure the same pairs back to back. The summary reports
+  // the median difference and how often both kernels agree on classifying
+  // a pair as same bank, different row (SBDR) conflict. On the simulated
+  // backend, it also scores each kernel against the simulated mapping.
+  const SimulatorConfig* truth = SimulatedGroundTruth();
+  uint64_t num_true_sbdr = 0, serial_correct = 0, batched_correct = 0,
+           serial_found = 0, batched_found = 0;
+  const size_t num_pairs = SUDOKU_CONFLICT_BATCH_SIZE;
+  addr_tuple* ftuples = new addr_tuple[num_pairs];
+  addr_tuple* stuples = new addr_tuple[num_pairs];
+  uint64_t* faddrs = new uint64_t[num_pairs];
+  uint64_t* saddrs = new uint64_t[num_pairs];
+  uint64_t* serial = new uint64_t[4];
+  uint64_t** batched = AllocateHistogram(num_pairs, 4);
+  uint64_t num_measured = 0, num_agreed = 0, num_sbdr = 0;
+  std::vector<uint64_t> differences;
+  for (size_t i = 0; i < SUDOKU_TEST_NUM_ITERATION; i += num_pairs) {
+    GenerateDistinctAddressPairs(ftuples, stuples, num_pairs);
+    for (size_t k = 0; k < num_pairs; ++k) {
+      faddrs[k] = reinterpret_cast<uint64_t>(ftuples[k].vaddr);
+      saddrs[k] = reinterpret_cast<uint64_t>(stuples[k].vaddr);
+    }
+    StatAccessTimingBatchedPairedMemoryAccess(faddrs, saddrs, num_pairs,
+                                              batched);
+    for (size_t k = 0; k < num_pairs; ++k) {
+      StatAccessTimingPairedMemoryAccess(faddrs[k], saddrs[k], serial);
+      bool serial_sbdr = serial[0] > SBDR_LOWER_BOUND &&
+                         serial[0] < SBDR_UPPER_BOUND;
+      bool batched_sbdr = batched[k][0] > SBDR_LOWER_BOUND &&
+                          batched[k][0] < SBDR_UPPER_BOUND;
+      num_measured++;
+      num_sbdr += serial_sbdr;
+      num_agreed += (serial_sbdr == batched_sbdr);
+      if (truth) {
+        bool sbdr = truth->SameBankDifferentRow(ftuples[k].paddr - PCI_OFFSET,
+                                                stuples[k].paddr - PCI_OFFSET);
+        num_true_sbdr += sbdr;
+        serial_correct += (serial_sbdr == sbdr);
+        batched_correct += (batched_sbdr == sbdr);
+        serial_found += (serial_sbdr && sbdr);
+        batched_found += (batched_sbdr && sbdr);
+      }
+      differences.push_back((serial[1] > batched[k][1])
+                                ? (serial[1] - batched[k][1])
+                                : (batched[k][1] - serial[1]));
+      logger->info("{},{},{},{},{},{},{}", i + k,
+                   reinterpret_cast<void*>(ftuples[k].paddr - PCI_OFFSET),
+                   reinterpret_cast<void*>(stuples[k].paddr - PCI_OFFSET),
+                   serial[0], serial[1], batched[k][0], batched[k][1]);
+    }
+  }
+  PRINT_INFO("Batched vs. serial: {} / {} pairs agree on SBDR ({} SBDR "
+             "pairs), median |difference| of medians: {} cycles",
+             num_agreed, num_measured, num_sbdr, GetMedian(differences));
+  if (truth && num_measured) {
+    PRINT_INFO("Accuracy against the simulated mapping ({} SBDR pairs): "
+               "serial: {:.1f}% ({} SBDR pairs found), batched: {:.1f}% ({} "
+               "SBDR pairs found)",
+               num_true_sbdr, 100.0 * serial_correct / num_measured,
+               serial_found, 100.0 * batched_correct / num_measured,
+               batched_found);
+  }
+
+  FreeHistogram(batched, num_pairs);
+  delete[] serial;
+  delete[] faddrs;
+  delete[] saddrs;
+  delete[] ftuples;
+  delete[] stuples;
+}
+
+void Addressing::CompareScheduledPairedMemoryAccess() {
+  PRINT_DEBUG_FUNCTION_NAME(debug_);
+  ScopedPhase phase(__func__);
+
+  std::string fname = fname_prefix_ + ".compare.scheduled.memory.access.log";
+  std::string log_name = "compare_scheduled_access_sink";
+
+  SetupLogger(fname, log_name);
+  auto logger = spdlog::get(log_name);
+  logger->set_pattern("%v");
+  logger->info("idx,fpaddr,spaddr,period,phases,outliers,scheduled_outliers,"
+               "avg,scheduled_avg");
+
+  // Samples above SBDR_UPPER_BOUND are outliers (mostly refreshes colliding
+  // with the accesses). Both kernels measure the same pairs back to back,
+  // and the outlier rates are normalized by their number of iterations.
   addr_tuple* ftuple = new addr_tuple;
   addr_tuple* stuple = new addr_tuple;
-  uint64_t* statistics = new uint64_t[4];
-  for (size_t i = 0; i < SUDOKU_TEST_NUM_ITERATION; ++i) {
-    GenerateRandomAddressTuple(ftuple);
-    while (!GenerateRandomAddressTupleWithConstraints(
-        ftuple, stuple, constraints.same_functions,
-        constraints.diff_functions)) {
-      // retry until found
+  uint64_t** histogram = AllocateHistogram(SUDOKU_CONFLICT_NUM_ITERATION, 2);
+  uint64_t** scheduled =
+      AllocateHistogram(SUDOKU_SCHEDULED_CONFLICT_NUM_ITERATION, 2);
+  RefreshScheduler scheduler;
+  uint64_t num_samples = 0, num_outliers = 0;
+  uint64_t num_scheduled_samples = 0, num_scheduled_outliers = 0;
+  uint64_t num_unlocked = 0;
+  for (size_t i = 0; i < TESTING_CHECKING_NUM_PAIRS; ++i) {
+    GenerateTwoRandomAddressTuples(ftuple, stuple);
+    uint64_t faddr = reinterpret_cast<uint64_t>(ftuple->vaddr);
+    uint64_t saddr = reinterpret_cast<uint64_t>(stuple->vaddr);
+    // the pair may span two ranks, so both refresh phases are avoided
+    if (!scheduler.Lock(faddr, saddr)) {
+      num_unlocked++;
+      continue;
     }
-    StatAccessTimingPairedMemoryAccess(
-        reinterpret_cast<uint64_t>(ftuple->vaddr),
-        reinterpret_cast<uint64_t>(stuple->vaddr), statistics);
-    logger->info("{},{},{},{},{},{},{}", i,
-                 reinterpret_cast<void*>(ftuple->paddr - PCI_OFFSET),
-                 reinterpret_cast<void*>(stuple->paddr - PCI_OFFSET),
-                 statistics[0], statistics[1], statistics[2], statistics[3]);
+    AccessTimingPairedMemoryAccess(faddr, saddr, histogram);
+    AccessTimingPairedMemoryAccessScheduled(faddr, saddr, scheduler,
+                                            scheduled);
+
+    uint64_t outliers = 0, scheduled_outliers = 0;
+    for (size_t k = 0; k < SUDOKU_CONFLICT_NUM_ITERATION; ++k) {
+      outliers += (histogram[k][1] > SBDR_UPPER_BOUND);
+    }
+    for (size_t k = 0; k < SUDOKU_SCHEDULED_CONFLICT_NUM_ITERATION; ++k) {
+      scheduled_outliers += (scheduled[k][1] > SBDR_UPPER_BOUND);
+    }
+    num_samples += SUDOKU_CONFLICT_NUM_ITERATION;
+    num_outliers += outliers;
+    num_scheduled_samples += SUDOKU_SCHEDULED_CONFLICT_NUM_ITERATION;
+    num_scheduled_outliers += scheduled_outliers;
+    logger->info(
+        "{},{},{},{:.1f},{},{},{},{},{}", i,
+        reinterpret_cast<void*>(ftuple->paddr - PCI_OFFSET),
+        reinterpret_cast<void*>(stuple->paddr - PCI_OFFSET),
+        scheduler.Period(), scheduler.NumPhases(), outliers, scheduled_outliers,
+        GetAverage(histogram, SUDOKU_CONFLICT_NUM_ITERATION, 1),
+        GetAverage(scheduled, SUDOKU_SCHEDULED_CONFLICT_NUM_ITERATION, 1));
   }
 
-  delete[] statistics;
+  if (num_samples == 0) {
+    PRINT_ERROR("No refresh phase lock on any of {} pairs", num_unlocked);
+  } else {
+    double rate = static_cast<double>(num_outliers) / num_samples;
+    double scheduled_rate =
+        static_cast<double>(num_scheduled_outliers) / num_scheduled_samples;
+    double reduction =
+        (rate > 0.0) ? 100.0 * (1.0 - scheduled_rate / rate) : 0.0;
+    PRINT_INFO("Outliers: {:.4f}% unscheduled, {:.4f}% scheduled ({:.1f}% "
+               "reduction, {} pairs without lock)",
+               100.0 * rate, 100.0 * scheduled_rate, reduction, num_unlocked);
+  }
+
+  FreeHistogram(histogram, SUDOKU_CONFLICT_NUM_ITERATION);
+  FreeHistogram(scheduled, SUDOKU_SCHEDULED_CONFLICT_NUM_ITERATION);
   delete ftuple;
   delete stuple;
 }
 
 void Addressing::WatchRefreshSingleAccess() {
   PRINT_DEBUG_FUNCTION_NAME(debug_);
+  ScopedPhase phase(__func__);
 
   std::string fname = fname_prefix_ + ".watch.refresh.single.log";
   std::string log_name = "watch_refresh_single_sink";
@@ -163,8 +383,53 @@ void Addressing::WatchRefreshSingleAccess() {
   delete tuple;
 }
 
+void Addressing::WatchRefreshStream(uint64_t threshold, uint64_t seconds) {
+  PRINT_DEBUG_FUNCTION_NAME(debug_);
+  ScopedPhase phase(__func__);
+
+  std::string fname = fname_prefix_ + ".watch.refresh.stream.log";
+  std::string log_name = "watch_refresh_stream_sink";
+  SetupLogger(fname, log_name);
+
+  auto logger = spdlog::get(log_name);
+  logger->set_pattern("%v");
+  logger->info("idx,timestamp,interval");
+
+  addr_tuple* tuple = new addr_tuple;
+  GenerateRandomAddressTuple(tuple);
+  PRINT_INFO("Watch refreshes of {} for {} seconds",
+             reinterpret_cast<void*>(tuple->paddr - PCI_OFFSET), seconds);
+
+  // Events are logged as they are detected; nothing else is kept
+  RefreshDetector detector(threshold);
+  uint64_t idx = 0;
+  auto callback = [&](uint64_t timestamp, uint64_t interval) {
+    logger->info("{},{},{}", idx++, timestamp, interval);
+  };
+  auto start = std::chrono::steady_clock::now();
+  while (std::chrono::steady_clock::now() - start <
+         std::chrono::seconds(seconds)) {
+    MeasureRefreshSingleAccess(reinterpret_cast<uint64_t>(tuple->vaddr),
+                               detector.Ring());
+    detector.Consume(2, callback);
+  }
+
+  uint64_t* statistics = new uint64_t[4];
+  const RunningStatistics& intervals = detector.Intervals();
+  intervals.GetStatistics(statistics);
+  PRINT_INFO("Samples: {}, refreshes: {}, intervals: {}", detector.NumSamples(),
+             detector.NumEvents(), intervals.count);
+  PRINT_INFO("Interval avg: {}, med: {}, min: {}, max: {}, std: {:.1f}",
+             statistics[0], statistics[1], statistics[2], statistics[3],
+             intervals.StandardDeviation());
+
+  delete[] statistics;
+  delete tuple;
+}
+
 void Addressing::StatRefIntervalSingleAccess(uint64_t threshold) {
   PRINT_DEBUG_FUNCTION_NAME(debug_);
+  ScopedPhase phase(__func__);
 
   std::string fname =
       fname_prefix_ + ".stat.refresh.interval.single.access.log";
@@ -173,17 +438,19 @@ void Addressing::StatRefIntervalSingleAccess(uint64_t threshold) {
 
   auto logger = spdlog::get(log_name);
   logger->set_pattern("%v");
-  logger->info("idx,paddr,avg,med,min,max");
+  logger->info("idx,paddr,avg,med,min,max,num");
 
+  // Each address is watched until its intervals stabilize
   addr_tuple* tuple = new addr_tuple;
   uint64_t* statistics = new uint64_t[4];
   for (size_t i = 0; i < SUDOKU_TEST_NUM_ITERATION; ++i) {
     GenerateRandomAddressTuple(tuple);
-    StatRefreshIntervalSingleAccess(reinterpret_cast<uint64_t>(tuple->vaddr),
-                                    threshold, statistics);
-    logger->info("{},{},{},{},{},{}", i,
+    uint64_t num_intervals = StatStableRefreshIntervalSingleAccess(
+        reinterpret_cast<uint64_t>(tuple->vaddr), threshold, statistics);
+    logger->info("{},{},{},{},{},{},{}", i,
                  reinterpret_cast<void*>(tuple->paddr - PCI_OFFSET),
-                 statistics[0], statistics[1], statistics[2], statistics[3]);
+                 statistics[0], statistics[1], statistics[2], statistics[3],
+                 num_intervals);
   }
 
   delete[] statistics;
@@ -192,6 +459,7 @@ void Addressing::StatRefIntervalSingleAccess(uint64_t threshold) {
 
 void Addressing::WatchRefreshPairedAccessCoarse() {
   PRINT_DEBUG_FUNCTION_NAME(debug_);
+  ScopedPhase phase(__func__);
 
   std::string fname = fname_prefix_ + ".watch.refresh.coarse.log";
   std::string log_name = "watch_coarse_refresh_sink";
@@ -220,6 +488,7 @@ void Addressing::WatchRefreshPairedAccessCoarse() {
 
 void Addressing::StatRefIntervalPairedAccessCoarse(uint64_t threshold) {
   PRINT_DEBUG_FUNCTION_NAME(debug_);
+  ScopedPhase phase(__func__);
 
   std::string fname = fname_prefix_ + ".stat.refresh.coarse.log";
   std::string log_name = "stat_refresh_coarse_sink";
@@ -227,30 +496,26 @@ void Addressing::StatRefIntervalPairedAccessCoarse(uint64_t threshold) {
 
   auto logger = spdlog::get(log_name);
   logger->set_pattern("%v");
-  logger->info("idx,fpaddr,spaddr,avg,med,min,max");
-
-  addr_tuple* ftuple = new addr_tuple;
-  addr_tuple* stuple = new addr_tuple;
-  uint64_t* statistics = new uint64_t[4];
-  for (size_t i = 0; i < SUDOKU_TEST_NUM_ITERATION; ++i) {
-    GenerateTwoRandomAddressTuples(ftuple, stuple);
-    StatRefreshIntervalPairedAccessCoarse(
-        reinterpret_cast<uint64_t>(ftuple->vaddr),
-        reinterpret_cast<uint64_t>(stuple->vaddr), threshold, statistics);
-    logger->info("{},{},{},{},{},{},{}", i,
-                 reinterpret_cast<void*>(ftuple->paddr - PCI_OFFSET),
-                 reinterpret_cast<void*>(stuple->paddr - PCI_OFFSET),
-                 statistics[0], statistics[1], statistics[2], statistics[3]);
-  }
-
-  delete[] statistics;
-  delete ftuple;
-  delete stuple;
+  logger->info("idx,fpaddr,spaddr,avg,med,min,max,num");
+
+  // Each pair is watched until its intervals stabilize
+  MeasurePairs(
+      SUDOKU_TEST_NUM_ITERATION,
+      [this](addr_tuple* ftuple, addr_tuple* stuple) {
+        GenerateTwoRandomAddressTuples(ftuple, stuple);
+      },
+      [threshold](uint64_t faddr, uint64_t saddr, uint64_t* statistics) {
+        return StatStableRefreshIntervalPairedAccessCoarse(faddr, saddr,
+                                                          threshold,
+                                                          statistics);
+      },
+      fname, log_name, true);
 }
 
 void Addressing::CheckRefIntervalPairedAccessCoarse(Constraints& constraints,
                                                     uint64_t threshold) {
   PRINT_DEBUG_FUNCTION_NAME(debug_);
+  ScopedPhase phase(__func__);
 
   std::string fname = fname_prefix_ + ".check.refresh.coarse.log";
   std::string log_name = "check_refresh_coarse_sink";
@@ -270,31 +535,27 @@ void Addressing::CheckRefIntervalPairedAccessCoarse(Constraints& constraints,
   logger->info("same_functions,{}", oss.str());
   logger->info("idx,fpaddr,spaddr,avg,med,min,max");
 
-  addr_tuple* ftuple = new addr_tuple;
-  addr_tuple* stuple = new addr_tuple;
-  uint64_t* statistics = new uint64_t[4];
-  for (size_t i = 0; i < SUDOKU_TEST_NUM_ITERATION; ++i) {
-    GenerateRandomAddressTuple(ftuple);
-    while (!GenerateRandomAddressTupleWithConstraints(
-        ftuple, stuple, constraints.same_functions,
-        constraints.diff_functions)) {
-      // retry until found
-    }
-    StatRefreshIntervalPairedAccessCoarse(
-        reinterpret_cast<uint64_t>(ftuple->vaddr),
-        reinterpret_cast<uint64_t>(stuple->vaddr), threshold, statistics);
-    logger->info("{},{},{},{},{},{},{}", i,
-                 reinterpret_cast<void*>(ftuple->paddr - PCI_OFFSET),
-                 reinterpret_cast<void*>(stuple->paddr - PCI_OFFSET),
-                 statistics[0], statistics[1], statistics[2], statistics[3]);
-  }
-
-  delete ftuple;
-  delete stuple;
+  MeasurePairs(
+      SUDOKU_TEST_NUM_ITERATION,
+      [this, &constraints](addr_tuple* ftuple, addr_tuple* stuple) {
+        GenerateRandomAddressTuple(ftuple);
+        while (!GenerateRandomAddressTupleWithConstraints(
+            ftuple, stuple, constraints.same_functions,
+            constraints.diff_functions)) {
+          // retry until found
+        }
+      },
+      [threshold](uint64_t faddr, uint64_t saddr, uint64_t* statistics) {
+        StatRefreshIntervalPairedAccessCoarse(faddr, saddr, threshold,
+                                            statistics);
+        return 0ULL;
+      },
+      fname, log_name, false);
 }
 
 void Addressing::WatchRefreshPairedAccessFine() {
   PRINT_DEBUG_FUNCTION_NAME(debug_);
+  ScopedPhase phase(__func__);
 
   std::string fname = fname_prefix_ + ".watch.refresh.fine.log";
   std::string log_name = "watch_fine_refresh_sink";
@@ -323,6 +584,7 @@ void Addressing::WatchRefreshPairedAccessFine() {
 
 void Addressing::StatRefIntervalPairedAccessFine(uint64_t threshold) {
   PRINT_DEBUG_FUNCTION_NAME(debug_);
+  ScopedPhase phase(__func__);
 
   std::string fname = fname_prefix_ + ".stat.refresh.fine.log";
   std::string log_name = "stat_refresh_fine_sink";
@@ -330,30 +592,26 @@ void Addressing::StatRefIntervalPairedAccessFine(uint64_t threshold) {
 
   auto logger = spdlog::get(log_name);
   logger->set_pattern("%v");
-  logger->info("idx,fpaddr,spaddr,avg,med,min,max");
-
-  addr_tuple* ftuple = new addr_tuple;
-  addr_tuple* stuple = new addr_tuple;
-  uint64_t* statistics = new uint64_t[4];
-  for (size_t i = 0; i < SUDOKU_TEST_NUM_ITERATION; ++i) {
-    GenerateTwoRandomAddressTuples(ftuple, stuple);
-    StatRefreshIntervalPairedAccessFine(
-        reinterpret_cast<uint64_t>(ftuple->vaddr),
-        reinterpret_cast<uint64_t>(stuple->vaddr), threshold, statistics);
-    logger->info("{},{},{},{},{},{},{}", i,
-                 reinterpret_cast<void*>(ftuple->paddr - PCI_OFFSET),
-                 reinterpret_cast<void*>(stuple->paddr - PCI_OFFSET),
-                 statistics[0], statistics[1], statistics[2], statistics[3]);
-  }
-
-  delete[] statistics;
-  delete ftuple;
-  delete stuple;
+  logger->info("idx,fpaddr,spaddr,avg,med,min,max,num");
+
+  // Each pair is watched until its intervals stabilize
+  MeasurePairs(
+      SUDOKU_TEST_NUM_ITERATION,
+      [this](addr_tuple* ftuple, addr_tuple* stuple) {
+        GenerateTwoRandomAddressTuples(ftuple, stuple);
+      },
+      [threshold](uint64_t faddr, uint64_t saddr, uint64_t* statistics) {
+        return StatStableRefreshIntervalPairedAccessFine(faddr, saddr,
+                                                          threshold,
+                                                          statistics);
+      },
+      fname, log_name, true);
 }
 
 void Addressing::CheckRefIntervalPairedAccessFine(Constraints& constraints,
                                                   uint64_t threshold) {
   PRINT_DEBUG_FUNCTION_NAME(debug_);
+  ScopedPhase phase(__func__);
 
   std::string fname = fname_prefix_ + ".check.refresh.fine.log";
   std::string log_name = "check_refresh_fine_sink";
@@ -373,34 +631,32 @@ void Addressing::CheckRefIntervalPairedAccessFine(Constraints& constraints,
   logger->info("same_functions,{}", oss.str());
   logger->info("idx,fpaddr,spaddr,avg,med,min,max");
 
-  addr_tuple* ftuple = new addr_tuple;
-  addr_tuple* stuple = new addr_tuple;
-  uint64_t* statistics = new uint64_t[4];
-  for (size_t i = 0; i < SUDOKU_TEST_NUM_ITERATION; ++i) {
-    GenerateRandomAddressTuple(ftuple);
-    while (!GenerateRandomAddressTupleWithConstraints(
-        ftuple, stuple, constraints.same_functions,
-        constraints.diff_functions)) {
-      // retry until found
-    }
-    StatRefreshIntervalPairedAccessFine(
-        reinterpret_cast<uint64_t>(ftuple->vaddr),
-        reinterpret_cast<uint64_t>(stuple->vaddr), threshold, statistics);
-    logger->info("{},{},{},{},{},{},{}", i,
-                 reinterpret_cast<void*>(ftuple->paddr - PCI_OFFSET),
-                 reinterpret_cast<void*>(stuple->paddr - PCI_OFFSET),
-                 statistics[0], statistics[1], statistics[2], statistics[3]);
-  }
-
-  delete ftuple;
-  delete stuple;
+  MeasurePairs(
+      SUDOKU_TEST_NUM_ITERATION,
+      [this, &constraints](addr_tuple* ftuple, addr_tuple* stuple) {
+        GenerateRandomAddressTuple(ftuple);
+        while (!GenerateRandomAddressTupleWithConstraints(
+            ftuple, stuple, constraints.same_functions,
+            constraints.diff_functions)) {
+          // retry until found
+        }
+      },
+      [threshold](uint64_t faddr, uint64_t saddr, uint64_t* statistics) {
+        StatRefreshIntervalPairedAccessFine(faddr, saddr, threshold,
+                                            statistics);
+        return 0ULL;
+      },
+      fname, log_name, false);
 }
 
-void Addressing::StatReadReadAccess(uint64_t length) {
+void Addressing::StatConsecutiveAccess(ConsecutiveAccess pattern,
+                                       uint64_t length) {
   PRINT_DEBUG_FUNCTION_NAME(debug_);
+  ScopedPhase phase(__func__);
 
-  std::string fname = fname_prefix_ + ".stat.rdrd.log";
-  std::string log_name = "stat_rdrd_sink";
+  std::string pattern_str = ConsecutiveAccessStr[static_cast<int>(pattern)];
+  std::string fname = fname_prefix_ + ".stat." + pattern_str + ".log";
+  std::string log_name = "stat_" + pattern_str + "_sink";
   SetupLogger(fname, log_name);
 
   auto logger = spdlog::get(log_name);
@@ -413,42 +669,27 @@ void Addressing::StatReadReadAccess(uint64_t length) {
   uint64_t* faddrs = new uint64_t[length];
   uint64_t* saddrs = new uint64_t[length];
   uint64_t* statistics = new uint64_t[4];
+  ResultSink sink;
+  bool binary =
+      OpenResultSink(fname, SUDOKU_NUM_EFFECTIVE_TRIAL, false, &sink);
 
   uint64_t trials = 0;
   while (trials < SUDOKU_NUM_EFFECTIVE_TRIAL) {
     GenerateTwoRandomAddressTuples(ftuple, stuple);
-    std::vector<uint64_t> offsets = GenerateRowBufferHitSequences(length);
-    for (size_t j = 0; j < length; ++j) {
-      faddrs[j] = PhysToVirt(
-          pool_, (((reinterpret_cast<uint64_t>(ftuple->paddr) - PCI_OFFSET) ^
-                   offsets[j]) +
-                  PCI_OFFSET));
-    }
-    offsets = GenerateRowBufferHitSequences(length);
-    for (size_t j = 0; j < length; ++j) {
-      saddrs[j] = PhysToVirt(
-          pool_, (((reinterpret_cast<uint64_t>(stuple->paddr) - PCI_OFFSET) ^
-                   offsets[j]) +
-                  PCI_OFFSET));
-    }
-
-    bool pass = true;
-    for (size_t j = 0; j < length; ++j) {
-      if (faddrs[j] == 0 || saddrs[j] == 0) {
-        pass = false;
-        break;
-      }
-    }
-
-    if (pass) {
+    if (GenerateRowBufferHitStreams(ftuple, stuple, length, faddrs, saddrs)) {
       trials++;
-      StatReadReadLatency(faddrs, saddrs, length, statistics);
-      logger->info("{},{},{},{},{},{},{}", trials,
-                   reinterpret_cast<void*>(ftuple->paddr - PCI_OFFSET),
-                   reinterpret_cast<void*>(stuple->paddr - PCI_OFFSET),
-                   statistics[0], statistics[1], statistics[2], statistics[3]);
+      StatConsecutiveAccessLatency(pattern, faddrs, saddrs, length,
+                                   statistics);
+      ResultRecord record = {trials,
+                             ftuple->paddr,
+                             stuple->paddr,
+                             {statistics[0], statistics[1], statistics[2],
+                              statistics[3]},
+                             0};
+      RecordResult(&sink, binary, logger, record, false);
     }
   }
+  CloseResultSink(&sink, binary, fname);
 
   delete ftuple;
   delete stuple;
@@ -457,12 +698,15 @@ void Addressing::StatReadReadAccess(uint64_t length) {
   delete[] statistics;
 }
 
-void Addressing::CheckReadReadAccess(Constraints& constraints,
-                                     uint64_t length) {
+void Addressing::CheckConsecutiveAccess(Constraints& constraints,
+                                        ConsecutiveAccess pattern,
+                                        uint64_t length) {
   PRINT_DEBUG_FUNCTION_NAME(debug_);
+  ScopedPhase phase(__func__);
 
-  std::string fname = fname_prefix_ + ".stat.rdrd.log";
-  std::string log_name = "stat_rdrd_sink";
+  std::string pattern_str = ConsecutiveAccessStr[static_cast<int>(pattern)];
+  std::string fname = fname_prefix_ + ".stat." + pattern_str + ".log";
+  std::string log_name = "stat_" + pattern_str + "_sink";
   SetupLogger(fname, log_name);
 
   auto logger = spdlog::get(log_name);
@@ -485,6 +729,9 @@ void Addressing::CheckReadReadAccess(Constraints& constraints,
   uint64_t* faddrs = new uint64_t[length];
   uint64_t* saddrs = new uint64_t[length];
   uint64_t* statistics = new uint64_t[4];
+  ResultSink sink;
+  bool binary =
+      OpenResultSink(fname, SUDOKU_NUM_EFFECTIVE_TRIAL, false, &sink);
 
   uint64_t trials = 0;
   while (trials < SUDOKU_NUM_EFFECTIVE_TRIAL) {
@@ -494,36 +741,64 @@ void Addressing::CheckReadReadAccess(Constraints& constraints,
         constraints.diff_functions)) {
       // retry until found
     }
-    std::vector<uint64_t> offsets = GenerateRowBufferHitSequences(length);
-    for (size_t j = 0; j < length; ++j) {
-      faddrs[j] = PhysToVirt(
-          pool_, (((reinterpret_cast<uint64_t>(ftuple->paddr) - PCI_OFFSET) ^
-                   offsets[j]) +
-                  PCI_OFFSET));
-    }
-    offsets = GenerateRowBufferHitSequences(length);
-    for (size_t j = 0; j < length; ++j) {
-      saddrs[j] = PhysToVirt(
-          pool_, (((reinterpret_cast<uint64_t>(stuple->paddr) - PCI_OFFSET) ^
-                   offsets[j]) +
-                  PCI_OFFSET));
-    }
-
-    bool pass = true;
-    for (size_t j = 0; j < length; ++j) {
-      if (faddrs[j] == 0 || saddrs[j] == 0) {
-        pass = false;
-        break;
-      }
+    if (GenerateRowBufferHitStreams(ftuple, stuple, length, faddrs, saddrs)) {
+      trials++;
+      StatConsecutiveAccessLatency(pattern, faddrs, saddrs, length,
+                                   statistics);
+      ResultRecord record = {trials,
+                             ftuple->paddr,
+                             stuple->paddr,
+                             {statistics[0], statistics[1], statistics[2],
+                              statistics[3]},
+                             0};
+      RecordResult(&sink, binary, logger, record, false);
     }
+  }
+  CloseResultSink(&sink, binary, fname);
 
-    if (pass) {
-      trials++;
-      StatReadReadLatency(faddrs, saddrs, length, statistics);
-      logger->info("{},{},{},{},{},{},{}", trials,
-                   reinterpret_cast<void*>(ftuple->paddr - PCI_OFFSET),
-                   reinterpret_cast<void*>(stuple->paddr - PCI_OFFSET),
-                   statistics[0], statistics[1], statistics[2], statistics[3]);
+  delete ftuple;
+  delete stuple;
+  delete[] faddrs;
+  delete[] saddrs;
+  delete[] statistics;
+}
+
+void Addressing::SweepConsecutiveAccess(ConsecutiveAccess pattern,
+                                        uint64_t min_length,
+                                        uint64_t max_length) {
+  PRINT_DEBUG_FUNCTION_NAME(debug_);
+  ScopedPhase phase(__func__);
+
+  std::string pattern_str = ConsecutiveAccessStr[static_cast<int>(pattern)];
+  std::string fname = fname_prefix_ + ".sweep." + pattern_str + ".log";
+  std::string log_name = "sweep_" + pattern_str + "_sink";
+  SetupLogger(fname, log_name);
+
+  auto logger = spdlog::get(log_name);
+  logger->set_pattern("%v");
+
+  logger->info("length,idx,fpaddr,spaddr,avg,med,min,max");
+
+  addr_tuple* ftuple = new addr_tuple;
+  addr_tuple* stuple = new addr_tuple;
+  uint64_t* faddrs = new uint64_t[max_length];
+  uint64_t* saddrs = new uint64_t[max_length];
+  uint64_t* statistics = new uint64_t[4];
+
+  for (uint64_t length = min_length; length <= max_length; ++length) {
+    uint64_t trials = 0;
+    while (trials < SUDOKU_NUM_EFFECTIVE_TRIAL) {
+      GenerateTwoRandomAddressTuples(ftuple, stuple);
+      if (GenerateRowBufferHitStreams(ftuple, stuple, length, faddrs, saddrs)) {
+        trials++;
+        StatConsecutiveAccessLatency(pattern, faddrs, saddrs, length,
+                                   statistics);
+        logger->info("{},{},{},{},{},{},{},{}", length, trials,
+                     reinterpret_cast<void*>(ftuple->paddr - PCI_OFFSET),
+                     reinterpret_cast<void*>(stuple->paddr - PCI_OFFSET),
+                     statistics[0], statistics[1], statistics[2],
+                     statistics[3]);
+      }
     }
   }
 
@@ -534,8 +809,80 @@ void Addressing::CheckReadReadAccess(Constraints& constraints,
   delete[] statistics;
 }
 
+void Addressing::ValidateRefreshPeriodEstimator() {
+  PRINT_DEBUG_FUNCTION_NAME(debug_);
+  ScopedPhase phase(__func__);
+
+  std::string fname = fname_prefix_ + ".validate.refresh.estimator.log";
+  std::string log_name = "validate_refresh_estimator_sink";
+  SetupLogger(fname, log_name);
+
+  auto logger = spdlog::get(log_name);
+  logger->set_pattern("%v");
+  logger->info(
+      "period,miss_rate,spurious_rate,median_accuracy,spectral_accuracy,"
+      "spectral_undecided");
+
+  // Synthetic trains mimic one SUDOKU_REFRESH_NUM_ITERATION window of the
+  // paired access kernel (about 400 cycles per sample) with tREFI and
+  // tREFI/2 placed around the profile's regular interval threshold
+  const uint64_t sample_cycles = 400, num_windows = 256;
+  const double jitter = 200.0;
+  const uint64_t regular = REGULAR_REFRESH_INTERVAL_THRESHOLD * 3 / 2;
+  const uint64_t periods[] = {regular, regular / 2};
+  const double miss_rates[] = {0.0, 0.1, 0.2, 0.3};
+  const double spurious_rates[] = {0.0, 0.002, 0.005};
+
+  auto is_reduced = [](uint64_t interval) {
+    return interval < REGULAR_REFRESH_INTERVAL_THRESHOLD &&
+           interval > REDUCED_REFRESH_INTERVAL_LOWER_BOUND;
+  };
+
+  std::mt19937 gen(0);
+  uint64_t median_total = 0, spectral_total = 0, decided_total = 0,
+           num_total = 0;
+  for (const auto& period : periods) {
+    bool reduced = is_reduced(period);
+    for (const auto& miss_rate : miss_rates) {
+      for (const auto& spurious_rate : spurious_rates) {
+        uint64_t median_correct = 0, spectral_correct = 0, undecided = 0;
+        for (uint64_t i = 0; i < num_windows; ++i) {
+          std::vector<uint64_t> refreshes = GenerateSyntheticRefreshes(
+              period, sample_cycles, SUDOKU_REFRESH_NUM_ITERATION, jitter,
+              miss_rate, spurious_rate, gen);
+          // Median of consecutive deltas, as in MedianRefreshInterval*
+          std::vector<uint64_t> intervals = ComputeRefreshIntervals(refreshes);
+          median_correct += (is_reduced(GetMedian(intervals)) == reduced);
+          // Spectral estimate; incoherent windows are retried by callers
+          double coherence = 0.0;
+          uint64_t estimate = EstimateRefreshInterval(refreshes, &coherence);
+          if (coherence < SUDOKU_REFRESH_MIN_COHERENCE) {
+            undecided++;
+          } else {
+            spectral_correct += (is_reduced(estimate) == reduced);
+          }
+        }
+        logger->info("{},{},{},{:.3f},{:.3f},{:.3f}", period, miss_rate,
+                     spurious_rate,
+                     static_cast<double>(median_correct) / num_windows,
+                     static_cast<double>(spectral_correct) /
+                         std::max<uint64_t>(num_windows - undecided, 1),
+                     static_cast<double>(undecided) / num_windows);
+        median_total += median_correct;
+        spectral_total += spectral_correct;
+        decided_total += num_windows - undecided;
+        num_total += num_windows;
+      }
+    }
+  }
+  PRINT_INFO("Median accuracy: {}/{}, spectral accuracy: {}/{} ({} decided)",
+             median_total, num_total, spectral_total, decided_total,
+             decided_total);
+}
+
 void Addressing::ReverseAddressingFunctions() {
   PRINT_DEBUG_FUNCTION_NAME(debug_);
+  ScopedPhase phase(__func__);
   std::string fname = fname_prefix_ + ".reverse.addressing.log";
   std::string log_name = "reverse_addressing_log";
   SetupLogger(fname, log_name);
@@ -592,12 +939,11 @@ void Addressing::ReverseAddressingFunctions() {
                    color_reset);
     }
   }
-  // shutdown
-  spdlog::shutdown();
 }
 
 void Addressing::IdentifyBits(std::vector<uint64_t> functions) {
   PRINT_DEBUG_FUNCTION_NAME(debug_);
+  ScopedPhase phase(__func__);
   std::string fname = fname_prefix_ + ".identify.bits.log";
   std::string log_name = "identify_bits_log";
   SetupLogger(fname, log_name);
@@ -621,10 +967,16 @@ void Addressing::IdentifyBits(std::vector<uint64_t> functions) {
   //  functions/sets, merge those two functions/sets into one set. Then, repeat
   //  until there are no duplicates btw two diff sets/functions.)
   std::vector<uint64_t> disjoint_sets = MergeFunctionsToDisjointSets(functions);
+  if (addressing_config_->checkpoint) {
+    MatchCheckpoint(functions);
+  }
   // Check unused physical address bits
   CheckUnusedBits(uncovered_bit_mask, log_name);
   // Check used physical address bits
   CheckUsedBits(disjoint_sets, log_name);
+  if (addressing_config_->checkpoint) {
+    SaveCheckpoint();
+  }
 
   // Optimize (reduce) row_functions_ and column_functions_ using Gaussian
   //  elimination and upate row/bit masks.
@@ -682,6 +1034,7 @@ void Addressing::IdentifyBits(std::vector<uint64_t> functions) {
 
 bool Addressing::ValidateAddressMapping() {
   PRINT_DEBUG_FUNCTION_NAME(debug_);
+  ScopedPhase phase(__func__);
   bool pass = false;
   std::string fname = fname_prefix_ + ".validate.address.mapping.log";
   std::string log_name = "validate_address_mapping_log";
@@ -731,11 +1084,13 @@ bool Addressing::ValidateAddressMapping() {
     logger->info("  column_bits:{}{}", reinterpret_cast<void*>(column_bits_),
                  color_reset);
   }
+  validated_ = pass;
   return pass;
 }
 
 void Addressing::DecomposeUsingRefreshes() {
   PRINT_DEBUG_FUNCTION_NAME(debug_);
+  ScopedPhase phase(__func__);
 
   std::string fname = fname_prefix_ + ".decompose.refresh.log";
   std::string log_name = "decompose_refresh_sink";
@@ -744,18 +1099,33 @@ void Addressing::DecomposeUsingRefreshes() {
   auto logger = spdlog::get(log_name);
   logger->set_pattern("%v");
 
+  // decomposing replaces the roles of a loaded mapping
+  rank_functions_.clear();
+  if (addressing_config_->concurrent) {
+    DecomposeUsingConcurrentRefreshes(log_name);
+    return;
+  }
+
+  const PlatformProfile& profile = GetPlatformProfile();
   std::function<uint64_t(uint64_t, uint64_t, uint64_t)> refresh_oracle;
-  if (type_ == "DDR4" || type_ == "ddr4") {
+  std::function<uint64_t(uint64_t, uint64_t, uint64_t, double*)>
+      spectral_refresh_oracle;
+  if (profile.refresh_oracle == RefreshOracle::FINE) {
     refresh_oracle = AverageRefreshIntervalPairedAccessFine;
-  } else if (type_ == "DDR5" || type_ == "ddr5") {
-    refresh_oracle = AverageRefreshIntervalPairedAccessCoarse;
+    spectral_refresh_oracle = SpectralRefreshIntervalPairedAccessFine;
   } else {
-    // unsupported (lpddr5/x)
     refresh_oracle = AverageRefreshIntervalPairedAccessCoarse;
+    spectral_refresh_oracle = SpectralRefreshIntervalPairedAccessCoarse;
   }
 
-  addr_tuple* ftuple = new addr_tuple;
-  addr_tuple* stuple = new addr_tuple;
+  // A spectral estimate survives missed and spurious spikes, so far fewer
+  // windows are needed per decision
+  bool spectral = addressing_config_->spectral;
+  uint64_t num_trials =
+      spectral ? SUDOKU_REFRESH_SPECTRAL_NUM_TRIAL : SUDOKU_NUM_EFFECTIVE_TRIAL;
+  uint64_t success_score = spectral ? SUDOKU_REFRESH_SPECTRAL_SUCCESS_SCORE
+                                    : SUDOKU_TRIAL_SUCCESS_SCORE;
+
   for (const auto& function : addressing_functions_) {
     logger->info("[+] Check refresh intervals of function {}",
                  reinterpret_cast<void*>(function));
@@ -765,172 +1135,778 @@ void Addressing::DecomposeUsingRefreshes() {
         other_functions.end());
     std::vector<uint64_t> diff_functions = {function};
 
-    // Checking for each function
-    uint64_t trials = 0, normal_interval_score = 0, reduced_interval_score = 0;
-    while (trials++ < SUDOKU_NUM_EFFECTIVE_TRIAL) {
+    // Checking for each function; the pairs are independent, so each round
+    // measures as many pairs as trials are missing (windows without a
+    // coherent period carry no decision and are retried)
+    uint64_t trials = 0, attempts = 0, normal_interval_score = 0,
+             reduced_interval_score = 0;
+    auto generate = [&](addr_tuple* ftuple, addr_tuple* stuple) {
       GenerateRandomAddressTuple(ftuple);
       while (!GenerateRandomAddressTupleWithConstraints(
           ftuple, stuple, other_functions, diff_functions)) {
         // retry until found
       }
-
-      // derive refresh intervals
-      uint64_t interval = refresh_oracle(
-          reinterpret_cast<uint64_t>(ftuple->vaddr),
-          reinterpret_cast<uint64_t>(stuple->vaddr), REFRESH_CYCLE_LOWER_BOUND);
-
+    };
+    // derive refresh intervals; statistics[0] flags a decision
+    auto measure = [&](uint64_t faddr, uint64_t saddr, uint64_t* statistics) {
+      statistics[0] = 1;
+      if (!spectral) {
+        return refresh_oracle(faddr, saddr, REFRESH_CYCLE_LOWER_BOUND);
+      }
+      double coherence = 0.0;
+      uint64_t interval = spectral_refresh_oracle(
+          faddr, saddr, REFRESH_CYCLE_LOWER_BOUND, &coherence);
+      statistics[0] = (coherence >= SUDOKU_REFRESH_MIN_COHERENCE);
+      return interval;
+    };
+    auto score = [&](const PairResult& result) {
+      if (!result.statistics[0]) {
+        return;
+      }
+      ++trials;
       // For Intel processors, reduced refresh intervals are observed in DIMM
       // and rank functions. In contrast, for AMD processors, normal refresh
-      // intervals are observed in channel and sub-channel functions.
-#if defined(COMPILE_ZEN_4)
-      if (interval < REGULAR_REFRESH_INTERVAL_THRESHOLD) {
-        ++reduced_interval_score;
-      } else {
-        ++normal_interval_score;
-      }
-#else
-      if (interval < REGULAR_REFRESH_INTERVAL_THRESHOLD && interval > 1000) {
+      // intervals are observed in channel and sub-channel functions. The
+      // profile's lower bound drops missed refreshes on Intel processors.
+      if (result.num < REGULAR_REFRESH_INTERVAL_THRESHOLD &&
+          result.num > REDUCED_REFRESH_INTERVAL_LOWER_BOUND) {
         ++reduced_interval_score;
       } else {
         ++normal_interval_score;
       }
-#endif
+    };
+    while (trials < num_trials && attempts < num_trials * 4) {
+      uint64_t num_pairs =
+          std::min(num_trials - trials, num_trials * 4 - attempts);
+      MeasurePairs(num_pairs, generate, measure, score);
+      attempts += num_pairs;
     }
-    logger->info("Functions: {}, tREFI: {}, tREFI/2: {}",
+    logger->info("Functions: {}, tREFI: {}, tREFI/2: {}, windows: {}/{}",
                  reinterpret_cast<void*>(function), normal_interval_score,
-                 reduced_interval_score);
+                 reduced_interval_score, trials, attempts);
 
     // need to update!
-    if (reduced_interval_score > SUDOKU_TRIAL_SUCCESS_SCORE) {
+    if (reduced_interval_score * num_trials > success_score * trials) {
       // AMD: reduced_refresh_intervals: sub-channel, DIMM, and rank
       // Intel with DDR4: reduced_refresh_intervals: channel, DIMM, and rank
       // Intel with DDR5: reduced_refresh_intervals: channel, sub-channel, 
       //    and bank address (a single)
       rank_functions_.push_back(function);
+      function_confidences_[function] =
+          static_cast<double>(reduced_interval_score) / trials;
     }
   }
-  /*
   std::ostringstream oss;
   for (const auto& function : rank_functions_) {
     oss << reinterpret_cast<void*>(function) << ",";
   }
-#if defined(COMPILE_ZEN_4)
-  logger->info("{}[+] Insert to rank, dimm, and sub-channel functions: {}{}",
-	       color_green, oss.str(), color_reset);
-#elif defined(COMPILE_ALDER_LAKE_DDR4)
-  logger->info("{}[+] Insert to rank functions: {}{}", color_green, oss.str(),
-               color_reset);
-#else
-  logger->info("{}[+] Insert to channel, sub-channel, and bank address functions: {}{}",
-          color_green, oss.str(), color_reset);
-#endif
-  */
-  delete ftuple;
-  delete stuple;
+  logger->info("{}[+] Insert to {} functions: {}{}", color_green,
+               profile.reduced_refresh_functions, oss.str(), color_reset);
 }
 
-void Addressing::DecomposeUsingConsecutiveAccesses() {
+bool Addressing::Decomposable() {
+  uint64_t num_unused_column_bits = __builtin_popcountll(UnusedColumnBits());
+  if (row_bits_ == 0 ||
+      (1ULL << num_unused_column_bits) - 1 < CONSECUTIVE_LENGTH) {
+    PRINT_ERROR("Decomposing needs row bits and {} unused column bits (row "
+                "bits: {:#x}, column bits: {:#x}); identify them with "
+                "identify_bits or sudoku_pipeline first",
+                64 - __builtin_clzll(CONSECUTIVE_LENGTH), row_bits_,
+                column_bits_);
+    return false;
+  }
+  return true;
+}
+
+void Addressing::DecomposeFunctions() {
   PRINT_DEBUG_FUNCTION_NAME(debug_);
+  ScopedPhase phase(__func__);
+  CheckpointedPhase checkpointed(addressing_config_->checkpoint);
+  if (!Decomposable()) {
+    return;
+  }
 
-  std::string fname = fname_prefix_ + ".decompose.rdrd.log";
-  std::string log_name = "decompose_rdrd_sink";
+  std::string fname = fname_prefix_ + ".decompose.log";
+  std::string log_name = "decompose_sink";
 
   SetupLogger(fname, log_name);
   auto logger = spdlog::get(log_name);
   logger->set_pattern("%v");
 
-  std::function<uint64_t(uint64_t*, uint64_t*, size_t)>
-      consecutive_access_oracle = AverageReadReadLatency;
-
-  std::vector<std::pair<uint64_t, uint64_t>> rdrd_latencies;
+  bool spectral = addressing_config_->spectral;
+  uint64_t num_refresh_trials =
+      spectral ? SUDOKU_REFRESH_SPECTRAL_NUM_TRIAL : SUDOKU_NUM_EFFECTIVE_TRIAL;
+  // With a trial budget, every function only gets a few warm-up trials here
+  // and AllocateTrials spends the rest on the uncertain ones
+  uint64_t budget = addressing_config_->trial_budget;
+  uint64_t refresh_target = num_refresh_trials;
+  uint64_t consecutive_target = SUDOKU_CONSECUTIVE_NUM_EFFECTIVE_TRIAL;
+  if (budget) {
+    refresh_target =
+        std::min<uint64_t>(SUDOKU_ADAPTIVE_MIN_TRIAL, num_refresh_trials);
+    consecutive_target = SUDOKU_ADAPTIVE_MIN_TRIAL;
+  }
 
   addr_tuple* ftuple = new addr_tuple;
   addr_tuple* stuple = new addr_tuple;
   uint64_t* faddrs = new uint64_t[CONSECUTIVE_LENGTH];
   uint64_t* saddrs = new uint64_t[CONSECUTIVE_LENGTH];
+  std::vector<FunctionEvidence> evidences;
+  if (addressing_config_->checkpoint) {
+    MatchCheckpoint(addressing_functions_);
+  }
+  uint64_t num_pairs = checkpoint_.num_pairs;
+  // decomposing replaces the roles of a loaded mapping
+  rank_functions_.clear();
   for (const auto& function : addressing_functions_) {
-    logger->info("[+] Check consecutive memory accesses of function {}",
+    logger->info("[+] Check refreshes and consecutive memory accesses of "
+                 "function {}",
                  reinterpret_cast<void*>(function));
-    std::vector<uint64_t> other_functions(addressing_functions_);
-    other_functions.erase(
-        std::remove(other_functions.begin(), other_functions.end(), function),
-        other_functions.end());
-    std::vector<uint64_t> diff_functions = {function};
-
-    // Checking for each function
-    uint64_t trials = 0, average_rdrd_latency = 0;
-    while (trials < SUDOKU_NUM_EFFECTIVE_TRIAL) {
-      // Generate two base addresses satisfying the constraints
-      GenerateRandomAddressTuple(ftuple);
-      while (!GenerateRandomAddressTupleWithConstraints(
-          ftuple, stuple, other_functions, diff_functions)) {
-        // retry until found
+    FunctionEvidence evidence(function);
+    for (const auto& restored : checkpoint_.evidences) {
+      if (restored.function == function) {
+        evidence = restored;
       }
-
-      // We use different offsets for each read stream
-      std::vector<uint64_t> offsets =
-          GenerateRowBufferHitSequences(CONSECUTIVE_LENGTH);
-      for (size_t i = 0; i < CONSECUTIVE_LENGTH; ++i) {
-        faddrs[i] = PhysToVirt(
-            pool_, (((reinterpret_cast<uint64_t>(ftuple->paddr) - PCI_OFFSET) ^
-                     offsets[i]) +
-                    PCI_OFFSET));
+    }
+    // Pairs outside the pool for the access streams still serve the refresh
+    // oracle, and incoherent spectral windows still serve the consecutive
+    // access oracles
+    for (;;) {
+      bool refresh = evidence.refresh_trials < refresh_target &&
+                     evidence.refresh_attempts < refresh_target * 4;
+      bool consecutive = evidence.latencies[0].count < consecutive_target;
+      if (!refresh && !consecutive) {
+        break;
       }
-      offsets = GenerateRowBufferHitSequences(CONSECUTIVE_LENGTH);
-      for (size_t i = 0; i < CONSECUTIVE_LENGTH; ++i) {
-        saddrs[i] = PhysToVirt(
-            pool_, (((reinterpret_cast<uint64_t>(stuple->paddr) - PCI_OFFSET) ^
-                     offsets[i]) +
-                    PCI_OFFSET));
+      MeasureFunctionEvidence(evidence, refresh, consecutive, ftuple, stuple,
+                              faddrs, saddrs);
+      num_pairs++;
+      if (addressing_config_->checkpoint && CheckpointDue()) {
+        checkpoint_.evidences = evidences;
+        checkpoint_.evidences.push_back(evidence);
+        checkpoint_.num_pairs = num_pairs;
+        SaveCheckpoint();
       }
-
-      bool pass = true;
-      for (size_t i = 0; i < CONSECUTIVE_LENGTH; ++i) {
-        if (faddrs[i] == 0 || saddrs[i] == 0) {
-          pass = false;
-          break;
-        }
+    }
+    evidences.push_back(evidence);
+  }
+  checkpoint_.num_pairs = num_pairs;
+  if (budget) {
+    num_pairs += AllocateTrials(evidences,
+                                (budget > num_pairs) ? budget - num_pairs : 0,
+                                ftuple, stuple, faddrs, saddrs, log_name);
+  }
+  if (addressing_config_->checkpoint) {
+    checkpoint_.evidences = evidences;
+    checkpoint_.num_pairs = num_pairs;
+    SaveCheckpoint();
+  }
+
+  for (const auto& evidence : evidences) {
+    double lower = 0.0, upper = 0.0;
+    WilsonInterval(evidence.reduced_interval_score, evidence.refresh_trials,
+                   &lower, &upper);
+    logger->info(
+        "Functions: {}, tREFI: {}, tREFI/2: {}, windows: {}/{}, "
+        "tREFI/2 ratio: [{:.3f}, {:.3f}], "
+        "Avg RDRD latency: {:.0f} +- {:.1f} ({} pairs){}",
+        reinterpret_cast<void*>(evidence.function),
+        evidence.normal_interval_score, evidence.reduced_interval_score,
+        evidence.refresh_trials, evidence.refresh_attempts, lower, upper,
+        evidence.latencies[0].mean, evidence.latencies[0].ConfidenceHalfWidth(),
+        evidence.latencies[0].count, TurnaroundLatencies(evidence));
+  }
+  logger->info("[+] Measured {} pairs", num_pairs);
+  ClassifyFunctions(evidences, log_name);
+
+  delete ftuple;
+  delete stuple;
+  delete[] faddrs;
+  delete[] saddrs;
+}
+
+uint64_t Addressing::AllocateTrials(std::vector<FunctionEvidence>& evidences,
+                                    uint64_t budget, addr_tuple* ftuple,
+                                    addr_tuple* stuple, uint64_t* faddrs,
+                                    uint64_t* saddrs, std::string log_name) {
+  PRINT_DEBUG_FUNCTION_NAME(debug_);
+
+  auto logger = spdlog::get(log_name);
+  bool spectral = addressing_config_->spectral;
+  uint64_t num_refresh_trials =
+      spectral ? SUDOKU_REFRESH_SPECTRAL_NUM_TRIAL : SUDOKU_NUM_EFFECTIVE_TRIAL;
+  // reduced interval ratio above which a function is rank-like
+  double success_ratio =
+      static_cast<double>(spectral ? SUDOKU_REFRESH_SPECTRAL_SUCCESS_SCORE
+                                   : SUDOKU_TRIAL_SUCCESS_SCORE) /
+      num_refresh_trials;
+
+  // Each round measures one pair of the function whose decision is the least
+  // certain (margin below 1: uncertain). For refreshes, the margin is the
+  // distance of the tREFI/2 ratio to the success ratio in units of the
+  // Wilson interval's half width. For RDRD latencies, it compares the
+  // function's mean mixture posterior with SUDOKU_MIXTURE_MIN_CONFIDENCE; the
+  // mixture is refitted every SUDOKU_ADAPTIVE_REFIT_ROUNDS rounds. A function
+  // near its threshold never reaches the margin, so it is also settled once
+  // the Wilson interval of its ratio (or of the share of its RDRD samples
+  // explained by the top component) is narrower than
+  // SUDOKU_ADAPTIVE_MIN_HALF_WIDTH. No function gets more trials than without
+  // a budget.
+  auto width_margin = [](uint64_t successes, uint64_t trials) {
+    double lower = 0.0, upper = 0.0;
+    WilsonInterval(successes, trials, &lower, &upper);
+    return SUDOKU_ADAPTIVE_MIN_HALF_WIDTH /
+           std::max((upper - lower) / 2.0, 1e-9);
+  };
+  uint64_t measured = checkpoint_.num_pairs, num_pairs = 0;
+  GaussianMixture mixture;
+  while (num_pairs < budget) {
+    if (num_pairs % SUDOKU_ADAPTIVE_REFIT_ROUNDS == 0) {
+      std::vector<double> values;
+      for (const auto& evidence : evidences) {
+        values.insert(values.end(), evidence.rdrd_samples.begin(),
+                      evidence.rdrd_samples.end());
       }
+      mixture = FitGaussianMixtureBIC(values, SUDOKU_MIXTURE_MIN_COMPONENTS,
+                                      SUDOKU_MIXTURE_MAX_COMPONENTS);
+    }
 
-      if (pass) {
-        trials++;
-        uint64_t rdrd_latency =
-            consecutive_access_oracle(faddrs, saddrs, CONSECUTIVE_LENGTH);
-        average_rdrd_latency += rdrd_latency;
+    std::vector<double> refresh_margins(evidences.size(), INFINITY);
+    std::vector<double> rdrd_margins(evidences.size(), INFINITY);
+    for (size_t k = 0; k < evidences.size(); ++k) {
+      const FunctionEvidence& evidence = evidences[k];
+      if (evidence.refresh_trials < num_refresh_trials &&
+          evidence.refresh_attempts < num_refresh_trials * 4) {
+        double lower = 0.0, upper = 0.0;
+        WilsonInterval(evidence.reduced_interval_score,
+                       evidence.refresh_trials, &lower, &upper);
+        double ratio = (lower + upper) / 2.0;
+        refresh_margins[k] = std::max(
+            std::fabs(ratio - success_ratio) / ((upper - lower) / 2.0),
+            width_margin(evidence.reduced_interval_score,
+                         evidence.refresh_trials));
+      }
+      uint64_t num_samples = evidence.rdrd_samples.size();
+      if (num_samples < SUDOKU_CONSECUTIVE_NUM_EFFECTIVE_TRIAL) {
+        std::vector<double> posterior =
+            mixture.MeanPosterior(evidence.rdrd_samples);
+        double confidence =
+            posterior.empty()
+                ? 0.0
+                : *std::max_element(posterior.begin(), posterior.end());
+        rdrd_margins[k] = std::max(
+            (1.0 - SUDOKU_MIXTURE_MIN_CONFIDENCE) /
+                std::max(1.0 - confidence, 1e-9),
+            width_margin(
+                static_cast<uint64_t>(std::round(confidence * num_samples)),
+                num_samples));
+      }
+    }
+
+    size_t next = evidences.size();
+    double margin = 1.0;
+    for (size_t k = 0; k < evidences.size(); ++k) {
+      double m = std::min(refresh_margins[k], rdrd_margins[k]);
+      if (m < margin) {
+        margin = m;
+        next = k;
       }
     }
-    average_rdrd_latency /= trials;
-    logger->info("Functions: {}, Avg RDRD latency: {}",
-                 reinterpret_cast<void*>(function), average_rdrd_latency);
-    rdrd_latencies.push_back({function, average_rdrd_latency});
+    if (next == evidences.size()) {
+      break;
+    }
+    MeasureFunctionEvidence(evidences[next], refresh_margins[next] < 1.0,
+                            rdrd_margins[next] < 1.0, ftuple, stuple, faddrs,
+                            saddrs);
+    num_pairs++;
+    if (addressing_config_->checkpoint && CheckpointDue()) {
+      checkpoint_.evidences = evidences;
+      checkpoint_.num_pairs = measured + num_pairs;
+      SaveCheckpoint();
+    }
   }
+  logger->info("[+] Allocated {} of the {} pairs left in the budget",
+               num_pairs, budget);
+  return num_pairs;
+}
 
-  // sort
-  std::sort(rdrd_latencies.begin(), rdrd_latencies.end(),
-            [](const auto& a, const auto& b) { return a.second < b.second; });
-  /*
-  std::ostringstream oss;
-  // First N high rdrd latency functions are rank/dimm and bank address
-  // functions.
-  uint64_t num_high_rdrd_latency = 2; // bank address
-  uint64_t num_functions = rdrd_latencies.size();
-  for (size_t i = 0; i < num_functions; ++i) {
-    uint64_t f = rdrd_latencies[num_functions - i - 1].first;
-    if (std::find(rank_functions_.begin(), rank_functions_.end(), f) ==
-        rank_functions_.end()) {
-      bank_address_functions_.push_back(f);
-      if (bank_address_functions_.size() == num_high_rdrd_latency) {
-	break;
+bool Addressing::MeasureFunctionEvidence(FunctionEvidence& evidence,
+                                         bool refresh, bool consecutive,
+                                         addr_tuple* ftuple,
+                                         addr_tuple* stuple, uint64_t* faddrs,
+                                         uint64_t* saddrs) {
+  // Called per pair, so it is counted rather than timed as a phase
+  Count(Counter::DECOMPOSITION_PAIRS);
+  std::vector<uint64_t> other_functions(addressing_functions_);
+  other_functions.erase(std::remove(other_functions.begin(),
+                                    other_functions.end(), evidence.function),
+                        other_functions.end());
+  std::vector<uint64_t> diff_functions = {evidence.function};
+
+  GenerateRandomAddressTuple(ftuple);
+  while (!GenerateRandomAddressTupleWithConstraints(
+      ftuple, stuple, other_functions, diff_functions)) {
+    // retry until found
+  }
+  uint64_t faddr = reinterpret_cast<uint64_t>(ftuple->vaddr);
+  uint64_t saddr = reinterpret_cast<uint64_t>(stuple->vaddr);
+
+  bool measured = false;
+  if (refresh) {
+    bool fine = GetPlatformProfile().refresh_oracle == RefreshOracle::FINE;
+    uint64_t interval = 0;
+    double coherence = 1.0;
+    ++evidence.refresh_attempts;
+    if (addressing_config_->spectral) {
+      interval = fine ? SpectralRefreshIntervalPairedAccessFine(
+                            faddr, saddr, REFRESH_CYCLE_LOWER_BOUND,
+                            &coherence)
+                      : SpectralRefreshIntervalPairedAccessCoarse(
+                            faddr, saddr, REFRESH_CYCLE_LOWER_BOUND,
+                            &coherence);
+    } else {
+      interval = fine ? AverageRefreshIntervalPairedAccessFine(
+                            faddr, saddr, REFRESH_CYCLE_LOWER_BOUND)
+                      : AverageRefreshIntervalPairedAccessCoarse(
+                            faddr, saddr, REFRESH_CYCLE_LOWER_BOUND);
+    }
+    // windows without a coherent period carry no decision
+    if (coherence >= SUDOKU_REFRESH_MIN_COHERENCE) {
+      ++evidence.refresh_trials;
+      if (interval < REGULAR_REFRESH_INTERVAL_THRESHOLD &&
+          interval > REDUCED_REFRESH_INTERVAL_LOWER_BOUND) {
+        ++evidence.reduced_interval_score;
+      } else {
+        ++evidence.normal_interval_score;
       }
+      measured = true;
     }
   }
 
-  for (const auto& function : bank_address_functions_) {
+  // The streams reuse the translated base addresses of the pair
+  if (consecutive && GenerateRowBufferHitStreams(ftuple, stuple,
+                                                 CONSECUTIVE_LENGTH, faddrs,
+                                                 saddrs)) {
+    TimeConsecutiveAccesses(evidence, faddrs, saddrs);
+    measured = true;
+  }
+  return measured;
+}
+
+void Addressing::TimeConsecutiveAccesses(FunctionEvidence& evidence,
+                                         uint64_t* faddrs, uint64_t* saddrs) {
+  // Only the RDRD latencies are classified, so the write turnarounds
+  // (tWTR_S/L, tRTW) cost three more streams per pair only on request
+  size_t num_patterns =
+      addressing_config_->turnarounds ? evidence.latencies.size() : 1;
+  for (size_t i = 0; i < num_patterns; ++i) {
+    uint64_t latency = AverageConsecutiveAccessLatency(
+        ConsecutiveAccesses[i], faddrs, saddrs, CONSECUTIVE_LENGTH);
+    evidence.latencies[i].Add(latency);
+    if (ConsecutiveAccesses[i] == ConsecutiveAccess::RDRD) {
+      evidence.rdrd_samples.push_back(latency);
+    }
+  }
+}
+
+std::string Addressing::TurnaroundLatencies(const FunctionEvidence& evidence) {
+  std::string latencies;
+  for (size_t i = 1; i < evidence.latencies.size(); ++i) {
+    if (evidence.latencies[i].count == 0) {
+      continue;
+    }
+    std::string pattern =
+        ConsecutiveAccessStr[static_cast<int>(ConsecutiveAccesses[i])];
+    std::transform(pattern.begin(), pattern.end(), pattern.begin(), ::toupper);
+    latencies += fmt::format(", Avg {} latency: {:.0f}", pattern,
+                             evidence.latencies[i].mean);
+  }
+  return latencies;
+}
+
+void Addressing::ClassifyFunctions(
+    const std::vector<FunctionEvidence>& evidences, std::string log_name) {
+  PRINT_DEBUG_FUNCTION_NAME(debug_);
+
+  auto logger = spdlog::get(log_name);
+  const PlatformProfile& profile = GetPlatformProfile();
+  uint64_t success_score = addressing_config_->spectral
+                               ? SUDOKU_REFRESH_SPECTRAL_SUCCESS_SCORE
+                               : SUDOKU_TRIAL_SUCCESS_SCORE;
+  uint64_t num_trials = addressing_config_->spectral
+                            ? SUDOKU_REFRESH_SPECTRAL_NUM_TRIAL
+                            : SUDOKU_NUM_EFFECTIVE_TRIAL;
+
+  // Refreshes first: functions with reduced refresh intervals
+  std::vector<const FunctionEvidence*> others;
+  for (const auto& evidence : evidences) {
+    if (evidence.refresh_trials > 0 &&
+        evidence.reduced_interval_score * num_trials >
+            success_score * evidence.refresh_trials) {
+      rank_functions_.push_back(evidence.function);
+      function_confidences_[evidence.function] =
+          static_cast<double>(evidence.reduced_interval_score) /
+          evidence.refresh_trials;
+    } else {
+      others.push_back(&evidence);
+    }
+  }
+  std::ostringstream oss;
+  for (const auto& function : rank_functions_) {
     oss << reinterpret_cast<void*>(function) << ",";
   }
+  logger->info("{}[+] Insert to {} functions: {}{}", color_green,
+               profile.reduced_refresh_functions, oss.str(), color_reset);
+
+  // Then consecutive accesses
+  ClassifyBanks(evidences, log_name);
+}
+
+void Addressing::ClassifyBanks(const std::vector<FunctionEvidence>& evidences,
+                               std::string log_name) {
+  PRINT_DEBUG_FUNCTION_NAME(debug_);
+
+  auto logger = spdlog::get(log_name);
+  bank_group_functions_.clear();
+  bank_address_functions_.clear();
+  std::vector<double> values;
+  for (const auto& evidence : evidences) {
+    values.insert(values.end(), evidence.rdrd_samples.begin(),
+                  evidence.rdrd_samples.end());
+  }
+  GaussianMixture mixture =
+      FitGaussianMixtureBIC(values, SUDOKU_MIXTURE_MIN_COMPONENTS,
+                            SUDOKU_MIXTURE_MAX_COMPONENTS);
+  if (mixture.NumComponents() == 0) {
+    logger->info("{}[-] Not enough RDRD latencies to classify banks{}",
+                 color_red, color_reset);
+    return;
+  }
+  logger->info("[+] RDRD latency mixture: {} components (BIC: {:.1f})",
+               mixture.NumComponents(), mixture.bic);
+  for (size_t c = 0; c < mixture.NumComponents(); ++c) {
+    logger->info("Component {}: weight: {:.3f}, mean: {:.1f}, std: {:.1f}", c,
+                 mixture.weights[c], mixture.means[c],
+                 std::sqrt(mixture.variances[c]));
+  }
+
+  // Component of each function: highest mean posterior over its pairs
+  std::vector<size_t> components;
+  std::vector<double> confidences;
+  for (const auto& evidence : evidences) {
+    std::vector<double> posterior =
+        mixture.MeanPosterior(evidence.rdrd_samples);
+    size_t best = 0;
+    for (size_t c = 1; c < posterior.size(); ++c) {
+      if (posterior[c] > posterior[best]) {
+        best = c;
+      }
+    }
+    components.push_back(best);
+    confidences.push_back(posterior.empty() ? 0.0 : posterior[best]);
+  }
+
+  // The highest component holds rank switches or tCCD_L (bank address),
+  // told apart by the latencies themselves rather than by the refresh
+  // decisions, so a missed rank function does not shift every label. With
+  // the write turnarounds timed, a read after a write pays tWTR within a
+  // rank but only the rank switch gap across ranks: the rank switch
+  // component has (almost) no WRRD turnaround over RDRD. Otherwise, the
+  // configured memory tells whether rank switches exist. The two highest
+  // components below rank switches are tCCD_L and tCCD_S (bank group);
+  // anything lower (e.g., channels served in parallel) is left unassigned.
+  auto is_rank = [&](uint64_t function) {
+    return std::find(rank_functions_.begin(), rank_functions_.end(),
+                     function) != rank_functions_.end();
+  };
+  const size_t num_components = mixture.NumComponents();
+  const size_t top = num_components - 1;
+  bool turnarounds = true;
+  std::vector<double> turnaround_sums(num_components, 0.0);
+  std::vector<uint64_t> num_members(num_components, 0);
+  for (size_t k = 0; k < evidences.size(); ++k) {
+    const RunningStatistics& wrrd = evidences[k].latencies[2];
+    turnarounds = turnarounds && wrrd.count > 0;
+    turnaround_sums[components[k]] +=
+        wrrd.mean - evidences[k].latencies[0].mean;
+    num_members[components[k]]++;
+  }
+  bool rank_switch = false;
+  if (turnarounds) {
+    double turnaround = 0.0;
+    for (size_t c = 0; c < top; ++c) {
+      if (num_members[c] > 0) {
+        turnaround = std::max(turnaround, turnaround_sums[c] / num_members[c]);
+      }
+    }
+    double top_turnaround =
+        turnaround_sums[top] / std::max<uint64_t>(num_members[top], 1);
+    logger->info("[+] WRRD turnaround: {:.1f} (highest component), {:.1f} "
+                 "(others)",
+                 top_turnaround, turnaround);
+    rank_switch = num_members[top] > 0 && turnaround > 0.0 &&
+                  2.0 * top_turnaround < turnaround;
+  } else {
+    rank_switch = memory_config_ && GetNumRankDimms(memory_config_) > 1;
+    if (rank_switch && num_components < 3) {
+      logger->info("{}[-] {} RDRD components on a memory with rank switches "
+                   "are ambiguous, time the write turnarounds "
+                   "(--turnarounds, -W) or add trials{}",
+                   color_red, num_components, color_reset);
+      return;
+    }
+  }
+  if (rank_switch && top < 2) {
+    logger->info("{}[-] tCCD_S and tCCD_L are not separated, more trials are "
+                 "needed{}",
+                 color_red, color_reset);
+    return;
+  }
+  size_t bank_address_component = rank_switch ? top - 1 : top;
+  size_t bank_group_component = bank_address_component - 1;
+
+  std::ostringstream bank_group, bank_address;
+  for (size_t k = 0; k < evidences.size(); ++k) {
+    uint64_t function = evidences[k].function;
+    logger->info("Functions: {}, RDRD component: {}, confidence: {:.4f}",
+                 reinterpret_cast<void*>(function), components[k],
+                 confidences[k]);
+    if (is_rank(function)) {
+      if (rank_switch && components[k] != top) {
+        logger->info("{}[!] Function {} has reduced refresh intervals but "
+                     "does not switch ranks{}",
+                     color_yellow, reinterpret_cast<void*>(function),
+                     color_reset);
+      }
+      continue;
+    }
+    function_confidences_[function] = confidences[k];
+    if (confidences[k] < SUDOKU_MIXTURE_MIN_CONFIDENCE) {
+      logger->info("{}[!] Uncertain function {}{}", color_yellow,
+                   reinterpret_cast<void*>(function), color_reset);
+    } else if (components[k] == bank_address_component) {
+      bank_address_functions_.push_back(function);
+      bank_address << reinterpret_cast<void*>(function) << ",";
+    } else if (components[k] == bank_group_component) {
+      bank_group_functions_.push_back(function);
+      bank_group << reinterpret_cast<void*>(function) << ",";
+    } else if (rank_switch && components[k] == top) {
+      logger->info("{}[!] Function {} switches ranks without reduced refresh "
+                   "intervals{}",
+                   color_yellow, reinterpret_cast<void*>(function),
+                   color_reset);
+    }
+  }
+  logger->info("{}[+] Insert to bank group functions: {}{}", color_green,
+               bank_group.str(), color_reset);
   logger->info("{}[+] Insert to bank address functions: {}{}", color_green,
-               oss.str(), color_reset);
-  */
+               bank_address.str(), color_reset);
+}
+
+void Addressing::DecomposeUsingConcurrentRefreshes(std::string log_name) {
+  PRINT_DEBUG_FUNCTION_NAME(debug_);
+
+  auto logger = spdlog::get(log_name);
+  const PlatformProfile& profile = GetPlatformProfile();
+
+  // Address 0 is the base and address k + 1 differs from it only in function
+  // k. Addresses differing in distinct functions map to distinct banks, so
+  // the probes do not conflict in the row buffers. With one address per
+  // function the spikes of an address are sparse, so the intervals are
+  // always estimated spectrally.
+  const size_t num_functions = addressing_functions_.size();
+  if (num_functions == 0) {
+    PRINT_ERROR("No DRAM functions to decompose (--functions, -f or "
+                "--mapping, -M)");
+    return;
+  }
+  const size_t num_addrs = num_functions + 1;
+  const uint64_t num_trials = SUDOKU_REFRESH_SPECTRAL_NUM_TRIAL;
+  const uint64_t success_score = SUDOKU_REFRESH_SPECTRAL_SUCCESS_SCORE;
+  addr_tuple* tuples = new addr_tuple[num_addrs];
+  uint64_t* addrs = new uint64_t[num_addrs];
+  uint64_t** histogram =
+      AllocateHistogram(SUDOKU_REFRESH_CONCURRENT_NUM_ITERATION, num_addrs + 1);
+  std::vector<std::vector<uint64_t>> refreshes;
+  std::vector<uint64_t> trials(num_functions, 0);
+  std::vector<uint64_t> same_phase_scores(num_functions, 0);
+  std::vector<uint64_t> shifted_phase_scores(num_functions, 0);
+  logger->info("[+] Check refresh intervals of {} functions concurrently",
+               num_functions);
+  // ranks refresh tREFI / num_ranks apart (at least two to tell apart)
+  const uint64_t num_ranks =
+      memory_config_ ? std::max<uint64_t>(GetNumRanks(memory_config_), 2) : 2;
+  // Addresses of the base's rank rarely see a spike, so a function is also
+  // decided once too many of its windows put it in the base's rank
+  auto decided = [&](size_t k) {
+    return trials[k] >= num_trials ||
+           same_phase_scores[k] > num_trials - success_score;
+  };
+  uint64_t captures = 0;
+  for (;;) {
+    size_t num_decided = 0;
+    for (size_t k = 0; k < num_functions; ++k) {
+      num_decided += decided(k);
+    }
+    if (num_decided == num_functions || captures++ >= num_trials * 4) {
+      break;
+    }
+    GenerateRandomAddressTuple(&tuples[0]);
+    for (size_t k = 0; k < num_functions; ++k) {
+      std::vector<uint64_t> other_functions(addressing_functions_);
+      other_functions.erase(other_functions.begin() + k);
+      std::vector<uint64_t> diff_functions = {addressing_functions_[k]};
+      while (!GenerateRandomAddressTupleWithConstraints(
+          &tuples[0], &tuples[k + 1], other_functions, diff_functions)) {
+        // retry until found
+      }
+    }
+    for (size_t k = 0; k < num_addrs; ++k) {
+      addrs[k] = reinterpret_cast<uint64_t>(tuples[k].vaddr);
+    }
+
+    MeasureRefreshMultiAccess(addrs, num_addrs,
+                              SUDOKU_REFRESH_CONCURRENT_NUM_ITERATION,
+                              histogram);
+    FilterRefreshTimingMultiAccess(histogram,
+                                   SUDOKU_REFRESH_CONCURRENT_NUM_ITERATION,
+                                   num_addrs, REFRESH_CYCLE_LOWER_BOUND,
+                                   refreshes);
+
+    // The base catches the refreshes of its rank and hides them from the
+    // later addresses of the same rank, which see few spikes or none. An
+    // address of another rank catches its own rank's refreshes, which are
+    // staggered by tREFI / num_ranks. So the rank functions are told apart by
+    // the phase of their spikes at the base's period, not by the interval of
+    // the merged spike trains.
+    double coherence = 0.0;
+    uint64_t period = EstimateRefreshPeriod(
+        refreshes[0], REGULAR_REFRESH_INTERVAL_THRESHOLD,
+        2 * REGULAR_REFRESH_INTERVAL_THRESHOLD, &coherence);
+    // windows without a coherent base period carry no decision
+    if (period == 0 || coherence < SUDOKU_REFRESH_MIN_COHERENCE) {
+      continue;
+    }
+    double base_phase = RefreshPhase(refreshes[0], period);
+    for (size_t k = 0; k < num_functions; ++k) {
+      if (decided(k) || refreshes[k + 1].empty()) {
+        continue;
+      }
+      double distance =
+          std::fabs(RefreshPhase(refreshes[k + 1], period) - base_phase);
+      distance = std::min(distance, period - distance);
+      ++trials[k];
+      if (distance > period / (2.0 * num_ranks)) {
+        ++shifted_phase_scores[k];
+      } else {
+        ++same_phase_scores[k];
+      }
+    }
+  }
+
+  for (size_t k = 0; k < num_functions; ++k) {
+    uint64_t function = addressing_functions_[k];
+    logger->info("Functions: {}, base phase: {}, shifted phase: {}, "
+                 "windows: {}/{}",
+                 reinterpret_cast<void*>(function), same_phase_scores[k],
+                 shifted_phase_scores[k], trials[k], captures);
+    if (shifted_phase_scores[k] >= SUDOKU_REFRESH_SPECTRAL_MIN_EVENTS &&
+        shifted_phase_scores[k] * num_trials > success_score * trials[k]) {
+      rank_functions_.push_back(function);
+      function_confidences_[function] =
+          static_cast<double>(shifted_phase_scores[k]) / trials[k];
+    }
+  }
+  std::ostringstream oss;
+  for (const auto& function : rank_functions_) {
+    oss << reinterpret_cast<void*>(function) << ",";
+  }
+  logger->info("{}[+] Insert to {} functions: {}{}", color_green,
+               profile.reduced_refresh_functions, oss.str(), color_reset);
+
+  FreeHistogram(histogram, SUDOKU_REFRESH_CONCURRENT_NUM_ITERATION);
+  delete[] addrs;
+  delete[] tuples;
+}
+
+void Addressing::DecomposeUsingConsecutiveAccesses() {
+  PRINT_DEBUG_FUNCTION_NAME(debug_);
+  ScopedPhase phase(__func__);
+  if (!Decomposable()) {
+    return;
+  }
+
+  std::string fname = fname_prefix_ + ".decompose.rdrd.log";
+  std::string log_name = "decompose_rdrd_sink";
+
+  SetupLogger(fname, log_name);
+  auto logger = spdlog::get(log_name);
+  logger->set_pattern("%v");
+
+  // The write turnarounds, if timed, are logged and ranked for diagnosis
+  const size_t num_patterns =
+      addressing_config_->turnarounds
+          ? sizeof(ConsecutiveAccesses) / sizeof(ConsecutiveAccesses[0])
+          : 1;
+  std::vector<std::vector<std::pair<uint64_t, uint64_t>>> latencies(
+      num_patterns);
+
+  addr_tuple* ftuple = new addr_tuple;
+  addr_tuple* stuple = new addr_tuple;
+  uint64_t* faddrs = new uint64_t[CONSECUTIVE_LENGTH];
+  uint64_t* saddrs = new uint64_t[CONSECUTIVE_LENGTH];
+  std::vector<FunctionEvidence> evidences;
+  for (const auto& function : addressing_functions_) {
+    logger->info("[+] Check consecutive memory accesses of function {}",
+                 reinterpret_cast<void*>(function));
+    std::vector<uint64_t> other_functions(addressing_functions_);
+    other_functions.erase(
+        std::remove(other_functions.begin(), other_functions.end(), function),
+        other_functions.end());
+    std::vector<uint64_t> diff_functions = {function};
+
+    // Checking for each function
+    FunctionEvidence evidence(function);
+    while (evidence.latencies[0].count <
+           SUDOKU_CONSECUTIVE_NUM_EFFECTIVE_TRIAL) {
+      // Generate two base addresses satisfying the constraints
+      GenerateRandomAddressTuple(ftuple);
+      while (!GenerateRandomAddressTupleWithConstraints(
+          ftuple, stuple, other_functions, diff_functions)) {
+        // retry until found
+      }
+
+      // We use different offsets for each access stream
+      if (GenerateRowBufferHitStreams(ftuple, stuple, CONSECUTIVE_LENGTH,
+                                      faddrs, saddrs)) {
+        TimeConsecutiveAccesses(evidence, faddrs, saddrs);
+      }
+    }
+    for (size_t i = 0; i < num_patterns; ++i) {
+      latencies[i].push_back(
+          {function, static_cast<uint64_t>(evidence.latencies[i].mean)});
+    }
+    logger->info("Functions: {}, Avg RDRD latency: {:.0f}{}",
+                 reinterpret_cast<void*>(function), evidence.latencies[0].mean,
+                 TurnaroundLatencies(evidence));
+    evidences.push_back(evidence);
+  }
+
+  // sort
+  for (size_t i = 0; i < num_patterns; ++i) {
+    std::sort(latencies[i].begin(), latencies[i].end(),
+              [](const auto& a, const auto& b) { return a.second < b.second; });
+    std::ostringstream oss;
+    for (const auto& latency : latencies[i]) {
+      oss << reinterpret_cast<void*>(latency.first) << "(" << latency.second
+          << "),";
+    }
+    logger->info("[+] Functions sorted by {} latency: {}",
+                 ConsecutiveAccessStr[static_cast<int>(ConsecutiveAccesses[i])],
+                 oss.str());
+  }
+  // Rank functions come from DecomposeUsingRefreshes
+  ClassifyBanks(evidences, log_name);
 
   delete ftuple;
   delete stuple;
@@ -955,41 +1931,45 @@ bool Addressing::EnoughSameBankPairs() {
 // "DRAMA: Exploiting DRAM Addressing for Cross-CPU Attacks," SEC, 2016
 void Addressing::CollectSameBankPairs(std::string log_name) {
   PRINT_DEBUG_FUNCTION_NAME(debug_);
+  CheckpointedPhase checkpointed(addressing_config_->checkpoint);
   std::vector<uint64_t> used_addresses;
+  std::vector<addr_tuple> candidates;
   addr_tuple* generated = new addr_tuple;
 
   auto logger = spdlog::get(log_name);
   logger->set_pattern("%v");
 
   logger->info("[+] Collect Same Bank, Different Row Pairs");
+  // resumed sets
+  for (const auto& set : sbdr_pairs_) {
+    for (const auto& addr : set) {
+      used_addresses.push_back(reinterpret_cast<uint64_t>(addr.vaddr));
+    }
+  }
   while (!EnoughSameBankPairs()) {
+    if (addressing_config_->checkpoint && CheckpointDue()) {
+      RecordSameBankPairs();
+      SaveCheckpoint();
+    }
     GenerateRandomAddressTuple(generated);
     if (std::find(used_addresses.begin(), used_addresses.end(),
                   reinterpret_cast<uint64_t>(generated->vaddr)) !=
         used_addresses.end()) {
       continue;
     }
-
-    bool found = false;
     used_addresses.push_back(reinterpret_cast<uint64_t>(generated->vaddr));
-    for (uint64_t i = 0; i < sbdr_pairs_.size(); ++i) {
-      addr_tuple base = sbdr_pairs_[i][0];
-      uint64_t latency = AverageAccessTimingPairedMemoryAccess(
-          reinterpret_cast<uint64_t>(base.vaddr),
-          reinterpret_cast<uint64_t>(generated->vaddr));
-      if (latency > SBDR_LOWER_BOUND && latency < SBDR_UPPER_BOUND) {
-        logger->info("Insert address {} to set {} with latency {} cycles.",
-                     reinterpret_cast<void*>(generated->paddr - PCI_OFFSET), i,
-                     latency);
-        sbdr_pairs_[i].push_back(*generated);
-        found = true;
-        break;
-      }
-    }
 
-    if (!found) {
-      sbdr_pairs_.push_back({*generated});
+    // Batching needs at least one distinct set (bank) per candidate
+    if (addressing_config_->batched &&
+        sbdr_pairs_.size() >= SUDOKU_CONFLICT_BATCH_SIZE) {
+      candidates.push_back(*generated);
+      if (candidates.size() == SUDOKU_CONFLICT_BATCH_SIZE) {
+        InsertSameBankCandidates(candidates, log_name);
+        candidates.clear();
+      }
+      continue;
     }
+    InsertSameBankCandidate(*generated, 0, log_name);
   }
 
   // filter
@@ -999,11 +1979,457 @@ void Addressing::CollectSameBankPairs(std::string log_name) {
       s--;
     }
   }
+  if (addressing_config_->checkpoint) {
+    RecordSameBankPairs();
+    SaveCheckpoint();
+  }
 
   delete generated;
 }
+
+void Addressing::InsertSameBankCandidate(const addr_tuple& candidate,
+                                         size_t first_set,
+                                         std::string log_name) {
+  auto logger = spdlog::get(log_name);
+  for (uint64_t i = first_set; i < sbdr_pairs_.size(); ++i) {
+    addr_tuple base = sbdr_pairs_[i][0];
+    uint64_t latency = AverageAccessTimingPairedMemoryAccess(
+        reinterpret_cast<uint64_t>(base.vaddr),
+        reinterpret_cast<uint64_t>(candidate.vaddr));
+    if (latency > SBDR_LOWER_BOUND && latency < SBDR_UPPER_BOUND) {
+      logger->info("Insert address {} to set {} with latency {} cycles.",
+                   reinterpret_cast<void*>(candidate.paddr - PCI_OFFSET), i,
+                   latency);
+      sbdr_pairs_[i].push_back(candidate);
+      return;
+    }
+  }
+  sbdr_pairs_.push_back({candidate});
+}
+
+void Addressing::InsertSameBankCandidates(
+    const std::vector<addr_tuple>& candidates, std::string log_name) {
+  auto logger = spdlog::get(log_name);
+  const size_t num_sets = sbdr_pairs_.size();
+  const size_t num_candidates = candidates.size();
+  std::vector<int64_t> assigned(num_candidates, -1);
+  std::vector<uint64_t> assigned_latency(num_candidates, 0);
+  std::vector<size_t> batch_candidates, batch_sets;
+  uint64_t* faddrs = new uint64_t[num_candidates];
+  uint64_t* saddrs = new uint64_t[num_candidates];
+  uint64_t* latencies = new uint64_t[num_candidates];
+
+  // In pass `shift`, candidate j is paired with set (j + shift) % num_sets,
+  // so all pairs of a pass hit distinct sets and every candidate meets every
+  // set after num_sets passes.
+  for (size_t shift = 0; shift < num_sets; ++shift) {
+    batch_candidates.clear();
+    batch_sets.clear();
+    for (size_t j = 0; j < num_candidates; ++j) {
+      if (assigned[j] != -1) {
+        continue;
+      }
+      size_t set = (j + shift) % num_sets;
+      faddrs[batch_candidates.size()] =
+          reinterpret_cast<uint64_t>(sbdr_pairs_[set][0].vaddr);
+      saddrs[batch_candidates.size()] =
+          reinterpret_cast<uint64_t>(candidates[j].vaddr);
+      batch_candidates.push_back(j);
+      batch_sets.push_back(set);
+    }
+    if (batch_candidates.empty()) {
+      break;
+    }
+    AverageAccessTimingBatchedPairedMemoryAccess(
+        faddrs, saddrs, batch_candidates.size(), latencies);
+    for (size_t k = 0; k < batch_candidates.size(); ++k) {
+      if (latencies[k] > SBDR_LOWER_BOUND && latencies[k] < SBDR_UPPER_BOUND) {
+        assigned[batch_candidates[k]] = batch_sets[k];
+        assigned_latency[batch_candidates[k]] = latencies[k];
+      }
+    }
+  }
+
+  for (size_t j = 0; j < num_candidates; ++j) {
+    if (assigned[j] != -1) {
+      logger->info("Insert address {} to set {} with latency {} cycles.",
+                   reinterpret_cast<void*>(candidates[j].paddr - PCI_OFFSET),
+                   assigned[j], assigned_latency[j]);
+      sbdr_pairs_[assigned[j]].push_back(candidates[j]);
+    } else {
+      // unmatched candidates may still share a bank with each other
+      InsertSameBankCandidate(candidates[j], num_sets, log_name);
+    }
+  }
+
+  delete[] faddrs;
+  delete[] saddrs;
+  delete[] latencies;
+}
 /* end of DRAMA */
 
+bool Addressing::GenerateRowBufferHitStreams(const addr_tuple* ftuple,
+                                             const addr_tuple* stuple,
+                                             uint64_t length, uint64_t* faddrs,
+                                             uint64_t* saddrs) {
+  std::vector<uint64_t> offsets = GenerateRowBufferHitSequences(length);
+  for (size_t j = 0; j < length; ++j) {
+    faddrs[j] = PhysToVirt(
+        pool_, (((ftuple->paddr - PCI_OFFSET) ^ offsets[j]) + PCI_OFFSET));
+  }
+  offsets = GenerateRowBufferHitSequences(length);
+  for (size_t j = 0; j < length; ++j) {
+    saddrs[j] = PhysToVirt(
+        pool_, (((stuple->paddr - PCI_OFFSET) ^ offsets[j]) + PCI_OFFSET));
+  }
+
+  for (size_t j = 0; j < length; ++j) {
+    if (faddrs[j] == 0 || saddrs[j] == 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void Addressing::MeasurePairs(
+    uint64_t num_pairs, std::function<void(addr_tuple*, addr_tuple*)> generate,
+    std::function<uint64_t(uint64_t, uint64_t, uint64_t*)> measure,
+    std::string fname, std::string log_name, bool with_num) {
+  auto logger = spdlog::get(log_name);
+  ResultSink sink;
+  bool binary = OpenResultSink(fname, num_pairs, with_num, &sink);
+  MeasurePairs(num_pairs, generate, measure, [&](const PairResult& result) {
+    RecordResult(&sink, binary, logger, result, with_num);
+  });
+  CloseResultSink(&sink, binary, fname);
+}
+
+void Addressing::MeasurePairs(
+    uint64_t num_pairs, std::function<void(addr_tuple*, addr_tuple*)> generate,
+    std::function<uint64_t(uint64_t, uint64_t, uint64_t*)> measure,
+    std::function<void(const ResultRecord&)> consume) {
+  auto produce = [&](uint64_t idx, PairJob* job) {
+    job->idx = idx;
+    generate(&job->first, &job->second);
+  };
+  auto measure_job = [&](const PairJob& job, PairResult* result) {
+    result->idx = job.idx;
+    result->fpaddr = job.first.paddr;
+    result->spaddr = job.second.paddr;
+    result->num = measure(reinterpret_cast<uint64_t>(job.first.vaddr),
+                          reinterpret_cast<uint64_t>(job.second.vaddr),
+                          result->statistics);
+  };
+
+  if (addressing_config_->pipelined) {
+    Pipeline<PairJob, PairResult> pipeline(addressing_config_->helper_core);
+    pipeline.Run(num_pairs, produce, measure_job, consume);
+  } else {
+    PairJob job;
+    PairResult result;
+    for (uint64_t i = 0; i < num_pairs; ++i) {
+      produce(i, &job);
+      measure_job(job, &result);
+      consume(result);
+    }
+  }
+}
+
+bool Addressing::OpenResultSink(std::string fname, uint64_t capacity,
+                                bool with_num, ResultSink* sink) {
+  if (!addressing_config_->binary && !addressing_config_->columnar) {
+    return false;
+  }
+  // {prefix}.stat.paired.memory.access.log -> ...access.bin
+  std::string bin_fname = fname.substr(0, fname.rfind(".log")) + ".bin";
+  if (!sink->Open(bin_fname, capacity, with_num, PCI_OFFSET)) {
+    PRINT_WARNING("Falling back to logging the results");
+    return false;
+  }
+  if (verbose_) {
+    PRINT_INFO("Writing results to {}", bin_fname);
+  }
+  return true;
+}
+
+void Addressing::CloseResultSink(ResultSink* sink, bool binary,
+                                 std::string fname) {
+  if (!binary) {
+    return;
+  }
+  sink->Close();
+  if (!addressing_config_->columnar) {
+    return;
+  }
+  // Encode after the run; the .bin is kept if encoding fails
+  std::string prefix = fname.substr(0, fname.rfind(".log"));
+  if (ConvertResultFileToColumnar(prefix + ".bin", prefix + ".col",
+                                  ResultMetadata(fname),
+                                  addressing_functions_)) {
+    std::remove((prefix + ".bin").c_str());
+    if (verbose_) {
+      PRINT_INFO("Wrote columnar results to {}.col", prefix);
+    }
+  }
+}
+
+bool Addressing::ReportRun(std::string binary) {
+  std::string fname = fname_prefix_ + ".report.json";
+  if (!WriteRunReport(fname, ResultMetadata(binary))) {
+    return false;
+  }
+  PRINT_INFO("Run report: {}", fname);
+  return true;
+}
+
+MappingArtifact Addressing::Mapping(std::string binary) const {
+  const PlatformProfile& profile = GetPlatformProfile();
+  MappingArtifact mapping;
+  mapping.binary = binary;
+  mapping.platform = profile.name;
+  mapping.sbdr_lower_bound = profile.sbdr_lower_bound;
+  mapping.sbdr_upper_bound = profile.sbdr_upper_bound;
+  mapping.bank_group_threshold = profile.bank_group_threshold;
+  mapping.refresh_cycle_lower_bound = profile.refresh_cycle_lower_bound;
+  mapping.regular_refresh_interval_threshold =
+      profile.regular_refresh_interval_threshold;
+  mapping.reduced_refresh_interval_lower_bound =
+      profile.reduced_refresh_interval_lower_bound;
+  mapping.pci_offset = PCI_OFFSET;
+  mapping.ddr_type = dram_config_->type;
+  mapping.module_size = dram_config_->module_size;
+  mapping.num_ranks = dram_config_->num_ranks;
+  mapping.dq_width = dram_config_->dq;
+  mapping.num_dimms = memory_config_->num_dimms_per_channel;
+
+  const std::vector<std::pair<FunctionRole, const std::vector<uint64_t>*>>
+      roles = {{FunctionRole::CHANNEL, &channel_functions_},
+               {FunctionRole::RANK, &rank_functions_},
+               {FunctionRole::BANK_GROUP, &bank_group_functions_},
+               {FunctionRole::BANK_ADDRESS, &bank_address_functions_}};
+  for (const auto& function : addressing_functions_) {
+    MappedFunction entry = {function, FunctionRole::UNKNOWN, -1.0};
+    for (const auto& role : roles) {
+      if (std::find(role.second->begin(), role.second->end(), function) !=
+          role.second->end()) {
+        entry.role = role.first;
+      }
+    }
+    auto it = function_confidences_.find(function);
+    if (it != function_confidences_.end()) {
+      entry.confidence = it->second;
+    }
+    mapping.functions.push_back(entry);
+  }
+  mapping.row_bits = row_bits_;
+  mapping.column_bits = column_bits_;
+  mapping.bit_confidences = bit_confidences_;
+  mapping.validated = validated_;
+  return mapping;
+}
+
+bool Addressing::WriteMapping(std::string binary) {
+  std::string fname = fname_prefix_ + ".mapping.json";
+  if (!WriteMappingArtifact(fname, Mapping(binary))) {
+    return false;
+  }
+  PRINT_INFO("Mapping: {}", fname);
+  return true;
+}
+
+bool Addressing::SetMapping(const MappingArtifact& mapping) {
+  // Functions and bits apply to physical addresses without the PCI offset
+  if (mapping.pci_offset != PCI_OFFSET) {
+    PRINT_ERROR("Mapping measured with PCI offset {:#x}, running with {:#x}",
+                mapping.pci_offset, PCI_OFFSET);
+    return false;
+  }
+  SetAddressingFunctions(mapping.Functions());
+  SetChannelFunctions(mapping.Functions(FunctionRole::CHANNEL));
+  SetRankFunctions(mapping.Functions(FunctionRole::RANK));
+  SetBankGroupFunctions(mapping.Functions(FunctionRole::BANK_GROUP));
+  SetBankAddressFunctions(mapping.Functions(FunctionRole::BANK_ADDRESS));
+  SetRowBits(mapping.row_bits);
+  SetColumnBits(mapping.column_bits);
+  function_confidences_.clear();
+  for (const auto& entry : mapping.functions) {
+    if (entry.confidence >= 0.0) {
+      function_confidences_[entry.function] = entry.confidence;
+    }
+  }
+  bit_confidences_ = mapping.bit_confidences;
+  validated_ = mapping.validated;
+  if (mapping.platform != GetPlatformProfile().name) {
+    PRINT_WARNING("Mapping measured on platform {}, running on {}",
+                  mapping.platform, GetPlatformProfile().name);
+  }
+  return true;
+}
+
+bool Addressing::ResumeCheckpoint() {
+  std::string fname = fname_prefix_ + ".checkpoint";
+  Checkpoint checkpoint;
+  if (!ReadCheckpoint(fname, &checkpoint)) {
+    return false;
+  }
+  if (!checkpoint.rng.empty()) {
+    std::istringstream iss(checkpoint.rng);
+    iss >> pool_->gen;
+  }
+  // Frames of the previous pool that this pool did not get are dropped
+  uint64_t num_addrs = 0, num_remapped = 0;
+  sbdr_pairs_.clear();
+  for (const auto& set : checkpoint.sets) {
+    std::vector<addr_tuple> remapped;
+    for (const auto& paddr : set) {
+      uint64_t vaddr = PhysToVirt(pool_, paddr);
+      if (vaddr != 0) {
+        remapped.push_back({reinterpret_cast<char*>(vaddr), paddr});
+      }
+    }
+    num_addrs += set.size();
+    num_remapped += remapped.size();
+    if (!remapped.empty()) {
+      sbdr_pairs_.push_back(remapped);
+    }
+  }
+  checkpoint_ = checkpoint;
+  PRINT_INFO("Resume from {}: {} sets ({} of {} addresses in the pool), {} "
+             "masks, {} functions with evidence",
+             fname, sbdr_pairs_.size(), num_remapped, num_addrs,
+             checkpoint_.masks.size(), checkpoint_.evidences.size());
+  return true;
+}
+
+void Addressing::MatchCheckpoint(const std::vector<uint64_t>& functions) {
+  if (checkpoint_.functions == functions) {
+    return;
+  }
+  if (!checkpoint_.masks.empty() || !checkpoint_.evidences.empty()) {
+    PRINT_WARNING("Checkpoint measured other functions, dropping {} masks and "
+                  "{} functions with evidence",
+                  checkpoint_.masks.size(), checkpoint_.evidences.size());
+  }
+  checkpoint_.functions = functions;
+  checkpoint_.masks.clear();
+  checkpoint_.evidences.clear();
+  checkpoint_.num_pairs = 0;
+}
+
+bool Addressing::RestoreMaskScore(uint64_t mask, uint64_t* row_bit_score,
+                                  uint64_t* column_bit_score,
+                                  uint64_t* effective_trials,
+                                  uint64_t* trials) {
+  auto it = checkpoint_.masks.find(mask);
+  if (it == checkpoint_.masks.end()) {
+    return false;
+  }
+  *row_bit_score = it->second.row_bit_score;
+  *column_bit_score = it->second.column_bit_score;
+  *effective_trials = it->second.effective_trials;
+  *trials = it->second.trials;
+  return true;
+}
+
+void Addressing::RecordMaskScore(uint64_t mask, uint64_t row_bit_score,
+                                 uint64_t column_bit_score,
+                                 uint64_t effective_trials, uint64_t trials) {
+  if (!addressing_config_->checkpoint) {
+    return;
+  }
+  checkpoint_.masks[mask] = {row_bit_score, column_bit_score, effective_trials,
+                             trials};
+  if (CheckpointDue()) {
+    SaveCheckpoint();
+  }
+}
+
+void Addressing::RecordSameBankPairs() {
+  checkpoint_.sets.clear();
+  for (const auto& set : sbdr_pairs_) {
+    checkpoint_.sets.emplace_back();
+    for (const auto& addr : set) {
+      checkpoint_.sets.back().push_back(addr.paddr);
+    }
+  }
+}
+
+void Addressing::SaveCheckpoint() {
+  std::string fname = fname_prefix_ + ".checkpoint";
+  std::ostringstream oss;
+  oss << pool_->gen;
+  checkpoint_.rng = oss.str();
+  bool saved = WriteCheckpoint(fname, checkpoint_);
+  StartCheckpointTimer();
+  if (CheckpointInterrupted()) {
+    if (saved) {
+      PRINT_INFO("Interrupted, continue with --resume from {}", fname);
+    }
+    exit(EXIT_FAILURE);
+  }
+  if (saved && verbose_) {
+    PRINT_INFO("Checkpoint: {}", fname);
+  }
+}
+
+ColumnarMetadata Addressing::ResultMetadata(std::string fname) {
+  std::ostringstream oss;
+  ColumnarMetadata metadata;
+  metadata.emplace_back("source", fname);
+  metadata.emplace_back("platform", GetPlatformProfile().ToString());
+  metadata.emplace_back("ddr_type",
+                        DDRTypeStr[static_cast<int>(dram_config_->type)]);
+  metadata.emplace_back("module_size",
+                        std::to_string(dram_config_->module_size));
+  metadata.emplace_back("num_ranks", std::to_string(dram_config_->num_ranks));
+  metadata.emplace_back("dq_width", std::to_string(dram_config_->dq));
+  metadata.emplace_back(
+      "num_dimms", std::to_string(memory_config_->num_dimms_per_channel));
+  oss << reinterpret_cast<void*>(row_bits_);
+  metadata.emplace_back("row_bits", oss.str());
+  oss.str("");
+  oss << reinterpret_cast<void*>(column_bits_);
+  metadata.emplace_back("column_bits", oss.str());
+  return metadata;
+}
+
+void Addressing::RecordResult(ResultSink* sink, bool binary,
+                              const std::shared_ptr<spdlog::logger>& logger,
+                              const ResultRecord& record, bool with_num) {
+  if (binary) {
+    sink->Append(record);
+  } else if (with_num) {
+    logger->info("{},{},{},{},{},{},{},{}", record.idx,
+                 reinterpret_cast<void*>(record.fpaddr - PCI_OFFSET),
+                 reinterpret_cast<void*>(record.spaddr - PCI_OFFSET),
+                 record.statistics[0], record.statistics[1],
+                 record.statistics[2], record.statistics[3], record.num);
+  } else {
+    logger->info("{},{},{},{},{},{},{}", record.idx,
+                 reinterpret_cast<void*>(record.fpaddr - PCI_OFFSET),
+                 reinterpret_cast<void*>(record.spaddr - PCI_OFFSET),
+                 record.statistics[0], record.statistics[1],
+                 record.statistics[2], record.statistics[3]);
+  }
+}
+
+void Addressing::GenerateDistinctAddressPairs(addr_tuple* ftuples,
+                                              addr_tuple* stuples,
+                                              size_t num_pairs) {
+  // batched kernels require that no address is shared between pairs
+  std::vector<char*> used;
+  for (size_t k = 0; k < num_pairs; ++k) {
+    do {
+      GenerateTwoRandomAddressTuples(&ftuples[k], &stuples[k]);
+    } while (std::find(used.begin(), used.end(), ftuples[k].vaddr) !=
+                 used.end() ||
+             std::find(used.begin(), used.end(), stuples[k].vaddr) !=
+                 used.end());
+    used.push_back(ftuples[k].vaddr);
+    used.push_back(stuples[k].vaddr);
+  }
+}
+
 std::vector<uint64_t> Addressing::MergeFunctionsToDisjointSets(
     std::vector<uint64_t> functions) {
   std::vector<uint64_t> merged_functions = std::move(functions);
@@ -1040,7 +2466,8 @@ std::vector<uint64_t> Addressing::MergeFunctionsToDisjointSets(
 }
 
 std::vector<uint64_t> Addressing::DeriveFunctions(
-    std::vector<std::vector<addr_tuple>> sets, std::string log_name) {
+    std::vector<std::vector<addr_tuple>> sets, std::string log_name,
+    uint64_t max_function_bits) {
   PRINT_DEBUG_FUNCTION_NAME(debug_);
 
   auto logger = spdlog::get(log_name);
@@ -1052,7 +2479,7 @@ std::vector<uint64_t> Addressing::DeriveFunctions(
   // below code came from TRRespass' GitHub
   // https://github.com/vusec/trrespass/blob/master/drama/src/rev-mc.c
   // (find_functions)
-  for (uint64_t b = FUNCTION_MIN_NUM_BITS; b <= FUNCTION_MAX_NUM_BITS; ++b) {
+  for (uint64_t b = FUNCTION_MIN_NUM_BITS; b <= max_function_bits; ++b) {
     uint64_t function_mask = ((1 << b) - 1);
     uint64_t last_function_mask = (function_mask << (max_bits_ - b));
     function_mask <<= CACHELINE_OFFSET;
@@ -1088,22 +2515,26 @@ std::vector<uint64_t> Addressing::DeriveFunctions(
 }
 
 void Addressing::CheckUnusedBits(uint64_t bitmask, std::string log_name) {
+  CheckpointedPhase checkpointed(addressing_config_->checkpoint);
   // Check uncovered bits
   // unused bits always generates the same rank and same bank xor mask (from
-  // derived addressing functions) therefore, we generate and use all possible
-  // combinations.
+  // derived addressing functions) therefore, each bit is either a row or a
+  // column bit on its own. A combination of them is a row function as soon as
+  // one of its bits is, so testing the single bits is enough; testing all
+  // combinations grows exponentially with the number of uncovered bits.
   auto logger = spdlog::get(log_name);
   logger->set_pattern("%v");
 
   logger->info("Check unused bits");
   addr_tuple* base = new addr_tuple;
 
-  // Exhaustive testing to verify all possible bitmasks
-  std::vector<uint64_t> masks = GenerateAllCombinations(bitmask);
-  for (const auto& mask : masks) {
+  for (uint64_t bits = bitmask; bits != 0; bits &= bits - 1) {
+    uint64_t mask = bits & -bits;
     uint64_t row_bit_score = 0, column_bit_score = 0, trials = 0,
              effective_trials = 0;
-    while (trials++ < SUDOKU_MAX_NUM_TRIALS) {
+    bool restored = RestoreMaskScore(mask, &row_bit_score, &column_bit_score,
+                                     &effective_trials, &trials);
+    while (!restored && trials++ < SUDOKU_MAX_NUM_TRIALS) {
       uint64_t vaddr = 0, paddr = 0, latency = 0;
       GenerateRandomAddressTuple(base);
       paddr = ((base->paddr - PCI_OFFSET) ^ mask) + PCI_OFFSET;
@@ -1125,6 +2556,10 @@ void Addressing::CheckUnusedBits(uint64_t bitmask, std::string log_name) {
         }
       }
     }
+    if (!restored) {
+      RecordMaskScore(mask, row_bit_score, column_bit_score, effective_trials,
+                      trials);
+    }
 
     if (trials >= SUDOKU_MAX_NUM_TRIALS) {
       logger->info("[ failed to identify ] {} exceeds the maximum attempts!",
@@ -1144,12 +2579,18 @@ void Addressing::CheckUnusedBits(uint64_t bitmask, std::string log_name) {
                    reinterpret_cast<void*>(mask), row_bit_score,
                    column_bit_score, trials);
     }
+    if (effective_trials > 0) {
+      bit_confidences_[mask] =
+          static_cast<double>(std::max(row_bit_score, column_bit_score)) /
+          effective_trials;
+    }
   }
   delete base;
 }
 
 void Addressing::CheckUsedBits(std::vector<uint64_t> disjoint_sets,
                                std::string log_name) {
+  CheckpointedPhase checkpointed(addressing_config_->checkpoint);
   // Check covered bits
   // Considering the derived addressing functions, we change the even number
   // of bits in a specific addressing functions to generate same hash output.
@@ -1175,27 +2616,52 @@ void Addressing::CheckUsedBits(std::vector<uint64_t> disjoint_sets,
       // for the even number of bits in mask to generate the same hash value.
       if (__builtin_popcountll(mask) >= 4) continue;
       if (XORReductionWithMasks(involved_functions, mask) != 0) continue;
-      while (trials++ < SUDOKU_MAX_NUM_TRIALS) {
-        uint64_t vaddr = 0, paddr = 0, latency = 0;
-        GenerateRandomAddressTuple(base);
-        paddr = ((base->paddr - PCI_OFFSET) ^ mask) + PCI_OFFSET;
-        vaddr = PhysToVirt(pool_, paddr);
-
-        if (vaddr != 0) {
-          effective_trials++;
-          latency = AverageAccessTimingPairedMemoryAccess(
-              reinterpret_cast<uint64_t>(base->vaddr), vaddr);
-
-          if ((latency > SBDR_LOWER_BOUND) && (latency < SBDR_UPPER_BOUND)) {
-            row_bit_score++;
-          } else {
-            column_bit_score++;
-          }
-
-          if (effective_trials >= SUDOKU_NUM_EFFECTIVE_TRIAL) {
-            break;
+      bool restored = RestoreMaskScore(mask, &row_bit_score,
+                                       &column_bit_score, &effective_trials,
+                                       &trials);
+      // Pairs are independent: each round measures as many pairs as
+      // effective trials are missing. Addresses outside the pool are
+      // redrawn; pairs drawn after the last attempt have no second address
+      // and are skipped (statistics[0] flags a measured pair).
+      auto generate = [&](addr_tuple* ftuple, addr_tuple* stuple) {
+        stuple->vaddr = nullptr;
+        stuple->paddr = 0;
+        while (trials <= SUDOKU_MAX_NUM_TRIALS &&
+               trials++ < SUDOKU_MAX_NUM_TRIALS) {
+          GenerateRandomAddressTuple(ftuple);
+          stuple->paddr = ((ftuple->paddr - PCI_OFFSET) ^ mask) + PCI_OFFSET;
+          stuple->vaddr =
+              reinterpret_cast<char*>(PhysToVirt(pool_, stuple->paddr));
+          if (stuple->vaddr != nullptr) {
+            return;
           }
         }
+      };
+      auto measure = [](uint64_t faddr, uint64_t saddr, uint64_t* statistics) {
+        statistics[0] = (saddr != 0);
+        return saddr ? AverageAccessTimingPairedMemoryAccess(faddr, saddr)
+                     : 0ULL;
+      };
+      auto score = [&](const PairResult& result) {
+        if (!result.statistics[0]) {
+          return;
+        }
+        effective_trials++;
+        if ((result.num > SBDR_LOWER_BOUND) &&
+            (result.num < SBDR_UPPER_BOUND)) {
+          row_bit_score++;
+        } else {
+          column_bit_score++;
+        }
+      };
+      while (!restored && effective_trials < SUDOKU_NUM_EFFECTIVE_TRIAL &&
+             trials <= SUDOKU_MAX_NUM_TRIALS) {
+        MeasurePairs(SUDOKU_NUM_EFFECTIVE_TRIAL - effective_trials, generate,
+                     measure, score);
+      }
+      if (!restored) {
+        RecordMaskScore(mask, row_bit_score, column_bit_score,
+                        effective_trials, trials);
       }
 
       if (trials > SUDOKU_MAX_NUM_TRIALS) {
@@ -1218,6 +2684,11 @@ void Addressing::CheckUsedBits(std::vector<uint64_t> disjoint_sets,
                      reinterpret_cast<void*>(mask), row_bit_score,
                      column_bit_score, trials);
       }
+      if (__builtin_popcountll(mask) == 1 && effective_trials > 0) {
+        bit_confidences_[mask] =
+            static_cast<double>(std::max(row_bit_score, column_bit_score)) /
+            effective_trials;
+      }
     }
   }
   delete base;
@@ -1241,7 +2712,15 @@ void Addressing::FilterSameBankPairs(std::string log_name) {
 
   uint32_t idx = 0;
   logger->info("[+] Filter Same Bank Different Row Pairs");
+  RefreshScheduler scheduler;
   for (auto& set : sbdr_pairs_) {
+    // All addresses of a set share a bank, hence a rank and its refreshes
+    bool scheduled = addressing_config_->scheduled && !set.empty() &&
+                     scheduler.Lock(reinterpret_cast<uint64_t>(set[0].vaddr));
+    if (addressing_config_->scheduled && !scheduled) {
+      logger->info("No refresh phase lock for set {}, filter unscheduled",
+                   idx);
+    }
     for (auto it = set.begin(); it != set.end();) {
       uint64_t score = 0;
       for (const auto& other : set) {
@@ -1249,9 +2728,12 @@ void Addressing::FilterSameBankPairs(std::string log_name) {
           continue;
         }
 
-        uint64_t latency = AverageAccessTimingPairedMemoryAccess(
-            reinterpret_cast<uint64_t>(it->vaddr),
-            reinterpret_cast<uint64_t>(other.vaddr));
+        uint64_t faddr = reinterpret_cast<uint64_t>(it->vaddr);
+        uint64_t saddr = reinterpret_cast<uint64_t>(other.vaddr);
+        uint64_t latency =
+            scheduled ? AverageAccessTimingPairedMemoryAccessScheduled(
+                            faddr, saddr, scheduler)
+                      : AverageAccessTimingPairedMemoryAccess(faddr, saddr);
 
         if (latency < SBDR_LOWER_BOUND) {
           score++;
@@ -2,8 +2,16 @@
 #define SUDOKU_SUDOKU_ADDRESSING_H
 
 #include <cstdint>
+#include <functional>
+#include <map>
 #include <vector>
 
+#include "checkpoint.h"
+#include "columnar.h"
+#include "consecutive_accesses.h"
+#include "constants.h"
+#include "mapping.h"
+#include "result_sink.h"
 #include "sudoku.h"
 
 namespace sudoku {
@@ -16,19 +24,71 @@ struct AddressingConfig {
   bool verbose;
   bool debug;
   bool logging;
+  bool batched;   // batched conflict measurements when collecting sets
+  bool spectral;  // spectral refresh interval estimation when decomposing
+  bool scheduled;  // conflict filtering scheduled between refreshes
+  bool concurrent;  // probe all functions in one refresh capture
+  bool turnarounds;  // also time the write turnarounds when decomposing
+  uint64_t trial_budget;  // pairs per decomposition (0: fixed per function)
+  bool pipelined;  // prepare and log pairs on a helper thread
+  int helper_core;  // helper thread core (negative: any other allowed core)
+  bool binary;  // write stat results to binary result files (.bin)
+  bool columnar;  // encode binary results into columnar files (.col)
+  bool checkpoint;  // checkpoint long-running phases to {prefix}.checkpoint
 
   AddressingConfig()
       : type("ddr4"),
         fname_prefix("default"),
         verbose(false),
         debug(false),
-        logging(false) {}
+        logging(false),
+        batched(false),
+        spectral(false),
+        scheduled(false),
+        concurrent(false),
+        turnarounds(false),
+        trial_budget(0),
+        pipelined(false),
+        helper_core(-1),
+        binary(false),
+        columnar(false),
+        checkpoint(false) {}
 
   AddressingConfig(std::string f, bool v, bool d, bool l)
-      : type("ddr4"), fname_prefix(f), verbose(v), debug(d), logging(l) {}
+      : type("ddr4"),
+        fname_prefix(f),
+        verbose(v),
+        debug(d),
+        logging(l),
+        batched(false),
+        spectral(false),
+        scheduled(false),
+        concurrent(false),
+        turnarounds(false),
+        trial_budget(0),
+        pipelined(false),
+        helper_core(-1),
+        binary(false),
+        columnar(false),
+        checkpoint(false) {}
 
   AddressingConfig(std::string t, std::string f, bool v, bool d, bool l)
-      : type(t), fname_prefix(f), verbose(v), debug(d), logging(l) {}
+      : type(t),
+        fname_prefix(f),
+        verbose(v),
+        debug(d),
+        logging(l),
+        batched(false),
+        spectral(false),
+        scheduled(false),
+        concurrent(false),
+        turnarounds(false),
+        trial_budget(0),
+        pipelined(false),
+        helper_core(-1),
+        binary(false),
+        columnar(false),
+        checkpoint(false) {}
 };
 
 /// @brief Constraints for address generation
@@ -61,9 +121,14 @@ class Addressing : public Sudoku {
   void StatSingleMemoryAccess();  // latency: avg,med,min,max
   void StatPairedMemoryAccess();  // latency: avg,med,min,max
   void CheckPairedMemoryAccess(Constraints& constraints);
+  void StatBatchedPairedMemoryAccess();     // latency: avg,med,min,max
+  void CompareBatchedPairedMemoryAccess();  // serial vs. batched latency
+  void CompareScheduledPairedMemoryAccess();  // refresh outlier reduction
 
   // Testing functions (refreshes)
   void WatchRefreshSingleAccess();  // watch periodic latency spikes
+  void WatchRefreshStream(uint64_t threshold,
+                          uint64_t seconds);  // online, constant memory
   void StatRefIntervalSingleAccess(
       uint64_t threshold);  // interval: avg,med,min,max
 
@@ -77,10 +142,15 @@ class Addressing : public Sudoku {
   void CheckRefIntervalPairedAccessFine(Constraints& constraints,
                                         uint64_t threshold);
 
+  // Median vs. spectral interval estimation on synthetic spike trains
+  void ValidateRefreshPeriodEstimator();
+
   // Testing functions (consecutive memory accesses)
-  // For now, we only check the consecutive reads (read-read)
-  void StatReadReadAccess(uint64_t length);
-  void CheckReadReadAccess(Constraints& constraints, uint64_t length);
+  void StatConsecutiveAccess(ConsecutiveAccess pattern, uint64_t length);
+  void CheckConsecutiveAccess(Constraints& constraints,
+                              ConsecutiveAccess pattern, uint64_t length);
+  void SweepConsecutiveAccess(ConsecutiveAccess pattern, uint64_t min_length,
+                              uint64_t max_length);
 
   // (optional) Reverse-engineering DRAM addressing functions
   // "DRAMA: Exploiting DRAM Addressing for Cross-CPU Attacks," SEC, 2016
@@ -102,18 +172,81 @@ class Addressing : public Sudoku {
   //  component-level functions.
   void DecomposeUsingRefreshes();
   void DecomposeUsingConsecutiveAccesses();
+  // Both steps in a single pass: each constrained pair is generated and
+  // translated once and timed with the refresh and consecutive access
+  // oracles, and one classifier decides on the evidence of both
+  void DecomposeFunctions();
+  // Decomposing times row buffer hit streams, so it needs row bits and at
+  // least log2(CONSECUTIVE_LENGTH + 1) unused column bits (identify_bits)
+  bool Decomposable();
+
+  // Write the phases and counters of this run to {prefix}.report.json
+  bool ReportRun(std::string binary);
+
+  // Continue from {prefix}.checkpoint (after Initialize): restore the pool's
+  // generator, the same-bank sets that are still in the pool, and the scores
+  // and evidence measured with the same functions
+  bool ResumeCheckpoint();
+
+  // DRAM address mapping artifact of this run (see mapping.h): write it to
+  // {prefix}.mapping.json, or start from a loaded one
+  MappingArtifact Mapping(std::string binary) const;
+  bool WriteMapping(std::string binary);
+  // False if the mapping was measured with another PCI offset
+  bool SetMapping(const MappingArtifact& mapping);
+
+  // From "DRAMA: Exploiting DRAM Addressing for Cross-CPU Attacks," SEC, 2016
+  // Brute-forcing for deriving functions (of up to max_function_bits bits)
+  // then, using Gaussian Elimination to reduce functions
+  std::vector<uint64_t> DeriveFunctions(
+      std::vector<std::vector<addr_tuple>> pairs, std::string log_name,
+      uint64_t max_function_bits = FUNCTION_MAX_NUM_BITS);
+  std::vector<uint64_t> MergeFunctionsToDisjointSets(
+      std::vector<uint64_t> functions);
 
  private:
   // From "DRAMA: Exploiting DRAM Addressing for Cross-CPU Attacks," SEC, 2016
   // Brute-forcing to collect row buffer conflicts address pairs
   bool EnoughSameBankPairs();
   void CollectSameBankPairs(std::string log_name);
-  // From "DRAMA: Exploiting DRAM Addressing for Cross-CPU Attacks," SEC, 2016
-  // Brute-forcing for deriving functions then, using Gaussian Elimination to
-  // reduce functions
-  std::vector<uint64_t> DeriveFunctions(
-      std::vector<std::vector<addr_tuple>> pairs, std::string log_name);
-
+  void InsertSameBankCandidate(const addr_tuple& candidate, size_t first_set,
+                               std::string log_name);
+  // Test a batch of candidates against distinct sets (i.e., distinct banks)
+  // in each pass using the batched conflict kernel
+  void InsertSameBankCandidates(const std::vector<addr_tuple>& candidates,
+                                std::string log_name);
+  // Read streams hitting the row buffers of the given base addresses (offsets
+  // only flip unused column bits); false if any address is outside the pool
+  bool GenerateRowBufferHitStreams(const addr_tuple* ftuple,
+                                   const addr_tuple* stuple, uint64_t length,
+                                   uint64_t* faddrs, uint64_t* saddrs);
+  void GenerateDistinctAddressPairs(addr_tuple* ftuples, addr_tuple* stuples,
+                                    size_t num_pairs);
+  // Measure generated pairs and record idx,fpaddr,spaddr,avg,med,min,max (and
+  // the returned num if with_num). If pipelined, pairs are generated and
+  // recorded on a helper thread while this thread only measures.
+  void MeasurePairs(
+      uint64_t num_pairs,
+      std::function<void(addr_tuple*, addr_tuple*)> generate,
+      std::function<uint64_t(uint64_t, uint64_t, uint64_t*)> measure,
+      std::string fname, std::string log_name, bool with_num);
+  // Same, but each result goes to consume in order (on the helper thread if
+  // pipelined), e.g., to score trials
+  void MeasurePairs(
+      uint64_t num_pairs,
+      std::function<void(addr_tuple*, addr_tuple*)> generate,
+      std::function<uint64_t(uint64_t, uint64_t, uint64_t*)> measure,
+      std::function<void(const ResultRecord&)> consume);
+  // Open the binary result file next to the log fname if enabled; records
+  // then go to the sink instead of the logger
+  bool OpenResultSink(std::string fname, uint64_t capacity, bool with_num,
+                      ResultSink* sink);
+  // Close the sink and, if columnar, encode its file into {prefix}.col
+  void CloseResultSink(ResultSink* sink, bool binary, std::string fname);
+  ColumnarMetadata ResultMetadata(std::string fname);
+  void RecordResult(ResultSink* sink, bool binary,
+                    const std::shared_ptr<spdlog::logger>& logger,
+                    const ResultRecord& record, bool with_num);
   // From "ZenHammer: Rowhammer Attacks on AMD Zen-based Platforms," SEC, 2024
   // Offset PCI_OFFSET for lower physical address space (just subtract PCI
   // address region from physical addresses)
@@ -122,8 +255,6 @@ class Addressing : public Sudoku {
   // different row address pairs
   void FilterSameBankPairs(std::string log_name);
 
-  std::vector<uint64_t> MergeFunctionsToDisjointSets(
-      std::vector<uint64_t> functions);
   void CheckUnusedBits(uint64_t bitmask, std::string log_name);
   void CheckUsedBits(std::vector<uint64_t> disjoint_sets, std::string log_name);
 
@@ -132,12 +263,62 @@ class Addressing : public Sudoku {
   void ResolveAddressMapping(std::vector<uint64_t> incomplete_sets,
                              std::string log_name);
 
+  // Generate one pair differing only in evidence.function and time it with
+  // the oracles still needing trials; false if nothing was measured
+  bool MeasureFunctionEvidence(FunctionEvidence& evidence, bool refresh,
+                               bool consecutive, addr_tuple* ftuple,
+                               addr_tuple* stuple, uint64_t* faddrs,
+                               uint64_t* saddrs);
+  // Time a pair's row buffer hit streams with RDRD, and with the write
+  // turnarounds too if configured
+  void TimeConsecutiveAccesses(FunctionEvidence& evidence, uint64_t* faddrs,
+                               uint64_t* saddrs);
+  // Average latencies of the timed write turnarounds for the logs (empty if
+  // they were not timed)
+  std::string TurnaroundLatencies(const FunctionEvidence& evidence);
+  // Spend up to budget pairs on the functions whose refresh or RDRD decision
+  // is still uncertain; returns the number of measured pairs
+  uint64_t AllocateTrials(std::vector<FunctionEvidence>& evidences,
+                          uint64_t budget, addr_tuple* ftuple,
+                          addr_tuple* stuple, uint64_t* faddrs,
+                          uint64_t* saddrs, std::string log_name);
+  void ClassifyFunctions(const std::vector<FunctionEvidence>& evidences,
+                         std::string log_name);
+  // Assign bank group (tCCD_S) and bank address (tCCD_L) functions from a
+  // Gaussian mixture of the per-pair RDRD latencies of all functions
+  void ClassifyBanks(const std::vector<FunctionEvidence>& evidences,
+                     std::string log_name);
+
+  // Probe a base address and one address per function (differing from the
+  // base only in that function) in a single sampling loop; each function's
+  // paired spike train is the union of the base's and its address's spikes
+  void DecomposeUsingConcurrentRefreshes(std::string log_name);
+
+  // Checkpointing: masks and evidences are only kept for the functions they
+  // were measured with
+  void MatchCheckpoint(const std::vector<uint64_t>& functions);
+  bool RestoreMaskScore(uint64_t mask, uint64_t* row_bit_score,
+                        uint64_t* column_bit_score,
+                        uint64_t* effective_trials, uint64_t* trials);
+  void RecordMaskScore(uint64_t mask, uint64_t row_bit_score,
+                       uint64_t column_bit_score, uint64_t effective_trials,
+                       uint64_t trials);
+  void RecordSameBankPairs();
+  // Write {prefix}.checkpoint; exits after the checkpoint of an interrupted
+  // run
+  void SaveCheckpoint();
+
  private:
   AddressingConfig* addressing_config_;
   std::vector<std::vector<addr_tuple>> address_pairs_;
   std::vector<std::vector<addr_tuple>> sbdr_pairs_;
   std::vector<uint64_t> covered_bits_;
   std::vector<uint64_t> uncovered_bits_;
+  Checkpoint checkpoint_;
+  // confidences of the decomposed roles and of single row and column bits
+  std::map<uint64_t, double> function_confidences_;
+  std::map<uint64_t, double> bit_confidences_;
+  bool validated_;
 };
 
 }  // namespace sudoku
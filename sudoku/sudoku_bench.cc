@@ -0,0 +1,559 @@
+#include <getopt.h>
+#include <spdlog/fmt/fmt.h>
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "internal/constants.h"
+#include "internal/simulator.h"
+#include "internal/translator.h"
+#include "internal/utils.h"
+#include "sudoku.h"
+#include "sudoku_addressing.h"
+
+using namespace sudoku;
+
+static const char help_msg[] =
+    R"([?] Usage:
+    $ ./sudoku_bench [OPTIONS]
+
+    Time the address mapping algorithms on synthetic inputs (simulated memory
+    pools, no sudo) and write the results as JSON for tracking regressions.
+
+    Benchmarks:
+      reduce_functions          ReduceFunctions (16 to 40 functions)
+      merge_functions           MergeFunctionsToDisjointSets (16 to 40 functions)
+      constrained_tuples        GenerateRandomAddressTupleWithConstraints (16 GB to 1 TB pools, 16 to 40 functions)
+      virt_to_phys              VirtToPhys (16 GB to 1 TB pools)
+      phys_to_virt              PhysToVirt (16 GB to 1 TB pools)
+      derive_functions          DeriveFunctions (16 sets of 64 to 4096 addresses)
+      translate_reference       DRAMTranslator, XORReductionWithMasks per component (batches of 64K addresses)
+      translate_lookup          DRAMTranslator, byte-sliced lookup tables (batches of 64K addresses)
+      translate_pext            DRAMTranslator, BMI2 pext (batches of 64K addresses, if supported)
+      encode_lookup             DRAMTranslator, packed coordinates only (batches of 64K addresses)
+      decode_lookup             DRAMTranslator, inverse of encode_lookup (batches of 64K addresses)
+
+    Options:
+      --output,    -o [FILE]    Output JSON file (default: sudoku_bench.json)
+      --filter,    -f [STR]     Only run benchmarks whose name contains STR
+      --repeats,   -r [INT]     Timed repetitions per benchmark (default: 5)
+      --time,      -t [INT]     Minimum time per repetition in ms (default: 200)
+      --label,     -L [STR]     Label stored in the output (e.g., a commit hash)
+
+      --help,      -h           Show this help message
+)";
+
+// Pool sizes in GB; the simulated DRAM is twice the pool
+static const uint64_t bench_pool_sizes[] = {16, 64, 256, 1024};
+static const uint64_t bench_num_functions[] = {16, 24, 32, 40};
+static const uint64_t bench_set_sizes[] = {64, 256, 1024, 4096};
+// Sets of derive_functions (e.g., the banks of a rank)
+static const uint64_t bench_num_sets = 16;
+// Brute-forced function width of derive_functions: the full width
+// (FUNCTION_MAX_NUM_BITS) takes hours per call on a 32 GB address space
+static const uint64_t bench_function_bits = 4;
+// Rotating inputs of the address benchmarks
+static const uint64_t bench_num_inputs = 4096;
+// Addresses per batch of the translation benchmarks (1 MB of coordinates
+// in and out, as a runtime caller would stream them)
+static const uint64_t bench_translate_batch = 65536;
+
+// Results are accumulated here so the compiler cannot drop the operations
+static volatile uint64_t bench_sink = 0;
+
+void PrintHelp(std::string msg) {
+  if (!msg.empty()) {
+    spdlog::error("{}", msg);
+    spdlog::info("Use --help or -h to see usage.");
+  } else {
+    spdlog::info("{}", help_msg);
+  }
+}
+
+/// @brief Timings of one parameterized benchmark
+struct BenchResult {
+  std::string name;
+  std::vector<std::pair<std::string, uint64_t>> params;
+  uint64_t iterations;            // operations per repetition
+  std::vector<double> ns_per_op;  // one sample per repetition
+  std::vector<std::pair<std::string, double>> counters;
+};
+
+/// @brief Runs benchmarks matching a name filter. Each benchmark is calibrated
+/// to take at least the minimum time per repetition and then timed for the
+/// given number of repetitions.
+class BenchRunner {
+ public:
+  BenchRunner(std::string filter, uint64_t repetitions, uint64_t min_time_ms)
+      : filter_(filter),
+        repetitions_(repetitions),
+        min_time_ns_(min_time_ms * 1000000ULL) {}
+
+  bool Enabled(const std::string& name) const {
+    return filter_.empty() || name.find(filter_) != std::string::npos;
+  }
+
+  // Time op (one operation per call) and return its result, so that callers
+  // can attach counters
+  BenchResult& Run(std::string name,
+                   std::vector<std::pair<std::string, uint64_t>> params,
+                   std::function<void()> op) {
+    BenchResult result;
+    result.name = name;
+    result.params = params;
+
+    // Calibrate (doubles as a warm-up)
+    uint64_t iterations = 1;
+    while (true) {
+      double elapsed = TimeIterations(op, iterations);
+      if (elapsed >= min_time_ns_ || iterations >= (1ULL << 30)) {
+        break;
+      }
+      double scale = (elapsed > 0) ? (1.2 * min_time_ns_ / elapsed) : 1024;
+      iterations = static_cast<uint64_t>(
+          std::max(static_cast<double>(iterations) * 2,
+                   std::min(static_cast<double>(iterations) * scale,
+                            static_cast<double>(1ULL << 30))));
+    }
+    result.iterations = iterations;
+    for (uint64_t r = 0; r < repetitions_; ++r) {
+      result.ns_per_op.push_back(TimeIterations(op, iterations) / iterations);
+    }
+
+    std::string label = name;
+    for (const auto& param : params) {
+      label += fmt::format("/{}={}", param.first, param.second);
+    }
+    spdlog::info("[+] {:<40} {:>14.1f} ns/op ({} ops x {})", label,
+                 Median(result.ns_per_op), iterations, repetitions_);
+    results_.push_back(result);
+    return results_.back();
+  }
+
+  bool Write(std::string fname, std::string label) const {
+    std::ofstream ofs(fname);
+    if (!ofs.is_open()) {
+      spdlog::error("Cannot open output file: {}", fname);
+      return false;
+    }
+    ofs << "{\n  \"version\": 1,\n  \"label\": " << JSONString(label)
+        << ",\n";
+#ifdef __OPTIMIZE__
+    ofs << "  \"optimized\": true,\n";
+#else
+    ofs << "  \"optimized\": false,\n";
+#endif
+    ofs << "  \"repetitions\": " << repetitions_
+        << ",\n  \"min_time_ms\": " << (min_time_ns_ / 1000000ULL)
+        << ",\n  \"benchmarks\": [";
+    for (size_t i = 0; i < results_.size(); ++i) {
+      const BenchResult& result = results_[i];
+      std::vector<double> samples = result.ns_per_op;
+      std::sort(samples.begin(), samples.end());
+      ofs << (i ? ",\n" : "\n") << "    {\"name\": \"" << result.name
+          << "\", \"params\": {";
+      for (size_t j = 0; j < result.params.size(); ++j) {
+        ofs << (j ? ", " : "") << "\"" << result.params[j].first
+            << "\": " << result.params[j].second;
+      }
+      ofs << "}, \"iterations\": " << result.iterations
+          << fmt::format(", \"ns_per_op\": {{\"median\": {:.1f}, "
+                         "\"min\": {:.1f}, \"max\": {:.1f}}}",
+                         Median(samples), samples.front(), samples.back())
+          << ", \"counters\": {";
+      for (size_t j = 0; j < result.counters.size(); ++j) {
+        ofs << (j ? ", " : "") << "\"" << result.counters[j].first << "\": "
+            << fmt::format("{:.4f}", result.counters[j].second);
+      }
+      ofs << "}}";
+    }
+    ofs << "\n  ]\n}\n";
+    return !ofs.fail();
+  }
+
+  static double Median(std::vector<double> samples) {
+    if (samples.empty()) {
+      return 0;
+    }
+    std::sort(samples.begin(), samples.end());
+    size_t mid = samples.size() / 2;
+    return (samples.size() % 2) ? samples[mid]
+                                : (samples[mid - 1] + samples[mid]) / 2;
+  }
+
+ private:
+  static double TimeIterations(const std::function<void()>& op,
+                               uint64_t iterations) {
+    auto start = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i < iterations; ++i) {
+      op();
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count();
+  }
+
+  std::string filter_;
+  uint64_t repetitions_;
+  uint64_t min_time_ns_;
+  std::vector<BenchResult> results_;
+};
+
+/// @brief Addressing instance over a simulated memory pool of 1 GB pages and
+/// the DRAM configuration backing it (32 GB 2Rx8 DDR4 DIMMs)
+struct BenchPool {
+  AddressingConfig* addressing_config;
+  MemoryPoolConfig* memory_pool_config;
+  DRAMConfig* dram_config;
+  MemoryConfig* memory_config;
+  Addressing* sudoku;
+  SimulatorConfig simulator_config;
+};
+
+BenchPool* CreateBenchPool(uint64_t pool_gb) {
+  BenchPool* bench = new BenchPool;
+  bench->simulator_config.dram_size = 2 * pool_gb * GB;
+  bench->simulator_config.seed = pool_gb;
+  SetBackend(new SimulatedBackend(bench->simulator_config));
+
+  bench->addressing_config = new AddressingConfig();
+  bench->addressing_config->fname_prefix = "sudoku_bench";
+  bench->memory_pool_config =
+      new MemoryPoolConfig(GB, pool_gb, (1ULL << CACHELINE_OFFSET), true);
+  bench->dram_config = new DRAMConfig(DDRType::DDR4, 32ULL * GB, 2, 8);
+  bench->memory_config = new MemoryConfig(
+      1, 1, static_cast<uint32_t>(2 * pool_gb / 32), bench->dram_config);
+  bench->sudoku =
+      new Addressing(bench->dram_config, bench->memory_config,
+                     bench->memory_pool_config, bench->addressing_config);
+  bench->sudoku->Initialize();
+  return bench;
+}
+
+void DestroyBenchPool(BenchPool* bench) {
+  bench->sudoku->Finalize();
+  delete bench->sudoku;
+  delete bench->memory_pool_config;
+  delete bench->memory_config;
+  delete bench->dram_config;
+  delete bench->addressing_config;
+  delete bench;
+}
+
+// Random functions of 1 to 4 bits between the cacheline offset and max_bits
+std::vector<uint64_t> RandomFunctions(std::mt19937_64& gen, uint64_t num,
+                                      uint64_t max_bits) {
+  std::uniform_int_distribution<uint64_t> bit_dist(CACHELINE_OFFSET,
+                                                   max_bits - 1);
+  std::uniform_int_distribution<uint64_t> width_dist(1, 4);
+  std::vector<uint64_t> functions;
+  while (functions.size() < num) {
+    uint64_t function = 0;
+    for (uint64_t w = width_dist(gen); w > 0; --w) {
+      function |= (1ULL << bit_dist(gen));
+    }
+    functions.push_back(function);
+  }
+  return functions;
+}
+
+void BenchFunctions(BenchRunner& runner) {
+  // MergeFunctionsToDisjointSets only needs an instance, not a pool
+  AddressingConfig* addressing_config = new AddressingConfig();
+  MemoryPoolConfig* memory_pool_config = new MemoryPoolConfig();
+  Addressing* sudoku = new Addressing(memory_pool_config, addressing_config);
+  std::mt19937_64 gen(0);
+
+  for (uint64_t num : bench_num_functions) {
+    std::vector<uint64_t> functions = RandomFunctions(gen, num, 41);
+    if (runner.Enabled("reduce_functions")) {
+      runner.Run("reduce_functions", {{"functions", num}}, [&]() {
+        bench_sink += ReduceFunctions(functions).size();
+      });
+    }
+    if (runner.Enabled("merge_functions")) {
+      runner.Run("merge_functions", {{"functions", num}}, [&]() {
+        bench_sink += sudoku->MergeFunctionsToDisjointSets(functions).size();
+      });
+    }
+  }
+
+  delete sudoku;
+  delete memory_pool_config;
+  delete addressing_config;
+}
+
+void BenchAddresses(BenchRunner& runner, uint64_t pool_gb) {
+  if (!runner.Enabled("constrained_tuples") &&
+      !runner.Enabled("virt_to_phys") && !runner.Enabled("phys_to_virt")) {
+    return;
+  }
+  BenchPool* bench = CreateBenchPool(pool_gb);
+  Addressing* sudoku = bench->sudoku;
+  uint64_t max_bits = static_cast<uint64_t>(std::log2(2 * pool_gb * GB));
+  std::mt19937_64 gen(pool_gb);
+
+  std::vector<addr_tuple> tuples(bench_num_inputs);
+  for (auto& tuple : tuples) {
+    sudoku->GenerateRandomAddressTuple(&tuple);
+  }
+
+  if (runner.Enabled("constrained_tuples")) {
+    for (uint64_t num : bench_num_functions) {
+      // Half of the functions must agree, the other half must differ
+      std::vector<uint64_t> functions = RandomFunctions(gen, num, max_bits);
+      std::vector<uint64_t> same_functions(functions.begin(),
+                                           functions.begin() + num / 2);
+      std::vector<uint64_t> diff_functions(functions.begin() + num / 2,
+                                           functions.end());
+      uint64_t calls = 0, solved = 0;
+      addr_tuple second;
+      BenchResult& result = runner.Run(
+          "constrained_tuples", {{"pool_gb", pool_gb}, {"functions", num}},
+          [&]() {
+            addr_tuple* first = &tuples[calls++ % bench_num_inputs];
+            solved += sudoku->GenerateRandomAddressTupleWithConstraints(
+                first, &second, same_functions, diff_functions);
+          });
+      result.counters.push_back(
+          {"solved", static_cast<double>(solved) / calls});
+    }
+  }
+  if (runner.Enabled("virt_to_phys")) {
+    uint64_t calls = 0;
+    runner.Run("virt_to_phys", {{"pool_gb", pool_gb}}, [&]() {
+      bench_sink += VirtToPhys(reinterpret_cast<uint64_t>(
+          tuples[calls++ % bench_num_inputs].vaddr));
+    });
+  }
+  if (runner.Enabled("phys_to_virt")) {
+    // Half hits (pool addresses) and half misses (flipped top DRAM bit of a
+    // pool address, outside the pool unless both frames are pooled)
+    uint64_t calls = 0, hits = 0;
+    BenchResult& result =
+        runner.Run("phys_to_virt", {{"pool_gb", pool_gb}}, [&]() {
+          uint64_t paddr = tuples[calls % bench_num_inputs].paddr;
+          if (calls++ % 2) {
+            paddr ^= (1ULL << (max_bits - 1));
+          }
+          hits += (PhysToVirt(sudoku->pool_, paddr) != 0);
+        });
+    result.counters.push_back({"hits", static_cast<double>(hits) / calls});
+  }
+
+  DestroyBenchPool(bench);
+}
+
+void BenchDerive(BenchRunner& runner) {
+  if (!runner.Enabled("derive_functions")) {
+    return;
+  }
+  // Sets of same-bank addresses under the simulated mapping functions
+  BenchPool* bench = CreateBenchPool(bench_pool_sizes[0]);
+  Addressing* sudoku = bench->sudoku;
+  const SimulatorConfig& config = bench->simulator_config;
+  std::vector<uint64_t> functions = config.rank_functions;
+  functions.insert(functions.end(), config.bank_group_functions.begin(),
+                   config.bank_group_functions.end());
+  functions.insert(functions.end(), config.bank_address_functions.begin(),
+                   config.bank_address_functions.end());
+  std::string log_name = "bench_derive_functions";
+  sudoku->SetupLogger("", log_name);
+
+  for (uint64_t set_size : bench_set_sizes) {
+    std::vector<std::vector<addr_tuple>> sets(bench_num_sets);
+    for (auto& set : sets) {
+      addr_tuple base, tuple;
+      sudoku->GenerateRandomAddressTuple(&base);
+      set.push_back(base);
+      while (set.size() < set_size) {
+        if (sudoku->GenerateRandomAddressTupleWithConstraints(&base, &tuple,
+                                                              functions, {})) {
+          set.push_back(tuple);
+        }
+      }
+    }
+    uint64_t derived = 0;
+    BenchResult& result = runner.Run(
+        "derive_functions",
+        {{"sets", bench_num_sets},
+         {"set_size", set_size},
+         {"function_bits", bench_function_bits}},
+        [&]() {
+          derived =
+              sudoku->DeriveFunctions(sets, log_name, bench_function_bits)
+                  .size();
+        });
+    result.counters.push_back({"functions", static_cast<double>(derived)});
+  }
+
+  DestroyBenchPool(bench);
+}
+
+void BenchTranslate(BenchRunner& runner) {
+  if (!runner.Enabled("translate") && !runner.Enabled("encode_lookup") &&
+      !runner.Enabled("decode_lookup")) {
+    return;
+  }
+  // Simulated mapping (five functions, 17 row bits, and 7 column bits)
+  SimulatorConfig config;
+  DRAMTranslator translator;
+  if (!translator.Build(config.channel_functions, config.rank_functions,
+                        config.bank_group_functions,
+                        config.bank_address_functions, config.row_bits,
+                        config.column_bits) ||
+      !translator.Invertible()) {
+    exit(EXIT_FAILURE);
+  }
+  std::mt19937_64 gen(0);
+  std::uniform_int_distribution<uint64_t> addr_dist(0, config.dram_size - 1);
+  std::vector<uint64_t> paddrs(bench_translate_batch);
+  for (auto& paddr : paddrs) {
+    paddr = addr_dist(gen);
+  }
+  std::vector<DRAMCoordinate> coordinates(bench_translate_batch);
+  std::vector<uint64_t> codes(bench_translate_batch);
+
+  // All methods must agree with the reference before they are timed
+  std::vector<DRAMCoordinate> expected(bench_translate_batch);
+  translator.TranslateBatch(paddrs.data(), paddrs.size(), expected.data(),
+                            TranslationMethod::REFERENCE);
+  std::vector<std::pair<std::string, TranslationMethod>> methods = {
+      {"translate_reference", TranslationMethod::REFERENCE},
+      {"translate_lookup", TranslationMethod::LOOKUP}};
+  if (DRAMTranslator::PextSupported()) {
+    methods.push_back({"translate_pext", TranslationMethod::PEXT});
+  }
+  for (const auto& method : methods) {
+    translator.TranslateBatch(paddrs.data(), paddrs.size(),
+                              coordinates.data(), method.second);
+    for (size_t i = 0; i < paddrs.size(); ++i) {
+      const DRAMCoordinate& a = coordinates[i];
+      const DRAMCoordinate& b = expected[i];
+      if (a.channel != b.channel || a.rank != b.rank ||
+          a.bank_group != b.bank_group || a.bank != b.bank ||
+          a.row != b.row || a.column != b.column) {
+        spdlog::error("{} disagrees with the reference at {:#x}",
+                      method.first, paddrs[i]);
+        exit(EXIT_FAILURE);
+      }
+    }
+  }
+
+  // and the inverse must give the addresses back (cacheline offset from base)
+  translator.EncodeBatch(paddrs.data(), paddrs.size(), codes.data());
+  std::vector<uint64_t> decoded(bench_translate_batch);
+  translator.DecodeBatch(codes.data(), codes.size(), 0, decoded.data());
+  for (size_t i = 0; i < paddrs.size(); ++i) {
+    uint64_t offset = paddrs[i] & ((1ULL << CACHELINE_OFFSET) - 1);
+    if ((decoded[i] | offset) != paddrs[i] ||
+        translator.Decode(codes[i], paddrs[i]) != paddrs[i]) {
+      spdlog::error("decode_lookup does not invert {:#x}", paddrs[i]);
+      exit(EXIT_FAILURE);
+    }
+  }
+
+  auto add_throughput = [](BenchResult& result) {
+    result.counters.push_back(
+        {"gaddr_per_s", bench_translate_batch /
+                            BenchRunner::Median(result.ns_per_op)});
+  };
+  for (const auto& method : methods) {
+    if (runner.Enabled(method.first)) {
+      add_throughput(runner.Run(
+          method.first, {{"batch", bench_translate_batch}}, [&]() {
+            translator.TranslateBatch(paddrs.data(), paddrs.size(),
+                                      coordinates.data(), method.second);
+            bench_sink += coordinates[0].row;
+          }));
+    }
+  }
+  if (runner.Enabled("encode_lookup")) {
+    add_throughput(runner.Run(
+        "encode_lookup", {{"batch", bench_translate_batch}}, [&]() {
+          translator.EncodeBatch(paddrs.data(), paddrs.size(), codes.data());
+          bench_sink += codes[0];
+        }));
+  }
+  if (runner.Enabled("decode_lookup")) {
+    add_throughput(runner.Run(
+        "decode_lookup", {{"batch", bench_translate_batch}}, [&]() {
+          translator.DecodeBatch(codes.data(), codes.size(), 0,
+                                 decoded.data());
+          bench_sink += decoded[0];
+        }));
+  }
+}
+
+int main(int argc, char* argv[]) {
+  std::string output_fname = "sudoku_bench.json", filter = "", label = "";
+  uint64_t repetitions = 5, min_time_ms = 200;
+
+  // parse argument
+  static struct option long_options[] = {
+      {"output", required_argument, 0, 'o'},
+      {"filter", required_argument, 0, 'f'},
+      {"repeats", required_argument, 0, 'r'},
+      {"time", required_argument, 0, 't'},
+      {"label", required_argument, 0, 'L'},
+      {"help", optional_argument, 0, 'h'},
+      {0, 0, 0, 0}};
+  int opt, idx;
+  while ((opt = getopt_long(argc, argv, "o:f:r:t:L:h", long_options, &idx)) !=
+         -1) {
+    switch (opt) {
+      case 'o':
+        output_fname = std::string(optarg);
+        break;
+      case 'f':
+        filter = std::string(optarg);
+        break;
+      case 'r':
+        repetitions = strtoull(optarg, NULL, 10);
+        break;
+      case 't':
+        min_time_ms = strtoull(optarg, NULL, 10);
+        break;
+      case 'L':
+        label = std::string(optarg);
+        break;
+      case 'h':
+        PrintHelp("");
+        exit(EXIT_SUCCESS);
+      default:
+        PrintHelp("");
+        exit(EXIT_FAILURE);
+    }
+  }
+  if (repetitions == 0) {
+    PrintHelp("The number of repetitions must be positive.");
+    exit(EXIT_FAILURE);
+  }
+
+  // Pools live on the simulated backend, which needs no hardware access
+  InitPlatformProfile("simulated", "", DDRType::UNKNOWN);
+
+  BenchRunner runner(filter, repetitions, min_time_ms);
+  BenchFunctions(runner);
+  for (uint64_t pool_gb : bench_pool_sizes) {
+    BenchAddresses(runner, pool_gb);
+  }
+  BenchDerive(runner);
+  BenchTranslate(runner);
+
+  if (!runner.Write(output_fname, label)) {
+    exit(EXIT_FAILURE);
+  }
+  spdlog::info("[+] Results written to {}", output_fname);
+
+  return 0;
+}
@@ -0,0 +1,104 @@
+#include <getopt.h>
+#include <spdlog/spdlog.h>
+
+#include <cstdint>
+#include <string>
+
+#include "internal/codegen.h"
+#include "internal/mapping.h"
+
+using namespace sudoku;
+
+static const char help_msg[] =
+    R"([?] Usage:
+    $ ./sudoku_codegen -M [FILE] [OPTIONS]
+
+    Generate a C++ header from a validated DRAM address mapping: constexpr
+    functions and bits, constexpr decoding and encoding of DRAM coordinates,
+    and static_asserts checking them on sample addresses.
+
+    Options:
+      --mapping,   -M [FILE]    DRAM address mapping ({prefix}.mapping.json of validate_mapping or a later step)
+      --output,    -o [FILE]    Output header (default: {name}.h)
+      --name,      -n [STR]     Namespace of the generated code (default: sudoku_{platform})
+      --unvalidated, -U         Accept mappings that were not validated
+
+      --help,      -h           Show this help message
+)";
+
+void PrintHelp(std::string msg) {
+  if (!msg.empty()) {
+    spdlog::error("{}", msg);
+    spdlog::info("Use --help or -h to see usage.");
+  } else {
+    spdlog::info("{}", help_msg);
+  }
+}
+
+int main(int argc, char* argv[]) {
+  std::string mapping_fname = "", output_fname = "", name = "";
+  bool unvalidated = false;
+
+  // parse argument
+  static struct option long_options[] = {
+      {"mapping", required_argument, 0, 'M'},
+      {"output", required_argument, 0, 'o'},
+      {"name", required_argument, 0, 'n'},
+      {"unvalidated", no_argument, 0, 'U'},
+      {"help", optional_argument, 0, 'h'},
+      {0, 0, 0, 0}};
+  if (argc < 2) {
+    PrintHelp("");
+  } else {
+    int opt, idx;
+    while ((opt = getopt_long(argc, argv, "M:o:n:Uh", long_options, &idx)) !=
+           -1) {
+      switch (opt) {
+        case 'M':
+          mapping_fname = std::string(optarg);
+          break;
+        case 'o':
+          output_fname = std::string(optarg);
+          break;
+        case 'n':
+          name = std::string(optarg);
+          break;
+        case 'U':
+          unvalidated = true;
+          break;
+        case 'h':
+          PrintHelp("");
+          exit(EXIT_SUCCESS);
+        default:
+          PrintHelp("");
+          exit(EXIT_FAILURE);
+      }
+    }
+  }
+  if (mapping_fname.empty()) {
+    PrintHelp("No mapping file (--mapping, -M)");
+    exit(EXIT_FAILURE);
+  }
+
+  MappingArtifact mapping;
+  if (!ReadMappingArtifact(mapping_fname, &mapping)) {
+    exit(EXIT_FAILURE);
+  }
+  if (!mapping.validated && !unvalidated) {
+    PrintHelp("The mapping was not validated (run validate_mapping, or "
+              "--unvalidated, -U)");
+    exit(EXIT_FAILURE);
+  }
+  if (name.empty()) {
+    name = MappingHeaderName(mapping);
+  }
+  if (output_fname.empty()) {
+    output_fname = name + ".h";
+  }
+  if (!WriteMappingHeader(output_fname, mapping, name, mapping_fname)) {
+    exit(EXIT_FAILURE);
+  }
+  spdlog::info("[+] Header written to {}", output_fname);
+
+  return 0;
+}
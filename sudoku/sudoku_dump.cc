@@ -0,0 +1,175 @@
+#include <getopt.h>
+#include <spdlog/fmt/fmt.h>
+#include <spdlog/spdlog.h>
+
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include "internal/columnar.h"
+
+using namespace sudoku;
+
+static const char help_msg[] =
+    R"([?] Usage:
+    $ ./sudoku_dump -i [FILE] [OPTIONS]
+
+    Print the records of a columnar result file (--columnar) as CSV.
+
+    Options:
+      --input,     -i [FILE]    Columnar result file (.col)
+      --output,    -o [FILE]    Output CSV file (default: stdout)
+      --metadata,  -M           Print the metadata and the chunk index instead
+      --address,   -a [HEX]     Pairs with either address in a range (ADDR or LOW-HIGH)
+      --same       -S [HEXes]   Pairs agreeing on DRAM mapping functions in hex, separated by commas
+      --diff,      -D [HEXes]   Pairs differing in DRAM mapping functions in hex, separated by commas
+
+      --help,      -h           Show this help message
+)";
+
+void PrintHelp(std::string msg) {
+  if (!msg.empty()) {
+    spdlog::error("{}", msg);
+    spdlog::info("Use --help or -h to see usage.");
+  } else {
+    spdlog::info("{}", help_msg);
+  }
+}
+
+void PrintMetadata(ColumnarReader& reader, std::ostream& out) {
+  for (const auto& entry : reader.Metadata()) {
+    out << entry.first << "=" << entry.second << "\n";
+  }
+  out << "num_records=" << reader.NumRecords() << "\n";
+  out << "chunk,first_idx,num_records,size,min_addr,max_addr,same_mask,"
+         "diff_mask\n";
+  for (size_t i = 0; i < reader.Chunks().size(); ++i) {
+    const ColumnarChunk& chunk = reader.Chunks()[i];
+    out << fmt::format("{},{},{},{},{},{},{:#x},{:#x}\n", i, chunk.first_idx,
+                       chunk.num_records, chunk.size,
+                       reinterpret_cast<void*>(chunk.min_addr),
+                       reinterpret_cast<void*>(chunk.max_addr),
+                       chunk.same_mask, chunk.diff_mask);
+  }
+}
+
+int main(int argc, char* argv[]) {
+  std::string input_fname = "", output_fname = "";
+  bool metadata = false;
+  ColumnarFilter filter;
+
+  // parse argument
+  static struct option long_options[] = {
+      {"input", required_argument, 0, 'i'},
+      {"output", required_argument, 0, 'o'},
+      {"metadata", no_argument, 0, 'M'},
+      {"address", required_argument, 0, 'a'},
+      {"same", required_argument, 0, 'S'},
+      {"diff", required_argument, 0, 'D'},
+      {"help", optional_argument, 0, 'h'},
+      {0, 0, 0, 0}};
+  if (argc < 2) {
+    PrintHelp("");
+  } else {
+    int opt, idx;
+    while ((opt = getopt_long(argc, argv, "i:o:Ma:S:D:h", long_options,
+                              &idx)) != -1) {
+      switch (opt) {
+        case 'i':
+          input_fname = std::string(optarg);
+          break;
+        case 'o':
+          output_fname = std::string(optarg);
+          break;
+        case 'M':
+          metadata = true;
+          break;
+        case 'a': {
+          std::string range(optarg);
+          size_t pos = range.find('-');
+          filter.min_addr = strtoull(range.substr(0, pos).c_str(), NULL, 16);
+          filter.max_addr =
+              (pos == std::string::npos)
+                  ? filter.min_addr
+                  : strtoull(range.substr(pos + 1).c_str(), NULL, 16);
+          break;
+        }
+        case 'S': {
+          std::stringstream ss(optarg);
+          std::string token;
+          while (std::getline(ss, token, ',')) {
+            filter.same_functions.push_back(
+                strtoull(token.c_str(), nullptr, 16));
+          }
+          break;
+        }
+        case 'D': {
+          std::stringstream ss(optarg);
+          std::string token;
+          while (std::getline(ss, token, ',')) {
+            filter.diff_functions.push_back(
+                strtoull(token.c_str(), nullptr, 16));
+          }
+          break;
+        }
+        case 'h':
+          PrintHelp("");
+          exit(EXIT_SUCCESS);
+        default:
+          PrintHelp("");
+          exit(EXIT_FAILURE);
+      }
+    }
+  }
+  if (input_fname.empty()) {
+    PrintHelp("No input file (--input, -i)");
+    exit(EXIT_FAILURE);
+  }
+
+  ColumnarReader reader;
+  if (!reader.Open(input_fname)) {
+    exit(EXIT_FAILURE);
+  }
+  std::ofstream ofs;
+  if (!output_fname.empty()) {
+    ofs.open(output_fname);
+    if (!ofs.is_open()) {
+      spdlog::error("Cannot open output file: {}", output_fname);
+      exit(EXIT_FAILURE);
+    }
+  }
+  std::ostream& out = output_fname.empty() ? std::cout : ofs;
+
+  if (metadata) {
+    PrintMetadata(reader, out);
+    return 0;
+  }
+
+  bool with_num = (reader.Get("with_num") == "1");
+  out << (with_num ? "idx,fpaddr,spaddr,avg,med,min,max,num\n"
+                   : "idx,fpaddr,spaddr,avg,med,min,max\n");
+  uint64_t chunks_read = 0;
+  uint64_t num_matches = reader.Scan(
+      filter,
+      [&](const ResultRecord& record) {
+        out << fmt::format("{},{},{},{},{},{},{}", record.idx,
+                           reinterpret_cast<void*>(record.fpaddr),
+                           reinterpret_cast<void*>(record.spaddr),
+                           record.statistics[0], record.statistics[1],
+                           record.statistics[2], record.statistics[3]);
+        if (with_num) {
+          out << "," << record.num;
+        }
+        out << "\n";
+      },
+      &chunks_read);
+  // stdout carries the CSV unless written to a file
+  if (!output_fname.empty()) {
+    spdlog::info("[+] {} of {} records ({} of {} chunks read)", num_matches,
+                 reader.NumRecords(), chunks_read, reader.Chunks().size());
+  }
+
+  return 0;
+}
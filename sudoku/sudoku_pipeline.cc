@@ -0,0 +1,368 @@
+#include <getopt.h>
+#include <spdlog/spdlog.h>
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+#include "internal/backend.h"
+#include "internal/constants.h"
+#include "sudoku.h"
+#include "sudoku_addressing.h"
+
+using namespace sudoku;
+
+static const char help_msg[] =
+    R"([?] Usage:
+    $ sudo numactl -C [core] -m [memory] ./sudoku_pipeline [OPTIONS]
+
+    Reverse-engineer, identify, validate, and decompose in a single run that
+    shares the memory pool and its state. Steps whose outputs are given are
+    skipped: --functions skips reversing, and --row with --column skips
+    identifying the bits.
+
+    Options:
+      --output,    -o [STR]     Output filename prefix
+      --pages,     -p [INT]     Number of OS memory pages to allocate
+      --type,      -t [STR]     DDR type (ddr4 or ddr5)
+      --num,       -n [INT]     Number of DRAM modules
+      --size,      -s [INT]     Size of DRAM module in GB
+      --rank,      -r [INT]     Number of ranks per DRAM module
+      --width,     -w [INT]     DQ width of DRAM (8, 16, or 32)
+      --mapping,   -M [FILE]    DRAM address mapping from an earlier step ({prefix}.mapping.json)
+      --functions, -f [HEXes]   DRAM functions in hex, separated by commas (skips reversing)
+      --row,       -R [HEX]     DRAM row bits (with --column, skips identifying)
+      --column,    -C [HEX]     DRAM column bits (with --row, skips identifying)
+      --platform,  -P [STR]     Platform profile name (default: auto-detect)
+      --profiles,  -F [FILE]    Custom platform profiles file
+      --batch,     -b           Use batched conflict measurements (for reversing)
+      --schedule,  -q           Schedule conflict filtering between refreshes (for reversing)
+      --spectral,  -E           Estimate refresh intervals spectrally (fewer trials per function)
+      --concurrent, -K          Probe all functions in one refresh capture per window (spectral)
+      --turnarounds, -W         Also time write turnarounds (RDWR, WRRD, WRWR) per pair
+      --budget,    -B [INT]     Total pairs for adaptive trial allocation (default: 0, fixed trials)
+      --pipeline,  -j           Prepare address pairs on a helper thread
+      --helper,    -H [INT]     Helper thread core (with --pipeline, default: another allowed core)
+      --report,    -J           Write a JSON run report ({prefix}.report.json)
+      --checkpoint, -k          Checkpoint long-running phases ({prefix}.checkpoint)
+      --resume,    -u           Resume from {prefix}.checkpoint (implies --checkpoint)
+      --simulate,  -x           Run on the simulated DRAM backend (no sudo)
+      --sim-file,  -X [FILE]    Simulated DRAM file (implies --simulate)
+      --record,    -c [FILE]    Record all oracle calls into a trace file
+      --replay,    -i [FILE]    Replay oracle calls from a trace file (no sudo)
+
+      --debug,     -d           Enable debug output
+      --verbose,   -v           Enable verbose mode
+      --log,       -l           Enable logging
+      --help,      -h           Show this help message
+)";
+
+void PrintHelp(std::string msg) {
+  if (!msg.empty()) {
+    spdlog::error("{}", msg);
+    spdlog::info("Use --help or -h to see usage.");
+  } else {
+    spdlog::info("{}", help_msg);
+  }
+}
+
+int main(int argc, char* argv[]) {
+  std::string fname_prefix = "default", type = "ddr4";
+  uint64_t num_pages = 19, page_size = 1ULL * 1024ULL * 1024ULL * 1024ULL,
+           granularity = (1ULL << CACHELINE_OFFSET), num_dimms = 1,
+           module_size = 32ULL * 1024ULL * 1024ULL * 1024ULL, num_ranks = 2,
+           dq_width = 8, row_bits = 0, column_bits = 0;
+  DDRType ddr_type = DDRType::DDR4;
+  MappingArtifact mapping;
+  bool mapped = false;
+  std::vector<uint64_t> functions = {};
+  std::string platform = "", profiles_fname = "";
+  bool batch = false;
+  bool schedule = false;
+  bool spectral = false;
+  bool concurrent = false;
+  bool turnarounds = false;
+  uint64_t budget = 0;
+  bool pipelined = false;
+  int helper_core = -1;
+  bool report = false;
+  bool checkpoint = false;
+  bool resume = false;
+  bool simulate = false;
+  std::string sim_fname = "";
+  std::string record_fname = "";
+  std::string replay_fname = "";
+  bool debug = false, verbose = false, logging = false;
+
+  // parse argument
+  static struct option long_options[] = {
+      {"output", optional_argument, 0, 'o'},
+      {"pages", optional_argument, 0, 'p'},
+      {"type", required_argument, 0, 't'},
+      {"num", required_argument, 0, 'n'},
+      {"size", required_argument, 0, 's'},
+      {"rank", required_argument, 0, 'r'},
+      {"width", required_argument, 0, 'w'},
+      {"mapping", required_argument, 0, 'M'},
+      {"functions", required_argument, 0, 'f'},
+      {"row", required_argument, 0, 'R'},
+      {"column", required_argument, 0, 'C'},
+      {"platform", required_argument, 0, 'P'},
+      {"profiles", required_argument, 0, 'F'},
+      {"batch", no_argument, 0, 'b'},
+      {"schedule", no_argument, 0, 'q'},
+      {"spectral", no_argument, 0, 'E'},
+      {"concurrent", no_argument, 0, 'K'},
+      {"turnarounds", no_argument, 0, 'W'},
+      {"budget", required_argument, 0, 'B'},
+      {"pipeline", no_argument, 0, 'j'},
+      {"helper", required_argument, 0, 'H'},
+      {"report", no_argument, 0, 'J'},
+      {"checkpoint", no_argument, 0, 'k'},
+      {"resume", no_argument, 0, 'u'},
+      {"simulate", no_argument, 0, 'x'},
+      {"sim-file", required_argument, 0, 'X'},
+      {"record", required_argument, 0, 'c'},
+      {"replay", required_argument, 0, 'i'},
+      {"debug", optional_argument, 0, 'd'},
+      {"verbose", optional_argument, 0, 'v'},
+      {"log", optional_argument, 0, 'l'},
+      {"help", optional_argument, 0, 'h'},
+      {0, 0, 0, 0}};
+  if (argc < 2) {
+    PrintHelp("");
+  } else {
+    int opt, idx;
+    while ((opt = getopt_long(argc, argv,
+                              "o:p:t:n:s:r:w:M:f:R:C:P:F:bqEKWB:jH:"
+                              "JkuxX:c:i:dvlh",
+                              long_options, &idx)) != -1) {
+      switch (opt) {
+        case 'o':
+          if (optarg) {
+            fname_prefix = std::string(optarg);
+          }
+          break;
+        case 'p':
+          num_pages = strtoull(optarg, NULL, 10);
+          break;
+        case 't': {
+          type = std::string(optarg);
+          if (type == "DDR4" || type == "ddr4") {
+            ddr_type = DDRType::DDR4;
+          } else if (type == "DDR5" || type == "ddr5") {
+            ddr_type = DDRType::DDR5;
+          } else {
+            spdlog::error("Unsupported DDR type: {}", type);
+            exit(EXIT_FAILURE);
+          }
+          break;
+        }
+        case 'n':
+          num_dimms = strtoull(optarg, NULL, 10);
+          break;
+        case 's':
+          module_size =
+              strtoull(optarg, NULL, 10) * 1024ULL * 1024ULL * 1024ULL;
+          break;
+        case 'r':
+          num_ranks = strtoull(optarg, NULL, 10);
+          break;
+        case 'w':
+          dq_width = strtoull(optarg, NULL, 10);
+          break;
+        case 'M':
+          if (!ReadMappingArtifact(std::string(optarg), &mapping)) {
+            exit(EXIT_FAILURE);
+          }
+          mapped = true;
+          ddr_type = mapping.ddr_type;
+          type = (ddr_type == DDRType::DDR5) ? "ddr5" : "ddr4";
+          module_size = mapping.module_size;
+          num_ranks = mapping.num_ranks;
+          dq_width = mapping.dq_width;
+          num_dimms = mapping.num_dimms;
+          functions = mapping.Functions();
+          row_bits = mapping.row_bits;
+          column_bits = mapping.column_bits;
+          break;
+        case 'f': {
+          std::stringstream ss(optarg);
+          std::string token;
+          while (std::getline(ss, token, ',')) {
+            functions.push_back(strtoull(token.c_str(), nullptr, 16));
+          }
+          break;
+        }
+        case 'R':
+          row_bits = strtoull(optarg, NULL, 16);
+          break;
+        case 'C':
+          column_bits = strtoull(optarg, NULL, 16);
+          break;
+        case 'P':
+          platform = std::string(optarg);
+          break;
+        case 'F':
+          profiles_fname = std::string(optarg);
+          break;
+        case 'b':
+          batch = true;
+          break;
+        case 'q':
+          schedule = true;
+          break;
+        case 'E':
+          spectral = true;
+          break;
+        case 'K':
+          concurrent = true;
+          break;
+        case 'W':
+          turnarounds = true;
+          break;
+        case 'B':
+          budget = strtoull(optarg, NULL, 10);
+          break;
+        case 'j':
+          pipelined = true;
+          break;
+        case 'H':
+          helper_core = static_cast<int>(strtol(optarg, NULL, 10));
+          break;
+        case 'J':
+          report = true;
+          break;
+        case 'k':
+          checkpoint = true;
+          break;
+        case 'u':
+          resume = true;
+          break;
+        case 'x':
+          simulate = true;
+          break;
+        case 'X':
+          simulate = true;
+          sim_fname = std::string(optarg);
+          break;
+        case 'c':
+          record_fname = std::string(optarg);
+          break;
+        case 'i':
+          replay_fname = std::string(optarg);
+          break;
+        case 'd':
+          debug = true;
+          break;
+        case 'v':
+          verbose = true;
+          break;
+        case 'l':
+          logging = true;
+          break;
+        case 'h':
+          PrintHelp("");
+          exit(EXIT_SUCCESS);
+        default:
+          PrintHelp("");
+          exit(EXIT_FAILURE);
+      }
+    }
+  }
+
+  InitBackends("sudoku_pipeline", simulate, sim_fname, record_fname,
+               replay_fname, profiles_fname, ddr_type, &platform);
+
+  AddressingConfig* addressing_config =
+      new AddressingConfig(type, fname_prefix, verbose, debug, logging);
+  addressing_config->checkpoint = checkpoint || resume;
+  addressing_config->pipelined = pipelined;
+  addressing_config->helper_core = helper_core;
+  addressing_config->batched = batch;
+  addressing_config->scheduled = schedule;
+  addressing_config->spectral = spectral;
+  addressing_config->concurrent = concurrent;
+  addressing_config->turnarounds = turnarounds;
+  addressing_config->trial_budget = budget;
+  MemoryPoolConfig* memory_pool_config = new MemoryPoolConfig(
+      page_size, num_pages, granularity, true /* hugepage */);
+  DRAMConfig* dram_config =
+      new DRAMConfig(ddr_type, module_size, static_cast<uint16_t>(num_ranks),
+                     static_cast<uint16_t>(dq_width));
+  MemoryConfig* memory_config = new MemoryConfig(1, 1, num_dimms, dram_config);
+
+  // All steps share this instance: the pool and its translation cache are
+  // set up once, and each step starts from the state of the previous ones
+  Addressing* sudoku = new Addressing(dram_config, memory_config,
+                                      memory_pool_config, addressing_config);
+  sudoku->Initialize();
+  if (resume && !sudoku->ResumeCheckpoint()) {
+    exit(EXIT_FAILURE);
+  }
+  if (mapped) {
+    if (!sudoku->SetMapping(mapping)) {
+      exit(EXIT_FAILURE);
+    }
+  }
+  bool pass = true;
+
+  // Step 0. Reverse-engineering DRAM addressing functions
+  if (functions.empty()) {
+    spdlog::info("[+] Reverse-engineer DRAM addressing functions");
+    sudoku->ReverseAddressingFunctions();
+    functions = sudoku->GetAddressingFunctions();
+    if (functions.size() != sudoku->GetNumFunctions()) {
+      spdlog::error("[-] Found {} functions instead of {}.", functions.size(),
+                    sudoku->GetNumFunctions());
+      pass = false;
+    }
+  } else {
+    spdlog::info("[+] Skip reversing: {} functions given", functions.size());
+    sudoku->SetAddressingFunctions(functions);
+  }
+
+  // Step 1. Identifying row and column bits
+  if (pass && (row_bits == 0 || column_bits == 0)) {
+    spdlog::info("[+] Identify DRAM row and column bits");
+    sudoku->IdentifyBits(functions);
+  } else if (pass) {
+    spdlog::info("[+] Skip identifying: row and column bits given");
+    sudoku->SetRowBits(row_bits);
+    sudoku->SetColumnBits(column_bits);
+  }
+
+  // Step 2. Validating the mapping (may resolve unidentified bits)
+  if (pass) {
+    spdlog::info("[+] Validate DRAM address mapping");
+    pass = sudoku->ValidateAddressMapping();
+    if (!pass) {
+      spdlog::error("[-] DRAM address mapping is not valid.");
+    }
+  }
+
+  // Step 3. Decomposing the functions
+  if (pass) {
+    spdlog::info("[+] Decompose DRAM addressing functions");
+    if (concurrent) {
+      // the concurrent refresh capture does not time single pairs
+      sudoku->DecomposeUsingRefreshes();
+      sudoku->DecomposeUsingConsecutiveAccesses();
+    } else {
+      sudoku->DecomposeFunctions();
+    }
+  }
+  sudoku->WriteMapping("sudoku_pipeline");
+  if (report) {
+    sudoku->ReportRun("sudoku_pipeline");
+  }
+  sudoku->Finalize();
+
+  delete sudoku;
+  delete memory_pool_config;
+  delete memory_config;
+  delete dram_config;
+  delete addressing_config;
+
+  return pass ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,35 @@
+# Run a binary on the simulated DRAM backend and check what it recovered: the
+# run must succeed, and its output (stdout and stderr), or FILE if set, must
+# match every regular expression of EXPECT. The output is printed, so
+# `ctest -V` shows the measurements of a passing run too.
+#
+# Usage: cmake "-DCOMMAND=binary;arg;..." "-DEXPECT=regex;..." [-DFILE=...]
+#            -P check_simulation.cmake
+
+execute_process(
+    COMMAND ${COMMAND}
+    OUTPUT_VARIABLE output
+    ERROR_VARIABLE output
+    RESULT_VARIABLE result
+)
+message("${output}")
+if(NOT result EQUAL 0)
+    message(FATAL_ERROR "${COMMAND} failed: ${result}")
+endif()
+
+if(FILE)
+    if(NOT EXISTS "${FILE}")
+        message(FATAL_ERROR "${FILE} was not written")
+    endif()
+    file(READ "${FILE}" output)
+endif()
+set(failures 0)
+foreach(regex IN LISTS EXPECT)
+    if(NOT output MATCHES "${regex}")
+        message(SEND_ERROR "Expected: ${regex}")
+        math(EXPR failures "${failures} + 1")
+    endif()
+endforeach()
+if(failures GREATER 0)
+    message(FATAL_ERROR "${failures} expectation(s) not met")
+endif()
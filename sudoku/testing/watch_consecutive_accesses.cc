@@ -1,11 +1,11 @@
 #include <getopt.h>
 #include <spdlog/spdlog.h>
-#include <unistd.h>
 
 #include <cstdint>
 #include <iostream>
 #include <string>
 
+#include "../internal/backend.h"
 #include "../internal/constants.h"
 #include "../sudoku.h"
 #include "../sudoku_addressing.h"
@@ -19,9 +19,10 @@ static const char help_msg[] =
     Options:
       --output,    -o [STR]     Output filename prefix
       --pages,     -p [INT]     Number of OS memory pages to allocate
-      --mode,      -m [STR]     Mode (supported: stat and check)
+      --mode,      -m [STR]     Mode (supported: stat, check, and sweep)
         stat:                   Get statistics of single and paired memory accesses
         check:                  Check the paired memory access latencies with given constraints
+        sweep:                  Get statistics of paired memory accesses for stream lengths 1 to --length
 
       --type,      -t [STR]     DDR type ([ddr4] or ddr5)
       --num,       -n [INT]     Number of DRAM modules
@@ -33,6 +34,16 @@ static const char help_msg[] =
       --row,       -R [HEX]     DRAM row bits (for check mode)
       --column,    -C [HEX]     DRAM column bits (for check mode)
       --length,    -L [INT]     length of each consecutive memory access stream (default: 4)
+      --access,    -A [STR]     Consecutive access pattern ([rdrd], rdwr, wrrd, or wrwr)
+      --platform,  -P [STR]     Platform profile name (default: auto-detect)
+      --profiles,  -F [FILE]    Custom platform profiles file
+      --binary,    -y           Write stat and check results to binary files (see convert_results)
+      --columnar,  -z           Write stat and check results to columnar files (see sudoku_dump)
+      --report,    -J           Write a JSON run report ({prefix}.report.json)
+      --simulate,  -x           Run on the simulated DRAM backend (no sudo)
+      --sim-file,  -X [FILE]    Simulated DRAM file (implies --simulate)
+      --record,    -c [FILE]    Record all oracle calls into a trace file
+      --replay,    -i [FILE]    Replay oracle calls from a trace file (no sudo)
 
       --debug,     -d           Enable debug output
       --verbose,   -v           Enable verbose mode
@@ -50,7 +61,8 @@ void PrintHelp(std::string msg) {
 }
 
 int main(int argc, char* argv[]) {
-  std::string fname_prefix = "default", type = "ddr4", mode = "watch";
+  std::string fname_prefix = "default", type = "ddr4", mode = "watch",
+              access = "rdrd";
   uint64_t num_pages = 19, page_size = 1ULL * 1024ULL * 1024ULL * 1024ULL,
            granularity = (1ULL << CACHELINE_OFFSET), num_dimms = 1,
            module_size = 32ULL * 1024ULL * 1024ULL * 1024ULL, num_ranks = 2,
@@ -58,17 +70,21 @@ int main(int argc, char* argv[]) {
   DDRType ddr_type = DDRType::DDR4;
   std::vector<uint64_t> same_functions = {};
   std::vector<uint64_t> diff_functions = {};
+  std::string platform = "", profiles_fname = "";
+  ConsecutiveAccess pattern = ConsecutiveAccess::RDRD;
+  bool binary = false;
+  bool columnar = false;
+  bool report = false;
+  bool simulate = false;
+  std::string sim_fname = "";
+  std::string record_fname = "";
+  std::string replay_fname = "";
   bool debug = false, verbose = false, logging = false;
 
-  // check sudo privilege
-  if (getuid() != 0) {
-    spdlog::error("watch_consecutive_accesses requires sudo privilege.");
-    exit(EXIT_FAILURE);
-  }
-
   // parse argument
   static struct option long_options[] = {{"output", optional_argument, 0, 'o'},
                                          {"pages", optional_argument, 0, 'p'},
+                                         {"mode", required_argument, 0, 'm'},
                                          {"type", required_argument, 0, 't'},
                                          {"num", required_argument, 0, 'n'},
                                          {"size", required_argument, 0, 's'},
@@ -79,6 +95,16 @@ int main(int argc, char* argv[]) {
                                          {"row", required_argument, 0, 'R'},
                                          {"column", required_argument, 0, 'C'},
                                          {"length", required_argument, 0, 'L'},
+                                         {"platform", required_argument, 0, 'P'},
+                                         {"profiles", required_argument, 0, 'F'},
+                                         {"access", required_argument, 0, 'A'},
+                                         {"binary", no_argument, 0, 'y'},
+                                         {"columnar", no_argument, 0, 'z'},
+                                         {"report", no_argument, 0, 'J'},
+                                         {"simulate", no_argument, 0, 'x'},
+                                         {"sim-file", required_argument, 0, 'X'},
+                                         {"record", required_argument, 0, 'c'},
+                                         {"replay", required_argument, 0, 'i'},
                                          {"debug", optional_argument, 0, 'd'},
                                          {"verbose", optional_argument, 0, 'v'},
                                          {"log", optional_argument, 0, 'l'},
@@ -88,7 +114,8 @@ int main(int argc, char* argv[]) {
     PrintHelp("");
   } else {
     int opt, idx;
-    while ((opt = getopt_long(argc, argv, "o:p:t:m:n:s:r:w:S:D:R:C:dvlh",
+    while ((opt = getopt_long(argc, argv,
+                              "o:p:t:m:n:s:r:w:S:D:R:C:L:P:F:A:yzJxX:c:i:dvlh",
                               long_options, &idx)) != -1) {
       switch (opt) {
         case 'o':
@@ -152,7 +179,50 @@ int main(int argc, char* argv[]) {
           column_bits = strtoull(optarg, NULL, 16);
           break;
         case 'L':
-          length = strtoull(optarg, NULL, 16);
+          length = strtoull(optarg, NULL, 10);
+          break;
+        case 'P':
+          platform = std::string(optarg);
+          break;
+        case 'F':
+          profiles_fname = std::string(optarg);
+          break;
+        case 'A':
+          access = std::string(optarg);
+          if (access == "rdrd" || access == "RDRD") {
+            pattern = ConsecutiveAccess::RDRD;
+          } else if (access == "rdwr" || access == "RDWR") {
+            pattern = ConsecutiveAccess::RDWR;
+          } else if (access == "wrrd" || access == "WRRD") {
+            pattern = ConsecutiveAccess::WRRD;
+          } else if (access == "wrwr" || access == "WRWR") {
+            pattern = ConsecutiveAccess::WRWR;
+          } else {
+            spdlog::error("Unsupported access pattern: {}", access);
+            exit(EXIT_FAILURE);
+          }
+          break;
+        case 'y':
+          binary = true;
+          break;
+        case 'z':
+          columnar = true;
+          break;
+        case 'J':
+          report = true;
+          break;
+        case 'x':
+          simulate = true;
+          break;
+        case 'X':
+          simulate = true;
+          sim_fname = std::string(optarg);
+          break;
+        case 'c':
+          record_fname = std::string(optarg);
+          break;
+        case 'i':
+          replay_fname = std::string(optarg);
           break;
         case 'd':
           debug = true;
@@ -173,8 +243,13 @@ int main(int argc, char* argv[]) {
     }
   }
 
+  InitBackends("watch_consecutive_accesses", simulate, sim_fname, record_fname,
+               replay_fname, profiles_fname, ddr_type, &platform);
+
   AddressingConfig* addressing_config =
       new AddressingConfig(type, fname_prefix, verbose, debug, logging);
+  addressing_config->binary = binary;
+  addressing_config->columnar = columnar;
   MemoryPoolConfig* memory_pool_config = new MemoryPoolConfig(
       page_size, num_pages, granularity, true /* hugepage */);
   DRAMConfig* dram_config =
@@ -185,20 +260,34 @@ int main(int argc, char* argv[]) {
   Addressing* sudoku = new Addressing(dram_config, memory_config,
                                       memory_pool_config, addressing_config);
   sudoku->Initialize();
+  // The constraints describe the results (e.g., the columnar file header)
+  std::vector<uint64_t> functions(same_functions);
+  functions.insert(functions.end(), diff_functions.begin(),
+                   diff_functions.end());
+  sudoku->SetAddressingFunctions(functions);
+  sudoku->SetRowBits(row_bits);
+  sudoku->SetColumnBits(column_bits);
   if (mode == "stat" || mode == "STAT") {
     // Stat
-    spdlog::info("[+] StatReadReadAccess");
-    sudoku->StatReadReadAccess(length);
+    spdlog::info("[+] StatConsecutiveAccess ({})", access);
+    sudoku->StatConsecutiveAccess(pattern, length);
   } else if (mode == "check" || mode == "CHECK") {
     // Check
     Constraints c =
         Constraints(same_functions, diff_functions, row_bits, column_bits);
-    spdlog::info("[+] CheckReadReadAccess");
-    sudoku->CheckReadReadAccess(c, length);
+    spdlog::info("[+] CheckConsecutiveAccess ({})", access);
+    sudoku->CheckConsecutiveAccess(c, pattern, length);
+  } else if (mode == "sweep" || mode == "SWEEP") {
+    // Sweep -- stream lengths from 1 to length
+    spdlog::info("[+] SweepConsecutiveAccess ({})", access);
+    sudoku->SweepConsecutiveAccess(pattern, 1, length);
   } else {
     spdlog::error("[-] Unsupported mode: {}", mode);
     exit(EXIT_FAILURE);
   }
+  if (report) {
+    sudoku->ReportRun("watch_consecutive_accesses");
+  }
   sudoku->Finalize();
 
   delete sudoku;
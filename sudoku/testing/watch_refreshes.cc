@@ -1,11 +1,11 @@
 #include <getopt.h>
 #include <spdlog/spdlog.h>
-#include <unistd.h>
 
 #include <cstdint>
 #include <iostream>
 #include <string>
 
+#include "../internal/backend.h"
 #include "../internal/constants.h"
 #include "../sudoku.h"
 #include "../sudoku_addressing.h"
@@ -19,10 +19,12 @@ static const char help_msg[] =
     Options:
       --output,    -o [STR]     Output filename prefix
       --pages,     -p [INT]     Number of OS memory pages to allocate
-      --mode,      -m [STR]     Mode (supported: watch, stat, and check)
+      --mode,      -m [STR]     Mode (supported: watch, stream, stat, check, and synthetic)
         watch:                  Watch periodic refresh-induced latency spikes on single and paired memory accesses
+        stream:                 Watch refresh events on a single memory access online for --duration seconds
         stat:                   Get statistics of single and paired memory accesses
         check:                  Check the paired memory access latencies with given constraints
+        synthetic:              Validate refresh interval estimators on synthetic spike trains (no sudo)
 
       --type,      -t [STR]     DDR type ([ddr4] or ddr5)
       --num,       -n [INT]     Number of DRAM modules
@@ -33,6 +35,18 @@ static const char help_msg[] =
       --diff,      -D [HEXes]   Constraints: diff DRAM mapping functions in hex, separated by commas (for check mode)
       --row,       -R [HEX]     DRAM row bits (for check mode)
       --column,    -C [HEX]     DRAM column bits (for check mode)
+      --platform,  -P [STR]     Platform profile name (default: auto-detect)
+      --profiles,  -F [FILE]    Custom platform profiles file
+      --duration,  -T [INT]     Watch duration in seconds (for stream mode, default: 60)
+      --pipeline,  -j           Prepare and log pairs on a helper thread (for stat and check modes)
+      --helper,    -H [INT]     Helper thread core (with --pipeline, default: another allowed core)
+      --binary,    -y           Write stat and check results to binary files (see convert_results)
+      --columnar,  -z           Write stat and check results to columnar files (see sudoku_dump)
+      --report,    -J           Write a JSON run report ({prefix}.report.json)
+      --simulate,  -x           Run on the simulated DRAM backend (no sudo)
+      --sim-file,  -X [FILE]    Simulated DRAM file (implies --simulate)
+      --record,    -c [FILE]    Record all oracle calls into a trace file
+      --replay,    -i [FILE]    Replay oracle calls from a trace file (no sudo)
 
       --debug,     -d           Enable debug output
       --verbose,   -v           Enable verbose mode
@@ -58,17 +72,23 @@ int main(int argc, char* argv[]) {
   DDRType ddr_type = DDRType::DDR4;
   std::vector<uint64_t> same_functions = {};
   std::vector<uint64_t> diff_functions = {};
+  std::string platform = "", profiles_fname = "";
+  uint64_t duration = 60;
+  bool pipelined = false;
+  int helper_core = -1;
+  bool binary = false;
+  bool columnar = false;
+  bool report = false;
+  bool simulate = false;
+  std::string sim_fname = "";
+  std::string record_fname = "";
+  std::string replay_fname = "";
   bool debug = false, verbose = false, logging = false;
 
-  // check sudo privilege
-  if (getuid() != 0) {
-    spdlog::error("watch_refreshes requires sudo privilege.");
-    exit(EXIT_FAILURE);
-  }
-
   // parse argument
   static struct option long_options[] = {{"output", optional_argument, 0, 'o'},
                                          {"pages", optional_argument, 0, 'p'},
+                                         {"mode", required_argument, 0, 'm'},
                                          {"type", required_argument, 0, 't'},
                                          {"num", required_argument, 0, 'n'},
                                          {"size", required_argument, 0, 's'},
@@ -78,6 +98,18 @@ int main(int argc, char* argv[]) {
                                          {"diff", required_argument, 0, 'D'},
                                          {"row", required_argument, 0, 'R'},
                                          {"column", required_argument, 0, 'C'},
+                                         {"platform", required_argument, 0, 'P'},
+                                         {"profiles", required_argument, 0, 'F'},
+                                         {"duration", required_argument, 0, 'T'},
+                                         {"pipeline", no_argument, 0, 'j'},
+                                         {"helper", required_argument, 0, 'H'},
+                                         {"binary", no_argument, 0, 'y'},
+                                         {"columnar", no_argument, 0, 'z'},
+                                         {"report", no_argument, 0, 'J'},
+                                         {"simulate", no_argument, 0, 'x'},
+                                         {"sim-file", required_argument, 0, 'X'},
+                                         {"record", required_argument, 0, 'c'},
+                                         {"replay", required_argument, 0, 'i'},
                                          {"debug", optional_argument, 0, 'd'},
                                          {"verbose", optional_argument, 0, 'v'},
                                          {"log", optional_argument, 0, 'l'},
@@ -87,7 +119,8 @@ int main(int argc, char* argv[]) {
     PrintHelp("");
   } else {
     int opt, idx;
-    while ((opt = getopt_long(argc, argv, "o:p:t:m:n:s:r:w:S:D:R:C:dvlh",
+    while ((opt = getopt_long(argc, argv,
+                              "o:p:t:m:n:s:r:w:S:D:R:C:P:F:T:jH:yzJxX:c:i:dvlh",
                               long_options, &idx)) != -1) {
       switch (opt) {
         case 'o':
@@ -150,6 +183,43 @@ int main(int argc, char* argv[]) {
         case 'C':
           column_bits = strtoull(optarg, NULL, 16);
           break;
+        case 'P':
+          platform = std::string(optarg);
+          break;
+        case 'F':
+          profiles_fname = std::string(optarg);
+          break;
+        case 'T':
+          duration = strtoull(optarg, NULL, 10);
+          break;
+        case 'j':
+          pipelined = true;
+          break;
+        case 'H':
+          helper_core = static_cast<int>(strtol(optarg, NULL, 10));
+          break;
+        case 'y':
+          binary = true;
+          break;
+        case 'z':
+          columnar = true;
+          break;
+        case 'J':
+          report = true;
+          break;
+        case 'x':
+          simulate = true;
+          break;
+        case 'X':
+          simulate = true;
+          sim_fname = std::string(optarg);
+          break;
+        case 'c':
+          record_fname = std::string(optarg);
+          break;
+        case 'i':
+          replay_fname = std::string(optarg);
+          break;
         case 'd':
           debug = true;
           break;
@@ -168,9 +238,18 @@ int main(int argc, char* argv[]) {
       }
     }
   }
+  bool synthetic = (mode == "synthetic" || mode == "SYNTHETIC");
+
+  // synthetic spike trains need no hardware access
+  InitBackends("watch_refreshes", simulate, sim_fname, record_fname,
+               replay_fname, profiles_fname, ddr_type, &platform, synthetic);
 
   AddressingConfig* addressing_config =
       new AddressingConfig(type, fname_prefix, verbose, debug, logging);
+  addressing_config->binary = binary;
+  addressing_config->columnar = columnar;
+  addressing_config->pipelined = pipelined;
+  addressing_config->helper_core = helper_core;
   MemoryPoolConfig* memory_pool_config = new MemoryPoolConfig(
       page_size, num_pages, granularity, true /* hugepage */);
   DRAMConfig* dram_config =
@@ -180,7 +259,26 @@ int main(int argc, char* argv[]) {
 
   Addressing* sudoku = new Addressing(dram_config, memory_config,
                                       memory_pool_config, addressing_config);
+  if (synthetic) {
+    // Validate -- interval estimators on synthetic spike trains
+    spdlog::info("[+] ValidateRefreshPeriodEstimator");
+    sudoku->ValidateRefreshPeriodEstimator();
+
+    delete sudoku;
+    delete memory_pool_config;
+    delete memory_config;
+    delete dram_config;
+    delete addressing_config;
+    return 0;
+  }
   sudoku->Initialize();
+  // The constraints describe the results (e.g., the columnar file header)
+  std::vector<uint64_t> functions(same_functions);
+  functions.insert(functions.end(), diff_functions.begin(),
+                   diff_functions.end());
+  sudoku->SetAddressingFunctions(functions);
+  sudoku->SetRowBits(row_bits);
+  sudoku->SetColumnBits(column_bits);
   if (mode == "watch" || mode == "WATCH") {
     // Watch -- single
     spdlog::info("[+] WatchRefreshSingleAccess");
@@ -190,6 +288,10 @@ int main(int argc, char* argv[]) {
     sudoku->WatchRefreshPairedAccessCoarse();
     spdlog::info("[+] WatchRefreshPairedAccessFine");
     sudoku->WatchRefreshPairedAccessFine();
+  } else if (mode == "stream" || mode == "STREAM") {
+    // Watch -- single, streaming
+    spdlog::info("[+] WatchRefreshStream");
+    sudoku->WatchRefreshStream(REFRESH_CYCLE_LOWER_BOUND, duration);
   } else if (mode == "stat" || mode == "STAT") {
     // Stat -- single
     spdlog::info("[+] StatRefIntervalSingleAccess");
@@ -211,6 +313,9 @@ int main(int argc, char* argv[]) {
     spdlog::error("[-] Unsupported mode: {}", mode);
     exit(EXIT_FAILURE);
   }
+  if (report) {
+    sudoku->ReportRun("watch_refreshes");
+  }
   sudoku->Finalize();
 
   delete sudoku;
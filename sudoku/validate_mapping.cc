@@ -1,11 +1,11 @@
 #include <getopt.h>
 #include <spdlog/spdlog.h>
-#include <unistd.h>
 
 #include <cstdint>
 #include <iostream>
 #include <string>
 
+#include "internal/backend.h"
 #include "internal/constants.h"
 #include "sudoku.h"
 #include "sudoku_addressing.h"
@@ -24,9 +24,17 @@ static const char help_msg[] =
       --size,      -s [INT]     Size of DRAM module in GB
       --rank,      -r [INT]     Number of ranks per DRAM module
       --width,     -w [INT]     DQ width of DRAM (8, 16, or 32)
+      --mapping,   -M [FILE]    DRAM address mapping from an earlier step ({prefix}.mapping.json)
       --functions, -f [HEXes]   DRAM functions in hex, separated by commas
       --row,       -R [HEX]     DRAM row bits
       --column,    -C [HEX]     DRAM column bits
+      --platform,  -P [STR]     Platform profile name (default: auto-detect)
+      --profiles,  -F [FILE]    Custom platform profiles file
+      --report,    -J           Write a JSON run report ({prefix}.report.json)
+      --simulate,  -x           Run on the simulated DRAM backend (no sudo)
+      --sim-file,  -X [FILE]    Simulated DRAM file (implies --simulate)
+      --record,    -c [FILE]    Record all oracle calls into a trace file
+      --replay,    -i [FILE]    Replay oracle calls from a trace file (no sudo)
 
       --debug,     -d
       --verbose,   -v
@@ -51,15 +59,17 @@ int main(int argc, char* argv[]) {
            dq_width = 8;
   uint64_t row_bits = 0, column_bits = 0;
   DDRType ddr_type = DDRType::DDR4;
+  MappingArtifact mapping;
+  bool mapped = false;
   std::vector<uint64_t> functions = {};
+  std::string platform = "", profiles_fname = "";
+  bool report = false;
+  bool simulate = false;
+  std::string sim_fname = "";
+  std::string record_fname = "";
+  std::string replay_fname = "";
   bool debug = false, verbose = false, logging = false;
 
-  // check sudo privilege
-  if (getuid() != 0) {
-    spdlog::error("validate_mapping requires sudo privilege.");
-    exit(EXIT_FAILURE);
-  }
-
   // parse argument
   static struct option long_options[] = {
       {"output", optional_argument, 0, 'o'},
@@ -69,9 +79,17 @@ int main(int argc, char* argv[]) {
       {"size", required_argument, 0, 's'},
       {"rank", required_argument, 0, 'r'},
       {"width", required_argument, 0, 'w'},
+      {"mapping", required_argument, 0, 'M'},
       {"functions", required_argument, 0, 'f'},
       {"row", required_argument, 0, 'R'},
       {"column", required_argument, 0, 'C'},
+      {"platform", required_argument, 0, 'P'},
+      {"profiles", required_argument, 0, 'F'},
+      {"report", no_argument, 0, 'J'},
+      {"simulate", no_argument, 0, 'x'},
+      {"sim-file", required_argument, 0, 'X'},
+      {"record", required_argument, 0, 'c'},
+      {"replay", required_argument, 0, 'i'},
       {"debug", optional_argument, 0, 'd'},
       {"verbose", optional_argument, 0, 'v'},
       {"log", optional_argument, 0, 'l'},
@@ -81,7 +99,8 @@ int main(int argc, char* argv[]) {
     PrintHelp("");
   } else {
     int opt, idx;
-    while ((opt = getopt_long(argc, argv, "o:p:t:n:s:r:w:f:R:C:dvlh",
+    while ((opt = getopt_long(argc, argv,
+                              "o:p:t:n:s:r:w:M:f:R:C:P:F:JxX:c:i:dvlh",
                               long_options, &idx)) != -1) {
       switch (opt) {
         case 'o':
@@ -117,6 +136,21 @@ int main(int argc, char* argv[]) {
         case 'w':
           dq_width = strtoull(optarg, NULL, 10);
           break;
+        case 'M':
+          if (!ReadMappingArtifact(std::string(optarg), &mapping)) {
+            exit(EXIT_FAILURE);
+          }
+          mapped = true;
+          ddr_type = mapping.ddr_type;
+          type = (ddr_type == DDRType::DDR5) ? "ddr5" : "ddr4";
+          module_size = mapping.module_size;
+          num_ranks = mapping.num_ranks;
+          dq_width = mapping.dq_width;
+          num_dimms = mapping.num_dimms;
+          functions = mapping.Functions();
+          row_bits = mapping.row_bits;
+          column_bits = mapping.column_bits;
+          break;
         case 'f': {
           std::stringstream ss(optarg);
           std::string token;
@@ -131,6 +165,28 @@ int main(int argc, char* argv[]) {
         case 'C':
           column_bits = strtoull(optarg, NULL, 16);
           break;
+        case 'P':
+          platform = std::string(optarg);
+          break;
+        case 'F':
+          profiles_fname = std::string(optarg);
+          break;
+        case 'J':
+          report = true;
+          break;
+        case 'x':
+          simulate = true;
+          break;
+        case 'X':
+          simulate = true;
+          sim_fname = std::string(optarg);
+          break;
+        case 'c':
+          record_fname = std::string(optarg);
+          break;
+        case 'i':
+          replay_fname = std::string(optarg);
+          break;
         case 'd':
           debug = true;
           break;
@@ -150,6 +206,9 @@ int main(int argc, char* argv[]) {
     }
   }
 
+  InitBackends("validate_mapping", simulate, sim_fname, record_fname,
+               replay_fname, profiles_fname, ddr_type, &platform);
+
   AddressingConfig* addressing_config =
       new AddressingConfig(type, fname_prefix, verbose, debug, logging);
   MemoryPoolConfig* memory_pool_config =
@@ -162,6 +221,11 @@ int main(int argc, char* argv[]) {
                                       memory_pool_config, addressing_config);
 
   sudoku->Initialize();
+  if (mapped) {
+    if (!sudoku->SetMapping(mapping)) {
+      exit(EXIT_FAILURE);
+    }
+  }
   sudoku->SetAddressingFunctions(functions);
   sudoku->SetRowBits(row_bits);
   sudoku->SetColumnBits(column_bits);
@@ -170,6 +234,10 @@ int main(int argc, char* argv[]) {
   if (!pass) {
     spdlog::error("[-] Input DRAM address mapping is not valid.");
   }
+  sudoku->WriteMapping("validate_mapping");
+  if (report) {
+    sudoku->ReportRun("validate_mapping");
+  }
   sudoku->Finalize();
 
   delete sudoku;